@@ -8,7 +8,7 @@
  * Original file: examples/test-encode-decode-benchmark.cpp
  * Original repository: https://github.com/named-data/ndn-cpp
  *
- * Summary of Changes: Use ndn-ind includes. Use std::chrono.
+ * Summary of Changes: Use ndn-ind includes. Use std::chrono. Report allocations. Benchmark lazy decoding.
  *
  * which was originally released under the LGPL license with the following rights:
  *
@@ -31,6 +31,8 @@
  * A copy of the GNU Lesser General Public License is in the file COPYING.
  */
 
+#include <cstdlib>
+#include <new>
 #include <iostream>
 #include <time.h>
 #include <sys/time.h>
@@ -53,6 +55,22 @@ using namespace std;
 using namespace std::chrono;
 using namespace ndn_ind;
 
+static size_t allocationCount = 0;
+
+// Count all heap allocations, including in the library.
+void*
+operator new(size_t size)
+{
+  ++allocationCount;
+  void* p = malloc(size);
+  if (!p)
+    throw bad_alloc();
+  return p;
+}
+
+void
+operator delete(void* p) noexcept { free(p); }
+
 static double
 getNowSeconds()
 {
@@ -186,13 +204,17 @@ static uint8_t DEFAULT_EC_PRIVATE_KEY_DER[] = {
  * and only required fields.
  * @param useCrypto If true, sign the data packet.  If false, use a blank signature.
  * @param keyType KeyType.RSA or EC, used if useCrypto is true.
+ * @param useReusedBuffer If true, encode into the same vector each iteration
+ * instead of calling wireEncode. This is only used if useCrypto is false.
  * @param encoding Set this to the wire encoding.
+ * @param allocationsPerEncode Set this to the number of heap allocations for
+ * each iteration, including creating the Data packet.
  * @return The number of seconds for all iterations.
  */
 static double
 benchmarkEncodeDataSecondsCpp
   (int nIterations, bool useComplex, bool useCrypto, KeyType keyType,
-   Blob& encoding)
+   bool useReusedBuffer, Blob& encoding, double& allocationsPerEncode)
 {
   Name name;
   Blob content;
@@ -231,7 +253,10 @@ benchmarkEncodeDataSecondsCpp
   uint8_t signatureBitsArray[256];
   memset(signatureBitsArray, 0, sizeof(signatureBitsArray));
   Blob signatureBits(signatureBitsArray, sizeof(signatureBitsArray));
+  vector<uint8_t> reusedBuffer;
+  size_t dummyBeginOffset, dummyEndOffset;
 
+  size_t startAllocationCount = allocationCount;
   double start = getNowSeconds();
   for (int i = 0; i < nIterations; ++i) {
     Data data(name);
@@ -254,10 +279,18 @@ benchmarkEncodeDataSecondsCpp
       sha256Signature->setSignature(signatureBits);
     }
 
-    encoding = data.wireEncode();
+    if (useReusedBuffer && !useCrypto)
+      WireFormat::getDefaultWireFormat()->encodeData
+        (data, reusedBuffer, &dummyBeginOffset, &dummyEndOffset);
+    else
+      encoding = data.wireEncode();
   }
   double finish = getNowSeconds();
+  allocationsPerEncode =
+    (allocationCount - startAllocationCount) / (double)nIterations;
 
+  if (useReusedBuffer && !useCrypto)
+    encoding = Blob(reusedBuffer);
   return finish - start;
 }
 
@@ -279,11 +312,14 @@ validationFailure(const Data& data, const ValidationError& error)
  * @param useCrypto If true, verify the signature.  If false, don't verify.
  * @param keyType KeyType.RSA or EC, used if useCrypto is true.
  * @param encoding The wire encoding to decode.
+ * @param useLazy If true, use wireDecodeLazy and only get the name, as a
+ * forwarder would. Used if useCrypto is false.
  * @return The number of seconds for all iterations.
  */
 static double
 benchmarkDecodeDataSecondsCpp
-  (int nIterations, bool useCrypto, KeyType keyType, const Blob& encoding)
+  (int nIterations, bool useCrypto, KeyType keyType, const Blob& encoding,
+   bool useLazy = false)
 {
   // Initialize the KeyChain storage in case useCrypto is true.
   KeyChain keyChain("pib-memory:", "tpm-memory:");
@@ -303,6 +339,12 @@ benchmarkDecodeDataSecondsCpp
   double start = getNowSeconds();
   for (int i = 0; i < nIterations; ++i) {
     ptr_lib::shared_ptr<Data> data(new Data());
+    if (useLazy && !useCrypto) {
+      data->wireDecodeLazy(encoding);
+      if (data->getName().size() == 0)
+        cout << "Error: The decoded name is empty" << endl;
+      continue;
+    }
     data->wireDecode(encoding);
 
     if (useCrypto)
@@ -558,13 +600,28 @@ benchmarkEncodeDecodeDataCpp(bool useComplex, bool useCrypto, KeyType keyType)
   {
     int nIterations = useCrypto ? (keyType == KEY_TYPE_EC ? 10000 : 5000)
                                 : 2000000;
+    double allocationsPerEncode;
     double duration = benchmarkEncodeDataSecondsCpp
-      (nIterations, useComplex, useCrypto, keyType, encoding);
+      (nIterations, useComplex, useCrypto, keyType, false, encoding,
+       allocationsPerEncode);
     cout << "Encode " << (useComplex ? "complex " : "simple  ") << format
          << " data C++: Crypto? "
          << (useCrypto ? (keyType == KEY_TYPE_EC ? "EC " : "RSA") : "-  ")
          << ", Duration sec, Hz: " << duration << ", "
-         << (nIterations / duration) << endl;
+         << (nIterations / duration) << ", allocations per encode: "
+         << allocationsPerEncode << endl;
+
+    if (!useCrypto) {
+      Blob reusedBufferEncoding;
+      duration = benchmarkEncodeDataSecondsCpp
+        (nIterations, useComplex, useCrypto, keyType, true,
+         reusedBufferEncoding, allocationsPerEncode);
+      cout << "Encode " << (useComplex ? "complex " : "simple  ") << format
+           << " data C++: Reused buffer"
+           << ", Duration sec, Hz: " << duration << ", "
+           << (nIterations / duration) << ", allocations per encode: "
+           << allocationsPerEncode << endl;
+    }
   }
   {
     int nIterations = useCrypto ? (keyType == KEY_TYPE_EC ? 5000 : 50000)
@@ -576,9 +633,53 @@ benchmarkEncodeDecodeDataCpp(bool useComplex, bool useCrypto, KeyType keyType)
          << (useCrypto ? (keyType == KEY_TYPE_EC ? "EC " : "RSA") : "-  ")
          << ", Duration sec, Hz: " << duration << ", "
          << (nIterations / duration) << endl;
+
+    if (!useCrypto) {
+      duration = benchmarkDecodeDataSecondsCpp
+        (nIterations, useCrypto, keyType, encoding, true);
+      cout << "Decode " << (useComplex ? "complex " : "simple  ") << format
+           << " data C++: Lazy, name only"
+           << ", Duration sec, Hz: " << duration << ", "
+           << (nIterations / duration) << endl;
+    }
   }
 }
 
+/**
+ * Encode a Data packet with large content nIterations times and print the
+ * encoding rate and the number of allocations per encode to cout. This calls
+ * the wire format directly so that Data doesn't return a cached encoding.
+ * @param contentSize The number of bytes of content.
+ * @param nIterations The number of times to encode.
+ */
+static void
+benchmarkEncodeLargeDataCpp(size_t contentSize, int nIterations)
+{
+  Data data(Name("/ndn/ucla.edu/apps/lwndn-test/large/%FD%01%02%03%04"));
+  vector<uint8_t> content(contentSize);
+  for (size_t i = 0; i < contentSize; ++i)
+    content[i] = (uint8_t)i;
+  data.setContent(content);
+  data.getMetaInfo().setFreshnessPeriod(milliseconds(1000));
+
+  WireFormat* wireFormat = WireFormat::getDefaultWireFormat();
+  size_t signedPortionBeginOffset, signedPortionEndOffset;
+  size_t encodingLength = 0;
+  size_t startAllocationCount = allocationCount;
+  double start = getNowSeconds();
+  for (int i = 0; i < nIterations; ++i)
+    encodingLength += wireFormat->encodeData
+      (data, &signedPortionBeginOffset, &signedPortionEndOffset).size();
+  double duration = getNowSeconds() - start;
+  double allocationsPerEncode =
+    (allocationCount - startAllocationCount) / (double)nIterations;
+
+  cout << "Encode " << contentSize << " byte content TLV data C++: "
+       << "Duration sec, Hz: " << duration << ", " << (nIterations / duration)
+       << ", allocations per encode: " << allocationsPerEncode
+       << ", encoding length: " << (encodingLength / nIterations) << endl;
+}
+
 /**
  * Call benchmarkEncodeDataSecondsC and benchmarkDecodeDataSecondsC with appropriate nInterations.  Print the
  * results to cout.
@@ -628,6 +729,10 @@ main(int argc, char** argv)
     benchmarkEncodeDecodeDataCpp(false, true, KEY_TYPE_RSA);
     benchmarkEncodeDecodeDataCpp(true, true, KEY_TYPE_RSA);
 
+    benchmarkEncodeLargeDataCpp(1000, 500000);
+    benchmarkEncodeLargeDataCpp(8000, 200000);
+    benchmarkEncodeLargeDataCpp(64000, 20000);
+
     benchmarkEncodeDecodeDataC(false, false, KEY_TYPE_RSA);
     benchmarkEncodeDecodeDataC(true, false, KEY_TYPE_RSA);
     benchmarkEncodeDecodeDataC(false, true, KEY_TYPE_EC);
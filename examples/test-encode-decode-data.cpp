@@ -194,7 +194,7 @@ static void dumpData(const Data& data)
   if (data.getContent().size() > 0) {
     cout << "content (raw): ";
     for (size_t i = 0; i < data.getContent().size(); ++i)
-      cout << (*data.getContent())[i];
+      cout << data.getContent().buf()[i];
     cout<< endl;
     cout << "content (hex): " << data.getContent().toHex() << endl;
   }
@@ -308,7 +308,7 @@ int main(int argc, char** argv)
     Blob encoding = data->wireEncode();
 
     ptr_lib::shared_ptr<Data> reDecodedData(new Data());
-    reDecodedData->wireDecode(*encoding);
+    reDecodedData->wireDecode(encoding.buf(), encoding.size());
     cout << endl << "Re-decoded Data:" << endl;
     dumpData(*reDecodedData);
 
@@ -52,7 +52,7 @@ public:
     ++callbackCount_;
     cout << "Got data packet with name " << data->getName().toUri() << endl;
     for (size_t i = 0; i < data->getContent().size(); ++i)
-      cout << (*data->getContent())[i];
+      cout << data->getContent().buf()[i];
     cout << endl;
   }
 
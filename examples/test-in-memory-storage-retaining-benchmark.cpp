@@ -0,0 +1,92 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2020 Operant Networks, Incorporated.
+ * @author: Jeff Thompson <jefft0@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+
+/**
+ * This measures the time for InMemoryStorageRetaining to find a Data packet
+ * by Interest and by Name prefix, as the number of stored Data packets grows,
+ * similar to the KDK and CK storage of AccessManagerV2 and EncryptorV2.
+ */
+
+#include <iostream>
+#include <ndn-ind/in-memory-storage/in-memory-storage-retaining.hpp>
+
+using namespace std;
+using namespace std::chrono;
+using namespace ndn_ind;
+
+/**
+ * Insert nData Data packets with names like the CK names of EncryptorV2, then
+ * benchmark finding them.
+ * @param nData The number of Data packets.
+ */
+static void
+benchmarkStorage(size_t nData)
+{
+  InMemoryStorageRetaining storage;
+  Name prefix("/benchmark/CK");
+  vector<Name> names;
+  for (size_t i = 0; i < nData; ++i) {
+    Data data(Name(prefix).appendSequenceNumber(i).append("ENCRYPTED-BY").append
+      ("/benchmark/KEK/key"));
+    data.setContent(Blob((const uint8_t*)"content", 7));
+    storage.insert(data);
+    names.push_back(Name(prefix).appendSequenceNumber(i));
+  }
+
+  // Keep the total time about the same for each size.
+  size_t nFinds = max((size_t)100, (size_t)10000000 / nData);
+  size_t nFound = 0;
+  auto start = steady_clock::now();
+  for (size_t i = 0; i < nFinds; ++i) {
+    Interest interest(names[(i * 7919) % nData]);
+    interest.setCanBePrefix(true);
+    if (storage.find(interest))
+      ++nFound;
+  }
+  double interestMicroseconds = duration_cast<nanoseconds>
+    (steady_clock::now() - start).count() / 1000.0 / nFinds;
+
+  start = steady_clock::now();
+  for (size_t i = 0; i < nFinds; ++i) {
+    if (storage.find(names[(i * 7919) % nData]))
+      ++nFound;
+  }
+  double nameMicroseconds = duration_cast<nanoseconds>
+    (steady_clock::now() - start).count() / 1000.0 / nFinds;
+
+  cout << nData << " Data packets: " << interestMicroseconds <<
+    " us per find(Interest), " << nameMicroseconds << " us per find(Name) (" <<
+    nFound << " of " << 2 * nFinds << " found)" << endl;
+}
+
+int
+main(int argc, char** argv)
+{
+  try {
+    benchmarkStorage(1000);
+    benchmarkStorage(10000);
+    benchmarkStorage(100000);
+  } catch (std::exception& e) {
+    cout << "exception: " << e.what() << endl;
+  }
+  return 0;
+}
@@ -0,0 +1,93 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2020 Operant Networks, Incorporated.
+ * @author: Jeff Thompson <jefft0@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+/**
+ * This measures the time to make and encode the Interest for each segment in
+ * a segment fetch loop, by copying the Interest and encoding it each time, and
+ * by using an InterestEncodingTemplate.
+ */
+
+#include <iostream>
+#include <ndn-ind/util/interest-encoding-template.hpp>
+
+using namespace std;
+using namespace std::chrono;
+using namespace ndn_ind;
+
+/**
+ * Time making and encoding nIterations segment Interests, and print the time
+ * per Interest.
+ * @param label The label to print.
+ * @param prefixInterest The Interest with the name prefix.
+ * @param useTemplate If true, use an InterestEncodingTemplate. If false, copy
+ * prefixInterest, append the segment and encode.
+ * @param nIterations The number of Interests.
+ */
+static void
+benchmarkSegmentInterests
+  (const string& label, const Interest& prefixInterest, bool useTemplate,
+   size_t nIterations)
+{
+  size_t nBytes = 0;
+
+  auto start = steady_clock::now();
+  if (useTemplate) {
+    InterestEncodingTemplate encodingTemplate(prefixInterest);
+    for (size_t i = 0; i < nIterations; ++i) {
+      ptr_lib::shared_ptr<Interest> interest =
+        encodingTemplate.makeInterest(Name::Component::fromSegment(i));
+      nBytes += interest->wireEncode().size();
+    }
+  }
+  else {
+    for (size_t i = 0; i < nIterations; ++i) {
+      Interest interest(prefixInterest);
+      interest.getName().appendSegment(i);
+      nBytes += interest.wireEncode().size();
+    }
+  }
+  double nanosecondsPerInterest = duration_cast<nanoseconds>
+    (steady_clock::now() - start).count() / (double)nIterations;
+
+  cout << label << ": " << nanosecondsPerInterest << " ns/Interest (" <<
+    nBytes << " bytes)" << endl;
+}
+
+int
+main(int argc, char** argv)
+{
+  try {
+    Interest prefixInterest
+      (Name("/ndn/ucla.edu/benchmark/segmented-content/%FD%00%01"));
+    prefixInterest.setCanBePrefix(false);
+    prefixInterest.setMustBeFresh(false);
+    prefixInterest.setInterestLifetime(milliseconds(4000));
+
+    size_t nIterations = 100000;
+    benchmarkSegmentInterests
+      ("Copy and encode", prefixInterest, false, nIterations);
+    benchmarkSegmentInterests
+      ("InterestEncodingTemplate", prefixInterest, true, nIterations);
+  } catch (std::exception& e) {
+    cout << "exception: " << e.what() << endl;
+  }
+  return 0;
+}
@@ -0,0 +1,168 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2020 Operant Networks, Incorporated.
+ * @author: Jeff Thompson <jefft0@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+/**
+ * This measures the cost of dispatching a received Interest to the interest
+ * filters while the number of filters grows, such as a producer which sets a
+ * filter for each user. It uses a loopback transport so that no forwarder is
+ * needed.
+ */
+
+#include <iostream>
+#include <ndn-ind/face.hpp>
+
+using namespace std;
+using namespace std::chrono;
+using namespace ndn_ind;
+using namespace ndn_ind::func_lib;
+
+/**
+ * A LoopbackTransport discards sent packets and lets the benchmark deliver
+ * received packets directly to the element listener.
+ */
+class LoopbackTransport : public Transport {
+public:
+  LoopbackTransport()
+  : elementListener_(0)
+  {
+  }
+
+  virtual bool
+  isLocal(const Transport::ConnectionInfo& connectionInfo) { return true; }
+
+  virtual bool
+  isAsync() { return false; }
+
+  virtual void
+  connect
+    (const Transport::ConnectionInfo& connectionInfo,
+     ElementListener& elementListener, const OnConnected& onConnected)
+  {
+    elementListener_ = &elementListener;
+    if (onConnected)
+      onConnected();
+  }
+
+  virtual void
+  send(const uint8_t *data, size_t dataLength) {}
+
+  virtual void
+  processEvents() {}
+
+  virtual bool
+  getIsConnected() { return elementListener_ != 0; }
+
+  /**
+   * Deliver the encoding to the element listener as if it was received.
+   * @param encoding The wire encoding of the packet.
+   */
+  void
+  receive(const Blob& encoding)
+  {
+    elementListener_->onReceivedElement(encoding.buf(), encoding.size());
+  }
+
+private:
+  ElementListener* elementListener_;
+};
+
+static void
+onInterest
+  (const ptr_lib::shared_ptr<const Name>& prefix,
+   const ptr_lib::shared_ptr<const Interest>& interest, Face& face,
+   uint64_t interestFilterId,
+   const ptr_lib::shared_ptr<const InterestFilter>& filter, size_t* callCount)
+{
+  ++(*callCount);
+}
+
+/**
+ * Set nFilters interest filters for different users plus one regex filter,
+ * then time the dispatch of Interests which match one user filter and of
+ * Interests which don't match any user filter.
+ * @param nFilters The number of user interest filters.
+ * @param nDispatches The number of Interest packets for each measurement.
+ */
+static void
+benchmarkDispatch(size_t nFilters, size_t nDispatches)
+{
+  ptr_lib::shared_ptr<LoopbackTransport> transport(new LoopbackTransport());
+  Face face(transport, ptr_lib::make_shared<Transport::ConnectionInfo>());
+  Name prefix("/benchmark/filter");
+  size_t onInterestCallCount = 0;
+
+  for (size_t i = 0; i < nFilters; ++i)
+    face.setInterestFilter
+      (Name(prefix).append("user" + to_string(i)),
+       bind(&onInterest, _1, _2, _3, _4, _5, &onInterestCallCount));
+  face.setInterestFilter
+    (InterestFilter(prefix, "<>*<metadata>"),
+     bind(&onInterest, _1, _2, _3, _4, _5, &onInterestCallCount));
+  // Setting an interest filter doesn't connect, so express an interest which
+  // connects the transport to the face.
+  Interest interest("/benchmark/connect");
+  interest.setCanBePrefix(false);
+  interest.setInterestLifetime(hours(1));
+  face.expressInterest(interest, OnData(), OnTimeout());
+
+  // Encode the Interest packets before timing.
+  vector<Blob> matchedEncodings;
+  vector<Blob> unmatchedEncodings;
+  for (size_t i = 0; i < nDispatches; ++i) {
+    interest.setName(Name(prefix).append("user" + to_string(i % nFilters))
+      .append("data").appendSegment(i));
+    matchedEncodings.push_back(interest.wireEncode());
+    interest.setName(Name(prefix).append("guest" + to_string(i))
+      .append("data").appendSegment(i));
+    unmatchedEncodings.push_back(interest.wireEncode());
+  }
+
+  auto start = steady_clock::now();
+  for (size_t i = 0; i < nDispatches; ++i)
+    transport->receive(matchedEncodings[i]);
+  double matchedMicroseconds = duration_cast<nanoseconds>
+    (steady_clock::now() - start).count() / 1000.0 / nDispatches;
+
+  start = steady_clock::now();
+  for (size_t i = 0; i < nDispatches; ++i)
+    transport->receive(unmatchedEncodings[i]);
+  double unmatchedMicroseconds = duration_cast<nanoseconds>
+    (steady_clock::now() - start).count() / 1000.0 / nDispatches;
+
+  cout << "Interest filters: " << nFilters <<
+    ", matching Interest: " << matchedMicroseconds << " us/packet" <<
+    ", unmatched Interest: " << unmatchedMicroseconds << " us/packet" <<
+    ", dispatched: " << onInterestCallCount << endl;
+}
+
+int
+main(int argc, char** argv)
+{
+  try {
+    size_t nDispatches = 2000;
+    size_t filterCounts[] = { 100, 1000, 5000, 10000 };
+    for (size_t i = 0; i < sizeof(filterCounts) / sizeof(filterCounts[0]); ++i)
+      benchmarkDispatch(filterCounts[i], nDispatches);
+  } catch (std::exception& e) {
+    cout << "exception: " << e.what() << endl;
+  }
+  return 0;
+}
@@ -0,0 +1,348 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2020 Operant Networks, Incorporated.
+ * @author: Jeff Thompson <jefft0@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+/**
+ * This compares the rate and CPU time of receiving and sending a stream of
+ * packets through an IoUringTransport and through a TcpTransport on the
+ * loopback interface, and through an IoUringTransport and an
+ * AsyncUnixTransport on a Unix socket. A local socket is the other end so that
+ * no forwarder is needed.
+ */
+
+#include <atomic>
+#include <cstring>
+#include <ctime>
+#include <functional>
+#include <iostream>
+#include <thread>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/resource.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <ndn-ind/data.hpp>
+#include <ndn-ind/interest.hpp>
+#include <ndn-ind/transport/tcp-transport.hpp>
+#include <ndn-ind/transport/unix-transport.hpp>
+#include <ndn-ind/transport/async-unix-transport.hpp>
+#include <ndn-ind/transport/io-uring-transport.hpp>
+
+using namespace std;
+using namespace std::chrono;
+using namespace ndn_ind;
+
+#if NDN_IND_HAVE_LINUX_IO_URING_H
+
+/**
+ * A CountingElementListener counts the received elements.
+ */
+class CountingElementListener : public ElementListener {
+public:
+  CountingElementListener()
+  : nElements_(0)
+  {
+  }
+
+  virtual void
+  onReceivedElement(const uint8_t *element, size_t elementLength)
+  {
+    ++nElements_;
+  }
+
+  size_t nElements_;
+};
+
+/**
+ * Create a listening socket bound to an available port on the loopback
+ * interface.
+ * @param port Set this to the bound port.
+ * @return The socket descriptor.
+ */
+static int
+listenLoopback(unsigned short& port)
+{
+  int socketDescriptor = socket(AF_INET, SOCK_STREAM, 0);
+  struct sockaddr_in address;
+  memset(&address, 0, sizeof(address));
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  if (socketDescriptor < 0 ||
+      ::bind(socketDescriptor, (struct sockaddr*)&address, sizeof(address)) != 0 ||
+      listen(socketDescriptor, 1) != 0)
+    throw runtime_error("Can't listen on the loopback socket");
+
+  socklen_t addressLength = sizeof(address);
+  getsockname(socketDescriptor, (struct sockaddr*)&address, &addressLength);
+  port = ntohs(address.sin_port);
+  return socketDescriptor;
+}
+
+/**
+ * Create a listening Unix socket at filePath.
+ * @return The socket descriptor.
+ */
+static int
+listenUnix(const string& filePath)
+{
+  unlink(filePath.c_str());
+  int socketDescriptor = socket(AF_UNIX, SOCK_STREAM, 0);
+  struct sockaddr_un address;
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  strncpy(address.sun_path, filePath.c_str(), sizeof(address.sun_path) - 1);
+  if (socketDescriptor < 0 ||
+      ::bind(socketDescriptor, (struct sockaddr*)&address, sizeof(address)) != 0 ||
+      listen(socketDescriptor, 1) != 0)
+    throw runtime_error("Can't listen on the Unix socket");
+
+  return socketDescriptor;
+}
+
+/**
+ * Get the CPU time used by the calling thread in seconds.
+ */
+static double
+getThreadCpuSeconds()
+{
+  struct timespec time;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+  return time.tv_sec + time.tv_nsec / 1000000000.0;
+}
+
+/**
+ * Get the user and system CPU time used by all threads of the process in
+ * seconds. Unlike getThreadCpuSeconds, this includes work which the kernel
+ * gives to the io_uring worker threads (and the work of the other thread
+ * writing or reading the socket, which is the same for each transport).
+ */
+static double
+getProcessCpuSeconds()
+{
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1000000.0 +
+    usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1000000.0;
+}
+
+/**
+ * Connect the transport to the listening socket. A writer thread writes
+ * nPackets copies of the encoding to the socket while this thread calls
+ * processEvents(). Then this thread sends nPackets copies of the encoding in
+ * corked batches of 16 while a reader thread discards them. Print the rate,
+ * the CPU time of this thread and the CPU time of the process for each
+ * direction.
+ * @param label The label to print.
+ * @param transport The transport to test.
+ * @param connectionInfo The connection info for the listening socket.
+ * @param listenSocket The listening socket, which this closes.
+ * @param encoding The packet to send.
+ * @param nPackets The number of packets.
+ * @param processEvents This calls processEvents() to receive packets and
+ * complete sends. For a synchronous transport, this calls
+ * transport.processEvents(). For an async transport, this polls its
+ * io_service in this thread.
+ */
+static void
+benchmarkTransport
+  (const string& label, Transport& transport,
+   const Transport::ConnectionInfo& connectionInfo, int listenSocket,
+   const Blob& encoding, size_t nPackets,
+   const function<void()>& processEvents)
+{
+  CountingElementListener elementListener;
+  transport.connect(connectionInfo, elementListener, []() {});
+  int socketDescriptor = accept(listenSocket, 0, 0);
+  close(listenSocket);
+  // An async transport is connected after processing the connect handler.
+  while (!transport.getIsConnected())
+    processEvents();
+
+  // Receive.
+  vector<uint8_t> chunk;
+  for (size_t i = 0; i < 16; ++i)
+    chunk.insert(chunk.end(), encoding.buf(), encoding.buf() + encoding.size());
+  size_t nChunks = nPackets / 16;
+
+  auto start = steady_clock::now();
+  double startCpu = getThreadCpuSeconds();
+  double startProcessCpu = getProcessCpuSeconds();
+  thread writer([&]() {
+    for (size_t i = 0; i < nChunks; ++i) {
+      for (size_t nSent = 0; nSent < chunk.size(); ) {
+        ssize_t result = ::send
+          (socketDescriptor, &chunk[nSent], chunk.size() - nSent, 0);
+        if (result <= 0)
+          return;
+        nSent += result;
+      }
+    }
+  });
+  while (elementListener.nElements_ < nChunks * 16) {
+    processEvents();
+    if (elementListener.nElements_ < nChunks * 16)
+      // Let the writer run on a single core.
+      this_thread::yield();
+  }
+  double receiveCpu = getThreadCpuSeconds() - startCpu;
+  double receiveProcessCpu = getProcessCpuSeconds() - startProcessCpu;
+  double receiveSeconds = duration_cast<nanoseconds>
+    (steady_clock::now() - start).count() / 1000000000.0;
+  writer.join();
+
+  // Send.
+  size_t totalBytes = nChunks * 16 * encoding.size();
+  atomic<size_t> nReceived(0);
+  thread reader([&]() {
+    vector<uint8_t> buffer(65536);
+    while (nReceived < totalBytes) {
+      ssize_t result = recv(socketDescriptor, &buffer[0], buffer.size(), 0);
+      if (result <= 0)
+        return;
+      nReceived += result;
+    }
+  });
+  start = steady_clock::now();
+  startCpu = getThreadCpuSeconds();
+  startProcessCpu = getProcessCpuSeconds();
+  for (size_t i = 0; i < nChunks; ++i) {
+    transport.cork();
+    for (size_t j = 0; j < 16; ++j)
+      transport.send(encoding.buf(), encoding.size());
+    transport.uncork();
+    processEvents();
+  }
+  double sendCpu = getThreadCpuSeconds() - startCpu;
+  reader.join();
+  double sendProcessCpu = getProcessCpuSeconds() - startProcessCpu;
+  double sendSeconds = duration_cast<nanoseconds>
+    (steady_clock::now() - start).count() / 1000000000.0;
+
+  transport.close();
+  close(socketDescriptor);
+
+  size_t nTotal = nChunks * 16;
+  cout << label << " (" << encoding.size() << " bytes): receive " <<
+    (size_t)(nTotal / receiveSeconds) << " packets/sec, " <<
+    receiveCpu * 1000000000.0 / nTotal << " CPU ns/packet (process " <<
+    receiveProcessCpu * 1000000000.0 / nTotal << "); send " <<
+    (size_t)(nTotal / sendSeconds) << " packets/sec, " <<
+    sendCpu * 1000000000.0 / nTotal << " CPU ns/packet (process " <<
+    sendProcessCpu * 1000000000.0 / nTotal << ")" << endl;
+}
+
+/**
+ * Benchmark the synchronous transport over TCP on the loopback interface.
+ */
+static void
+benchmarkTcp
+  (const string& label, Transport& transport, const Blob& encoding,
+   size_t nPackets)
+{
+  unsigned short port;
+  int listenSocket = listenLoopback(port);
+  benchmarkTransport
+    (label, transport, TcpTransport::ConnectionInfo("127.0.0.1", port),
+     listenSocket, encoding, nPackets, [&]() { transport.processEvents(); });
+}
+
+/**
+ * Benchmark an IoUringTransport and an AsyncUnixTransport over a Unix socket.
+ * The AsyncUnixTransport handlers run in this thread by polling the
+ * io_service so that the thread CPU time is comparable.
+ */
+static void
+benchmarkUnix(const string& label, const Blob& encoding, size_t nPackets)
+{
+  string filePath = "/tmp/test-io-uring-transport-benchmark-" +
+    to_string(getpid()) + ".sock";
+
+  {
+    IoUringTransport transport;
+    int listenSocket = listenUnix(filePath);
+    benchmarkTransport
+      ("IoUringTransport Unix " + label, transport,
+       UnixTransport::ConnectionInfo(filePath.c_str()), listenSocket, encoding,
+       nPackets, [&]() { transport.processEvents(); });
+    unlink(filePath.c_str());
+  }
+  {
+    boost::asio::io_service ioService;
+    boost::asio::io_service::work work(ioService);
+    AsyncUnixTransport transport(ioService);
+    int listenSocket = listenUnix(filePath);
+    benchmarkTransport
+      ("AsyncUnixTransport " + label, transport,
+       AsyncUnixTransport::ConnectionInfo(filePath.c_str()), listenSocket,
+       encoding, nPackets, [&]() { ioService.poll(); });
+    unlink(filePath.c_str());
+  }
+}
+
+int
+main(int argc, char** argv)
+{
+  try {
+    Interest interest(Name("/benchmark/io-uring/interest").appendSegment(0));
+    interest.setCanBePrefix(false);
+    interest.setInterestLifetime(milliseconds(4000));
+    Blob interestEncoding = interest.wireEncode();
+
+    Data data(Name("/benchmark/io-uring/data").appendSegment(0));
+    data.setContent(Blob(vector<uint8_t>(5000, 'x')));
+    Blob dataEncoding = data.wireEncode();
+
+    {
+      TcpTransport transport;
+      benchmarkTcp("TcpTransport Interest", transport, interestEncoding,
+                   1000000);
+    }
+    {
+      IoUringTransport transport;
+      benchmarkTcp("IoUringTransport Interest", transport, interestEncoding,
+                   1000000);
+    }
+    benchmarkUnix("Interest", interestEncoding, 1000000);
+    {
+      TcpTransport transport;
+      benchmarkTcp("TcpTransport Data", transport, dataEncoding, 200000);
+    }
+    {
+      IoUringTransport transport;
+      benchmarkTcp("IoUringTransport Data", transport, dataEncoding, 200000);
+    }
+    benchmarkUnix("Data", dataEncoding, 200000);
+  } catch (std::exception& e) {
+    cout << "exception: " << e.what() << endl;
+  }
+  return 0;
+}
+
+#else // NDN_IND_HAVE_LINUX_IO_URING_H
+
+int
+main(int argc, char** argv)
+{
+  cout << "This benchmark requires Linux io_uring." << endl;
+  return 0;
+}
+
+#endif // NDN_IND_HAVE_LINUX_IO_URING_H
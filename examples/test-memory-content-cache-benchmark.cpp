@@ -0,0 +1,245 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2020 Operant Networks, Incorporated.
+ * @author: Jeff Thompson <jefft0@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+/**
+ * This measures the time for MemoryContentCache to add Data packets and to
+ * answer an Interest with an exact name, with a prefix and MustBeFresh, and
+ * with a prefix and ChildSelector rightmost, as the number of cached Data
+ * packets grows. It also measures the time to add a Data packet which
+ * satisfies a pending interest, as the number of pending interests grows. It
+ * uses a loopback transport so that no forwarder is needed.
+ */
+
+#include <iostream>
+#include <ndn-ind/encoding/tlv-0_2-wire-format.hpp>
+#include <ndn-ind/util/memory-content-cache.hpp>
+
+using namespace std;
+using namespace std::chrono;
+using namespace ndn_ind;
+
+/**
+ * A LoopbackTransport counts sent packets and lets the benchmark deliver
+ * received packets directly to the element listener.
+ */
+class LoopbackTransport : public Transport {
+public:
+  LoopbackTransport()
+  : nSent_(0), elementListener_(0)
+  {
+  }
+
+  virtual bool
+  isLocal(const Transport::ConnectionInfo& connectionInfo) { return true; }
+
+  virtual bool
+  isAsync() { return false; }
+
+  virtual void
+  connect
+    (const Transport::ConnectionInfo& connectionInfo,
+     ElementListener& elementListener, const OnConnected& onConnected)
+  {
+    elementListener_ = &elementListener;
+    if (onConnected)
+      onConnected();
+  }
+
+  virtual void
+  send(const uint8_t *data, size_t dataLength) { ++nSent_; }
+
+  virtual void
+  processEvents() {}
+
+  virtual bool
+  getIsConnected() { return elementListener_ != 0; }
+
+  /**
+   * Deliver the buffer to the element listener as if it was received.
+   * @param encoding The wire encoding of the packet.
+   */
+  void
+  receive(const Blob& encoding)
+  {
+    elementListener_->onReceivedElement(encoding.buf(), encoding.size());
+  }
+
+  size_t nSent_;
+
+private:
+  ElementListener* elementListener_;
+};
+
+/**
+ * Deliver the Interest repeatedly and print the time per Interest.
+ * @param label The label to print.
+ * @param transport The connected LoopbackTransport.
+ * @param interest The Interest to deliver.
+ * @param nInterests The number of times to deliver the Interest.
+ * @param wireFormat The wire format to encode the Interest. NDN-TLV 0.2 keeps
+ * the ChildSelector.
+ */
+static void
+benchmarkInterest
+  (const string& label, LoopbackTransport& transport, Interest interest,
+   size_t nInterests, WireFormat& wireFormat)
+{
+  interest.setInterestLifetime(seconds(4));
+  size_t startSent = transport.nSent_;
+  auto start = steady_clock::now();
+  for (size_t i = 0; i < nInterests; ++i) {
+    // Each Interest needs a new nonce so that it is not a duplicate.
+    interest.refreshNonce();
+    transport.receive(interest.wireEncode(wireFormat));
+  }
+  double microseconds = duration_cast<nanoseconds>
+    (steady_clock::now() - start).count() / 1000.0 / nInterests;
+
+  cout << "  " << label << ": " << microseconds << " us per Interest (" <<
+    (transport.nSent_ - startSent) << " answered)" << endl;
+}
+
+/**
+ * Add nData Data packets to a new MemoryContentCache, where the name has
+ * 10 versions of nData / 10 segments each, then benchmark the Interests.
+ * @param nData The number of Data packets.
+ */
+static void
+benchmarkCache(size_t nData)
+{
+  ptr_lib::shared_ptr<LoopbackTransport> transport(new LoopbackTransport());
+  Face face(transport, ptr_lib::make_shared<Transport::ConnectionInfo>());
+  // Express an interest which connects the transport to the face.
+  Interest connectInterest(Name("/benchmark/connect"));
+  connectInterest.setCanBePrefix(false);
+  connectInterest.setInterestLifetime(hours(1));
+  face.expressInterest(connectInterest, OnData(), OnTimeout());
+
+  Name prefix("/benchmark/content");
+  MemoryContentCache cache(&face);
+  cache.setInterestFilter(prefix);
+
+  size_t nVersions = 10;
+  size_t nSegments = nData / nVersions;
+  vector<Data> dataList;
+  dataList.reserve(nData);
+  for (size_t version = 0; version < nVersions; ++version) {
+    for (size_t segment = 0; segment < nSegments; ++segment) {
+      dataList.push_back(Data(Name(prefix).appendVersion(version).appendSegment(segment)));
+      dataList.back().setContent(Blob((const uint8_t*)"content", 7));
+      dataList.back().getMetaInfo().setFreshnessPeriod(hours(1));
+      dataList.back().wireEncode();
+    }
+  }
+
+  auto start = steady_clock::now();
+  for (size_t i = 0; i < dataList.size(); ++i)
+    cache.add(dataList[i]);
+  double microseconds = duration_cast<nanoseconds>
+    (steady_clock::now() - start).count() / 1000.0 / nData;
+  cout << nData << " Data packets: " << microseconds << " us per add" << endl;
+  dataList.clear();
+
+  // Keep the total time about the same for each cache size.
+  size_t nInterests = max((size_t)20, (size_t)20000000 / nData);
+  Interest exactInterest
+    (Name(prefix).appendVersion(nVersions / 2).appendSegment(nSegments / 2));
+  exactInterest.setCanBePrefix(false);
+  benchmarkInterest
+    ("Exact name", *transport, exactInterest, nInterests,
+     *WireFormat::getDefaultWireFormat());
+
+  Interest freshInterest(Name(prefix).appendVersion(nVersions / 2));
+  freshInterest.setCanBePrefix(true);
+  freshInterest.setMustBeFresh(true);
+  benchmarkInterest
+    ("Prefix MustBeFresh", *transport, freshInterest, nInterests,
+     *WireFormat::getDefaultWireFormat());
+
+  Interest latestInterest(prefix);
+  latestInterest.setCanBePrefix(true);
+  latestInterest.setChildSelector(1);
+  benchmarkInterest
+    ("Rightmost child", *transport, latestInterest, nInterests,
+     *Tlv0_2WireFormat::get());
+}
+
+/**
+ * Store nPending pending interests in a new MemoryContentCache, then
+ * benchmark adding Data packets which each satisfy one pending interest.
+ * @param nPending The number of pending interests.
+ */
+static void
+benchmarkPendingInterests(size_t nPending)
+{
+  ptr_lib::shared_ptr<LoopbackTransport> transport(new LoopbackTransport());
+  Face face(transport, ptr_lib::make_shared<Transport::ConnectionInfo>());
+  // Express an interest which connects the transport to the face.
+  Interest connectInterest(Name("/benchmark/connect"));
+  connectInterest.setCanBePrefix(false);
+  connectInterest.setInterestLifetime(hours(1));
+  face.expressInterest(connectInterest, OnData(), OnTimeout());
+
+  Name prefix("/benchmark/pending");
+  MemoryContentCache cache(&face);
+  cache.setInterestFilter(prefix, cache.getStorePendingInterest());
+
+  for (size_t i = 0; i < nPending; ++i) {
+    Interest interest(Name(prefix).appendSequenceNumber(i));
+    interest.setCanBePrefix(false);
+    interest.setInterestLifetime(hours(1));
+    transport->receive(interest.wireEncode());
+  }
+
+  size_t nData = 1000;
+  vector<Data> dataList;
+  for (size_t i = 0; i < nData; ++i) {
+    // Spread the names over the pending interests.
+    dataList.push_back(Data(Name(prefix).appendSequenceNumber(i * (nPending / nData))));
+    dataList.back().setContent(Blob((const uint8_t*)"content", 7));
+    dataList.back().wireEncode();
+  }
+
+  size_t startSent = transport->nSent_;
+  auto start = steady_clock::now();
+  for (size_t i = 0; i < dataList.size(); ++i)
+    cache.add(dataList[i]);
+  double microseconds = duration_cast<nanoseconds>
+    (steady_clock::now() - start).count() / 1000.0 / nData;
+  cout << nPending << " pending interests: " << microseconds <<
+    " us per add (" << (transport->nSent_ - startSent) << " answered)" << endl;
+}
+
+int
+main(int argc, char** argv)
+{
+  try {
+    benchmarkCache(10000);
+    benchmarkCache(100000);
+    benchmarkCache(1000000);
+    benchmarkPendingInterests(1000);
+    benchmarkPendingInterests(10000);
+    benchmarkPendingInterests(100000);
+  } catch (std::exception& e) {
+    cout << "exception: " << e.what() << endl;
+  }
+  return 0;
+}
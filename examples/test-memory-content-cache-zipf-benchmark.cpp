@@ -0,0 +1,265 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2020 Operant Networks, Incorporated.
+ * @author: Jeff Thompson <jefft0@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+
+/**
+ * This measures the hit ratio and the requests per second of a
+ * MemoryContentCache with a capacity for each ReplacementPolicy, replaying
+ * a trace of Interests whose names have a Zipf popularity. A second trace adds
+ * periodic scans of names which are requested only once. On a cache miss, the
+ * benchmark adds the Data packet as a producer would, and the Data packet
+ * sizes vary between 100 and 2000 bytes. It uses a loopback transport so that
+ * no forwarder is needed.
+ */
+
+#include <iostream>
+#include <random>
+#include <cmath>
+#include <algorithm>
+#include <ndn-ind/util/memory-content-cache.hpp>
+
+using namespace std;
+using namespace std::chrono;
+using namespace ndn_ind;
+using namespace ndn_ind::func_lib;
+
+/**
+ * A LoopbackTransport counts sent packets and lets the benchmark deliver
+ * received packets directly to the element listener.
+ */
+class LoopbackTransport : public Transport {
+public:
+  LoopbackTransport()
+  : nSent_(0), elementListener_(0)
+  {
+  }
+
+  virtual bool
+  isLocal(const Transport::ConnectionInfo& connectionInfo) { return true; }
+
+  virtual bool
+  isAsync() { return false; }
+
+  virtual void
+  connect
+    (const Transport::ConnectionInfo& connectionInfo,
+     ElementListener& elementListener, const OnConnected& onConnected)
+  {
+    elementListener_ = &elementListener;
+    if (onConnected)
+      onConnected();
+  }
+
+  virtual void
+  send(const uint8_t *data, size_t dataLength) { ++nSent_; }
+
+  virtual void
+  processEvents() {}
+
+  virtual bool
+  getIsConnected() { return elementListener_ != 0; }
+
+  /**
+   * Deliver the buffer to the element listener as if it was received.
+   * @param encoding The wire encoding of the packet.
+   */
+  void
+  receive(const Blob& encoding)
+  {
+    elementListener_->onReceivedElement(encoding.buf(), encoding.size());
+  }
+
+  size_t nSent_;
+
+private:
+  ElementListener* elementListener_;
+};
+
+static const size_t N_NAMES = 100000;
+static const size_t N_REQUESTS = 1000000;
+// For the scan trace, each scan follows this many Zipf requests.
+static const size_t SCAN_INTERVAL = 10000;
+static const size_t SCAN_LENGTH = 2000;
+
+/**
+ * Get the content size of the Data packet for the name number, between 100 and
+ * 2000 bytes, which does not depend on the popularity.
+ */
+static size_t
+getContentSize(uint64_t nameNumber)
+{
+  return 100 + (size_t)((nameNumber * 2654435761u) % 1901);
+}
+
+/**
+ * Make a trace of name numbers where 0 to N_NAMES - 1 have a Zipf popularity.
+ * @param alpha The Zipf exponent.
+ * @param withScans If true, then after each SCAN_INTERVAL Zipf requests add
+ * SCAN_LENGTH requests for new name numbers starting from N_NAMES.
+ * @return The trace.
+ */
+static vector<uint64_t>
+makeTrace(double alpha, bool withScans)
+{
+  vector<double> cumulative(N_NAMES);
+  double sum = 0;
+  for (size_t i = 0; i < N_NAMES; ++i) {
+    sum += 1.0 / pow((double)(i + 1), alpha);
+    cumulative[i] = sum;
+  }
+
+  // Use a fixed seed so that each policy sees the same trace.
+  mt19937_64 random(1);
+  uniform_real_distribution<double> uniform(0, sum);
+  // Shuffle the ranks so that the popular names are not adjacent.
+  vector<uint64_t> rankToName(N_NAMES);
+  for (size_t i = 0; i < N_NAMES; ++i)
+    rankToName[i] = i;
+  shuffle(rankToName.begin(), rankToName.end(), random);
+
+  vector<uint64_t> trace;
+  uint64_t nextScanName = N_NAMES;
+  for (size_t i = 0; i < N_REQUESTS; ++i) {
+    size_t rank = lower_bound
+      (cumulative.begin(), cumulative.end(), uniform(random)) - cumulative.begin();
+    trace.push_back(rankToName[min(rank, N_NAMES - 1)]);
+
+    if (withScans && (i + 1) % SCAN_INTERVAL == 0) {
+      for (size_t j = 0; j < SCAN_LENGTH; ++j)
+        trace.push_back(nextScanName++);
+    }
+  }
+
+  return trace;
+}
+
+/**
+ * The Producer is the onDataNotFound callback which adds the Data packet to
+ * the cache.
+ */
+class Producer {
+public:
+  Producer(MemoryContentCache& cache)
+  : cache_(cache), content_(2000, 0)
+  {
+  }
+
+  void
+  onDataNotFound
+    (const ptr_lib::shared_ptr<const Name>& prefix,
+     const ptr_lib::shared_ptr<const Interest>& interest, Face& face,
+     uint64_t interestFilterId,
+     const ptr_lib::shared_ptr<const InterestFilter>& filter)
+  {
+    Data data(interest->getName());
+    data.setContent(Blob
+      (&content_[0], getContentSize(interest->getName().get(-1).toNumber())));
+    cache_.add(data);
+  }
+
+private:
+  MemoryContentCache& cache_;
+  vector<uint8_t> content_;
+};
+
+/**
+ * Replay the trace with a new MemoryContentCache and print the hit ratio and
+ * the requests per second.
+ * @param trace The trace from makeTrace.
+ * @param capacity The cache capacity in bytes.
+ * @param replacementPolicy The replacement policy.
+ * @param label The label to print for the replacement policy.
+ */
+static void
+benchmarkPolicy
+  (const vector<uint64_t>& trace, size_t capacity,
+   MemoryContentCache::ReplacementPolicy replacementPolicy, const string& label)
+{
+  ptr_lib::shared_ptr<LoopbackTransport> transport(new LoopbackTransport());
+  Face face(transport, ptr_lib::make_shared<Transport::ConnectionInfo>());
+  // Express an interest which connects the transport to the face.
+  Interest connectInterest(Name("/benchmark/connect"));
+  connectInterest.setCanBePrefix(false);
+  connectInterest.setInterestLifetime(hours(1));
+  face.expressInterest(connectInterest, OnData(), OnTimeout());
+
+  Name prefix("/benchmark/zipf");
+  // Use a large cleanup interval since the Data packets do not go stale.
+  MemoryContentCache cache(&face, hours(1));
+  Producer producer(cache);
+  cache.setInterestFilter
+    (prefix, bind(&Producer::onDataNotFound, &producer, _1, _2, _3, _4, _5));
+  cache.setCapacity(capacity, replacementPolicy);
+
+  // Encode the Interests before the timing.
+  vector<Blob> encodings;
+  encodings.reserve(trace.size());
+  for (size_t i = 0; i < trace.size(); ++i) {
+    Interest interest(Name(prefix).appendNumber(trace[i]));
+    interest.setCanBePrefix(false);
+    interest.setInterestLifetime(seconds(4));
+    encodings.push_back(interest.wireEncode());
+  }
+
+  auto start = steady_clock::now();
+  for (size_t i = 0; i < encodings.size(); ++i)
+    transport->receive(encodings[i]);
+  double seconds = duration_cast<nanoseconds>
+    (steady_clock::now() - start).count() / 1e9;
+
+  double hitRatio = (double)cache.getNHits() /
+    (cache.getNHits() + cache.getNMisses());
+  cout << "    " << label << ": hit ratio " << hitRatio << ", " <<
+    (size_t)(encodings.size() / seconds / 1000) << "k requests/s, " <<
+    cache.getNEvictions() << " evictions" << endl;
+}
+
+int
+main(int argc, char** argv)
+{
+  try {
+    size_t totalSize = 0;
+    for (uint64_t i = 0; i < N_NAMES; ++i)
+      totalSize += getContentSize(i);
+
+    double alphas[] = { 0.8, 1.0 };
+    for (size_t iAlpha = 0; iAlpha < sizeof(alphas) / sizeof(alphas[0]); ++iAlpha) {
+      for (int withScans = 0; withScans <= 1; ++withScans) {
+        vector<uint64_t> trace = makeTrace(alphas[iAlpha], withScans != 0);
+        double percents[] = { 1, 10 };
+        for (size_t iPercent = 0; iPercent < sizeof(percents) / sizeof(percents[0]);
+             ++iPercent) {
+          size_t capacity = (size_t)(totalSize * percents[iPercent] / 100);
+          cout << "Zipf alpha " << alphas[iAlpha] <<
+            (withScans ? " with scans" : "") << ", capacity " <<
+            percents[iPercent] << "% of " << N_NAMES << " names (" <<
+            capacity / 1000 << " KB):" << endl;
+          benchmarkPolicy(trace, capacity, MemoryContentCache::LRU, "LRU  ");
+          benchmarkPolicy(trace, capacity, MemoryContentCache::CLOCK, "CLOCK");
+          benchmarkPolicy(trace, capacity, MemoryContentCache::ARC, "ARC  ");
+        }
+      }
+    }
+  } catch (std::exception& e) {
+    cout << "exception: " << e.what() << endl;
+  }
+  return 0;
+}
@@ -0,0 +1,129 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2020 Operant Networks, Incorporated.
+ * @author: Jeff Thompson <jefft0@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+/**
+ * This measures the heap allocations and time to create segment and version
+ * name components and to build names with them, such as in a segment fetch
+ * loop.
+ */
+
+#include <cstdlib>
+#include <new>
+#include <iostream>
+#include <ndn-ind/name.hpp>
+
+using namespace std;
+using namespace std::chrono;
+using namespace ndn_ind;
+
+static size_t allocationCount = 0;
+
+// Count all heap allocations, including in the library.
+void*
+operator new(size_t size)
+{
+  ++allocationCount;
+  void* p = malloc(size);
+  if (!p)
+    throw bad_alloc();
+  return p;
+}
+
+void
+operator delete(void* p) noexcept { free(p); }
+
+/**
+ * Time building nIterations names, as in a segment fetch loop, and print the
+ * allocations and time per name.
+ * @param label The label to print.
+ * @param prefix The name prefix.
+ * @param appendVersion If true, append a version before the segment.
+ * @param nIterations The number of names to build.
+ */
+static void
+benchmarkAppend
+  (const string& label, const Name& prefix, bool appendVersion,
+   size_t nIterations)
+{
+  size_t checksum = 0;
+
+  size_t startAllocationCount = allocationCount;
+  auto start = steady_clock::now();
+  for (size_t i = 0; i < nIterations; ++i) {
+    Name name(prefix);
+    if (appendVersion)
+      name.appendVersion(i);
+    name.appendSegment(i);
+    checksum += name.hash();
+  }
+  double nanosecondsPerName = duration_cast<nanoseconds>
+    (steady_clock::now() - start).count() / (double)nIterations;
+  double allocationsPerName =
+    (allocationCount - startAllocationCount) / (double)nIterations;
+
+  cout << label << ": " << allocationsPerName << " allocations/name, " <<
+    nanosecondsPerName << " ns/name (checksum " << checksum << ")" << endl;
+}
+
+/**
+ * Time creating nIterations segment components and comparing them, and print
+ * the allocations and time per component.
+ * @param nIterations The number of components to create.
+ */
+static void
+benchmarkComponent(size_t nIterations)
+{
+  Name::Component previous = Name::Component::fromSegment(0);
+  size_t nIncreasing = 0;
+
+  size_t startAllocationCount = allocationCount;
+  auto start = steady_clock::now();
+  for (size_t i = 1; i < nIterations; ++i) {
+    Name::Component component = Name::Component::fromSegment(i);
+    if (component > previous)
+      ++nIncreasing;
+    previous = component;
+  }
+  double nanosecondsPerComponent = duration_cast<nanoseconds>
+    (steady_clock::now() - start).count() / (double)nIterations;
+  double allocationsPerComponent =
+    (allocationCount - startAllocationCount) / (double)nIterations;
+
+  cout << "Segment component: " << allocationsPerComponent <<
+    " allocations/component, " << nanosecondsPerComponent <<
+    " ns/component (increasing " << nIncreasing << ")" << endl;
+}
+
+int
+main(int argc, char** argv)
+{
+  try {
+    Name prefix("/ndn/ucla.edu/benchmark/segmented-content");
+    size_t nIterations = 1000000;
+    benchmarkComponent(nIterations);
+    benchmarkAppend("Prefix plus segment", prefix, false, nIterations);
+    benchmarkAppend
+      ("Prefix plus version and segment", prefix, true, nIterations);
+  } catch (std::exception& e) {
+    cout << "exception: " << e.what() << endl;
+  }
+  return 0;
+}
@@ -0,0 +1,246 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2020 Operant Networks, Incorporated.
+ * @author: Jeff Thompson <jefft0@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+/**
+ * This measures the cost of dispatching a received Data packet to the pending
+ * interest table, of cancelling all pending interests, and of a fetch which
+ * expresses and satisfies interests, while the number of outstanding interests
+ * grows. It uses a loopback transport so that no forwarder is needed.
+ */
+
+#include <cstdlib>
+#include <iostream>
+#include <ndn-ind/face.hpp>
+
+using namespace std;
+using namespace std::chrono;
+using namespace ndn_ind;
+using namespace ndn_ind::func_lib;
+
+/**
+ * A LoopbackTransport discards sent packets and lets the benchmark deliver
+ * received packets directly to the element listener.
+ */
+class LoopbackTransport : public Transport {
+public:
+  LoopbackTransport()
+  : elementListener_(0)
+  {
+  }
+
+  virtual bool
+  isLocal(const Transport::ConnectionInfo& connectionInfo) { return true; }
+
+  virtual bool
+  isAsync() { return false; }
+
+  virtual void
+  connect
+    (const Transport::ConnectionInfo& connectionInfo,
+     ElementListener& elementListener, const OnConnected& onConnected)
+  {
+    elementListener_ = &elementListener;
+    if (onConnected)
+      onConnected();
+  }
+
+  virtual void
+  send(const uint8_t *data, size_t dataLength) {}
+
+  virtual void
+  processEvents() {}
+
+  virtual bool
+  getIsConnected() { return elementListener_ != 0; }
+
+  /**
+   * Deliver the encoding to the element listener as if it was received.
+   * @param encoding The wire encoding of the packet.
+   */
+  void
+  receive(const Blob& encoding)
+  {
+    elementListener_->onReceivedElement(encoding.buf(), encoding.size());
+  }
+
+private:
+  ElementListener* elementListener_;
+};
+
+static void
+onData
+  (const ptr_lib::shared_ptr<const Interest>& interest,
+   const ptr_lib::shared_ptr<Data>& data, size_t* callCount)
+{
+  ++(*callCount);
+}
+
+static void
+onTimeout(const ptr_lib::shared_ptr<const Interest>& interest) {}
+
+/**
+ * Express nInterests interests, then time the dispatch of Data packets which
+ * don't match any interest (the table size stays at nInterests) and Data
+ * packets which each satisfy one interest.
+ * @param nInterests The number of outstanding interests.
+ * @param nDispatches The number of Data packets for each measurement.
+ */
+static void
+benchmarkDispatch(size_t nInterests, size_t nDispatches)
+{
+  ptr_lib::shared_ptr<LoopbackTransport> transport(new LoopbackTransport());
+  Face face(transport, ptr_lib::make_shared<Transport::ConnectionInfo>());
+  Name prefix("/benchmark/pit/fetch");
+  size_t onDataCallCount = 0;
+
+  Interest interest;
+  interest.setCanBePrefix(false);
+  interest.setInterestLifetime(hours(1));
+  for (size_t i = 0; i < nInterests; ++i) {
+    interest.setName(Name(prefix).appendSegment(i));
+    face.expressInterest
+      (interest, bind(&onData, _1, _2, &onDataCallCount), &onTimeout);
+  }
+
+  // Encode the Data packets before timing.
+  vector<Blob> unmatchedEncodings;
+  vector<Blob> matchedEncodings;
+  Data data;
+  for (size_t i = 0; i < nDispatches; ++i) {
+    data.setName(Name(prefix).appendSegment(nInterests + i));
+    unmatchedEncodings.push_back(data.wireEncode());
+    data.setName(Name(prefix).appendSegment(i % nInterests));
+    matchedEncodings.push_back(data.wireEncode());
+  }
+
+  auto start = steady_clock::now();
+  for (size_t i = 0; i < nDispatches; ++i)
+    transport->receive(unmatchedEncodings[i]);
+  double unmatchedMicroseconds = duration_cast<nanoseconds>
+    (steady_clock::now() - start).count() / 1000.0 / nDispatches;
+
+  start = steady_clock::now();
+  for (size_t i = 0; i < nDispatches; ++i)
+    transport->receive(matchedEncodings[i]);
+  double matchedMicroseconds = duration_cast<nanoseconds>
+    (steady_clock::now() - start).count() / 1000.0 / nDispatches;
+
+  cout << "Outstanding interests: " << nInterests <<
+    ", unmatched Data: " << unmatchedMicroseconds << " us/packet" <<
+    ", matching Data: " << matchedMicroseconds << " us/packet" <<
+    ", satisfied: " << onDataCallCount << endl;
+}
+
+/**
+ * Express nInterests interests, then time cancelling all of them at once with
+ * removePendingInterests.
+ * @param nInterests The number of outstanding interests.
+ */
+static void
+benchmarkRemove(size_t nInterests)
+{
+  ptr_lib::shared_ptr<LoopbackTransport> transport(new LoopbackTransport());
+  Face face(transport, ptr_lib::make_shared<Transport::ConnectionInfo>());
+  Name prefix("/benchmark/pit/cancel");
+  size_t onDataCallCount = 0;
+
+  Interest interest;
+  interest.setCanBePrefix(false);
+  interest.setInterestLifetime(hours(1));
+  vector<uint64_t> pendingInterestIds;
+  for (size_t i = 0; i < nInterests; ++i) {
+    interest.setName(Name(prefix).appendSegment(i));
+    pendingInterestIds.push_back(face.expressInterest
+      (interest, bind(&onData, _1, _2, &onDataCallCount), &onTimeout));
+  }
+
+  auto start = steady_clock::now();
+  face.removePendingInterests(pendingInterestIds);
+  double milliseconds = duration_cast<nanoseconds>
+    (steady_clock::now() - start).count() / 1000000.0;
+
+  cout << "Outstanding interests: " << nInterests <<
+    ", cancel all: " << milliseconds << " ms" << endl;
+}
+
+/**
+ * Simulate a fetch which keeps nOutstanding interests with varied lifetimes in
+ * the table. Each iteration expresses an interest, satisfies the oldest one
+ * and calls processEvents, so this measures the whole lifecycle including the
+ * interest timeouts.
+ * @param nInterests The total number of interests to express.
+ * @param nOutstanding The number of interests waiting for Data.
+ */
+static void
+benchmarkFetch(size_t nInterests, size_t nOutstanding)
+{
+  ptr_lib::shared_ptr<LoopbackTransport> transport(new LoopbackTransport());
+  Face face(transport, ptr_lib::make_shared<Transport::ConnectionInfo>());
+  Name prefix("/benchmark/pit/window");
+  size_t onDataCallCount = 0;
+
+  vector<Blob> encodings;
+  Data data;
+  for (size_t i = 0; i < nInterests; ++i) {
+    data.setName(Name(prefix).appendSegment(i));
+    encodings.push_back(data.wireEncode());
+  }
+
+  srand(0);
+  Interest interest;
+  interest.setCanBePrefix(false);
+  auto start = steady_clock::now();
+  for (size_t i = 0; i < nInterests; ++i) {
+    interest.setName(Name(prefix).appendSegment(i));
+    // Use a lifetime from 1 to 4 seconds.
+    interest.setInterestLifetime(milliseconds(1000 + rand() % 3000));
+    face.expressInterest
+      (interest, bind(&onData, _1, _2, &onDataCallCount), &onTimeout);
+
+    if (i >= nOutstanding)
+      transport->receive(encodings[i - nOutstanding]);
+    face.processEvents();
+  }
+  double seconds = duration_cast<nanoseconds>
+    (steady_clock::now() - start).count() / 1000000000.0;
+
+  cout << "Outstanding interests: " << nOutstanding <<
+    ", express and satisfy: " << (size_t)(nInterests / seconds) <<
+    " interests/sec, satisfied: " << onDataCallCount << endl;
+}
+
+int
+main(int argc, char** argv)
+{
+  try {
+    size_t nDispatches = 2000;
+    size_t interestCounts[] = { 1000, 5000, 10000, 20000, 50000 };
+    for (size_t i = 0; i < sizeof(interestCounts) / sizeof(interestCounts[0]); ++i)
+      benchmarkDispatch(interestCounts[i], nDispatches);
+    for (size_t i = 0; i < sizeof(interestCounts) / sizeof(interestCounts[0]); ++i)
+      benchmarkRemove(interestCounts[i]);
+    for (size_t i = 0; i < sizeof(interestCounts) / sizeof(interestCounts[0]); ++i)
+      benchmarkFetch(100000, interestCounts[i]);
+  } catch (std::exception& e) {
+    cout << "exception: " << e.what() << endl;
+  }
+  return 0;
+}
@@ -133,9 +133,9 @@ int main(int argc, char** argv)
     // Wait forever to receive an interest for the prefix.
     // If !keepResponding, then quit after one response.
     while (keepResponding || echo.responseCount_ < 1) {
-      face.processEvents();
-      // We need to sleep for a few milliseconds so we don't use 100% of the CPU.
-      usleep(10000);
+      // Wait for an interest instead of polling so that we don't use 100% of
+      // the CPU or add a sleep to the response time.
+      face.processEvents(std::chrono::milliseconds(500));
     }
   } catch (std::exception& e) {
     cout << "exception: " << e.what() << endl;
@@ -0,0 +1,215 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2020 Operant Networks, Incorporated.
+ * @author: Jeff Thompson <jefft0@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+/**
+ * This measures the heap bytes allocated and copied when a Face receives a Data
+ * packet, with and without an LpPacket, when the transport passes a buffer
+ * which is only valid during the call and when it hands over a Blob. It uses
+ * a loopback transport so that no forwarder is needed.
+ */
+
+#include <cstdlib>
+#include <new>
+#include <iostream>
+#include <ndn-ind/face.hpp>
+
+using namespace std;
+using namespace std::chrono;
+using namespace ndn_ind;
+
+static size_t allocationCount = 0;
+static size_t allocationBytes = 0;
+
+// Count all heap allocations, including in the library.
+void*
+operator new(size_t size)
+{
+  ++allocationCount;
+  allocationBytes += size;
+  void* p = malloc(size);
+  if (!p)
+    throw bad_alloc();
+  return p;
+}
+
+void
+operator delete(void* p) noexcept { free(p); }
+
+/**
+ * A LoopbackTransport discards sent packets and lets the benchmark deliver
+ * received packets directly to the element listener.
+ */
+class LoopbackTransport : public Transport {
+public:
+  LoopbackTransport()
+  : elementListener_(0)
+  {
+  }
+
+  virtual bool
+  isLocal(const Transport::ConnectionInfo& connectionInfo) { return true; }
+
+  virtual bool
+  isAsync() { return false; }
+
+  virtual void
+  connect
+    (const Transport::ConnectionInfo& connectionInfo,
+     ElementListener& elementListener, const OnConnected& onConnected)
+  {
+    elementListener_ = &elementListener;
+    if (onConnected)
+      onConnected();
+  }
+
+  virtual void
+  send(const uint8_t *data, size_t dataLength) {}
+
+  virtual void
+  processEvents() {}
+
+  virtual bool
+  getIsConnected() { return elementListener_ != 0; }
+
+  /**
+   * Deliver the buffer to the element listener as if it was received. The
+   * listener must copy what it keeps.
+   * @param encoding The wire encoding of the packet.
+   */
+  void
+  receive(const Blob& encoding)
+  {
+    elementListener_->onReceivedElement(encoding.buf(), encoding.size());
+  }
+
+  /**
+   * Hand over the Blob to the element listener as if it was received.
+   * @param encoding The wire encoding of the packet.
+   */
+  void
+  receiveBlob(const Blob& encoding)
+  {
+    elementListener_->onReceivedElement(encoding);
+  }
+
+private:
+  ElementListener* elementListener_;
+};
+
+/**
+ * Append the TLV type and the length as a 3-byte TLV number.
+ * @param output The vector to append to.
+ * @param type The TLV type, which must be less than 253.
+ * @param length The TLV length, which must be less than 65536.
+ */
+static void
+appendTypeAndLength(vector<uint8_t>& output, uint8_t type, size_t length)
+{
+  output.push_back(type);
+  output.push_back(253);
+  output.push_back((uint8_t)(length >> 8));
+  output.push_back((uint8_t)(length & 0xff));
+}
+
+/**
+ * Wrap the encoding in an LpPacket with only a fragment field.
+ * @param encoding The encoding of the Interest or Data.
+ * @return The LpPacket encoding.
+ */
+static Blob
+makeLpPacket(const Blob& encoding)
+{
+  vector<uint8_t> lpPacket;
+  lpPacket.reserve(8 + encoding.size());
+  // The fragment type is 80.
+  appendTypeAndLength(lpPacket, 100, 4 + encoding.size());
+  appendTypeAndLength(lpPacket, 80, encoding.size());
+  for (size_t i = 0; i < encoding.size(); ++i)
+    lpPacket.push_back(encoding.buf()[i]);
+  return Blob(lpPacket);
+}
+
+/**
+ * Deliver the encodings and print the allocations per packet.
+ * @param label The label to print.
+ * @param transport The connected LoopbackTransport.
+ * @param encodings The packets to deliver.
+ * @param useBlob If true, call receiveBlob, else call receive.
+ */
+static void
+benchmarkReceive
+  (const string& label, LoopbackTransport& transport,
+   const vector<Blob>& encodings, bool useBlob)
+{
+  size_t startCount = allocationCount;
+  size_t startBytes = allocationBytes;
+  auto start = steady_clock::now();
+  for (size_t i = 0; i < encodings.size(); ++i) {
+    if (useBlob)
+      transport.receiveBlob(encodings[i]);
+    else
+      transport.receive(encodings[i]);
+  }
+  double microseconds = duration_cast<nanoseconds>
+    (steady_clock::now() - start).count() / 1000.0 / encodings.size();
+
+  cout << label << ": " <<
+    (allocationCount - startCount) / encodings.size() << " allocations, " <<
+    (allocationBytes - startBytes) / encodings.size() << " bytes allocated, " <<
+    microseconds << " us per packet" << endl;
+}
+
+int
+main(int argc, char** argv)
+{
+  try {
+    ptr_lib::shared_ptr<LoopbackTransport> transport(new LoopbackTransport());
+    Face face(transport, ptr_lib::make_shared<Transport::ConnectionInfo>());
+    // Express an interest which connects the transport to the face.
+    Interest interest("/benchmark/connect");
+    interest.setCanBePrefix(false);
+    interest.setInterestLifetime(hours(1));
+    face.expressInterest(interest, OnData(), OnTimeout());
+
+    // Make Data packets with a 10-component name and 1000 bytes of content,
+    // which don't match a pending interest.
+    size_t nPackets = 10000;
+    vector<uint8_t> content(1000, 'x');
+    vector<Blob> dataEncodings;
+    vector<Blob> lpPacketEncodings;
+    Data data;
+    data.setContent(content);
+    for (size_t i = 0; i < nPackets; ++i) {
+      data.setName(Name("/benchmark/receive/a/b/c/d/e/f/g").appendSegment(i));
+      dataEncodings.push_back(data.wireEncode());
+      lpPacketEncodings.push_back(makeLpPacket(dataEncodings.back()));
+    }
+
+    cout << "Data size: " << dataEncodings[0].size() << " bytes" << endl;
+    benchmarkReceive("Data buffer", *transport, dataEncodings, false);
+    benchmarkReceive("Data Blob", *transport, dataEncodings, true);
+    benchmarkReceive("LpPacket buffer", *transport, lpPacketEncodings, false);
+    benchmarkReceive("LpPacket Blob", *transport, lpPacketEncodings, true);
+  } catch (std::exception& e) {
+    cout << "exception: " << e.what() << endl;
+  }
+  return 0;
+}
@@ -0,0 +1,275 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2020 Operant Networks, Incorporated.
+ * @author: Jeff Thompson <jefft0@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+/**
+ * This measures the goodput of SegmentFetcher through an in-process producer
+ * which answers after a propagation delay and serves one packet at a time
+ * through a bottleneck queue, for the sequential fetch and for a pipelined
+ * fetch with a constant window of each size and with AIMD and CUBIC. The
+ * bottleneck marks Data with a CongestionMark when the queue delay is over
+ * the marking threshold, and drops the Interest when the queue is full.
+ * With the argument "stream" or "buffer", this instead fetches 256 MB with
+ * OnSegment writing to /dev/null or with the content concatenated for
+ * onComplete, and prints the peak resident set size.
+ */
+
+#include <deque>
+#include <iostream>
+#include <iomanip>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <ndn-ind/util/segment-fetcher.hpp>
+
+using namespace std;
+using namespace std::chrono;
+using namespace ndn_ind;
+
+/**
+ * A DelayedProducerTransport answers each Interest for a segment of
+ * /benchmark/<version>/<segment> after the queue and propagation delay.
+ */
+class DelayedProducerTransport : public Transport {
+public:
+  /**
+   * Create a DelayedProducerTransport.
+   * @param nSegments The number of segments.
+   * @param segmentSize The content size of each segment.
+   * @param delay The round-trip propagation delay.
+   * @param serviceTime The time for the bottleneck to send one segment.
+   * @param markDelay Mark the Data if the queue delay is over this.
+   * @param maxQueueDelay Drop the Interest if the queue delay is over this.
+   */
+  DelayedProducerTransport
+    (size_t nSegments, size_t segmentSize, nanoseconds delay,
+     nanoseconds serviceTime, nanoseconds markDelay, nanoseconds maxQueueDelay)
+  : prefix_("/benchmark/%FD%01"), nSegments_(nSegments),
+    content_(vector<uint8_t>(segmentSize, 'x')), delay_(delay),
+    serviceTime_(serviceTime), markDelay_(markDelay),
+    maxQueueDelay_(maxQueueDelay), nMarked_(0), nDropped_(0),
+    elementListener_(0)
+  {
+    lastDeparture_ = steady_clock::now();
+  }
+
+  virtual bool
+  isLocal(const Transport::ConnectionInfo& connectionInfo) { return true; }
+
+  virtual bool
+  isAsync() { return false; }
+
+  virtual void
+  connect
+    (const Transport::ConnectionInfo& connectionInfo,
+     ElementListener& elementListener, const OnConnected& onConnected)
+  {
+    elementListener_ = &elementListener;
+    if (onConnected)
+      onConnected();
+  }
+
+  virtual void
+  send(const uint8_t *data, size_t dataLength)
+  {
+    Interest interest;
+    interest.wireDecode(data, dataLength);
+    uint64_t segment = 0;
+    if (interest.getName().size() > prefix_.size())
+      segment = interest.getName().get(-1).toSegment();
+
+    steady_clock::time_point now = steady_clock::now();
+    steady_clock::time_point departure =
+      max(now, lastDeparture_) + serviceTime_;
+    nanoseconds queueDelay = departure - now;
+    if (queueDelay > maxQueueDelay_) {
+      ++nDropped_;
+      return;
+    }
+    lastDeparture_ = departure;
+
+    // Encode each segment when requested so that the producer doesn't hold
+    // the content.
+    Data segmentData(Name(prefix_).appendSegment(segment));
+    segmentData.setContent(content_);
+    segmentData.getMetaInfo().setFinalBlockId
+      (Name::Component::fromSegment(nSegments_ - 1));
+    bool isMarked = (queueDelay > markDelay_);
+    if (isMarked)
+      ++nMarked_;
+    Blob encoding = segmentData.wireEncode();
+    answers_.push_back(make_pair
+      (departure + delay_, isMarked ? makeMarked(encoding) : encoding));
+  }
+
+  virtual void
+  processEvents()
+  {
+    steady_clock::time_point now = steady_clock::now();
+    while (!answers_.empty() && answers_.front().first <= now) {
+      Blob answer = answers_.front().second;
+      answers_.pop_front();
+      elementListener_->onReceivedElement(answer.buf(), answer.size());
+    }
+  }
+
+  virtual bool
+  getIsConnected() { return elementListener_ != 0; }
+
+  size_t nMarked_;
+  size_t nDropped_;
+
+private:
+  /**
+   * Wrap the Data encoding in an LpPacket with a CongestionMark of 1.
+   */
+  static Blob
+  makeMarked(const Blob& encoding)
+  {
+    // CongestionMark type 832 and Fragment type 80 with a 3-byte length.
+    vector<uint8_t> value = { 253, 3, 64, 1, 1, 80, 253,
+      (uint8_t)(encoding.size() >> 8), (uint8_t)(encoding.size() & 0xff) };
+    value.insert(value.end(), encoding.buf(), encoding.buf() + encoding.size());
+    vector<uint8_t> lpPacket = { 100, 253, (uint8_t)(value.size() >> 8),
+      (uint8_t)(value.size() & 0xff) };
+    lpPacket.insert(lpPacket.end(), value.begin(), value.end());
+    return Blob(lpPacket);
+  }
+
+  Name prefix_;
+  size_t nSegments_;
+  Blob content_;
+  nanoseconds delay_;
+  nanoseconds serviceTime_;
+  nanoseconds markDelay_;
+  nanoseconds maxQueueDelay_;
+  steady_clock::time_point lastDeparture_;
+  deque<pair<steady_clock::time_point, Blob> > answers_;
+  ElementListener* elementListener_;
+};
+
+static const size_t segmentSize = 4000;
+
+/**
+ * Fetch the segments and print the goodput.
+ * @param label The label to print.
+ * @param options The Options for a pipelined fetch, or 0 for the sequential
+ * fetch.
+ * @param nSegments The number of segments to fetch.
+ */
+static void
+benchmarkFetch
+  (const string& label, const SegmentFetcher::Options* options,
+   size_t nSegments)
+{
+  ptr_lib::shared_ptr<DelayedProducerTransport> transport
+    (new DelayedProducerTransport
+     (nSegments, segmentSize, milliseconds(2), microseconds(50),
+      milliseconds(2), milliseconds(20)));
+  Face face(transport, ptr_lib::make_shared<Transport::ConnectionInfo>());
+  Interest interest(Name("/benchmark"));
+  interest.setCanBePrefix(true);
+  interest.setInterestLifetime(milliseconds(1000));
+
+  bool isFinished = false;
+  size_t contentSize = 0;
+  string error;
+  SegmentFetcher::OnComplete onComplete = [&](const Blob& content) {
+    contentSize = content.isNull() ? nSegments * segmentSize : content.size();
+    isFinished = true;
+  };
+  SegmentFetcher::OnError onError =
+    [&](SegmentFetcher::ErrorCode errorCode, const string& message) {
+    error = message;
+    isFinished = true;
+  };
+
+  auto start = steady_clock::now();
+  if (options)
+    SegmentFetcher::fetch
+      (face, interest, SegmentFetcher::DontVerifySegment, onComplete, onError,
+       *options);
+  else
+    SegmentFetcher::fetch
+      (face, interest, SegmentFetcher::DontVerifySegment, onComplete, onError);
+  while (!isFinished)
+    face.processEvents();
+  double seconds = duration_cast<duration<double> >
+    (steady_clock::now() - start).count();
+
+  if (!error.empty())
+    cout << label << ": Error " << error << endl;
+  else
+    cout << setw(16) << left << label << ": " << setw(8) << right << fixed <<
+      setprecision(1) << (contentSize * 8 / seconds / 1e6) << " Mbit/s, " <<
+      transport->nMarked_ << " marked, " << transport->nDropped_ <<
+      " dropped" << endl;
+  face.shutdown();
+}
+
+int
+main(int argc, char** argv)
+{
+  try {
+    if (argc > 1) {
+      // Fetch 256 MB in a fresh process to measure the peak memory.
+      size_t nSegments = 65536;
+      string mode = argv[1];
+      int devNull = open("/dev/null", O_WRONLY);
+      SegmentFetcher::Options options;
+      if (mode == "stream")
+        options.setOnSegment(SegmentFetcher::makeFileDescriptorSink(devNull));
+      else if (mode != "buffer") {
+        cout << "Usage: test-segment-fetcher-benchmark [stream|buffer]" << endl;
+        return 1;
+      }
+      benchmarkFetch(mode, &options, nSegments);
+      ::close(devNull);
+
+      struct rusage usage;
+      getrusage(RUSAGE_SELF, &usage);
+      cout << "Peak RSS for " << (nSegments * segmentSize / 1000000) <<
+        " MB: " << (usage.ru_maxrss / 1024) << " MB" << endl;
+      return 0;
+    }
+
+    // The bottleneck is 20000 segments/s (640 Mbit/s) and the bandwidth-delay
+    // product is 40 segments.
+    size_t nSegments = 1000;
+    cout << nSegments << " segments of " << segmentSize <<
+      " bytes, 2 ms delay, 640 Mbit/s bottleneck" << endl;
+    benchmarkFetch("Sequential", 0, nSegments);
+    for (int window = 1; window <= 128; window *= 2) {
+      SegmentFetcher::Options options;
+      options.setInitialWindow(window).setMaxWindow(window)
+        .setCongestionControl(SegmentFetcher::CONSTANT_WINDOW);
+      benchmarkFetch("Window " + to_string(window), &options, nSegments);
+    }
+
+    SegmentFetcher::Options aimdOptions;
+    benchmarkFetch("AIMD", &aimdOptions, nSegments);
+    SegmentFetcher::Options cubicOptions;
+    cubicOptions.setCongestionControl(SegmentFetcher::CUBIC);
+    benchmarkFetch("CUBIC", &cubicOptions, nSegments);
+  } catch (std::exception& e) {
+    cout << "exception: " << e.what() << endl;
+  }
+  return 0;
+}
@@ -0,0 +1,189 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2020 Operant Networks, Incorporated.
+ * @author: Jeff Thompson <jefft0@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+
+/**
+ * This measures the rate of operations when several threads insert and find
+ * Data packets at the same time, for a mix of finds and inserts. It compares
+ * an InMemoryStorageRetaining with one mutex around the whole storage to a
+ * ShardedContentStore with lock-striped shards. The shards can only scale up
+ * to the number of cores of the machine.
+ */
+
+#include <atomic>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <ndn-ind/in-memory-storage/sharded-content-store.hpp>
+
+using namespace std;
+using namespace std::chrono;
+using namespace ndn_ind;
+
+/**
+ * A GlobalMutexStore has one mutex around an InMemoryStorageRetaining, which
+ * is how a multi-threaded producer shares a single-threaded cache.
+ */
+class GlobalMutexStore {
+public:
+  void
+  insert(const Data& data)
+  {
+    lock_guard<mutex> lock(mutex_);
+    storage_.insert(data);
+  }
+
+  bool
+  find(const Interest& interest)
+  {
+    lock_guard<mutex> lock(mutex_);
+    return !!storage_.find(interest);
+  }
+
+private:
+  mutex mutex_;
+  InMemoryStorageRetaining storage_;
+};
+
+/**
+ * A ShardedStore adapts the ShardedContentStore to the methods of
+ * GlobalMutexStore.
+ */
+class ShardedStore {
+public:
+  ShardedStore(size_t nShards)
+  : store_(nShards)
+  {
+  }
+
+  void
+  insert(const Data& data) { store_.insert(data); }
+
+  bool
+  find(const Interest& interest) { return !!store_.find(interest); }
+
+private:
+  ShardedContentStore store_;
+};
+
+static const size_t nNames = 100000;
+static const size_t nOperationsPerThread = 100000;
+
+static Name
+makeName(size_t i)
+{
+  return Name("/benchmark/stream").appendVersion(7).appendSegment(i);
+}
+
+/**
+ * Make the Data packet with the name from makeName(i). Encode it and cache its
+ * full name and name hash now so that the work is not in the measurement.
+ */
+static Data
+makeData(size_t i)
+{
+  Data data(makeName(i));
+  data.setContent(Blob((const uint8_t*)"content", 7));
+  data.wireEncode();
+  data.getFullName();
+  data.getName().hash();
+  return data;
+}
+
+/**
+ * Fill the store, then run nThreads threads which each do
+ * nOperationsPerThread operations where findPercent percent are find and the
+ * rest are insert.
+ * @return The total operations per second.
+ */
+template<class Store> static double
+benchmarkStore(Store& store, size_t nThreads, int findPercent)
+{
+  for (size_t i = 0; i < nNames; ++i)
+    store.insert(makeData(i));
+
+  // Each thread has its own packets so that the threads only share the store.
+  vector<vector<Data> > threadData(nThreads);
+  vector<vector<Interest> > threadInterests(nThreads);
+  for (size_t t = 0; t < nThreads; ++t) {
+    for (size_t i = 0; i < 1024; ++i) {
+      size_t n = ((t * 1024 + i) * 7919) % nNames;
+      threadData[t].push_back(makeData(n));
+      // An exact Interest for a segment only searches one shard.
+      threadInterests[t].push_back(Interest(makeName(n)));
+      threadInterests[t].back().setCanBePrefix(false);
+      threadInterests[t].back().getName().hash();
+    }
+  }
+
+  atomic<size_t> nFound(0);
+  vector<thread> threads;
+  auto start = steady_clock::now();
+  for (size_t t = 0; t < nThreads; ++t) {
+    threads.push_back(thread([&store, &threadData, &threadInterests, &nFound, t, findPercent]() {
+      size_t threadFound = 0;
+      for (size_t i = 0; i < nOperationsPerThread; ++i) {
+        size_t n = i % 1024;
+        if ((int)(i % 100) < findPercent) {
+          if (store.find(threadInterests[t][n]))
+            ++threadFound;
+        }
+        else
+          store.insert(threadData[t][n]);
+      }
+      nFound += threadFound;
+    }));
+  }
+  for (size_t t = 0; t < nThreads; ++t)
+    threads[t].join();
+  double seconds = duration_cast<nanoseconds>
+    (steady_clock::now() - start).count() / 1e9;
+
+  return nThreads * nOperationsPerThread / seconds;
+}
+
+int
+main(int argc, char** argv)
+{
+  try {
+    cout << "Cores: " << thread::hardware_concurrency() << endl;
+    int findPercents[] = { 90, 50 };
+    for (size_t i = 0; i < sizeof(findPercents) / sizeof(findPercents[0]); ++i) {
+      int findPercent = findPercents[i];
+      cout << findPercent << "% find, " << (100 - findPercent) << "% insert:" <<
+        endl;
+      for (size_t nThreads = 1; nThreads <= 8; nThreads *= 2) {
+        GlobalMutexStore globalMutexStore;
+        double globalRate = benchmarkStore
+          (globalMutexStore, nThreads, findPercent);
+        ShardedStore shardedStore(16);
+        double shardedRate = benchmarkStore
+          (shardedStore, nThreads, findPercent);
+        cout << "  " << nThreads << " threads: global mutex " <<
+          (size_t)globalRate << " ops/s, 16 shards " << (size_t)shardedRate <<
+          " ops/s" << endl;
+      }
+    }
+  } catch (std::exception& e) {
+    cout << "exception: " << e.what() << endl;
+  }
+  return 0;
+}
@@ -0,0 +1,250 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2020 Operant Networks, Incorporated.
+ * @author: Jeff Thompson <jefft0@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+/**
+ * This measures the rate of fetching Data with a ShardedFace while the number
+ * of shards grows from 1 to 16. A stand-in forwarder listens on a Unix socket
+ * and answers each Interest with a Data packet of the same name, using a
+ * thread for each connection, so that no forwarder is needed. The shards can
+ * only scale up to the number of cores of the machine.
+ */
+
+#include <atomic>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <ndn-ind/sharded-face.hpp>
+#include <ndn-ind/transport/async-unix-transport.hpp>
+
+using namespace std;
+using namespace std::chrono;
+using namespace ndn_ind;
+using namespace ndn_ind::func_lib;
+
+/**
+ * Read a TLV VarNumber from the buffer.
+ * @param buffer The buffer.
+ * @param length The number of bytes in buffer.
+ * @param offset The offset of the VarNumber. This is advanced past it.
+ * @param value Set this to the VarNumber.
+ * @return True for success, false if the buffer doesn't have the whole
+ * VarNumber.
+ */
+static bool
+readVarNumber
+  (const uint8_t* buffer, size_t length, size_t& offset, uint64_t& value)
+{
+  if (offset >= length)
+    return false;
+  uint8_t firstOctet = buffer[offset++];
+  size_t nOctets = firstOctet < 253 ? 0 : (firstOctet == 253 ? 2 :
+    (firstOctet == 254 ? 4 : 8));
+  if (nOctets == 0) {
+    value = firstOctet;
+    return true;
+  }
+  if (offset + nOctets > length)
+    return false;
+
+  value = 0;
+  for (size_t i = 0; i < nOctets; ++i)
+    value = (value << 8) + buffer[offset++];
+  return true;
+}
+
+/**
+ * Read the packets from the connection of one shard and answer each Interest
+ * with a Data packet of the same name, until the connection is closed.
+ * @param socketDescriptor The accepted connection.
+ */
+static void
+serveConnection(int socketDescriptor)
+{
+  vector<uint8_t> received;
+  uint8_t buffer[65536];
+  Data data;
+  data.setContent(Blob(vector<uint8_t>(100)));
+
+  while (true) {
+    ssize_t nBytes = recv(socketDescriptor, buffer, sizeof(buffer), 0);
+    if (nBytes <= 0)
+      break;
+    received.insert(received.end(), buffer, buffer + nBytes);
+
+    // Answer each whole packet, and gather the replies to send at once.
+    vector<uint8_t> replies;
+    size_t offset = 0;
+    while (true) {
+      size_t elementOffset = offset;
+      uint64_t type, valueLength;
+      if (!readVarNumber(&received[0], received.size(), offset, type) ||
+          !readVarNumber(&received[0], received.size(), offset, valueLength) ||
+          offset + valueLength > received.size()) {
+        offset = elementOffset;
+        break;
+      }
+      offset += valueLength;
+
+      // Reply to an Interest, which has TLV type 5, and ignore other packets.
+      if (type == 5) {
+        Interest interest;
+        interest.wireDecode(&received[elementOffset], offset - elementOffset);
+        data.setName(interest.getName());
+        Blob encoding = data.wireEncode();
+        replies.insert(replies.end(), encoding.buf(), encoding.buf() + encoding.size());
+      }
+    }
+    received.erase(received.begin(), received.begin() + offset);
+
+    for (size_t sent = 0; sent < replies.size(); ) {
+      nBytes = send(socketDescriptor, &replies[sent], replies.size() - sent, 0);
+      if (nBytes <= 0)
+        break;
+      sent += nBytes;
+    }
+  }
+
+  close(socketDescriptor);
+}
+
+/**
+ * The FetchState holds the counters shared by the onData callbacks of all
+ * shards.
+ */
+class FetchState {
+public:
+  FetchState(ShardedFace& face, size_t nInterests)
+  : face_(face), nInterests_(nInterests), nExpressed_(0), nReceived_(0)
+  {
+  }
+
+  /**
+   * Express the next Interest if not all have been expressed.
+   */
+  void
+  expressNext()
+  {
+    size_t i = nExpressed_++;
+    if (i >= nInterests_)
+      return;
+
+    Interest interest(Name("/benchmark/sharded").appendSegment(i));
+    interest.setCanBePrefix(false);
+    interest.setInterestLifetime(seconds(10));
+    face_.expressInterest(interest, bind(&FetchState::onData, this, _1, _2));
+  }
+
+  void
+  onData
+    (const ptr_lib::shared_ptr<const Interest>& interest,
+     const ptr_lib::shared_ptr<Data>& data)
+  {
+    ++nReceived_;
+    expressNext();
+  }
+
+  ShardedFace& face_;
+  size_t nInterests_;
+  atomic<size_t> nExpressed_;
+  atomic<size_t> nReceived_;
+};
+
+/**
+ * Fetch nInterests Data packets with a window of outstanding Interests for
+ * each shard and print the rate.
+ * @param socketFilePath The Unix socket file of the stand-in forwarder.
+ * @param listener The listening socket of the stand-in forwarder.
+ * @param nShards The number of shards.
+ * @param nInterests The number of Interests to express.
+ */
+static void
+benchmarkFetch
+  (const string& socketFilePath, int listener, size_t nShards,
+   size_t nInterests)
+{
+  // Accept the connection of each shard when it connects.
+  vector<thread> connectionThreads;
+  thread acceptThread([listener, nShards, &connectionThreads]() {
+    for (size_t i = 0; i < nShards; ++i)
+      connectionThreads.push_back(thread(&serveConnection, accept(listener, 0, 0)));
+  });
+
+  double dataPerSecond;
+  {
+    ShardedFace face
+      (nShards,
+       [](boost::asio::io_service& ioService) {
+         return ptr_lib::make_shared<AsyncUnixTransport>(ioService);
+       },
+       ptr_lib::make_shared<AsyncUnixTransport::ConnectionInfo>
+         (socketFilePath.c_str()));
+    FetchState state(face, nInterests);
+
+    const size_t windowPerShard = 64;
+    auto start = steady_clock::now();
+    for (size_t i = 0; i < windowPerShard * nShards; ++i)
+      state.expressNext();
+    while (state.nReceived_ < nInterests)
+      this_thread::sleep_for(microseconds(100));
+    dataPerSecond = nInterests / (duration_cast<nanoseconds>
+      (steady_clock::now() - start).count() / 1000000000.0);
+  }
+
+  acceptThread.join();
+  for (size_t i = 0; i < connectionThreads.size(); ++i)
+    connectionThreads[i].join();
+
+  cout << "Shards: " << nShards << ", fetch: " << (size_t)dataPerSecond <<
+    " Data/sec" << endl;
+}
+
+int
+main(int argc, char** argv)
+{
+  try {
+    string socketFilePath =
+      "/tmp/test-sharded-face-benchmark-" + to_string(getpid()) + ".sock";
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, socketFilePath.c_str());
+    unlink(socketFilePath.c_str());
+    if (listener < 0 ||
+        ::bind(listener, (struct sockaddr*)&address, sizeof(address)) != 0 ||
+        listen(listener, 16) != 0)
+      throw runtime_error("Can't listen on the Unix socket");
+
+    cout << "Cores: " << thread::hardware_concurrency() << endl;
+    size_t shardCounts[] = { 1, 2, 4, 8, 16 };
+    for (size_t i = 0; i < sizeof(shardCounts) / sizeof(shardCounts[0]); ++i)
+      benchmarkFetch(socketFilePath, listener, shardCounts[i], 200000);
+
+    close(listener);
+    unlink(socketFilePath.c_str());
+  } catch (std::exception& e) {
+    cout << "exception: " << e.what() << endl;
+  }
+  return 0;
+}
@@ -0,0 +1,351 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2020 Operant Networks, Incorporated.
+ * @author: Jeff Thompson <jefft0@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+/**
+ * This compares a ShmTransport with a UnixTransport between two threads. It
+ * prints the rate and CPU time of receiving a stream of packets, and the round
+ * trip time of a packet which the other thread echoes back. The other end is
+ * a thread in this process so that no forwarder is needed.
+ */
+
+#include <atomic>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <thread>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <ndn-ind/data.hpp>
+#include <ndn-ind/interest.hpp>
+#include <ndn-ind/transport/unix-transport.hpp>
+#include <ndn-ind/transport/shm-transport.hpp>
+
+using namespace std;
+using namespace std::chrono;
+using namespace ndn_ind;
+
+#if NDN_IND_HAVE_SYS_EVENTFD_H
+
+/**
+ * A CountingElementListener counts the received elements and optionally
+ * echoes each one back on a transport.
+ */
+class CountingElementListener : public ElementListener {
+public:
+  CountingElementListener(Transport* echoTransport = 0)
+  : nElements_(0), echoTransport_(echoTransport)
+  {
+  }
+
+  virtual void
+  onReceivedElement(const uint8_t *element, size_t elementLength)
+  {
+    if (echoTransport_)
+      echoTransport_->send(element, elementLength);
+    ++nElements_;
+  }
+
+  atomic<size_t> nElements_;
+
+private:
+  Transport* echoTransport_;
+};
+
+/**
+ * Create a listening Unix socket at filePath.
+ * @return The socket descriptor.
+ */
+static int
+listenUnix(const string& filePath)
+{
+  unlink(filePath.c_str());
+  int socketDescriptor = socket(AF_UNIX, SOCK_STREAM, 0);
+  struct sockaddr_un address;
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  strncpy(address.sun_path, filePath.c_str(), sizeof(address.sun_path) - 1);
+  if (socketDescriptor < 0 ||
+      ::bind(socketDescriptor, (struct sockaddr*)&address, sizeof(address)) != 0 ||
+      listen(socketDescriptor, 1) != 0)
+    throw runtime_error("Can't listen on the Unix socket");
+
+  return socketDescriptor;
+}
+
+/**
+ * Get the CPU time used by the calling thread in seconds.
+ */
+static double
+getThreadCpuSeconds()
+{
+  struct timespec time;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+  return time.tv_sec + time.tv_nsec / 1000000000.0;
+}
+
+/**
+ * The Peer is the other end of the transport under test, which runs in its
+ * own thread.
+ */
+class Peer {
+public:
+  virtual
+  ~Peer() {}
+
+  /**
+   * Send nPackets copies of the encoding in corked batches of 16.
+   * @param nReceived The count of packets received by the other end, to wait
+   * until all are received.
+   */
+  virtual void
+  sendStream
+    (const Blob& encoding, size_t nPackets,
+     const atomic<size_t>& nReceived) = 0;
+
+  /**
+   * Echo nPackets packets of the given size.
+   */
+  virtual void
+  echo(size_t packetSize, size_t nPackets) = 0;
+};
+
+/**
+ * A UnixPeer uses the accepted Unix socket.
+ */
+class UnixPeer : public Peer {
+public:
+  UnixPeer(int socketDescriptor)
+  : socketDescriptor_(socketDescriptor)
+  {
+  }
+
+  virtual
+  ~UnixPeer() { close(socketDescriptor_); }
+
+  virtual void
+  sendStream
+    (const Blob& encoding, size_t nPackets, const atomic<size_t>& nReceived)
+  {
+    vector<uint8_t> chunk;
+    for (size_t i = 0; i < 16; ++i)
+      chunk.insert(chunk.end(), encoding.buf(), encoding.buf() + encoding.size());
+    for (size_t i = 0; i < nPackets / 16; ++i)
+      writeAll(&chunk[0], chunk.size());
+  }
+
+  virtual void
+  echo(size_t packetSize, size_t nPackets)
+  {
+    vector<uint8_t> packet(packetSize);
+    for (size_t i = 0; i < nPackets; ++i) {
+      for (size_t nRead = 0; nRead < packetSize; ) {
+        ssize_t result = recv
+          (socketDescriptor_, &packet[nRead], packetSize - nRead, 0);
+        if (result <= 0)
+          return;
+        nRead += result;
+      }
+      writeAll(&packet[0], packetSize);
+    }
+  }
+
+private:
+  void
+  writeAll(const uint8_t* data, size_t length)
+  {
+    for (size_t nSent = 0; nSent < length; ) {
+      ssize_t result = ::send(socketDescriptor_, data + nSent, length - nSent, 0);
+      if (result <= 0)
+        return;
+      nSent += result;
+    }
+  }
+
+  int socketDescriptor_;
+};
+
+/**
+ * A ShmPeer connects a ShmTransport to the accepted Unix socket.
+ */
+class ShmPeer : public Peer {
+public:
+  ShmPeer(int socketDescriptor)
+  : listener_(&transport_)
+  {
+    transport_.connect
+      (ShmTransport::AcceptedConnectionInfo(socketDescriptor), listener_,
+       Transport::OnConnected());
+  }
+
+  virtual void
+  sendStream
+    (const Blob& encoding, size_t nPackets, const atomic<size_t>& nReceived)
+  {
+    for (size_t i = 0; i < nPackets / 16; ++i) {
+      transport_.cork();
+      for (size_t j = 0; j < 16; ++j)
+        transport_.send(encoding.buf(), encoding.size());
+      transport_.uncork();
+      // Write packets queued when the ring is full.
+      transport_.processEvents();
+    }
+    // Write the rest of the queued packets as the other end frees space.
+    while (nReceived < nPackets && transport_.getIsConnected()) {
+      transport_.processEvents();
+      this_thread::yield();
+    }
+  }
+
+  virtual void
+  echo(size_t packetSize, size_t nPackets)
+  {
+    while (listener_.nElements_ < nPackets && transport_.getIsConnected()) {
+      transport_.waitForReceive(seconds(1));
+      transport_.processEvents();
+    }
+  }
+
+private:
+  ShmTransport transport_;
+  CountingElementListener listener_;
+};
+
+/**
+ * Connect the transport and the peer, and measure the stream and round trip.
+ * @param label The label to print.
+ * @param transport The transport to test.
+ * @param connectionInfo The connection info for transport.
+ * @param filePath The file path of the Unix socket in connectionInfo.
+ * @param isShm True to use a ShmPeer, false for a UnixPeer.
+ * @param encoding The packet to send.
+ * @param nPackets The number of packets in the stream.
+ * @param nRoundTrips The number of round trips.
+ */
+static void
+benchmarkTransport
+  (const string& label, Transport& transport,
+   const Transport::ConnectionInfo& connectionInfo, const string& filePath,
+   bool isShm, const Blob& encoding, size_t nPackets, size_t nRoundTrips)
+{
+  int listenSocket = listenUnix(filePath);
+  CountingElementListener elementListener;
+  transport.connect(connectionInfo, elementListener, []() {});
+  int socketDescriptor = accept(listenSocket, 0, 0);
+  close(listenSocket);
+  unlink(filePath.c_str());
+  ptr_lib::shared_ptr<Peer> peer;
+  if (isShm)
+    peer.reset(new ShmPeer(socketDescriptor));
+  else
+    peer.reset(new UnixPeer(socketDescriptor));
+
+  // Receive a stream.
+  size_t nTotal = (nPackets / 16) * 16;
+  auto start = steady_clock::now();
+  double startCpu = getThreadCpuSeconds();
+  thread writer([&]() { peer->sendStream(encoding, nTotal, elementListener.nElements_); });
+  while (elementListener.nElements_ < nTotal) {
+    transport.processEvents();
+    if (elementListener.nElements_ < nTotal)
+      // Let the writer run on a single core.
+      this_thread::yield();
+  }
+  double receiveCpu = getThreadCpuSeconds() - startCpu;
+  double receiveSeconds = duration_cast<nanoseconds>
+    (steady_clock::now() - start).count() / 1000000000.0;
+  writer.join();
+
+  // Send one packet at a time and wait for the echo.
+  elementListener.nElements_ = 0;
+  thread echoer([&]() { peer->echo(encoding.size(), nRoundTrips); });
+  start = steady_clock::now();
+  for (size_t i = 0; i < nRoundTrips; ++i) {
+    transport.send(encoding.buf(), encoding.size());
+    while (elementListener.nElements_ <= i) {
+      transport.waitForReceive(seconds(1));
+      transport.processEvents();
+    }
+  }
+  double roundTripSeconds = duration_cast<nanoseconds>
+    (steady_clock::now() - start).count() / 1000000000.0;
+  echoer.join();
+
+  transport.close();
+  peer.reset();
+
+  cout << label << " (" << encoding.size() << " bytes): receive " <<
+    (size_t)(nTotal / receiveSeconds) << " packets/sec, " <<
+    receiveCpu * 1000000000.0 / nTotal << " CPU ns/packet; round trip " <<
+    roundTripSeconds * 1000000.0 / nRoundTrips << " us" << endl;
+}
+
+int
+main(int argc, char** argv)
+{
+  try {
+    string filePath = "/tmp/test-shm-transport-benchmark-" +
+      to_string(getpid()) + ".sock";
+
+    Interest interest(Name("/benchmark/shm/interest").appendSegment(0));
+    interest.setCanBePrefix(false);
+    interest.setInterestLifetime(milliseconds(4000));
+    Blob interestEncoding = interest.wireEncode();
+
+    Data data(Name("/benchmark/shm/data").appendSegment(0));
+    data.setContent(Blob(vector<uint8_t>(5000, 'x')));
+    Blob dataEncoding = data.wireEncode();
+
+    Blob encodings[] = { interestEncoding, dataEncoding };
+    const char* names[] = { "Interest", "Data" };
+    size_t nPackets[] = { 1000000, 200000 };
+    for (size_t i = 0; i < 2; ++i) {
+      {
+        UnixTransport transport;
+        benchmarkTransport
+          (string("UnixTransport ") + names[i], transport,
+           UnixTransport::ConnectionInfo(filePath.c_str()), filePath, false,
+           encodings[i], nPackets[i], 20000);
+      }
+      {
+        ShmTransport transport;
+        benchmarkTransport
+          (string("ShmTransport ") + names[i], transport,
+           ShmTransport::ConnectionInfo(filePath.c_str()), filePath, true,
+           encodings[i], nPackets[i], 20000);
+      }
+    }
+  } catch (std::exception& e) {
+    cout << "exception: " << e.what() << endl;
+  }
+  return 0;
+}
+
+#else // NDN_IND_HAVE_SYS_EVENTFD_H
+
+int
+main(int argc, char** argv)
+{
+  cout << "This benchmark requires Linux eventfd." << endl;
+  return 0;
+}
+
+#endif // NDN_IND_HAVE_SYS_EVENTFD_H
@@ -0,0 +1,126 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2020 Operant Networks, Incorporated.
+ * @author: Jeff Thompson <jefft0@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+/**
+ * This measures the rate of finding the element boundaries in a buffer of 1M
+ * concatenated small Interests with ElementReaderLite, which uses the
+ * ndn_TlvStructureDecoder. It passes the buffer once as a whole and once in
+ * 64 KB reads so that some element headers are split across reads.
+ */
+
+#include <iostream>
+#include <ndn-ind/interest.hpp>
+#include <ndn-ind/lite/encoding/element-reader-lite.hpp>
+
+using namespace std;
+using namespace std::chrono;
+using namespace ndn_ind;
+
+/**
+ * A CountingElementListener counts the received elements and their bytes.
+ */
+class CountingElementListener : public ElementListenerLite {
+public:
+  CountingElementListener()
+  : ElementListenerLite(&onReceivedElementWrapper),
+    nElements_(0), nBytes_(0)
+  {
+  }
+
+  size_t nElements_;
+  size_t nBytes_;
+
+private:
+  static void
+  onReceivedElementWrapper
+    (ElementListenerLite *self, const uint8_t *element, size_t elementLength)
+  {
+    CountingElementListener* listener = (CountingElementListener*)self;
+    listener->nBytes_ += elementLength;
+    ++listener->nElements_;
+  }
+};
+
+/**
+ * Call reader.onReceivedData for the buffer nIterations times in chunks of
+ * readSize bytes, and print the rate.
+ * @param label The label to print.
+ * @param buffer The concatenated packets.
+ * @param nPackets The number of packets in the buffer.
+ * @param readSize The number of bytes in each call to onReceivedData.
+ * @param nIterations The number of times to read the buffer.
+ */
+static void
+benchmarkElementReader
+  (const string& label, const vector<uint8_t>& buffer, size_t nPackets,
+   size_t readSize, size_t nIterations)
+{
+  CountingElementListener listener;
+  uint8_t elementBufferBytes[MAX_NDN_PACKET_SIZE];
+  DynamicUInt8ArrayLite elementBuffer
+    (elementBufferBytes, sizeof(elementBufferBytes), 0);
+  ElementReaderLite reader(&listener, &elementBuffer);
+
+  auto start = steady_clock::now();
+  for (size_t i = 0; i < nIterations; ++i) {
+    for (size_t offset = 0; offset < buffer.size(); offset += readSize) {
+      ndn_Error error;
+      if ((error = reader.onReceivedData
+           (&buffer[offset], min(readSize, buffer.size() - offset))))
+        throw runtime_error(ndn_getErrorString(error));
+    }
+  }
+  double seconds = duration_cast<nanoseconds>
+    (steady_clock::now() - start).count() / 1000000000.0;
+
+  if (listener.nElements_ != nPackets * nIterations ||
+      listener.nBytes_ != buffer.size() * nIterations)
+    throw runtime_error("The elements were not found correctly");
+
+  cout << label << ": " << (size_t)(listener.nElements_ / seconds) <<
+    " packets/sec, " <<
+    (size_t)(listener.nBytes_ / seconds / 1000000.0) << " MB/sec, " <<
+    seconds * 1000000000.0 / listener.nElements_ << " ns/packet" << endl;
+}
+
+int
+main(int argc, char** argv)
+{
+  try {
+    // Make 1M Interests with different name lengths.
+    size_t nPackets = 1000000;
+    vector<uint8_t> buffer;
+    for (size_t i = 0; i < nPackets; ++i) {
+      Interest interest(Name("/benchmark/tlv").appendSegment(i));
+      interest.setCanBePrefix(false);
+      interest.setInterestLifetime(milliseconds(4000));
+      Blob encoding = interest.wireEncode();
+      buffer.insert(buffer.end(), encoding.buf(), encoding.buf() + encoding.size());
+    }
+    cout << nPackets << " Interests, " << buffer.size() << " bytes" << endl;
+
+    benchmarkElementReader("Whole buffer", buffer, nPackets, buffer.size(), 10);
+    benchmarkElementReader("64 KB reads", buffer, nPackets, 65536, 10);
+  } catch (std::exception& e) {
+    cout << "exception: " << e.what() << endl;
+  }
+  return 0;
+}
@@ -0,0 +1,167 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2020 Operant Networks, Incorporated.
+ * @author: Jeff Thompson <jefft0@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+/**
+ * This measures the rate of receiving a stream of packets through an
+ * AsyncTcpTransport on the loopback interface, for small Interest packets and
+ * for larger Data packets which often span two reads. A local socket sends the
+ * packets so that no forwarder is needed.
+ */
+
+#include <atomic>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <ndn-ind/data.hpp>
+#include <ndn-ind/interest.hpp>
+#include <ndn-ind/transport/async-tcp-transport.hpp>
+
+using namespace std;
+using namespace std::chrono;
+using namespace ndn_ind;
+
+/**
+ * A CountingElementListener counts the received elements and their bytes.
+ */
+class CountingElementListener : public ElementListener {
+public:
+  CountingElementListener()
+  : nElements_(0), nBytes_(0)
+  {
+  }
+
+  virtual void
+  onReceivedElement(const uint8_t *element, size_t elementLength)
+  {
+    nBytes_ += elementLength;
+    ++nElements_;
+  }
+
+  atomic<size_t> nElements_;
+  size_t nBytes_;
+};
+
+/**
+ * Create a listening socket bound to an available port on the loopback
+ * interface.
+ * @param port Set this to the bound port.
+ * @return The socket descriptor.
+ */
+static int
+listenLoopback(unsigned short& port)
+{
+  int socketDescriptor = socket(AF_INET, SOCK_STREAM, 0);
+  struct sockaddr_in address;
+  memset(&address, 0, sizeof(address));
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  if (socketDescriptor < 0 ||
+      ::bind(socketDescriptor, (struct sockaddr*)&address, sizeof(address)) != 0 ||
+      listen(socketDescriptor, 1) != 0)
+    throw runtime_error("Can't listen on the loopback socket");
+
+  socklen_t addressLength = sizeof(address);
+  getsockname(socketDescriptor, (struct sockaddr*)&address, &addressLength);
+  port = ntohs(address.sin_port);
+  return socketDescriptor;
+}
+
+/**
+ * Connect an AsyncTcpTransport to a local socket, write nPackets copies of the
+ * encoding to the socket in large writes, and print the rate at which the
+ * transport gives the packets to the element listener.
+ * @param label The label to print.
+ * @param encoding The packet to send.
+ * @param nPackets The number of packets.
+ */
+static void
+benchmarkReceive(const string& label, const Blob& encoding, size_t nPackets)
+{
+  unsigned short port;
+  int listenSocket = listenLoopback(port);
+
+  boost::asio::io_service ioService;
+  boost::asio::io_service::work work(ioService);
+  thread ioThread([&ioService]() { ioService.run(); });
+
+  AsyncTcpTransport transport(ioService);
+  CountingElementListener elementListener;
+  ioService.dispatch([&]() {
+    transport.connect
+      (AsyncTcpTransport::ConnectionInfo("127.0.0.1", port), elementListener,
+       []() {});
+  });
+  int socketDescriptor = accept(listenSocket, 0, 0);
+  close(listenSocket);
+
+  // Write about 64 KB at a time, which splits packets across writes.
+  vector<uint8_t> chunk;
+  while (chunk.size() < 65536)
+    chunk.insert(chunk.end(), encoding.buf(), encoding.buf() + encoding.size());
+  size_t totalBytes = nPackets * encoding.size();
+
+  auto start = steady_clock::now();
+  for (size_t nSent = 0; nSent < totalBytes; ) {
+    size_t nBytes = min(chunk.size(), totalBytes - nSent);
+    // The chunk repeats the packet, so start at the offset in the packet.
+    size_t offset = nSent % encoding.size();
+    nBytes = min(nBytes, chunk.size() - offset);
+    ssize_t result = ::send(socketDescriptor, &chunk[offset], nBytes, 0);
+    if (result <= 0)
+      throw runtime_error("Error in send");
+    nSent += result;
+  }
+  while (elementListener.nElements_ < nPackets)
+    this_thread::yield();
+  double seconds = duration_cast<nanoseconds>
+    (steady_clock::now() - start).count() / 1000000000.0;
+
+  ioService.stop();
+  ioThread.join();
+  transport.close();
+  close(socketDescriptor);
+
+  cout << label << " (" << encoding.size() << " bytes): " <<
+    (size_t)(nPackets / seconds) << " packets/sec, " <<
+    (size_t)(elementListener.nBytes_ / seconds / 1000000) << " MB/sec" << endl;
+}
+
+int
+main(int argc, char** argv)
+{
+  try {
+    Interest interest(Name("/benchmark/receive/interest").appendSegment(0));
+    interest.setCanBePrefix(false);
+    interest.setInterestLifetime(milliseconds(4000));
+    benchmarkReceive("Interest", interest.wireEncode(), 2000000);
+
+    Data data(Name("/benchmark/receive/data").appendSegment(0));
+    data.setContent(Blob(vector<uint8_t>(5000, 'x')));
+    benchmarkReceive("Data", data.wireEncode(), 200000);
+  } catch (std::exception& e) {
+    cout << "exception: " << e.what() << endl;
+  }
+  return 0;
+}
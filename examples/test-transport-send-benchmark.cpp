@@ -0,0 +1,169 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2020 Operant Networks, Incorporated.
+ * @author: Jeff Thompson <jefft0@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+/**
+ * This measures the rate of sending a burst of small packets through a
+ * UdpTransport and a TcpTransport on the loopback interface, sending each
+ * packet immediately or corking the transport for each burst as
+ * Face::processEvents does. A local socket receives the packets so that no
+ * forwarder is needed.
+ */
+
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <ndn-ind/data.hpp>
+#include <ndn-ind/transport/tcp-transport.hpp>
+#include <ndn-ind/transport/udp-transport.hpp>
+
+using namespace std;
+using namespace std::chrono;
+using namespace ndn_ind;
+
+class DummyElementListener : public ElementListener {
+public:
+  virtual void
+  onReceivedElement(const uint8_t *element, size_t elementLength) {}
+};
+
+/**
+ * Create a socket bound to an available port on the loopback interface.
+ * @param type SOCK_DGRAM or SOCK_STREAM.
+ * @param port Set this to the bound port.
+ * @return The socket descriptor.
+ */
+static int
+bindLoopback(int type, unsigned short& port)
+{
+  int socketDescriptor = socket(AF_INET, type, 0);
+  struct sockaddr_in address;
+  memset(&address, 0, sizeof(address));
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  if (socketDescriptor < 0 ||
+      ::bind(socketDescriptor, (struct sockaddr*)&address, sizeof(address)) != 0)
+    throw runtime_error("Can't bind the loopback socket");
+
+  socklen_t addressLength = sizeof(address);
+  getsockname(socketDescriptor, (struct sockaddr*)&address, &addressLength);
+  port = ntohs(address.sin_port);
+  return socketDescriptor;
+}
+
+/**
+ * Send nBursts bursts of burstSize copies of the encoding through the
+ * transport, and return the packets per second.
+ * @param transport The connected transport.
+ * @param encoding The packet to send.
+ * @param nBursts The number of bursts.
+ * @param burstSize The number of packets in each burst.
+ * @param useCork If true, cork the transport for each burst.
+ * @return The number of packets per second.
+ */
+static double
+benchmarkSend
+  (Transport& transport, const Blob& encoding, size_t nBursts,
+   size_t burstSize, bool useCork)
+{
+  auto start = steady_clock::now();
+  for (size_t i = 0; i < nBursts; ++i) {
+    if (useCork)
+      transport.cork();
+    for (size_t j = 0; j < burstSize; ++j)
+      transport.send(encoding.buf(), encoding.size());
+    if (useCork)
+      transport.uncork();
+  }
+  double seconds = duration_cast<nanoseconds>
+    (steady_clock::now() - start).count() / 1000000000.0;
+
+  return nBursts * burstSize / seconds;
+}
+
+int
+main(int argc, char** argv)
+{
+  try {
+    Data data(Name("/benchmark/transport/send").appendSegment(0));
+    data.setContent(Blob(vector<uint8_t>(100)));
+    Blob encoding = data.wireEncode();
+    DummyElementListener elementListener;
+    const size_t nBursts = 2000;
+    const size_t burstSize = 64;
+
+    {
+      // UDP. The receiver doesn't read, so the kernel drops datagrams when its
+      // buffer is full, but this doesn't slow the sender.
+      unsigned short port;
+      int receiver = bindLoopback(SOCK_DGRAM, port);
+      UdpTransport transport;
+      transport.connect
+        (UdpTransport::ConnectionInfo("127.0.0.1", port), elementListener,
+         Transport::OnConnected());
+
+      for (int useCork = 0; useCork <= 1; ++useCork)
+        cout << "UDP send " << encoding.size() << " byte packets, " <<
+          (useCork ? "corked " : "each   ") << ": " <<
+          (size_t)benchmarkSend
+            (transport, encoding, nBursts, burstSize, useCork != 0) <<
+          " packets/sec" << endl;
+
+      transport.close();
+      close(receiver);
+    }
+
+    {
+      // TCP. A thread reads and discards the received bytes.
+      unsigned short port;
+      int listener = bindLoopback(SOCK_STREAM, port);
+      listen(listener, 1);
+      thread readerThread([listener]() {
+        int receiver = accept(listener, 0, 0);
+        uint8_t buffer[65536];
+        while (recv(receiver, buffer, sizeof(buffer), 0) > 0) {}
+        close(receiver);
+      });
+
+      TcpTransport transport;
+      transport.connect
+        (TcpTransport::ConnectionInfo("127.0.0.1", port), elementListener,
+         Transport::OnConnected());
+
+      for (int useCork = 0; useCork <= 1; ++useCork)
+        cout << "TCP send " << encoding.size() << " byte packets, " <<
+          (useCork ? "corked " : "each   ") << ": " <<
+          (size_t)benchmarkSend
+            (transport, encoding, nBursts, burstSize, useCork != 0) <<
+          " packets/sec" << endl;
+
+      transport.close();
+      readerThread.join();
+      close(listener);
+    }
+  } catch (std::exception& e) {
+    cout << "exception: " << e.what() << endl;
+  }
+  return 0;
+}
@@ -75,6 +75,23 @@ public:
   int
   addFace(const char *host, unsigned short port = 6363);
 
+#if NDN_IND_HAVE_SYS_EVENTFD_H
+  /**
+   * Listen on a Unix socket at filePath for applications which connect with a
+   * ShmTransport. For each connection, processEvents() adds a new face with a
+   * ShmTransport which uses the shared memory created by the application,
+   * after the application sends it. (If it is not sent within 5 seconds, the
+   * connection is closed.) The
+   * URI to use in the faces/query and faces/list commands will be
+   * "shm://filePath" .
+   * @param filePath The file path of the Unix socket. If the file exists, it
+   * is removed first.
+   * @throws runtime_error for an error creating the Unix socket.
+   */
+  void
+  listenShm(const std::string& filePath);
+#endif
+
   /**
    * Find or create the FIB entry with the given name and add the ForwarderFace
    * with the given faceId. All routes are multicast by default.
@@ -125,7 +142,8 @@ public:
      const ndn_ind::OnRegisterSuccess& onRegisterSuccess = ndn_ind::OnRegisterSuccess());
 
   /**
-   * Call processEvents() for the Transport object in each face. This is
+   * Add a face for each connection on the Unix sockets given to listenShm, then
+   * call processEvents() for the Transport object in each face. This is
    * normally called by MicroForwarderTransport::processEvents() which is called
    * by the application when it calls Face::processEvents(), so an application
    * normally doesn't need to call this directly.
@@ -430,6 +448,19 @@ private:
   std::vector<ndn_ind::ptr_lib::shared_ptr<PitEntry> > PIT_;
   std::vector<ndn_ind::ptr_lib::shared_ptr<FibEntry> > FIB_;
   std::vector<ndn_ind::ptr_lib::shared_ptr<ForwarderFace> > faces_;
+  /**
+   * A PendingShmConnection holds a socket accepted on a Unix socket given to
+   * listenShm until the application sends the shared memory.
+   */
+  struct PendingShmConnection {
+    std::string filePath;
+    int socketDescriptor;
+    std::chrono::steady_clock::time_point deadline;
+  };
+
+  // The file path and socket of each Unix socket given to listenShm.
+  std::vector<std::pair<std::string, int> > shmListeners_;
+  std::vector<PendingShmConnection> pendingShmConnections_;
   std::chrono::nanoseconds minPitEntryLifetime_;
 
   ndn_ind::Name localhostNamePrefix;
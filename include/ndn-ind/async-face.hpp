@@ -156,6 +156,23 @@ public:
       if (err == boost::system::errc::success) callback(); });
   }
 
+  Callback
+  callLaterCancellable(nanoseconds delay, const Callback& callback) override final
+  {
+    ptr_lib::shared_ptr<boost::asio::deadline_timer> timer
+      (new boost::asio::deadline_timer(ioService_,
+        boost::posix_time::milliseconds(duration_cast<milliseconds>(delay).count())));
+
+    // Pass the timer to waitHandler to keep it alive.
+    timer->async_wait([callback, timer](const auto& err) {
+      if (err == boost::system::errc::success) callback(); });
+    // The cancel function doesn't keep the timer alive after the wait handler.
+    ptr_lib::weak_ptr<boost::asio::deadline_timer> weakTimer(timer);
+    return [weakTimer]() {
+      auto sharedTimer = weakTimer.lock();
+      if (sharedTimer) sharedTimer->cancel(); };
+  }
+
 private:
   static ptr_lib::shared_ptr<Transport>
   getDefaultTransport(boost::asio::io_service& ioService)
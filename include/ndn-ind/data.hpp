@@ -8,7 +8,8 @@
  * Original file: include/ndn-cpp/data.hpp
  * Original repository: https://github.com/named-data/ndn-cpp
  *
- * Summary of Changes: Support ndn_ind_dll.
+ * Summary of Changes: Support ndn_ind_dll. Share a backing Blob in set. Add wireDecodeLazy.
+ * Add wireDecodeShared.
  *
  * which was originally released under the LGPL license with the following rights:
  *
@@ -96,6 +97,20 @@ public:
   virtual void
   wireDecode(const Blob& input, WireFormat& wireFormat = *WireFormat::getDefaultWireFormat());
 
+  /**
+   * Decode the input like wireDecode(Blob), but set the name components and
+   * the content to slices which share the buffer of input instead of copying
+   * them. (See Blob for the slice rules.) A slice keeps the whole buffer of
+   * input in memory, so only use this if the decoded Data does not outlive
+   * input for long, or if input is exactly the size of the encoding.
+   * @param input The input byte array to be decoded as an immutable Blob.
+   * @param wireFormat A WireFormat object used to decode the input. If omitted, use WireFormat getDefaultWireFormat().
+   */
+  void
+  wireDecodeShared
+    (const Blob& input,
+     WireFormat& wireFormat = *WireFormat::getDefaultWireFormat());
+
   /**
    * Decode the input using a particular wire format and update this Data. If wireFormat is the default wire format, also
    * set the defaultWireEncoding field to a copy of the input. (To not copy the input, see wireDecode(Blob).)
@@ -123,6 +138,42 @@ public:
     wireDecode(&input[0], input.size(), wireFormat);
   }
 
+  /**
+   * Decode the input like wireDecode, but only make the Name and Content
+   * objects, which share the buffer of input as in wireDecodeShared. The MetaInfo and Signature objects are made from the input on the
+   * first call to getMetaInfo() or getSignature(). The whole input is still
+   * checked, so this throws for a bad encoding just like wireDecode. This is
+   * useful to forward or cache a Data packet where usually only the name is
+   * needed. If wireFormat is not an NDN-TLV wire format, this is the same as
+   * wireDecode.
+   * Thread safety: The first call to getMetaInfo() or getSignature() updates
+   * this object, even through a const reference. So if this Data will be
+   * used by more than one thread (for example, by passing a
+   * shared_ptr<const Data> to worker threads), first call getMetaInfo() and
+   * getSignature() in one thread, or use wireDecode instead.
+   * @param input The input byte array to be decoded as an immutable Blob.
+   * @param wireFormat A WireFormat object used to decode the input. If omitted, use WireFormat getDefaultWireFormat().
+   */
+  void
+  wireDecodeLazy
+    (const Blob& input,
+     WireFormat& wireFormat = *WireFormat::getDefaultWireFormat());
+
+  /**
+   * Decode the input like wireDecode, but only make the Name and Content
+   * objects. (See wireDecodeLazy(Blob).) This copies the input.
+   * @param input The input byte array to be decoded.
+   * @param inputLength The length of input.
+   * @param wireFormat A WireFormat object used to decode the input. If omitted, use WireFormat getDefaultWireFormat().
+   */
+  void
+  wireDecodeLazy
+    (const uint8_t* input, size_t inputLength,
+     WireFormat& wireFormat = *WireFormat::getDefaultWireFormat())
+  {
+    wireDecodeLazy(Blob(input, inputLength), wireFormat);
+  }
+
   /**
    * Set dataLite to point to the values in this Data object, without copying
    * any memory.
@@ -137,15 +188,30 @@ public:
   /**
    * Clear this data object, and set the values by copying from dataLite.
    * @param dataLite A DataLite object.
+   * @param backing (optional) If a value in dataLite points into the bytes of
+   * this Blob (such as the encoding which was decoded), then share its buffer
+   * instead of copying. If omitted, copy all values.
+   * This shares the buffer for the name components and the content.
    */
   void
-  set(const DataLite& dataLite);
+  set(const DataLite& dataLite, const Blob& backing = Blob());
 
   const Signature*
-  getSignature() const { return signature_.get(); }
+  getSignature() const
+  {
+    if (isSignatureLazy_)
+      // This method can be called on a const object, but we want to be able to update the signature_.
+      const_cast<Data*>(this)->decodeLazySignature();
+    return signature_.get();
+  }
 
   Signature*
-  getSignature() { return signature_.get(); }
+  getSignature()
+  {
+    if (isSignatureLazy_)
+      decodeLazySignature();
+    return signature_.get();
+  }
 
   const Name&
   getName() const { return name_.get(); }
@@ -154,9 +220,19 @@ public:
   getName() { return name_.get(); }
 
   const MetaInfo&
-  getMetaInfo() const { return metaInfo_.get(); }
+  getMetaInfo() const
+  {
+    if (isMetaInfoLazy_)
+      const_cast<Data*>(this)->decodeLazyMetaInfo();
+    return metaInfo_.get();
+  }
 
-  MetaInfo& getMetaInfo() { return metaInfo_.get(); }
+  MetaInfo& getMetaInfo()
+  {
+    if (isMetaInfoLazy_)
+      decodeLazyMetaInfo();
+    return metaInfo_.get();
+  }
 
   const Blob&
   getContent() const { return content_; }
@@ -222,6 +298,7 @@ public:
   setSignature(const Signature& signature)
   {
     signature_.set(signature.clone());
+    isSignatureLazy_ = false;
     ++changeCount_;
     return *this;
   }
@@ -243,6 +320,7 @@ public:
   setMetaInfo(const MetaInfo& metaInfo)
   {
     metaInfo_.set(metaInfo);
+    isMetaInfoLazy_ = false;
     ++changeCount_;
     return *this;
   }
@@ -319,6 +397,21 @@ private:
     getDefaultWireEncodingChangeCount_ = getChangeCount();
   }
 
+  /**
+   * Set metaInfo_ from lazyMetaInfo_ which was saved by wireDecodeLazy. This
+   * does not invalidate the default wire encoding.
+   */
+  void
+  decodeLazyMetaInfo();
+
+  /**
+   * Set signature_ by decoding the signature info and value in lazyEncoding_
+   * which was saved by wireDecodeLazy. This does not invalidate the default
+   * wire encoding.
+   */
+  void
+  decodeLazySignature();
+
   SharedPointerChangeCounter<Signature> signature_;
   ChangeCounter<Name> name_;
   ChangeCounter<MetaInfo> metaInfo_;
@@ -329,6 +422,15 @@ private:
   uint64_t getDefaultWireEncodingChangeCount_;
   ptr_lib::shared_ptr<LpPacket> lpPacket_;
   uint64_t changeCount_;
+  // The following are set by wireDecodeLazy for the fields not yet decoded.
+  bool isMetaInfoLazy_;
+  bool isSignatureLazy_;
+  MetaInfoLite lazyMetaInfo_;
+  Blob lazyEncoding_;
+  WireFormat* lazyWireFormat_;
+  size_t lazySignatureInfoOffset_;
+  size_t lazySignatureValueOffset_;
+  size_t lazySignatureValueEndOffset_;
 };
 
 }
@@ -9,6 +9,7 @@
  * Original repository: https://github.com/named-data/ndn-cpp
  *
  * Summary of Changes: Add readRawPackets. Put element-listener.hpp in API. Support ndn_ind_dll.
+ * Add onReceivedElement(Blob).
  *
  * which was originally released under the LGPL license with the following rights:
  *
@@ -38,6 +39,8 @@
 
 namespace ndn_ind {
 
+class Blob;
+
 /**
  * An ElementListener extends an ndn_ElementListener struct to proved an abstract virtual onReceivedElement function which wraps
  * the onReceivedElement used by the ndn_ElementListener struct.  You must extend this class to override onReceivedElement.
@@ -56,6 +59,18 @@ public:
   virtual void
   onReceivedElement(const uint8_t *element, size_t elementLength) = 0;
 
+  /**
+   * This is called by a transport which hands over a buffer that it no longer
+   * modifies, so that the listener can keep a reference to the element instead
+   * of copying it. The default implementation calls
+   * onReceivedElement(element.buf(), element.size()). Override this if the
+   * listener can use the Blob without copying.
+   * @param element The Blob with the entire element. The listener may keep
+   * a reference to it after this returns.
+   */
+  virtual void
+  onReceivedElement(const Blob& element);
+
 private:
   /**
    * Call the virtual method onReceivedElement. This is used to initialize the base ndn_ElementListener struct.
@@ -8,7 +8,8 @@
  * Original file: include/ndn-cpp/encoding/tlv-0_2-wire-format.hpp
  * Original repository: https://github.com/named-data/ndn-cpp
  *
- * Summary of Changes: Support ndn_ind_dll.
+ * Summary of Changes: Support ndn_ind_dll. Add encode to a caller's vector and
+ * decode from a Blob.
  *
  * which was originally released under the LGPL license with the following rights:
  *
@@ -65,6 +66,19 @@ public:
     (const Interest& interest, size_t *signedPortionBeginOffset,
      size_t *signedPortionEndOffset);
 
+  /**
+   * Encode interest in NDN-TLV into the caller's output vector, reusing its
+   * capacity. See WireFormat::encodeInterest.
+   * @param interest The Interest object to encode.
+   * @param output The vector to receive the encoding.
+   * @param signedPortionBeginOffset See encodeInterest.
+   * @param signedPortionEndOffset See encodeInterest.
+   */
+  virtual void
+  encodeInterest
+    (const Interest& interest, std::vector<uint8_t>& output,
+     size_t *signedPortionBeginOffset, size_t *signedPortionEndOffset);
+
   /**
    * Decode input as an interest in NDN-TLV and set the fields of the interest object.
    * @param interest The Interest object whose fields are updated.
@@ -90,6 +104,20 @@ public:
     (Interest& interest, const uint8_t *input, size_t inputLength,
      size_t *signedPortionBeginOffset, size_t *signedPortionEndOffset);
 
+  /**
+   * Decode input as an interest in NDN-TLV and set the fields of the interest
+   * object. This overrides the version 0.3 method so that the version 0.2
+   * format is used.
+   * @param interest The Interest object whose fields are updated.
+   * @param input The Blob with the input buffer to decode.
+   * @param signedPortionBeginOffset See decodeInterest.
+   * @param signedPortionEndOffset See decodeInterest.
+   */
+  virtual void
+  decodeInterest
+    (Interest& interest, const Blob& input, size_t *signedPortionBeginOffset,
+     size_t *signedPortionEndOffset);
+
   /**
    * Get a singleton instance of a Tlv0_2WireFormat.  To always use the
    * preferred version NDN-TLV, you should use TlvWireFormat::get().
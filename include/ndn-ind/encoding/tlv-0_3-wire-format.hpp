@@ -8,7 +8,8 @@
  * Original file: include/ndn-cpp/encoding/tlv-0_3-wire-format.hpp
  * Original repository: https://github.com/named-data/ndn-cpp
  *
- * Summary of Changes: Support ndn_ind_dll.
+ * Summary of Changes: Support ndn_ind_dll. Add decode from a Blob.
+ * Add encode to a caller's vector.
  *
  * which was originally released under the LGPL license with the following rights:
  *
@@ -80,6 +81,19 @@ public:
     (const Interest& interest, size_t *signedPortionBeginOffset,
      size_t *signedPortionEndOffset);
 
+  /**
+   * Encode interest in NDN-TLV into the caller's output vector, reusing its
+   * capacity. See WireFormat::encodeInterest.
+   * @param interest The Interest object to encode.
+   * @param output The vector to receive the encoding.
+   * @param signedPortionBeginOffset See encodeInterest.
+   * @param signedPortionEndOffset See encodeInterest.
+   */
+  virtual void
+  encodeInterest
+    (const Interest& interest, std::vector<uint8_t>& output,
+     size_t *signedPortionBeginOffset, size_t *signedPortionEndOffset);
+
   /**
    * Decode input as an interest in NDN-TLV and set the fields of the interest object.
    * @param interest The Interest object whose fields are updated.
@@ -105,6 +119,20 @@ public:
     (Interest& interest, const uint8_t *input, size_t inputLength,
      size_t *signedPortionBeginOffset, size_t *signedPortionEndOffset);
 
+  /**
+   * Decode input as an interest in NDN-TLV and set the fields of the interest
+   * object. The name components, application parameters and nonce are slices
+   * which share the buffer of input.
+   * @param interest The Interest object whose fields are updated.
+   * @param input The Blob with the input buffer to decode.
+   * @param signedPortionBeginOffset See decodeInterest.
+   * @param signedPortionEndOffset See decodeInterest.
+   */
+  virtual void
+  decodeInterest
+    (Interest& interest, const Blob& input, size_t *signedPortionBeginOffset,
+     size_t *signedPortionEndOffset);
+
   /**
    * Encode data with NDN-TLV and return the encoding.
    * @param data The Data object to encode.
@@ -118,6 +146,19 @@ public:
   encodeData
     (const Data& data, size_t *signedPortionBeginOffset, size_t *signedPortionEndOffset);
 
+  /**
+   * Encode data in NDN-TLV into the caller's output vector, reusing its
+   * capacity. See WireFormat::encodeData.
+   * @param data The Data object to encode.
+   * @param output The vector to receive the encoding.
+   * @param signedPortionBeginOffset See encodeData.
+   * @param signedPortionEndOffset See encodeData.
+   */
+  virtual void
+  encodeData
+    (const Data& data, std::vector<uint8_t>& output,
+     size_t *signedPortionBeginOffset, size_t *signedPortionEndOffset);
+
   /**
    * Decode input as a data packet in NDN-TLV and set the fields in the data object.
    * @param data The Data object whose fields are updated.
@@ -134,6 +175,20 @@ public:
   decodeData
     (Data& data, const uint8_t *input, size_t inputLength, size_t *signedPortionBeginOffset, size_t *signedPortionEndOffset);
 
+  /**
+   * Decode input as a data packet in NDN-TLV and set the fields in the data
+   * object. The name components and content are slices which share the buffer
+   * of input.
+   * @param data The Data object whose fields are updated.
+   * @param input The Blob with the input buffer to decode.
+   * @param signedPortionBeginOffset See decodeData.
+   * @param signedPortionEndOffset See decodeData.
+   */
+  virtual void
+  decodeData
+    (Data& data, const Blob& input, size_t *signedPortionBeginOffset,
+     size_t *signedPortionEndOffset);
+
   /**
    * Encode controlParameters as NDN-TLV and return the encoding.
    * @param controlParameters The ControlParameters object to encode.
@@ -272,6 +327,29 @@ public:
   }
 
 private:
+  /**
+   * Decode input as an interest in NDN-TLV and set the fields of the interest
+   * object, sharing the buffer of backing for the fields which point into it.
+   * @param backing The Blob with the buffer of input, or a null Blob to copy
+   * all fields.
+   */
+  void
+  decodeInterest
+    (Interest& interest, const uint8_t *input, size_t inputLength,
+     const Blob& backing, size_t *signedPortionBeginOffset,
+     size_t *signedPortionEndOffset);
+
+  /**
+   * Decode input as a data packet in NDN-TLV and set the fields in the data
+   * object, sharing the buffer of backing for the fields which point into it.
+   * @param backing The Blob with the buffer of input, or a null Blob to copy
+   * all fields.
+   */
+  void
+  decodeData
+    (Data& data, const uint8_t *input, size_t inputLength, const Blob& backing,
+     size_t *signedPortionBeginOffset, size_t *signedPortionEndOffset);
+
   static Tlv0_3WireFormat* instance_;
 };
 
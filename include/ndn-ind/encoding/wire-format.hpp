@@ -8,7 +8,8 @@
  * Original file: include/ndn-cpp/encoding/wire-format.hpp
  * Original repository: https://github.com/named-data/ndn-cpp
  *
- * Summary of Changes: Remove unused methods. Support ndn_ind_dll.
+ * Summary of Changes: Remove unused methods. Support ndn_ind_dll. Add decode
+ * from a Blob. Add encode to a caller's vector.
  *
  * which was originally released under the LGPL license with the following rights:
  *
@@ -105,6 +106,24 @@ public:
     return encodeInterest(interest, &dummyBeginOffset, &dummyEndOffset);
   }
 
+  /**
+   * Encode interest into the caller's output vector, which is resized to the
+   * encoding length. If the caller reuses the same output for the next
+   * encoding, then its capacity is reused so that encoding doesn't need to
+   * allocate. This default implementation copies the result of
+   * encodeInterest(interest, signedPortionBeginOffset, signedPortionEndOffset),
+   * and a derived class can override to encode directly into output.
+   * @param interest The Interest object to encode.
+   * @param output The vector to receive the encoding.
+   * @param signedPortionBeginOffset See encodeInterest.
+   * @param signedPortionEndOffset See encodeInterest.
+   * @throws logic_error for unimplemented if the derived class does not override.
+   */
+  virtual void
+  encodeInterest
+    (const Interest& interest, std::vector<uint8_t>& output,
+     size_t *signedPortionBeginOffset, size_t *signedPortionEndOffset);
+
   /**
    * Decode input as an interest and set the fields of the interest object.  Your derived class should override.
    * @param interest The Interest object whose fields are updated.
@@ -131,6 +150,22 @@ public:
     (Interest& interest, const uint8_t *input, size_t inputLength,
      size_t *signedPortionBeginOffset, size_t *signedPortionEndOffset);
 
+  /**
+   * Decode input as an interest and set the fields of the interest object.
+   * This is the same as decodeInterest(interest, input.buf(), input.size(),
+   * signedPortionBeginOffset, signedPortionEndOffset), except that a derived
+   * class can override to set decoded fields such as the name components to
+   * slices which share the buffer of input instead of copying.
+   * @param interest The Interest object whose fields are updated.
+   * @param input The Blob with the input buffer to decode.
+   * @param signedPortionBeginOffset See decodeInterest.
+   * @param signedPortionEndOffset See decodeInterest.
+   */
+  virtual void
+  decodeInterest
+    (Interest& interest, const Blob& input, size_t *signedPortionBeginOffset,
+     size_t *signedPortionEndOffset);
+
   void
   decodeInterest(Interest& interest, const uint8_t *input, size_t inputLength)
   {
@@ -166,6 +201,24 @@ public:
     return encodeData(data, &dummyBeginOffset, &dummyEndOffset);
   }
 
+  /**
+   * Encode data into the caller's output vector, which is resized to the
+   * encoding length. If the caller reuses the same output for the next
+   * encoding, then its capacity is reused so that encoding doesn't need to
+   * allocate. This default implementation copies the result of
+   * encodeData(data, signedPortionBeginOffset, signedPortionEndOffset), and a
+   * derived class can override to encode directly into output.
+   * @param data The Data object to encode.
+   * @param output The vector to receive the encoding.
+   * @param signedPortionBeginOffset See encodeData.
+   * @param signedPortionEndOffset See encodeData.
+   * @throws logic_error for unimplemented if the derived class does not override.
+   */
+  virtual void
+  encodeData
+    (const Data& data, std::vector<uint8_t>& output,
+     size_t *signedPortionBeginOffset, size_t *signedPortionEndOffset);
+
   /**
    * Decode input as a data packet and set the fields in the data object.  Your derived class should override.
    * @param data The Data object whose fields are updated.
@@ -183,6 +236,22 @@ public:
   decodeData
     (Data& data, const uint8_t *input, size_t inputLength, size_t *signedPortionBeginOffset, size_t *signedPortionEndOffset);
 
+  /**
+   * Decode input as a data packet and set the fields in the data object.
+   * This is the same as decodeData(data, input.buf(), input.size(),
+   * signedPortionBeginOffset, signedPortionEndOffset), except that a derived
+   * class can override to set decoded fields such as the name components to
+   * slices which share the buffer of input instead of copying.
+   * @param data The Data object whose fields are updated.
+   * @param input The Blob with the input buffer to decode.
+   * @param signedPortionBeginOffset See decodeData.
+   * @param signedPortionEndOffset See decodeData.
+   */
+  virtual void
+  decodeData
+    (Data& data, const Blob& input, size_t *signedPortionBeginOffset,
+     size_t *signedPortionEndOffset);
+
   void
   decodeData(Data& data, const uint8_t *input, size_t inputLength)
   {
@@ -144,6 +144,17 @@ public:
   size_t
   size() { return impl_->size(); }
 
+  /**
+   * Set the offset when the in-memory storage gets the current time, which
+   * should only be used for testing.
+   * @param nowOffset The offset.
+   */
+  void
+  setNowOffset_(std::chrono::nanoseconds nowOffset)
+  {
+    impl_->setNowOffset_(nowOffset);
+  }
+
 private:
   // Give friend access to the tests.
   friend class ::TestAccessManagerV2_EnumerateDataFromInMemoryStorage_Test;
@@ -164,6 +175,9 @@ private:
       (const ptr_lib::shared_ptr<PibIdentity>& identity, KeyChain* keyChain,
        Face* face, ndn_EncryptAlgorithmType groupContentKeyAlgorithmType)
       : identity_(identity), keyChain_(keyChain), face_(face),
+        // A producer's own storage is authoritative, and the KEK and KDKs are
+        // inserted only once, so don't check their FreshnessPeriod.
+        storage_(0, false),
         gckAlgorithmType_(groupContentKeyAlgorithmType),
         kekRegisteredPrefixId_(0), kdkRegisteredPrefixId_(0)
       {}
@@ -199,6 +213,12 @@ private:
     size_t
     size() { return storage_.size(); }
 
+    void
+    setNowOffset_(std::chrono::nanoseconds nowOffset)
+    {
+      storage_.setNowOffset_(nowOffset);
+    }
+
   private:
     // Give friend access to the tests.
     friend class ::TestAccessManagerV2_EnumerateDataFromInMemoryStorage_Test;
@@ -8,7 +8,8 @@
  * Original file: include/ndn-cpp/face.hpp
  * Original repository: https://github.com/named-data/ndn-cpp
  *
- * Summary of Changes: Use std::chrono. Support ndn_ind_dll.
+ * Summary of Changes: Use std::chrono. Support ndn_ind_dll. Add processEvents(maxWait).
+ * Add setLazyDataDecodingEnabled. Add setSharedDecodingEnabled.
  *
  * which was originally released under the LGPL license with the following rights:
  *
@@ -136,6 +137,38 @@ public:
   void
   setInterestLoopbackEnabled(bool interestLoopbackEnabled);
 
+  /**
+   * Enable or disable lazy decoding of incoming Data packets. If enabled, an
+   * incoming Data is decoded with Data::wireDecodeLazy so that the MetaInfo
+   * and Signature are only made if the application calls getMetaInfo() or
+   * getSignature(). This is faster if the application usually only needs the
+   * name and content, but the application must not give the Data to another
+   * thread until it is fully decoded (see Data::wireDecodeLazy). Lazy decoding
+   * is disabled by default.
+   * @param lazyDataDecodingEnabled If true, enable lazy decoding of incoming
+   * Data packets, otherwise disable it.
+   */
+  void
+  setLazyDataDecodingEnabled(bool lazyDataDecodingEnabled);
+
+  /**
+   * Enable or disable shared decoding of incoming packets. If enabled, an
+   * incoming Interest or Data is decoded with wireDecodeShared so that the name
+   * components and the content (or the application parameters and nonce of an
+   * Interest) are slices which share the buffer of the received element
+   * instead of copies. This saves an allocation and a copy for each field, but
+   * a kept slice (for example the content of a cached Data) keeps the whole
+   * received element in memory. When enabled, the received element itself is
+   * also not copied, so it may be a slice of the transport's receive buffer
+   * (up to 256 KB) which is kept with it. When disabled, each received element
+   * is first copied into an exact-size Blob. Shared decoding is disabled by
+   * default.
+   * @param sharedDecodingEnabled If true, enable shared decoding of incoming
+   * packets, otherwise disable it.
+   */
+  void
+  setSharedDecodingEnabled(bool sharedDecodingEnabled);
+
   /**
    * Send the Interest through the transport, read the entire response and call
    * onData, onTimeout or onNetworkNack as described below.
@@ -379,6 +412,16 @@ public:
   virtual void
   removePendingInterest(uint64_t pendingInterestId);
 
+  /**
+   * Remove the pending interest entries with the given pendingInterestIds from
+   * the pending interest table, for example to cancel a whole fetch window at
+   * once. This is the same as calling removePendingInterest for each ID, but
+   * the cost of each removal does not depend on the size of the table.
+   * @param pendingInterestIds The IDs returned from expressInterest.
+   */
+  virtual void
+  removePendingInterests(const std::vector<uint64_t>& pendingInterestIds);
+
   /**
    * Set the KeyChain and certificate name used to sign command interests
    * (e.g. for registerPrefix).
@@ -662,13 +705,32 @@ public:
    * loop doesn’t use 100% of the CPU. Since processEvents modifies the pending
    * interest table, your application should make sure that it calls
    * processEvents in the same thread as expressInterest (which also modifies
-   * the pending interest table).
+   * the pending interest table). The transport is corked while calling the
+   * callbacks so that the packets they send are sent together. A callback may
+   * call processEvents again in a nested loop, which first sends the packets
+   * that the callback already sent.
    * @throws This may throw an exception for reading data or in the callback for processing the data.  If you
    * call this from an main event loop, you may want to catch and log/disregard all exceptions.
    */
   virtual void
   processEvents();
 
+  /**
+   * Wait until there is data to receive, the next timeout such as an interest
+   * timeout or a call from callLater is due, or maxWait has elapsed, whichever
+   * comes first, then process events the same as processEvents(). Unlike
+   * calling processEvents() and then sleeping, this doesn't add the sleep
+   * time to the latency of each received packet, and the event loop doesn't
+   * use 100% of the CPU. (A socket transport waits in poll. A transport which
+   * doesn't support waiting, such as an async transport, sleeps until the next
+   * timeout or maxWait.)
+   * @param maxWait The maximum time to wait before processing events.
+   * @throws This may throw an exception for reading data or in the callback
+   * for processing the data.
+   */
+  virtual void
+  processEvents(std::chrono::nanoseconds maxWait);
+
   /**
    * Check if the face is local based on the current connection through the
    * Transport; some Transport may cause network I/O (e.g. an IP host name lookup).
@@ -709,6 +771,23 @@ public:
   virtual void
   callLater(std::chrono::nanoseconds delay, const Callback& callback);
 
+  /**
+   * Call callback() after the given delay, the same as callLater, and return
+   * a function which cancels the call. This is used for interest timeouts so
+   * that a satisfied interest doesn't leave a pending call. Even though this
+   * is public, it is not part of the public API of Face. This default
+   * implementation calls Node::callLaterCancellable, which removes the call
+   * from the Node's delayed call table. A subclass which overrides callLater
+   * must also override this.
+   * @param delay The delay.
+   * @param callback This calls callback() after the delay.
+   * @return A function which cancels the call. It does nothing if the call was
+   * already made.
+   */
+  virtual Callback
+  callLaterCancellable
+    (std::chrono::nanoseconds delay, const Callback& callback);
+
 protected:
   /**
    * If the forwarder's Unix socket file path exists, then return the file path.
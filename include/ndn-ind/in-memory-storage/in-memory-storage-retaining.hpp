@@ -8,7 +8,7 @@
  * Original file: include/ndn-cpp/in-memory-storage/in-memory-storage-retaining.hpp
  * Original repository: https://github.com/named-data/ndn-cpp
  *
- * Summary of Changes: Support ndn_ind_dll.
+ * Summary of Changes: Support ndn_ind_dll. Use lower_bound, selectors, limit and lifetime.
  *
  * which was originally released under the LGPL license with the following rights:
  *
@@ -36,6 +36,9 @@
 #define NDN_IN_MEMORY_STORAGE_RETAINING_HPP
 
 #include <map>
+#include <list>
+#include <queue>
+#include <unordered_map>
 #include "../interest.hpp"
 #include "../data.hpp"
 
@@ -47,26 +50,50 @@ namespace ndn_ind {
 
 /**
  * InMemoryStorageRetaining provides an application cache with in-memory
- * storage, of which no eviction policy will be employed. Entries will only be
- * evicted by explicit application control.
+ * storage. By default, no eviction policy will be employed and entries will
+ * only be evicted by explicit application control. Optionally, the constructor
+ * can set a limit on the number of entries so that the least recently used
+ * entry is evicted, and insert can set a lifetime for an entry. The entries
+ * are sorted by name, so that find only searches the entries whose name has
+ * the requested prefix.
  * Note: In ndn-cxx, this class is called InMemoryStoragePersistent, but
  * "persistent" misleadingly sounds like persistent on-disk storage.
  */
 class ndn_ind_dll InMemoryStorageRetaining {
 public:
+  /**
+   * Create an InMemoryStorageRetaining.
+   * @param limit (optional) The maximum number of Data packets. If inserting
+   * a Data packet would exceed the limit, first evict the least recently
+   * inserted or found Data packet. If omitted or 0, there is no limit.
+   * @param checkFreshness (optional) If true or omitted, then
+   * find(const Interest&) skips a Data packet whose FreshnessPeriod has expired
+   * when the Interest has MustBeFresh. If false, ignore the FreshnessPeriod, for
+   * a producer's own storage which is authoritative, such as the KEK and KDKs
+   * of AccessManagerV2 which are inserted only once.
+   */
+  InMemoryStorageRetaining(size_t limit = 0, bool checkFreshness = true)
+  : limit_(limit), checkFreshness_(checkFreshness), nInserted_(0),
+    nowOffset_(0)
+  {
+  }
+
   /**
    * Insert a Data packet. If a Data packet with the same name, including the
    * implicit digest, already exists, replace it.
    * @param data The packet to insert, which is copied.
+   * @param lifetime (optional) If not negative, remove the packet after
+   * this period. If omitted, keep the packet until it is removed by remove()
+   * or evicted because of the limit.
    */
   void
-  insert(const Data& data)
-  {
-    cache_[*data.getFullName()] = ptr_lib::make_shared<Data>(data);
-  }
+  insert
+    (const Data& data,
+     std::chrono::nanoseconds lifetime = std::chrono::nanoseconds(-1));
 
   /**
-   * Find the best match Data for a Name.
+   * Find the best match Data for a Name, which is the first Data packet in
+   * the NDN canonical order whose name has the given name as a prefix.
    * @param name The Name of the Data packet to find.
    * @return The best match if any, otherwise null. You should not modify the
    * returned object. If you need to modify it then you must make a copy.
@@ -75,17 +102,19 @@ public:
   find(const Name& name);
 
   /**
-   * Find the best match Data for an Interest.
+   * Find the best match Data for an Interest, according to
+   * Interest.matchesData, which checks CanBePrefix and the other selectors.
+   * If checkFreshness given to the constructor is true (the default) and the
+   * Interest has MustBeFresh, then skip a Data packet whose FreshnessPeriod has expired
+   * since it was inserted. (A Data packet without a FreshnessPeriod is always
+   * fresh.) If the Interest ChildSelector is 1, then
+   * return the last match in the NDN canonical order, otherwise the first.
    * @param interest The Interest with the Name of the Data packet to find.
    * @return The best match if any, otherwise null. You should not modify the
    * returned object. If you need to modify it then you must make a copy.
    */
   ptr_lib::shared_ptr<Data>
-  find(const Interest& interest)
-  {
-    // Debug: Check selectors, especially CanBePrefix.
-    return find(interest.getName());
-  }
+  find(const Interest& interest);
 
   /**
    * Remove matching entries by prefix.
@@ -101,6 +130,24 @@ public:
   size_t
   size() { return cache_.size(); }
 
+  /**
+   * Get the limit given to the constructor.
+   * @return The maximum number of packets, or 0 for no limit.
+   */
+  size_t
+  getLimit() const { return limit_; }
+
+  /**
+   * Set the offset when insert() and find() get the current time, which should
+   * only be used for testing.
+   * @param nowOffset The offset.
+   */
+  void
+  setNowOffset_(std::chrono::nanoseconds nowOffset)
+  {
+    nowOffset_ = nowOffset;
+  }
+
   /**
    * Get the the storage cache, which should only be used for testing.
    * @return The storage cache.
@@ -113,7 +160,104 @@ private:
   friend class ::TestEncryptorV2_EnumerateDataFromInMemoryStorage_Test;
   friend class ::TestAccessManagerV2_EnumerateDataFromInMemoryStorage_Test;
 
-  std::map<Name, ptr_lib::shared_ptr<Data> > cache_;
+  typedef std::map<Name, ptr_lib::shared_ptr<Data> > Cache;
+
+  /**
+   * An EntryInfo has the information for an entry in cache_ which is not
+   * in the Data packet.
+   */
+  class EntryInfo {
+  public:
+    // The time when the FreshnessPeriod expires, or the maximum time_point if
+    // the Data packet has no FreshnessPeriod.
+    std::chrono::system_clock::time_point freshnessExpiryTime_;
+    // The position in useOrder_, if limit_ is not 0.
+    std::list<Cache::iterator>::iterator usePosition_;
+    // The value of nInserted_ when inserted, to identify the entry.
+    uint64_t insertNumber_;
+  };
+
+  /**
+   * A RemovalEntry is in removalHeap_ for a Data packet inserted with a
+   * lifetime.
+   */
+  class RemovalEntry {
+  public:
+    RemovalEntry
+      (std::chrono::system_clock::time_point removalTime, const Name& fullName,
+       uint64_t insertNumber)
+    : removalTime_(removalTime), fullName_(fullName),
+      insertNumber_(insertNumber)
+    {
+    }
+
+    bool
+    operator<(const RemovalEntry& other) const
+    {
+      // Reverse the order so that a priority_queue has the earliest at the top.
+      return removalTime_ > other.removalTime_;
+    }
+
+    std::chrono::system_clock::time_point removalTime_;
+    Name fullName_;
+    // Check this with the EntryInfo in case the entry was replaced.
+    uint64_t insertNumber_;
+  };
+
+  /**
+   * Get the current time, adding nowOffset_.
+   * @return The current time.
+   */
+  std::chrono::system_clock::time_point
+  now() const
+  {
+    return std::chrono::system_clock::now() +
+      std::chrono::duration_cast<std::chrono::system_clock::duration>(nowOffset_);
+  }
+
+  /**
+   * Remove the entries in removalHeap_ whose removal time has passed.
+   * @param now The current time from system_clock::now().
+   */
+  void
+  removeExpired(std::chrono::system_clock::time_point now);
+
+  /**
+   * Remove the entry from cache_, entryInfo_ and useOrder_.
+   * @param entry The iterator of the entry in cache_.
+   */
+  void
+  erase(Cache::iterator entry);
+
+  /**
+   * If limit_ is not 0, move the entry to the back of useOrder_ as the most
+   * recently used.
+   * @param entry The iterator of the entry in cache_.
+   */
+  void
+  touch(Cache::iterator entry)
+  {
+    if (limit_ != 0) {
+      EntryInfo& info = entryInfo_[entry->second.get()];
+      useOrder_.splice(useOrder_.end(), useOrder_, info.usePosition_);
+    }
+  }
+
+  // The copy constructor and assignment would copy the iterators.
+  InMemoryStorageRetaining(const InMemoryStorageRetaining& other);
+  InMemoryStorageRetaining&
+  operator=(const InMemoryStorageRetaining& other);
+
+  Cache cache_;
+  // The key is the Data packet pointer in cache_.
+  std::unordered_map<const Data*, EntryInfo> entryInfo_;
+  size_t limit_;
+  bool checkFreshness_;
+  uint64_t nInserted_;
+  std::chrono::nanoseconds nowOffset_;
+  // The least recently used is at the front.
+  std::list<Cache::iterator> useOrder_;
+  std::priority_queue<RemovalEntry> removalHeap_;
 };
 
 }
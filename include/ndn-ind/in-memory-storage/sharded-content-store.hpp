@@ -0,0 +1,202 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2020 Operant Networks, Incorporated.
+ * @author: Jeff Thompson <jefft0@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+
+#ifndef NDN_SHARDED_CONTENT_STORE_HPP
+#define NDN_SHARDED_CONTENT_STORE_HPP
+
+#include <mutex>
+#include "in-memory-storage-retaining.hpp"
+
+namespace ndn_ind {
+
+/**
+ * A ShardedContentStore holds Data packets which many threads can insert and
+ * find at the same time. The packets are spread over several shards, where
+ * each shard is an InMemoryStorageRetaining with its own mutex, so that
+ * threads only wait for each other when they use the same shard.
+ *
+ * A Data packet is put in the shard chosen by the hash of the first
+ * nShardComponents components of its name (or the whole name if it is
+ * shorter). A lookup whose name has at least nShardComponents components, or
+ * which can only match a Data packet of the same name, only locks that shard.
+ * Otherwise, a prefix lookup searches each shard in turn and returns the best
+ * match among them. Therefore, if the producer's names share a prefix of a
+ * known length such as /app/stream/version, use it for nShardComponents so that
+ * prefix Interests also go to a single shard.
+ *
+ * The methods of ShardedContentStore are thread safe. A ShardedContentStore
+ * does not use a Face, but it can answer Interests through
+ * MemoryContentCache::setContentStore.
+ */
+class ndn_ind_dll ShardedContentStore {
+public:
+  /**
+   * Create a ShardedContentStore with nShards empty shards.
+   * @param nShards The number of shards. This must be at least 1.
+   * @param limit (optional) The maximum number of Data packets, which is
+   * divided evenly among the shards. Each shard evicts its own least recently
+   * used Data packet to stay within its part of the limit. If omitted or 0,
+   * there is no limit.
+   * @param nShardComponents (optional) The number of leading name components
+   * which choose the shard. If omitted, use the whole name.
+   */
+  ShardedContentStore
+    (size_t nShards, size_t limit = 0,
+     size_t nShardComponents = (size_t)-1);
+
+  /**
+   * Insert a Data packet into its shard. If a Data packet with the same name,
+   * including the implicit digest, already exists, replace it. See
+   * InMemoryStorageRetaining::insert.
+   * @param data The packet to insert, which is copied. This first decodes any
+   * lazily decoded fields of data and caches its wire encoding, so that the
+   * copy can be read by many threads.
+   * @param lifetime (optional) If not negative, remove the packet after
+   * this period. If omitted, keep the packet until it is removed by remove()
+   * or evicted because of the limit.
+   */
+  void
+  insert
+    (const Data& data,
+     std::chrono::nanoseconds lifetime = std::chrono::nanoseconds(-1));
+
+  /**
+   * Find the best match Data for a Name, which is the first Data packet in
+   * the NDN canonical order whose name has the given name as a prefix.
+   * @param name The Name of the Data packet to find.
+   * @return The best match if any, otherwise null. The returned Data packet may
+   * be used by other threads at the same time, so you must not modify it.
+   */
+  ptr_lib::shared_ptr<const Data>
+  find(const Name& name);
+
+  /**
+   * Find the best match Data for an Interest. See
+   * InMemoryStorageRetaining::find(const Interest&) for how the selectors are
+   * used.
+   * @param interest The Interest with the Name of the Data packet to find.
+   * @return The best match if any, otherwise null. The returned Data packet may
+   * be used by other threads at the same time, so you must not modify it.
+   */
+  ptr_lib::shared_ptr<const Data>
+  find(const Interest& interest);
+
+  /**
+   * Remove matching entries by prefix from each shard which can have them.
+   * @param prefix The prefix Name of the entries to remove.
+   */
+  void
+  remove(const Name& prefix);
+
+  /**
+   * Get the number of packets stored in all the shards. Since other threads
+   * may be inserting at the same time, this is only a snapshot.
+   * @return The number of packets.
+   */
+  size_t
+  size();
+
+  /**
+   * Get the number of shards given to the constructor.
+   * @return The number of shards.
+   */
+  size_t
+  getShardCount() const { return shards_.size(); }
+
+  /**
+   * Get the index of the shard which owns the Data packets with the name.
+   * @param name The name of the Data packet, without the implicit digest.
+   * @return The shard index, from 0 to getShardCount() - 1.
+   */
+  size_t
+  getShardIndex(const Name& name) const
+  {
+    if (name.size() <= nShardComponents_)
+      return name.hash() % shards_.size();
+    else
+      return name.getPrefix(nShardComponents_).hash() % shards_.size();
+  }
+
+private:
+  /**
+   * A Shard holds the storage of one shard and the mutex which guards it.
+   */
+  class Shard {
+  public:
+    Shard(size_t limit)
+    : storage_(limit)
+    {
+    }
+
+    std::mutex mutex_;
+    InMemoryStorageRetaining storage_;
+  };
+
+  /**
+   * Find the best match Data in one shard.
+   * @param shardIndex The shard index.
+   * @param nameOrInterest The Name or Interest to pass to InMemoryStorageRetaining::find.
+   * @return The best match if any, otherwise null.
+   */
+  template<class T> ptr_lib::shared_ptr<const Data>
+  findInShard(size_t shardIndex, const T& nameOrInterest)
+  {
+    Shard& shard = *shards_[shardIndex];
+    std::lock_guard<std::mutex> lock(shard.mutex_);
+    return shard.storage_.find(nameOrInterest);
+  }
+
+  /**
+   * Find the best match in each shard and return the first (or the last if
+   * isRightmost) in the NDN canonical order.
+   * @param nameOrInterest The Name or Interest to pass to
+   * InMemoryStorageRetaining::find.
+   * @param isRightmost True to return the last match, false for the first.
+   * @return The best match if any, otherwise null.
+   */
+  template<class T> ptr_lib::shared_ptr<const Data>
+  findInAllShards(const T& nameOrInterest, bool isRightmost)
+  {
+    ptr_lib::shared_ptr<const Data> selected;
+    for (size_t i = 0; i < shards_.size(); ++i) {
+      ptr_lib::shared_ptr<const Data> data = findInShard(i, nameOrInterest);
+      if (data &&
+          (!selected ||
+           (isRightmost ? selected->getName() < data->getName()
+                        : data->getName() < selected->getName())))
+        selected = data;
+    }
+
+    return selected;
+  }
+
+  // Disable the copy constructor and assignment operator.
+  ShardedContentStore(const ShardedContentStore& other);
+  ShardedContentStore& operator=(const ShardedContentStore& other);
+
+  std::vector<ptr_lib::shared_ptr<Shard> > shards_;
+  size_t nShardComponents_;
+};
+
+}
+
+#endif
@@ -8,7 +8,8 @@
  * Original file: include/ndn-cpp/interest.hpp
  * Original repository: https://github.com/named-data/ndn-cpp
  *
- * Summary of Changes: Use NDN_IND macros. Use std::chrono. Support ndn_ind_dll.
+ * Summary of Changes: Use NDN_IND macros. Use std::chrono. Support ndn_ind_dll. Friend InterestEncodingTemplate.
+ * Share a backing Blob in set. Add wireDecodeShared.
  *
  * which was originally released under the LGPL license with the following rights:
  *
@@ -48,6 +49,7 @@ namespace ndn_ind {
 
 class LpPacket;
 class Data;
+class InterestEncodingTemplate;
 
 /**
  * An Interest holds a Name and other fields for an interest.
@@ -160,6 +162,22 @@ public:
     (const Blob& input,
      WireFormat& wireFormat = *WireFormat::getDefaultWireFormat());
 
+  /**
+   * Decode the input like wireDecode(Blob), but set the name components, the
+   * application parameters and the nonce to slices which share the buffer of
+   * input instead of copying them. (See Blob for the slice rules.) A slice
+   * keeps the whole buffer of input in memory, so only use this if the decoded
+   * Interest does not outlive input for long, or if input is exactly the size
+   * of the encoding.
+   * @param input The input byte array to be decoded as an immutable Blob.
+   * @param wireFormat (optional) A WireFormat object used to decode the input.
+   * If omitted, use WireFormat::getDefaultWireFormat().
+   */
+  void
+  wireDecodeShared
+    (const Blob& input,
+     WireFormat& wireFormat = *WireFormat::getDefaultWireFormat());
+
   /**
    * Decode the input using a particular wire format and update this Interest.
    * If wireFormat is the default wire format, also set the defaultWireEncoding
@@ -221,9 +239,15 @@ public:
    * @param interestLite An InterestLite object.
    * @param wireFormat The wire format of the encoding, to be used later if
    * necessary to decode the link wire encoding.
+   * @param backing (optional) If a value in interestLite points into the bytes of
+   * this Blob (such as the encoding which was decoded), then share its buffer
+   * instead of copying. If omitted, copy all values.
+   * This shares the buffer for the name components, the application
+   * parameters and the nonce.
    */
   void
-  set(const InterestLite& interestLite, WireFormat& wireFormat);
+  set(const InterestLite& interestLite, WireFormat& wireFormat,
+      const Blob& backing = Blob());
 
   Name&
   getName() { return name_.get(); }
@@ -769,6 +793,9 @@ public:
   getDidSetCanBePrefix_() const { return didSetCanBePrefix_; }
 
 private:
+  // InterestEncodingTemplate calls setDefaultWireEncoding.
+  friend class InterestEncodingTemplate;
+
   void
   construct()
   {
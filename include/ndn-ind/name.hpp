@@ -9,6 +9,7 @@
  * Original repository: https://github.com/named-data/ndn-cpp
  *
  * Summary of Changes: Use NDN_IND macros. Use std::chrono. Add findParametersSha256Digest.
+ * Share a backing Blob in set. Hold short component values inline.
  *   Support ndn_ind_dll.
  *
  * which was originally released under the LGPL license with the following rights:
@@ -41,6 +42,7 @@
 #include <string>
 #include <string.h>
 #include <sstream>
+#include <atomic>
 #include "util/blob.hpp"
 #include "encoding/wire-format.hpp"
 #include "lite/name-lite.hpp"
@@ -63,7 +65,9 @@ public:
     Component()
     : type_(ndn_NameComponentType_GENERIC),
       otherTypeCode_(-1),
-      value_((const uint8_t*)0, 0)
+      value_((const uint8_t*)0, 0),
+      inlineValueLength_(NOT_INLINE),
+      inlineBlobState_(INLINE_BLOB_NONE)
     {
     }
 
@@ -85,8 +89,11 @@ public:
       (const std::vector<uint8_t>& value,
        ndn_NameComponentType type = ndn_NameComponentType_GENERIC,
        int otherTypeCode = -1)
-    : value_(value)
+    : inlineValueLength_(NOT_INLINE),
+      inlineBlobState_(INLINE_BLOB_NONE)
     {
+      if (!trySetInlineValue(value.data(), value.size()))
+        value_ = Blob(value);
       setType(type, otherTypeCode);
     }
 
@@ -109,8 +116,11 @@ public:
       (const uint8_t *value, size_t valueLength,
        ndn_NameComponentType type = ndn_NameComponentType_GENERIC,
        int otherTypeCode = -1)
-    : value_(value, valueLength)
+    : inlineValueLength_(NOT_INLINE),
+      inlineBlobState_(INLINE_BLOB_NONE)
     {
+      if (!trySetInlineValue(value, valueLength))
+        value_ = Blob(value, valueLength);
       setType(type, otherTypeCode);
     }
 
@@ -133,8 +143,12 @@ public:
       (const char* value,
        ndn_NameComponentType type = ndn_NameComponentType_GENERIC,
        int otherTypeCode = -1)
-    : value_((const uint8_t*)value, ::strlen(value))
+    : inlineValueLength_(NOT_INLINE),
+      inlineBlobState_(INLINE_BLOB_NONE)
     {
+      size_t valueLength = ::strlen(value);
+      if (!trySetInlineValue((const uint8_t*)value, valueLength))
+        value_ = Blob((const uint8_t*)value, valueLength);
       setType(type, otherTypeCode);
     }
 
@@ -157,8 +171,11 @@ public:
       (const std::string& value,
        ndn_NameComponentType type = ndn_NameComponentType_GENERIC,
        int otherTypeCode = -1)
-    : value_((const uint8_t*)&value[0], value.size())
+    : inlineValueLength_(NOT_INLINE),
+      inlineBlobState_(INLINE_BLOB_NONE)
     {
+      if (!trySetInlineValue((const uint8_t*)&value[0], value.size()))
+        value_ = Blob((const uint8_t*)&value[0], value.size());
       setType(type, otherTypeCode);
     }
 
@@ -181,7 +198,9 @@ public:
       (const Blob &value,
        ndn_NameComponentType type = ndn_NameComponentType_GENERIC,
        int otherTypeCode = -1)
-    : value_(value)
+    : value_(value),
+      inlineValueLength_(NOT_INLINE),
+      inlineBlobState_(INLINE_BLOB_NONE)
     {
       setType(type, otherTypeCode);
     }
@@ -194,8 +213,95 @@ public:
     Component(const NameLite::Component &componentLite)
     : type_(componentLite.getType()),
       otherTypeCode_(componentLite.getOtherTypeCode()),
-      value_(componentLite.getValue())
+      inlineValueLength_(NOT_INLINE),
+      inlineBlobState_(INLINE_BLOB_NONE)
     {
+      if (!trySetInlineValue
+          (componentLite.getValue().buf(), componentLite.getValue().size()))
+        value_ = Blob(componentLite.getValue());
+    }
+
+    /**
+     * Create a new Name::Component with the type and value of componentLite.
+     * A short value is copied into the component. Otherwise if the value points
+     * into the bytes of backing (such as the encoding which was decoded), then
+     * share its buffer instead of copying.
+     * @param componentLite The NameLite::Component.
+     * @param backing The Blob which may hold the value.
+     */
+    Component
+      (const NameLite::Component &componentLite, const Blob& backing)
+    : type_(componentLite.getType()),
+      otherTypeCode_(componentLite.getOtherTypeCode()),
+      inlineValueLength_(NOT_INLINE),
+      inlineBlobState_(INLINE_BLOB_NONE)
+    {
+      if (!trySetInlineValue
+          (componentLite.getValue().buf(), componentLite.getValue().size()))
+        value_ = Blob(componentLite.getValue(), backing);
+    }
+
+    /**
+     * Create a Name::Component with a copy of the type and value of other.
+     * An inline value is copied. Otherwise, this shares the value Blob.
+     * @param other The Name::Component to copy.
+     */
+    Component(const Component& other)
+    : type_(other.type_),
+      otherTypeCode_(other.otherTypeCode_),
+      inlineValueLength_(other.inlineValueLength_),
+      inlineBlobState_(INLINE_BLOB_NONE)
+    {
+      copyValue(other);
+    }
+
+    /**
+     * Create a Name::Component with the type and value of other, moving the
+     * value Blob. Since other is an rvalue, no other thread is using it.
+     * @param other The Name::Component to move.
+     */
+    Component(Component&& other) noexcept
+    : type_(other.type_),
+      otherTypeCode_(other.otherTypeCode_),
+      value_(std::move(other.value_)),
+      inlineValueLength_(other.inlineValueLength_),
+      inlineBlobState_(other.inlineBlobState_.load(std::memory_order_relaxed))
+    {
+      if (inlineValueLength_ != NOT_INLINE)
+        ::memcpy(inlineValue_, other.inlineValue_, inlineValueLength_);
+    }
+
+    Component&
+    operator=(const Component& other)
+    {
+      if (&other != this) {
+        type_ = other.type_;
+        otherTypeCode_ = other.otherTypeCode_;
+        inlineValueLength_ = other.inlineValueLength_;
+        value_ = Blob();
+        inlineBlobState_.store(INLINE_BLOB_NONE, std::memory_order_relaxed);
+        copyValue(other);
+      }
+
+      return *this;
+    }
+
+    Component&
+    operator=(Component&& other) noexcept
+    {
+      if (&other != this) {
+        type_ = other.type_;
+        otherTypeCode_ = other.otherTypeCode_;
+        inlineValueLength_ = other.inlineValueLength_;
+        value_ = std::move(other.value_);
+        inlineBlobState_.store
+          (other.inlineBlobState_.load(std::memory_order_relaxed),
+           std::memory_order_relaxed);
+        if (inlineValueLength_ != NOT_INLINE)
+          ::memcpy(inlineValue_, other.inlineValue_, inlineValueLength_);
+      }
+
+      return *this;
     }
 
     /**
@@ -208,11 +314,19 @@ public:
     get(NameLite::Component& componentLite) const;
 
     /**
-     * Get the component value.
+     * Get the component value. If the value is short and held in the
+     * component, then the first call creates the Blob which is returned. This
+     * is safe to call from multiple threads.
      * @return The component value.
      */
     const Blob&
-    getValue() const { return value_; }
+    getValue() const
+    {
+      if (inlineValueLength_ != NOT_INLINE &&
+          inlineBlobState_.load(std::memory_order_acquire) != INLINE_BLOB_CREATED)
+        createInlineBlob();
+      return value_;
+    }
 
     /**
      * Get the name component type.
@@ -259,7 +373,7 @@ public:
     bool
     isSegment() const
     {
-      return value_.size() >= 1 && value_.buf()[0] == 0x00 &&
+      return valueSize() >= 1 && valueBuf()[0] == 0x00 &&
              type_ == ndn_NameComponentType_GENERIC;
     }
 
@@ -272,7 +386,7 @@ public:
     bool
     isSegmentOffset() const
     {
-      return value_.size() >= 1 && value_.buf()[0] == 0xFB &&
+      return valueSize() >= 1 && valueBuf()[0] == 0xFB &&
              type_ == ndn_NameComponentType_GENERIC;
     }
 
@@ -285,7 +399,7 @@ public:
     bool
     isVersion() const
     {
-      return value_.size() >= 1 && value_.buf()[0] == 0xFD &&
+      return valueSize() >= 1 && valueBuf()[0] == 0xFD &&
              type_ == ndn_NameComponentType_GENERIC;
     }
 
@@ -298,7 +412,7 @@ public:
     bool
     isTimestamp() const
     {
-      return value_.size() >= 1 && value_.buf()[0] == 0xFC &&
+      return valueSize() >= 1 && valueBuf()[0] == 0xFC &&
              type_ == ndn_NameComponentType_GENERIC;
     }
 
@@ -311,7 +425,7 @@ public:
     bool
     isSequenceNumber() const
     {
-      return value_.size() >= 1 && value_.buf()[0] == 0xFE &&
+      return valueSize() >= 1 && valueBuf()[0] == 0xFE &&
              type_ == ndn_NameComponentType_GENERIC;
     }
 
@@ -722,11 +836,11 @@ public:
     equals(const Component& other) const
     {
       if (type_ == ndn_NameComponentType_OTHER_CODE)
-        return  value_.equals(other.value_) &&
+        return  valueEquals(other) &&
           other.type_ == ndn_NameComponentType_OTHER_CODE &&
           otherTypeCode_ == other.otherTypeCode_;
       else
-        return value_.equals(other.value_) && type_ == other.type_;
+        return valueEquals(other) && type_ == other.type_;
     }
 
     /**
@@ -738,7 +852,7 @@ public:
     {
       return 37 *
         (type_ == ndn_NameComponentType_OTHER_CODE ? otherTypeCode_ : type_) +
-        value_.hash();
+        (valueBuf() ? BlobLite::hash(valueBuf(), valueSize()) : 0);
     }
 
     /**
@@ -805,6 +919,8 @@ public:
     operator > (const Component& other) const { return compare(other) > 0; }
 
   private:
+    friend class Name;
+
     /**
      * A private helper for the constructor to check and set the type and
      * otherTypeCode.
@@ -814,15 +930,115 @@ public:
     void
     setType(ndn_NameComponentType type, int otherTypeCode);
 
+    /**
+     * If the value is not empty and fits in inlineValue_, copy it there.
+     * @param value A pointer to the value byte array.
+     * @param valueLength The length of value.
+     * @return True if the value was copied to inlineValue_, false if the
+     * caller must set value_.
+     */
+    bool
+    trySetInlineValue(const uint8_t* value, size_t valueLength)
+    {
+      if (!value || valueLength == 0 || valueLength > MAX_INLINE_VALUE_LENGTH)
+        return false;
+
+      ::memcpy(inlineValue_, value, valueLength);
+      inlineValueLength_ = (uint8_t)valueLength;
+      return true;
+    }
+
+    /**
+     * Copy the value of other, which has the same inlineValueLength_. This
+     * does not read other.value_ for an inline value unless other.getValue()
+     * has finished creating it, so that other can be used by another thread.
+     * @param other The Name::Component to copy.
+     */
+    void
+    copyValue(const Component& other)
+    {
+      if (inlineValueLength_ == NOT_INLINE) {
+        value_ = other.value_;
+        return;
+      }
+
+      ::memcpy(inlineValue_, other.inlineValue_, inlineValueLength_);
+      if (other.inlineBlobState_.load(std::memory_order_acquire) ==
+          INLINE_BLOB_CREATED) {
+        value_ = other.value_;
+        inlineBlobState_.store(INLINE_BLOB_CREATED, std::memory_order_relaxed);
+      }
+    }
+
+    /**
+     * Create value_ from the inline value for getValue(). Since getValue() is
+     * const, it may be called from multiple threads. The thread which changes
+     * inlineBlobState_ from INLINE_BLOB_NONE to INLINE_BLOB_CREATING creates
+     * value_ and the others wait until it is INLINE_BLOB_CREATED.
+     */
+    void
+    createInlineBlob() const;
+
+    /**
+     * Get a pointer to the value bytes, without creating a Blob.
+     * @return A pointer to the value, or 0 if the value is null.
+     */
+    const uint8_t*
+    valueBuf() const
+    {
+      return inlineValueLength_ != NOT_INLINE ? inlineValue_ : value_.buf();
+    }
+
+    /**
+     * Get the length of the value, without creating a Blob.
+     * @return The length of the value.
+     */
+    size_t
+    valueSize() const
+    {
+      return inlineValueLength_ != NOT_INLINE ?
+        inlineValueLength_ : value_.size();
+    }
+
+    /**
+     * Check if the value bytes of this and other are equal, ignoring the type.
+     * @param other The other Component to compare with.
+     * @return True if the values are equal.
+     */
+    bool
+    valueEquals(const Component& other) const
+    {
+      size_t size = valueSize();
+      return size == other.valueSize() &&
+        (size == 0 || ::memcmp(valueBuf(), other.valueBuf(), size) == 0);
+    }
+
     /**
      * FINAL_SEGMENT_PREFIX has the bytes of the component prefix used by toFinalSegment, etc.
      */
     static const uint8_t FINAL_SEGMENT_PREFIX[];
     static size_t FINAL_SEGMENT_PREFIX_LENGTH;
 
+    /**
+     * A value up to this length, such as a segment or version number, is held
+     * in inlineValue_ instead of allocating a Blob.
+     */
+    static const size_t MAX_INLINE_VALUE_LENGTH = 23;
+    static const uint8_t NOT_INLINE = 0xff;
+    // The values of inlineBlobState_.
+    static const uint8_t INLINE_BLOB_NONE = 0;
+    static const uint8_t INLINE_BLOB_CREATING = 1;
+    static const uint8_t INLINE_BLOB_CREATED = 2;
+
     ndn_NameComponentType type_;
     int otherTypeCode_;
-    Blob value_;
+    // If inlineValueLength_ is not NOT_INLINE, the value is in inlineValue_ and
+    // value_ is null until getValue() creates it and sets inlineBlobState_ to
+    // INLINE_BLOB_CREATED.
+    mutable Blob value_;
+    uint8_t inlineValueLength_;
+    mutable std::atomic<uint8_t> inlineBlobState_;
+    uint8_t inlineValue_[MAX_INLINE_VALUE_LENGTH];
   };
 
   /**
@@ -875,9 +1091,12 @@ public:
   /**
    * Clear this name, and set the components by copying from nameLite.
    * @param nameLite A NameLite object.
+   * @param backing (optional) If a value in nameLite points into the bytes of
+   * this Blob (such as the encoding which was decoded), then share its buffer
+   * instead of copying. If omitted, copy all values.
    */
   void
-  set(const NameLite& nameLite);
+  set(const NameLite& nameLite, const Blob& backing = Blob());
 
   /**
    * Parse the uri according to the NDN URI Scheme and set the name with the components.
@@ -1478,6 +1697,17 @@ public:
   static Blob
   fromEscapedString(const std::string& escapedString) { return fromEscapedString(escapedString.c_str()); }
 
+  /**
+   * Write the value to result, escaping characters according to the NDN URI Scheme.
+   * This also adds "..." to a value with zero or more ".".
+   * @param value The pointer to the buffer with the value to escape.
+   * @param valueLength The length of value.
+   * @param result the string stream to write to.
+   */
+  static void
+  toEscapedString
+    (const uint8_t* value, size_t valueLength, std::ostringstream& result);
+
   /**
    * Write the value to result, escaping characters according to the NDN URI Scheme.
    * This also adds "..." to a value with zero or more ".".
@@ -1485,7 +1715,10 @@ public:
    * @param result the string stream to write to.
    */
   static void
-  toEscapedString(const std::vector<uint8_t>& value, std::ostringstream& result);
+  toEscapedString(const std::vector<uint8_t>& value, std::ostringstream& result)
+  {
+    toEscapedString(value.data(), value.size(), result);
+  }
 
   /**
    * Convert the value by escaping characters according to the NDN URI Scheme.
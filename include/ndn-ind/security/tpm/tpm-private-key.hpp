@@ -218,7 +218,7 @@ private:
    */
   static Blob
   encodePkcs8PrivateKey
-    (const std::vector<uint8_t>& privateKeyDer, const OID& oid,
+    (const Blob& privateKeyDer, const OID& oid,
      const ptr_lib::shared_ptr<DerNode>& parameters);
 
   /**
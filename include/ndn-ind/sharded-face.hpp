@@ -0,0 +1,240 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2020 Operant Networks, Incorporated.
+ * @author: Jeff Thompson <jefft0@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+#ifndef NDN_SHARDED_FACE_HPP
+#define NDN_SHARDED_FACE_HPP
+
+// Only compile if ndn-ind-config.h defines NDN_IND_HAVE_BOOST_ASIO.
+#include "ndn-ind-config.h"
+#ifdef NDN_IND_HAVE_BOOST_ASIO
+
+#include <map>
+#include <mutex>
+#include <thread>
+#include "threadsafe-face.hpp"
+
+namespace ndn_ind {
+
+/**
+ * A ShardedFace spreads the work of a face over several shards so that it can
+ * use several cores. Each shard has its own asio io_service run by its own
+ * thread, and its own ThreadsafeFace with a separate connection to the
+ * forwarder, so each shard has its own pending interest table, interest filter
+ * table and timers. A ThreadsafeFace serializes all its work onto one thread,
+ * but the shards work in parallel.
+ *
+ * expressInterest and registerPrefix choose a shard by the hash of the name,
+ * and the forwarder returns the Data or sends the Interest on the connection of
+ * that shard, so the callbacks are called on the thread of that shard.
+ * setInterestFilter uses the shard which registered the prefix. To
+ * answer an Interest, call putData on the Face given to the OnInterestCallback,
+ * which is the ThreadsafeFace of the shard which received it.
+ * The methods of ShardedFace are thread safe.
+ */
+class ndn_ind_dll ShardedFace {
+public:
+  typedef func_lib::function<ptr_lib::shared_ptr<Transport>
+    (boost::asio::io_service& ioService)> MakeTransport;
+
+  /**
+   * Create a ShardedFace with nShards shards. For each shard, create an
+   * io_service, a ThreadsafeFace which uses a transport from makeTransport and
+   * the connectionInfo, and a thread to run the io_service.
+   * @param nShards The number of shards. This must be at least 1.
+   * @param makeTransport This calls makeTransport(ioService) to make an async
+   * transport for each shard, which uses the shard's ioService, for example
+   * ptr_lib::make_shared<AsyncUnixTransport>(ioService).
+   * @param connectionInfo The connection info for each transport.
+   */
+  ShardedFace
+    (size_t nShards, const MakeTransport& makeTransport,
+     const ptr_lib::shared_ptr<const Transport::ConnectionInfo>& connectionInfo);
+
+  /**
+   * Create a ShardedFace with nShards shards which each connect to the
+   * forwarder with the default connection of ThreadsafeFace. If the
+   * forwarder's Unix socket file exists, then use AsyncUnixTransport. Otherwise,
+   * connect to "localhost" on port 6363 using AsyncTcpTransport.
+   * @param nShards The number of shards. This must be at least 1.
+   */
+  ShardedFace(size_t nShards);
+
+  /**
+   * Shut down each shard, stop its io_service and join its thread.
+   */
+  ~ShardedFace();
+
+  /**
+   * Get the number of shards given to the constructor.
+   * @return The number of shards.
+   */
+  size_t
+  getShardCount() const { return shards_.size(); }
+
+  /**
+   * Get the index of the shard which owns the name, which is used by
+   * expressInterest and registerPrefix.
+   * @param name The name of the Interest or the registered prefix.
+   * @return The shard index, from 0 to getShardCount() - 1.
+   */
+  size_t
+  getShardIndex(const Name& name) const
+  {
+    return name.hash() % shards_.size();
+  }
+
+  /**
+   * Get the ThreadsafeFace of the shard, for example to call other Face
+   * methods. You should only call the methods of a ThreadsafeFace which are
+   * thread safe.
+   * @param shardIndex The shard index, from 0 to getShardCount() - 1.
+   * @return The ThreadsafeFace.
+   */
+  ThreadsafeFace&
+  getShard(size_t shardIndex) { return *shards_[shardIndex]->face_; }
+
+  /**
+   * Call setCommandSigningInfo on the face of each shard. This is not thread
+   * safe, so you should call this before the first call to registerPrefix.
+   * @param keyChain The KeyChain object for signing interests, which must
+   * remain valid for the life of this ShardedFace.
+   * @param certificateName The certificate name for signing interests.
+   */
+  void
+  setCommandSigningInfo(KeyChain& keyChain, const Name& certificateName);
+
+  /**
+   * Call expressInterest on the face of the shard for the interest name. See
+   * Face::expressInterest for calling details. The callbacks are called on
+   * the thread of that shard.
+   * @return The pending interest ID which can be used with
+   * removePendingInterest.
+   */
+  uint64_t
+  expressInterest
+    (const Interest& interest, const OnData& onData,
+     const OnTimeout& onTimeout = OnTimeout(),
+     const OnNetworkNack& onNetworkNack = OnNetworkNack(),
+     WireFormat& wireFormat = *WireFormat::getDefaultWireFormat());
+
+  /**
+   * Call removePendingInterest on the face of the shard which expressed the
+   * interest.
+   * @param pendingInterestId The ID returned from expressInterest.
+   */
+  void
+  removePendingInterest(uint64_t pendingInterestId);
+
+  /**
+   * Call registerPrefix on the face of the shard for the prefix, so that the
+   * forwarder sends the Interests for the prefix on the connection of that
+   * shard. See Face::registerPrefix for calling details.
+   * @return The registered prefix ID which can be used with
+   * removeRegisteredPrefix.
+   */
+  uint64_t
+  registerPrefix
+    (const Name& prefix, const OnInterestCallback& onInterest,
+     const OnRegisterFailed& onRegisterFailed,
+     const OnRegisterSuccess& onRegisterSuccess = OnRegisterSuccess(),
+     const RegistrationOptions& registrationOptions = RegistrationOptions(),
+     WireFormat& wireFormat = *WireFormat::getDefaultWireFormat());
+
+  /**
+   * Call removeRegisteredPrefix on the face of the shard which registered the
+   * prefix.
+   * @param registeredPrefixId The ID returned from registerPrefix.
+   */
+  void
+  removeRegisteredPrefix(uint64_t registeredPrefixId);
+
+  /**
+   * Call setInterestFilter on the face of the shard which registered the
+   * longest prefix of the filter prefix with registerPrefix, since the
+   * forwarder sends the matching Interests on the connection of that shard. If
+   * no registered prefix matches, use the shard for the filter prefix, which
+   * is the shard of a later registerPrefix for the same prefix. See
+   * Face::setInterestFilter for calling details.
+   * @return The interest filter ID which can be used with unsetInterestFilter.
+   */
+  uint64_t
+  setInterestFilter
+    (const InterestFilter& filter, const OnInterestCallback& onInterest);
+
+  /**
+   * Call unsetInterestFilter on the face of the shard which set the filter.
+   * @param interestFilterId The ID returned from setInterestFilter.
+   */
+  void
+  unsetInterestFilter(uint64_t interestFilterId);
+
+private:
+  /**
+   * A Shard holds the io_service, ThreadsafeFace and thread of one shard.
+   */
+  class Shard {
+  public:
+    Shard();
+
+    boost::asio::io_service ioService_;
+    // This keeps ioService_.run() from returning when there is no work.
+    ptr_lib::shared_ptr<boost::asio::io_service::work> work_;
+    ptr_lib::shared_ptr<ThreadsafeFace> face_;
+    std::thread thread_;
+  };
+
+  /**
+   * Start the thread of each shard.
+   */
+  void
+  start();
+
+  /**
+   * Combine the ID from the face of a shard with the shard index so that the ID
+   * is unique among all shards.
+   */
+  uint64_t
+  makeId(uint64_t faceId, size_t shardIndex) const
+  {
+    return faceId * shards_.size() + shardIndex;
+  }
+
+  size_t
+  getShardIndexOfId(uint64_t id) const { return id % shards_.size(); }
+
+  uint64_t
+  getFaceIdOfId(uint64_t id) const { return id / shards_.size(); }
+
+  // Disable the copy constructor and assignment operator.
+  ShardedFace(const ShardedFace& other);
+  ShardedFace& operator=(const ShardedFace& other);
+
+  std::vector<ptr_lib::shared_ptr<Shard> > shards_;
+  // The key is the registered prefix ID, which has the shard index.
+  std::map<uint64_t, Name> registeredPrefixes_;
+  std::mutex registeredPrefixesMutex_;
+};
+
+}
+
+#endif // NDN_IND_HAVE_BOOST_ASIO
+
+#endif
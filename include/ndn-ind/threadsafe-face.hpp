@@ -153,6 +153,14 @@ public:
   virtual void
   removePendingInterest(uint64_t pendingInterestId);
 
+  /**
+   * Override to use the ioService given to the constructor to dispatch
+   * removePendingInterests to be called in a thread-safe manner. See
+   * Face.removePendingInterests for calling details.
+   */
+  virtual void
+  removePendingInterests(const std::vector<uint64_t>& pendingInterestIds);
+
   /**
    * Override to use the ioService given to the constructor to dispatch
    * registerPrefix to be called in a thread-safe manner. See
@@ -264,6 +272,20 @@ public:
   virtual void
   callLater(std::chrono::nanoseconds delay, const Callback& callback);
 
+  /**
+   * Override to call callback() after the given delay, using a
+   * basic_deadline_timer with the ioService given to the constructor, and
+   * return a function which cancels the timer. Even though this is public, it
+   * is not part of the public API of Face.
+   * @param delay The delay.
+   * @param callback This calls callback() after the delay.
+   * @return A function which cancels the call. This must be called on the
+   * ioService thread.
+   */
+  virtual Callback
+  callLaterCancellable
+    (std::chrono::nanoseconds delay, const Callback& callback);
+
 private:
   static ptr_lib::shared_ptr<Transport>
   getDefaultTransport(boost::asio::io_service& ioService);
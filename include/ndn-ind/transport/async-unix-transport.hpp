@@ -8,7 +8,7 @@
  * Original file: include/ndn-cpp/transport/async-unix-transport.hpp
  * Original repository: https://github.com/named-data/ndn-cpp
  *
- * Summary of Changes: Use NDN_IND macros. Add readRawPackets. Support ndn_ind_dll.
+ * Summary of Changes: Use NDN_IND macros. Add readRawPackets. Support ndn_ind_dll. Add cork.
  *
  * which was originally released under the LGPL license with the following rights:
  *
@@ -139,6 +139,33 @@ public:
   virtual void
   send(const uint8_t *data, size_t dataLength);
 
+  /**
+   * Override to queue the packets given to send() until uncork() is called or
+   * the queue reaches 64 KB. Calls to cork() and uncork() can be nested. This
+   * transport also corks while it processes the elements from each socket read.
+   * To be thread-safe, this must be called from a dispatch to the ioService
+   * which was given to the constructor.
+   */
+  virtual void
+  cork();
+
+  /**
+   * Override to undo one call to cork(). If this is the outermost call, then
+   * write the queued packets with one gathering write and resume sending each
+   * packet immediately. To be thread-safe, this must be called from a dispatch
+   * to the ioService which was given to the constructor.
+   */
+  virtual void
+  uncork();
+
+  /**
+   * Override to write the queued packets with one gathering write. To be
+   * thread-safe, this must be called from a dispatch to the ioService which was
+   * given to the constructor.
+   */
+  virtual void
+  flush();
+
   /**
    * Do nothing since the asio io_service reads the socket.
    */
@@ -0,0 +1,164 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2020 Operant Networks, Incorporated.
+ * @author: Jeff Thompson <jefft0@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+#ifndef NDN_IO_URING_TRANSPORT_HPP
+#define NDN_IO_URING_TRANSPORT_HPP
+
+// Only compile if ndn-ind-config.h defines NDN_IND_HAVE_LINUX_IO_URING_H.
+#include <ndn-ind/ndn-ind-config.h>
+#if NDN_IND_HAVE_LINUX_IO_URING_H
+
+#include "../common.hpp"
+#include "transport.hpp"
+
+namespace ndn_ind {
+
+/**
+ * IoUringTransport extends the Transport interface to implement communication
+ * over a TCP, UDP or Unix socket using Linux io_uring. A multishot receive
+ * stays submitted while connected and fills buffers which are provided to
+ * the kernel, so processEvents() reads the received packets from the
+ * completion queue without a system call, and returns immediately without a
+ * system call if there is nothing to receive. The packets given to send()
+ * while corked are submitted with one system call. This requires Linux 6.0 or
+ * later.
+ */
+class ndn_ind_dll IoUringTransport : public Transport {
+public:
+  /**
+   * Create an IoUringTransport.
+   * @param readRawPackets (optional) If true, then call
+   * elementListener->onReceivedElement for each received packet as-is. If
+   * false or omitted, then use the ndn_TlvStructureDecoder to ensure that
+   * elementListener->onReceivedElement is called once for a whole TLV packet.
+   */
+  IoUringTransport(bool readRawPackets = false);
+
+  /**
+   * Determine whether this transport connecting according to connectionInfo is
+   * to a node on the current machine. A Unix socket is always local.
+   * @param connectionInfo A TcpTransport::ConnectionInfo,
+   * UdpTransport::ConnectionInfo or UnixTransport::ConnectionInfo.
+   * @return True if the host is local, false if not.
+   */
+  virtual bool
+  isLocal(const Transport::ConnectionInfo& connectionInfo);
+
+  /**
+   * Override to return false since connect does not need to use the onConnected
+   * callback.
+   * @return False.
+   */
+  virtual bool
+  isAsync();
+
+  /**
+   * Connect according to the info in ConnectionInfo, and processEvents() will
+   * use elementListener.
+   * @param connectionInfo A TcpTransport::ConnectionInfo,
+   * UdpTransport::ConnectionInfo or UnixTransport::ConnectionInfo, which
+   * selects the type of socket.
+   * @param elementListener Not a shared_ptr because we assume that it will
+   * remain valid during the life of this object.
+   * @param onConnected This calls onConnected() when the connection is
+   * established.
+   * @throws runtime_error if the kernel does not support io_uring with
+   * multishot receive, or for an error connecting.
+   */
+  virtual void
+  connect
+    (const Transport::ConnectionInfo& connectionInfo,
+     ElementListener& elementListener, const OnConnected& onConnected);
+
+  /**
+   * Submit the packet to be sent, or if corked, add it to the queue which is
+   * submitted by flush(). Because the kernel completes the send later, an
+   * error in sending is thrown by a later call to processEvents().
+   * @param data A pointer to the buffer of data to send. This copies the data.
+   * @param dataLength The number of bytes in data.
+   */
+  virtual void
+  send(const uint8_t *data, size_t dataLength);
+
+  /**
+   * Override to queue the packets given to send() until uncork() is called or
+   * the queue reaches 64 KB. Calls to cork() and uncork() can be nested.
+   */
+  virtual void
+  cork();
+
+  /**
+   * Override to undo one call to cork(). If this is the outermost call, then
+   * submit the queued packets and resume sending each packet immediately.
+   */
+  virtual void
+  uncork();
+
+  /**
+   * Override to submit the queued packets with one system call.
+   */
+  virtual void
+  flush();
+
+  /**
+   * Process the completed receives and sends. For each element received, call
+   * elementListener.onReceivedElement. This is non-blocking and will return
+   * immediately if there is no data to receive. You should normally not call
+   * this directly since it is called by Face.processEvents.
+   * @throws This may throw an exception for a receive or send error or in the
+   * callback for processing the data. If you call this from an main event
+   * loop, you may want to catch and log/disregard all exceptions.
+   */
+  virtual void
+  processEvents();
+
+  /**
+   * Wait in io_uring_enter until a receive or send completes, or until
+   * maxWait has elapsed.
+   * @param maxWait The maximum time to wait.
+   */
+  virtual void
+  waitForReceive(std::chrono::nanoseconds maxWait);
+
+  virtual bool
+  getIsConnected();
+
+  /**
+   * Cancel the receive, wait for the submitted sends and close the
+   * connection to the host.
+   */
+  virtual void
+  close();
+
+  virtual
+  ~IoUringTransport();
+
+private:
+  class Impl;
+
+  ptr_lib::shared_ptr<Impl> impl_;
+};
+
+}
+
+#endif // NDN_IND_HAVE_LINUX_IO_URING_H
+
+#endif
@@ -0,0 +1,249 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2020 Operant Networks, Incorporated.
+ * @author: Jeff Thompson <jefft0@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+#ifndef NDN_SHM_TRANSPORT_HPP
+#define NDN_SHM_TRANSPORT_HPP
+
+// Only compile if ndn-ind-config.h defines NDN_IND_HAVE_SYS_EVENTFD_H.
+#include <ndn-ind/ndn-ind-config.h>
+#if NDN_IND_HAVE_SYS_EVENTFD_H
+
+#include <string>
+#include "../common.hpp"
+#include "transport.hpp"
+
+namespace ndn_ind {
+
+/**
+ * ShmTransport extends the Transport interface to implement communication with
+ * a process on the same machine through a pair of single-producer
+ * single-consumer rings in shared memory. The sender copies each packet once
+ * into the ring and the receiver copies it once out of the ring into a Blob
+ * for the element listener, so a packet is not copied into and out of the
+ * kernel as with UnixTransport. When the receiver is waiting in waitForReceive(), the sender
+ * wakes it with an eventfd. The process which connects with a
+ * ShmTransport::ConnectionInfo creates the shared memory and gives it to the
+ * other process over a Unix socket, which is used for nothing else except to
+ * detect if the other process exits. On the other side, a forwarder accepts
+ * the Unix socket connection and connects a ShmTransport with a
+ * ShmTransport::AcceptedConnectionInfo. (See MicroForwarder::listenShm.) Each
+ * packet given to send() must be a whole TLV element. This requires Linux.
+ */
+class ndn_ind_dll ShmTransport : public Transport {
+public:
+  /**
+   * A ShmTransport::ConnectionInfo extends Transport::ConnectionInfo to hold
+   * the file path of the Unix socket where a forwarder accepts connections.
+   */
+  class ndn_ind_dll ConnectionInfo : public Transport::ConnectionInfo {
+  public:
+    /**
+     * Create a ConnectionInfo with the given filePath.
+     * @param filePath The file path of the Unix socket to connect to.
+     * @param ringCapacity (optional) The number of bytes in the ring for each
+     * direction, which is rounded up to a power of 2 and at least
+     * 2 * MAX_NDN_PACKET_SIZE. If omitted, use getDefaultRingCapacity().
+     */
+    ConnectionInfo
+      (const char *filePath, size_t ringCapacity = getDefaultRingCapacity())
+    : filePath_(filePath), ringCapacity_(ringCapacity)
+    {
+    }
+
+    /**
+     * Get the file path given to the constructor.
+     * @return A string reference for the file path.
+     */
+    const std::string&
+    getFilePath() const { return filePath_; }
+
+    /**
+     * Get the ring capacity given to the constructor.
+     * @return The ring capacity.
+     */
+    size_t
+    getRingCapacity() const { return ringCapacity_; }
+
+    /**
+     * Get the default number of bytes in the ring for each direction.
+     * @return The default ring capacity.
+     */
+    static size_t
+    getDefaultRingCapacity() { return 1048576; }
+
+    virtual
+    ~ConnectionInfo();
+
+  private:
+    std::string filePath_;
+    size_t ringCapacity_;
+  };
+
+  /**
+   * A ShmTransport::AcceptedConnectionInfo extends Transport::ConnectionInfo
+   * to hold the Unix socket returned by accept() in a forwarder, from which
+   * connect() receives the shared memory created by the other process.
+   */
+  class ndn_ind_dll AcceptedConnectionInfo : public Transport::ConnectionInfo {
+  public:
+    /**
+     * Create an AcceptedConnectionInfo with the given socket.
+     * @param socketDescriptor The accepted Unix socket. The ShmTransport
+     * takes ownership and closes it. connect() receives the shared memory
+     * without waiting if the socket is non-blocking, so in that case first
+     * wait until the socket is readable.
+     */
+    AcceptedConnectionInfo(int socketDescriptor)
+    : socketDescriptor_(socketDescriptor)
+    {
+    }
+
+    int
+    getSocketDescriptor() const { return socketDescriptor_; }
+
+    virtual
+    ~AcceptedConnectionInfo();
+
+  private:
+    int socketDescriptor_;
+  };
+
+  /**
+   * Create a ShmTransport.
+   */
+  ShmTransport();
+
+  /**
+   * Determine whether this transport connecting according to connectionInfo is
+   * to a node on the current machine. Shared memory transports are always
+   * local.
+   * @param connectionInfo This is ignored.
+   * @return True because shared memory transports are always local.
+   */
+  virtual bool
+  isLocal(const Transport::ConnectionInfo& connectionInfo);
+
+  /**
+   * Override to return false since connect does not need to use the onConnected
+   * callback.
+   * @return False.
+   */
+  virtual bool
+  isAsync();
+
+  /**
+   * Connect according to the info in ConnectionInfo, and processEvents() will
+   * use elementListener.
+   * @param connectionInfo A ShmTransport::ConnectionInfo to create the shared
+   * memory and give it to the forwarder, or a
+   * ShmTransport::AcceptedConnectionInfo to receive it in the forwarder.
+   * @param elementListener Not a shared_ptr because we assume that it will
+   * remain valid during the life of this object.
+   * @param onConnected This calls onConnected() when the connection is
+   * established.
+   * @throws runtime_error for an error creating or receiving the shared
+   * memory.
+   */
+  virtual void
+  connect
+    (const Transport::ConnectionInfo& connectionInfo,
+     ElementListener& elementListener, const OnConnected& onConnected);
+
+  /**
+   * Write the packet to the send ring. If the ring is full, queue the packet
+   * to be written by a later call to send() or processEvents(). If not
+   * corked, wake the other process if it is waiting.
+   * @param data A pointer to the buffer of data to send, which must be a
+   * whole TLV element.
+   * @param dataLength The number of bytes in data.
+   */
+  virtual void
+  send(const uint8_t *data, size_t dataLength);
+
+  /**
+   * Override to stop waking the other process for each packet until uncork()
+   * is called. Calls to cork() and uncork() can be nested.
+   */
+  virtual void
+  cork();
+
+  /**
+   * Override to undo one call to cork(). If this is the outermost call, then
+   * wake the other process if packets were sent.
+   */
+  virtual void
+  uncork();
+
+  /**
+   * Override to wake the other process if packets were sent while corked.
+   */
+  virtual void
+  flush();
+
+  /**
+   * Call elementListener.onReceivedElement(const Blob&) for each packet in the
+   * receive ring, with a copy of the packet, and write the queued packets
+   * if there is room in the send ring. This does not make a system call if
+   * the other process is not waiting. You should normally not call this
+   * directly since it is called by Face.processEvents.
+   * @throws This may throw an exception in the callback for processing the
+   * data. If you call this from an main event loop, you may want to catch and
+   * log/disregard all exceptions.
+   */
+  virtual void
+  processEvents();
+
+  /**
+   * Wait on the eventfd until the other process sends a packet, or until
+   * maxWait has elapsed.
+   * @param maxWait The maximum time to wait.
+   */
+  virtual void
+  waitForReceive(std::chrono::nanoseconds maxWait);
+
+  /**
+   * Check if connected. This is false after the other process closes its
+   * transport or exits.
+   */
+  virtual bool
+  getIsConnected();
+
+  /**
+   * Tell the other process that this is closed, then unmap the shared memory
+   * and close the file descriptors.
+   */
+  virtual void
+  close();
+
+  virtual
+  ~ShmTransport();
+
+private:
+  class Impl;
+
+  ptr_lib::shared_ptr<Impl> impl_;
+};
+
+}
+
+#endif // NDN_IND_HAVE_SYS_EVENTFD_H
+
+#endif
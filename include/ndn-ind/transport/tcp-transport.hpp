@@ -8,7 +8,7 @@
  * Original file: include/ndn-ind/transport/tcp-transport.hpp
  * Original repository: https://github.com/named-data/ndn-cpp
  *
- * Summary of Changes: Add readRawPackets. Support ndn_ind_dll.
+ * Summary of Changes: Add readRawPackets. Support ndn_ind_dll. Add cork. Add waitForReceive.
  *
  * which was originally released under the LGPL license with the following rights:
  *
@@ -43,6 +43,7 @@ struct ndn_TcpTransport;
 namespace ndn_ind {
 
 class DynamicUInt8Vector;
+class TransportSendQueue;
 
 /**
  * TcpTransport extends the Transport interface to implement communication over
@@ -134,13 +135,34 @@ public:
      ElementListener& elementListener, const OnConnected& onConnected);
 
   /**
-   * Send data to the host
+   * Send data to the host. If corked, add to the queue which is sent by
+   * flush().
    * @param data A pointer to the buffer of data to send.
    * @param dataLength The number of bytes in data.
    */
   virtual void
   send(const uint8_t *data, size_t dataLength);
 
+  /**
+   * Override to queue the packets given to send() until uncork() is called or
+   * the queue reaches 64 KB. Calls to cork() and uncork() can be nested.
+   */
+  virtual void
+  cork();
+
+  /**
+   * Override to undo one call to cork(). If this is the outermost call, then
+   * send the queued packets with writev and resume sending each packet immediately.
+   */
+  virtual void
+  uncork();
+
+  /**
+   * Override to send the queued packets with writev.
+   */
+  virtual void
+  flush();
+
   /**
    * Process any data to receive.  For each element received, call
    * elementListener.onReceivedElement. This is non-blocking and will return
@@ -153,6 +175,15 @@ public:
   virtual void
   processEvents();
 
+  /**
+   * Poll the socket until there is data to receive, or until maxWait has
+   * elapsed.
+   * @param maxWait The maximum time to wait, which is rounded up to
+   * milliseconds.
+   */
+  virtual void
+  waitForReceive(std::chrono::nanoseconds maxWait);
+
   virtual bool
   getIsConnected();
 
@@ -165,6 +196,7 @@ public:
 private:
   ptr_lib::shared_ptr<struct ndn_TcpTransport> transport_;
   ptr_lib::shared_ptr<DynamicUInt8Vector> elementBuffer_;
+  ptr_lib::shared_ptr<TransportSendQueue> sendQueue_;
   bool isConnected_;
   ConnectionInfo connectionInfo_;
   bool isLocal_;
@@ -8,7 +8,7 @@
  * Original file: include/ndn-ind/transport/transport.hpp
  * Original repository: https://github.com/named-data/ndn-cpp
  *
- * Summary of Changes: Put element-listener.hpp in API. Support ndn_ind_dll.
+ * Summary of Changes: Put element-listener.hpp in API. Support ndn_ind_dll. Add cork. Add waitForReceive.
  *
  * which was originally released under the LGPL license with the following rights:
  *
@@ -105,6 +105,34 @@ public:
     send(&data[0], data.size());
   }
 
+  /**
+   * Start queueing the packets given to send() instead of sending each one
+   * immediately, until uncork() is called. A transport may still send the
+   * queue early if it becomes large. Calls to cork() and uncork() can be
+   * nested. Face::processEvents corks the transport while it processes
+   * received packets and timeouts so that the packets sent by the callbacks
+   * are sent together with fewer system calls. This base class implementation
+   * does nothing, but your derived class can override.
+   */
+  virtual void
+  cork();
+
+  /**
+   * Undo one call to cork(). If this is the outermost call, send the queued
+   * packets and resume sending each packet immediately. This base class
+   * implementation does nothing, but your derived class can override.
+   */
+  virtual void
+  uncork();
+
+  /**
+   * Send any packets queued by cork() without changing whether the transport
+   * is corked. This base class implementation does nothing, but your derived
+   * class can override.
+   */
+  virtual void
+  flush();
+
   /**
    * Process any data to receive.  For each element received, call
    * elementListener.onReceivedElement. This is non-blocking and will return
@@ -117,6 +145,20 @@ public:
   virtual void
   processEvents() = 0;
 
+  /**
+   * Wait until there is data to receive, or until maxWait has elapsed, so
+   * that a following call to processEvents() has data to process. This is
+   * used by Face::processEvents(maxWait) to block instead of polling. This
+   * base class implementation is for when there is nothing to wait for, such
+   * as before the transport connects. It sleeps for maxWait, but at most 100
+   * milliseconds so that a large maxWait such as nanoseconds::max() doesn't
+   * block forever. Your derived class can override to return as soon as there
+   * is data to receive, and call this base method if it is not connected.
+   * @param maxWait The maximum time to wait.
+   */
+  virtual void
+  waitForReceive(std::chrono::nanoseconds maxWait);
+
   virtual bool
   getIsConnected();
 
@@ -128,6 +170,16 @@ public:
   close();
 
   virtual ~Transport();
+
+  /**
+   * Convert maxWait to a timeout for poll, rounded up so that a wait for a
+   * fraction of a millisecond doesn't return early and spin.
+   * @param maxWait The maximum time to wait.
+   * @return The timeout in milliseconds, which is 0 if maxWait is not positive
+   * and at most INT_MAX, such as for nanoseconds::max().
+   */
+  static int
+  getPollTimeoutMilliseconds(std::chrono::nanoseconds maxWait);
 };
 
 }
@@ -8,7 +8,7 @@
  * Original file: include/ndn-cpp/util/blob.hpp
  * Original repository: https://github.com/named-data/ndn-cpp
  *
- * Summary of Changes: Use NDN_IND macros. Support ndn_ind_dll.
+ * Summary of Changes: Use NDN_IND macros. Support ndn_ind_dll. Add slices.
  *
  * which was originally released under the LGPL license with the following rights:
  *
@@ -34,6 +34,8 @@
 #ifndef NDN_BLOB_HPP
 #define NDN_BLOB_HPP
 
+#include <algorithm>
+#include <stdexcept>
 #include <iostream>
 #include "../common.hpp"
 #include "../c/util/blob-types.h"
@@ -50,6 +52,13 @@ namespace ndn_ind {
  * (Note that we could have made Blob derive directly from vector<uint8_t> and then explicitly use
  * a pointer to it like Blob, but this does not enforce immutability because we can't declare
  * Blob as derived from const vector<uint8_t>.)
+ * A Blob can also be a slice which holds a pointer to a byte array but only
+ * refers to a range of its bytes, so that decoded fields can share the buffer
+ * of the packet encoding. Therefore, use buf() and size() to access the bytes,
+ * not the std::vector of the shared_ptr which may have more bytes. The
+ * inherited operator->, operator* and shared_ptr::get() are not slice-aware.
+ * They return the whole buffer, so for a slice blob->size() is greater than
+ * blob.size().
  */
 class ndn_ind_dll Blob : public ptr_lib::shared_ptr<const std::vector<uint8_t> > {
 public:
@@ -113,8 +122,56 @@ public:
    * @param blob The Blob from which we take another pointer to the same buffer.
    */
   Blob(const Blob& blob)
+  : ptr_lib::shared_ptr<const std::vector<uint8_t> >(blob),
+    offset_(blob.offset_), length_(blob.length_)
+  {
+  }
+
+  /**
+   * Create a new Blob which is a slice of the given blob's bytes, taking
+   * another pointer to the same buffer without copying.
+   * @param blob The Blob with the bytes. If blob.isNull(), then create a Blob
+   * where isNull() is true.
+   * @param offset The offset in blob.buf() of the first byte of the slice.
+   * @param length The number of bytes in the slice.
+   * @throws runtime_error if offset + length is greater than blob.size().
+   */
+  Blob(const Blob& blob, size_t offset, size_t length)
   : ptr_lib::shared_ptr<const std::vector<uint8_t> >(blob)
   {
+    if (!blob)
+      return;
+    if (offset > blob.size() || length > blob.size() - offset)
+      throw std::runtime_error("Blob: The slice is outside the blob");
+
+    offset_ = blob.offset_ + offset;
+    length_ = length;
+  }
+
+  /**
+   * Create a new Blob for the bytes in blobLite. If the bytes are inside the
+   * bytes of the backing Blob (such as a field decoded from the backing
+   * encoding), then create a slice which takes another pointer to the backing
+   * buffer without copying. Otherwise, make a copy as Blob(blobLite).
+   * @param blobLite The BlobLite with the bytes. If blobLite.isNull() then
+   * create a Blob where isNull() is true.
+   * @param backing The Blob which may hold the bytes. This may be a null Blob.
+   */
+  Blob(const BlobLite& blobLite, const Blob& backing)
+  {
+    if (blobLite.isNull())
+      return;
+
+    const uint8_t* backingBuf = backing.buf();
+    if (backingBuf && blobLite.buf() >= backingBuf &&
+        blobLite.buf() + blobLite.size() <= backingBuf + backing.size()) {
+      ptr_lib::shared_ptr<const std::vector<uint8_t> >::operator=(backing);
+      offset_ = backing.offset_ + (blobLite.buf() - backingBuf);
+      length_ = blobLite.size();
+    }
+    else
+      reset(new std::vector<uint8_t>
+            (blobLite.buf(), blobLite.buf() + blobLite.size()));
   }
 
   Blob& operator=(const Blob& blob) = default;
@@ -173,7 +230,7 @@ public:
   size() const
   {
     if (*this)
-      return (*this)->size();
+      return length_ == WHOLE_BUFFER ? (*this)->size() : length_;
     else
       return 0;
   }
@@ -185,11 +242,44 @@ public:
   buf() const
   {
     if (*this)
-      return &(*this)->front();
+      return (*this)->data() + offset_;
     else
       return 0;
   }
 
+  /**
+   * Set this to a null Blob. This hides shared_ptr::reset() so that it also
+   * clears the slice.
+   */
+  void
+  reset()
+  {
+    ptr_lib::shared_ptr<const std::vector<uint8_t> >::reset();
+    offset_ = 0;
+    length_ = WHOLE_BUFFER;
+  }
+
+  /**
+   * Take ownership of value and refer to all of its bytes. This hides
+   * shared_ptr::reset(p) so that it also clears the slice.
+   * @param value The vector allocated with new, or 0 for a null Blob.
+   */
+  void
+  reset(const std::vector<uint8_t>* value)
+  {
+    ptr_lib::shared_ptr<const std::vector<uint8_t> >::reset(value);
+    offset_ = 0;
+    length_ = WHOLE_BUFFER;
+  }
+
+  /**
+   * Check if this Blob is a slice which refers to only some of the bytes in
+   * the buffer.
+   * @return True if this is a slice.
+   */
+  bool
+  isSlice() const { return length_ != WHOLE_BUFFER; }
+
   /**
    * Check if the array pointer is null.
    * @return true if the buffer pointer is null, otherwise false.
@@ -206,7 +296,7 @@ public:
   toHex(std::ostringstream& result) const
   {
     if (*this)
-      ndn_ind::toHex(**this, result);
+      ndn_ind::toHex(buf(), size(), result);
   }
 
   /**
@@ -215,7 +305,7 @@ public:
    * null.
    */
   std::string
-  toHex() const { return (*this) ? ndn_ind::toHex(**this) : std::string(); }
+  toHex() const { return (*this) ? ndn_ind::toHex(buf(), size()) : std::string(); }
 
   /**
    * Return the bytes of the byte array as a raw str of the same length. This
@@ -225,8 +315,7 @@ public:
   std::string
   toRawStr() const
   {
-    return (*this) ? std::string((const char*)(&(*this)->front()), (*this)->size())
-                   : std::string();
+    return (*this) ? std::string((const char*)buf(), size()) : std::string();
   }
 
   /**
@@ -242,13 +331,12 @@ public:
       return other.isNull();
     else if (other.isNull())
       return false;
-    else if (static_cast<const ptr_lib::shared_ptr<const std::vector<uint8_t> >&>(*this).get() ==
-             static_cast<const ptr_lib::shared_ptr<const std::vector<uint8_t> >&>(other).get())
-      // The other is the same byte array object.
+    else if (buf() == other.buf() && size() == other.size())
+      // The other is the same bytes in the same byte array object.
       return true;
     else
-      // Use the vector equals operator.
-      return (**this) == (*other);
+      return size() == other.size() &&
+             (size() == 0 || std::equal(buf(), buf() + size(), other.buf()));
   }
 
   /**
@@ -273,10 +361,16 @@ public:
   operator const BlobLite() const
   {
     if (*this)
-      return BlobLite(&(*this)->front(), (*this)->size());
+      return BlobLite(buf(), size());
     else
       return BlobLite();
   }
+
+private:
+  static const size_t WHOLE_BUFFER = (size_t)-1;
+
+  size_t offset_ = 0;          /**< The offset of the slice in the buffer. */
+  size_t length_ = WHOLE_BUFFER; /**< The slice length, or WHOLE_BUFFER if not a slice. */
 };
 
 inline std::ostream&
@@ -8,7 +8,7 @@
  * Original file: include/ndn-cpp/util/exponential-re-express.hpp
  * Original repository: https://github.com/named-data/ndn-cpp
  *
- * Summary of Changes: Use std::chrono. Support ndn_ind_dll.
+ * Summary of Changes: Use std::chrono. Support ndn_ind_dll. Use InterestEncodingTemplate.
  *
  * which was originally released under the LGPL license with the following rights:
  *
@@ -35,6 +35,7 @@
 #define NDN_EXPONENTIAL_RE_EXPRESS_HPP
 
 #include "../face.hpp"
+#include "interest-encoding-template.hpp"
 
 namespace ndn_ind {
 
@@ -95,6 +96,8 @@ private:
   OnData callerOnData_;
   OnTimeout callerOnTimeout_;
   std::chrono::nanoseconds maxInterestLifetime_;
+  // The template to re-express the interest, made on the first timeout.
+  ptr_lib::shared_ptr<InterestEncodingTemplate> interestTemplate_;
 };
 
 }
@@ -0,0 +1,122 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2020 Operant Networks, Incorporated.
+ * @author: Jeff Thompson <jefft0@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+
+#ifndef NDN_INTEREST_ENCODING_TEMPLATE_HPP
+#define NDN_INTEREST_ENCODING_TEMPLATE_HPP
+
+#include "../interest.hpp"
+
+namespace ndn_ind {
+
+/**
+ * An InterestEncodingTemplate holds the NDN-TLV encoding of an Interest, split
+ * around the end of the Name, the Nonce and the InterestLifetime. makeInterest
+ * makes a new Interest with a name suffix, a new Nonce and a lifetime by
+ * copying the pre-encoded parts and only encoding these fields, so that
+ * re-expressing an Interest or fetching many segments does not encode the
+ * whole Interest each time. The new Interest keeps the encoding as its default
+ * wire encoding, so that Face.expressInterest sends it without encoding again.
+ */
+class ndn_ind_dll InterestEncodingTemplate {
+public:
+  /**
+   * Create an InterestEncodingTemplate by encoding the interest once.
+   * @param interest The Interest with the name prefix and the other fields for
+   * each Interest made by makeInterest. This copies the Interest. The Nonce is
+   * ignored.
+   * @param wireFormat (optional) A WireFormat object used to encode the
+   * Interest, which must be an NDN-TLV wire format. If omitted, use
+   * WireFormat::getDefaultWireFormat().
+   * @throws runtime_error if the wireFormat is not an NDN-TLV wire format, or
+   * if the interest has ApplicationParameters (since the name has a digest of
+   * the parameters).
+   */
+  InterestEncodingTemplate
+    (const Interest& interest,
+     WireFormat& wireFormat = *WireFormat::getDefaultWireFormat());
+
+  /**
+   * Make a new Interest which is a copy of the template Interest with the
+   * suffix appended to the name, a new random Nonce and the given lifetime.
+   * @param suffix The name component to append to the name.
+   * @param interestLifetime The InterestLifetime, or -1 milliseconds for none.
+   * @return The new Interest, whose wire encoding is already made.
+   */
+  ptr_lib::shared_ptr<Interest>
+  makeInterest
+    (const Name::Component& suffix, std::chrono::nanoseconds interestLifetime)
+  {
+    return makeInterest(&suffix, interestLifetime);
+  }
+
+  /**
+   * Make a new Interest which is a copy of the template Interest with the
+   * suffix appended to the name and a new random Nonce, using the lifetime of
+   * the template Interest.
+   * @param suffix The name component to append to the name.
+   * @return The new Interest, whose wire encoding is already made.
+   */
+  ptr_lib::shared_ptr<Interest>
+  makeInterest(const Name::Component& suffix)
+  {
+    return makeInterest(&suffix, interest_.getInterestLifetime());
+  }
+
+  /**
+   * Make a new Interest which is a copy of the template Interest with a new
+   * random Nonce and the given lifetime.
+   * @param interestLifetime The InterestLifetime, or -1 milliseconds for none.
+   * @return The new Interest, whose wire encoding is already made.
+   */
+  ptr_lib::shared_ptr<Interest>
+  makeInterest(std::chrono::nanoseconds interestLifetime)
+  {
+    return makeInterest(0, interestLifetime);
+  }
+
+  /**
+   * Get the template Interest given to the constructor.
+   * @return The template Interest.
+   */
+  const Interest&
+  getInterest() const { return interest_; }
+
+private:
+  ptr_lib::shared_ptr<Interest>
+  makeInterest
+    (const Name::Component* suffix, std::chrono::nanoseconds interestLifetime);
+
+  Interest interest_;
+  WireFormat* wireFormat_;
+  Blob encoding_;
+  // The offsets in encoding_ of the name components, the fields between the
+  // Name and Nonce, and the fields after the InterestLifetime.
+  size_t nameComponentsBegin_;
+  size_t finalComponentBegin_;
+  size_t nameComponentsEnd_;
+  size_t nonceBegin_;
+  size_t afterInterestLifetimeBegin_;
+};
+
+}
+
+#endif
@@ -8,7 +8,7 @@
  * Original file: include/ndn-cpp/util/memory-content-cache.hpp
  * Original repository: https://github.com/named-data/ndn-cpp
  *
- * Summary of Changes: Use std::chrono. Support ndn_ind_dll.
+ * Summary of Changes: Use std::chrono. Support ndn_ind_dll. Document lazy decoding in add. Index by name. Add setCapacity. Index pending interests. Add setContentStore.
  *
  * which was originally released under the LGPL license with the following rights:
  *
@@ -35,15 +35,23 @@
 #define NDN_MEMORY_CONTENT_CACHE_HPP
 
 #include <map>
-#include <deque>
+#include <queue>
 #include "../face.hpp"
 
 namespace ndn_ind {
 
+class ShardedContentStore;
+
 /**
  * A MemoryContentCache holds a set of Data packets and answers an Interest to
  * return the correct Data packet. The cache is periodically cleaned up to
  * remove each stale Data packet based on its FreshnessPeriod (if it has one).
+ * The Data packets are sorted by name, so that answering an Interest only
+ * searches the Data packets whose name has the Interest name as a prefix.
+ * Optionally, setCapacity() limits the total size of the cached Data packets
+ * and selects the policy to evict Data packets when the cache is full.
+ * Optionally, setContentStore() adds a ShardedContentStore which other threads
+ * can fill while this answers Interests on the thread of the Face.
  * @note This class is an experimental feature.  See the API docs for more detail at
  * http://named-data.net/doc/ndn-ccl-api/memory-content-cache.html .
  */
@@ -117,6 +125,21 @@ public:
       return now >= timeoutTime_;
     }
 
+    /**
+     * Compare shared_ptrs to PendingInterest based only on timeoutTime_, so
+     * that a priority_queue has the earliest timeoutTime_ at the top.
+     */
+    class Compare {
+    public:
+      bool
+      operator()
+        (const ptr_lib::shared_ptr<const PendingInterest>& x,
+         const ptr_lib::shared_ptr<const PendingInterest>& y) const
+      {
+        return x->timeoutTime_ > y->timeoutTime_;
+      }
+    };
+
   private:
     ptr_lib::shared_ptr<const Interest> interest_;
     Face& face_;
@@ -168,6 +191,24 @@ public:
   typedef func_lib::function<void
     (const ptr_lib::shared_ptr<ContentList>& contentList)> OnContentRemoved;
 
+  /**
+   * A ReplacementPolicy selects which Data packet to evict when adding a Data
+   * packet would exceed the capacity. See setCapacity().
+   */
+  enum ReplacementPolicy {
+    // Evict the least recently used Data packet.
+    LRU = 0,
+    // Evict the first Data packet found by a clock hand which has not been
+    // used since the hand last passed it. This approximates LRU with less
+    // work for each cache hit.
+    CLOCK = 1,
+    // The Adaptive Replacement Cache of Megiddo and Modha, which balances
+    // recently used and frequently used Data packets, and keeps the names of
+    // recently evicted Data packets to adapt the balance. This resists a scan
+    // of Data packets which are only used once.
+    ARC = 2
+  };
+
   /**
    * Call registerPrefix on the Face given to the constructor so that this
    * MemoryContentCache will answer interests whose name has the prefix.
@@ -323,7 +364,11 @@ public:
    * answer interests. If data.getMetaInfo().getFreshnessPeriod() is not
    * negative, set the staleness time to now plus the maximum of
    * data.getMetaInfo().getFreshnessPeriod() and minimumCacheLifetime, which is
-   * checked during cleanup to remove stale content.
+   * checked during cleanup to remove stale content. If the cache already has
+   * a Data packet with the same name, this replaces it. If adding the Data
+   * packet would exceed the capacity, this first evicts Data packets according
+   * to the replacement policy and calls the OnContentRemoved callback for them.
+   * See setCapacity().
    * This also checks if the cleanupInterval has passed and
    * removes stale content from the cache. After
    * removing stale content, remove timed-out pending interests from
@@ -333,7 +378,9 @@ public:
    * Because this modifies the internal tables, you should call this on the same
    * thread as processEvents, which can also modify the tables.
    * @param data The Data packet object to put in the cache. This copies the
-   * fields from the object.
+   * fields from the object. This only uses the name, FreshnessPeriod and wire
+   * encoding, so if the Data was decoded with Data.wireDecodeLazy, then this
+   * does not decode its signature.
    */
   void
   add(const Data& data) { impl_->add(data); }
@@ -445,6 +492,94 @@ public:
     impl_->setMinimumCacheLifetime(minimumCacheLifetime);
   }
 
+  /**
+   * Set the maximum total size of the wire encodings of the cached Data
+   * packets. When adding a Data packet would exceed the capacity, add() evicts
+   * Data packets according to the replacement policy. A Data packet which is
+   * larger than the capacity is not cached. If the cache is already larger
+   * than the new capacity, this evicts Data packets now. The OnContentRemoved
+   * callback is called for each evicted Data packet.
+   * @param capacity The capacity in bytes, or 0 for no limit. The default is
+   * no limit.
+   * @param replacementPolicy (optional) The ReplacementPolicy to select the
+   * Data packet to evict. If omitted, use LRU.
+   */
+  void
+  setCapacity
+    (size_t capacity, ReplacementPolicy replacementPolicy = LRU)
+  {
+    impl_->setCapacity(capacity, replacementPolicy);
+  }
+
+  /**
+   * Get the capacity given to setCapacity().
+   * @return The capacity in bytes, or 0 for no limit.
+   */
+  size_t
+  getCapacity() const { return impl_->getCapacity(); }
+
+  /**
+   * Get the replacement policy given to setCapacity().
+   * @return The ReplacementPolicy.
+   */
+  ReplacementPolicy
+  getReplacementPolicy() const { return impl_->getReplacementPolicy(); }
+
+  /**
+   * Get the total size of the wire encodings of the cached Data packets.
+   * @return The size in bytes.
+   */
+  size_t
+  getSize() const { return impl_->getSize(); }
+
+  /**
+   * Get the number of Interests which were answered from the cache.
+   * @return The number of cache hits.
+   */
+  uint64_t
+  getNHits() const { return impl_->getNHits(); }
+
+  /**
+   * Get the number of Interests which were not answered from the cache.
+   * @return The number of cache misses.
+   */
+  uint64_t
+  getNMisses() const { return impl_->getNMisses(); }
+
+  /**
+   * Get the number of Data packets which were evicted to stay within the
+   * capacity. This does not count the stale Data packets which are removed
+   * during cleanup.
+   * @return The number of evictions.
+   */
+  uint64_t
+  getNEvictions() const { return impl_->getNEvictions(); }
+
+  /**
+   * Set the ShardedContentStore to search for an Interest which does not match
+   * a Data packet in this cache. Worker threads can insert Data packets into
+   * the content store at the same time as this answers Interests on the thread
+   * of the Face, without a lock around the whole cache. A Data packet which is
+   * inserted into the content store is not sent to a pending interest from
+   * storePendingInterest, since that must be done on the thread of the Face by
+   * add(). The capacity and cleanup of this cache do not apply to the content
+   * store.
+   * @param contentStore The ShardedContentStore, which may be shared with other
+   * threads, or null to not use a content store.
+   */
+  void
+  setContentStore(const ptr_lib::shared_ptr<ShardedContentStore>& contentStore)
+  {
+    impl_->setContentStore(contentStore);
+  }
+
+  /**
+   * Get the ShardedContentStore given to setContentStore().
+   * @return The ShardedContentStore, or null if not set.
+   */
+  const ptr_lib::shared_ptr<ShardedContentStore>&
+  getContentStore() const { return impl_->getContentStore(); }
+
 private:
   /**
    * MemoryContentCache::Impl does the work of MemoryContentCache. It is a
@@ -520,14 +655,47 @@ private:
       minimumCacheLifetime_ = minimumCacheLifetime;
     }
 
+    void
+    setCapacity(size_t capacity, ReplacementPolicy replacementPolicy);
+
+    size_t
+    getCapacity() const { return capacity_; }
+
+    ReplacementPolicy
+    getReplacementPolicy() const { return replacementPolicy_; }
+
+    size_t
+    getSize() const { return size_; }
+
+    uint64_t
+    getNHits() const { return nHits_; }
+
+    uint64_t
+    getNMisses() const { return nMisses_; }
+
+    uint64_t
+    getNEvictions() const { return nEvictions_; }
+
+    void
+    setContentStore
+      (const ptr_lib::shared_ptr<ShardedContentStore>& contentStore)
+    {
+      contentStore_ = contentStore;
+    }
+
+    const ptr_lib::shared_ptr<ShardedContentStore>&
+    getContentStore() const { return contentStore_; }
+
     /**
      * This is the OnInterestCallback which is called when the library receives
      * an interest whose name has the prefix given to registerPrefix. First
      * check if the cleanupInterval has passed and remove
-     * stale content from the cache. Then search the cache for the Data packet,
-     * matching any interest selectors including ChildSelector, and send the
+     * stale content from the cache. Then search the cache for the Data packet
+     * in the range of names with the interest name as a prefix, from the end
+     * of the range for the rightmost ChildSelector, else from the start,
+     * matching any interest selectors, and send the
      * Data packet to the transport. If no matching Data packet is in the cache,
-     * call the callback in onDataNotFoundForPrefix_ (if defined).
+     * search the contentStore_ (if set). If there is still no match, call the callback in onDataNotFoundForPrefix_ (if defined).
      */
     void
     onInterest
@@ -557,16 +725,13 @@ private:
          std::chrono::nanoseconds minimumCacheLifetime);
 
       /**
-       * Check if this content is stale and should be removed from the cache,
-       * according to the content freshness period and the minimumCacheLifetime.
-       * @param now The current time from system_clock::now().
-       * @return True if this content should be removed, otherwise false.
+       * Get the time when this content is stale and should be removed from the
+       * cache, according to the content freshness period and the
+       * minimumCacheLifetime.
+       * @return The time according to system_clock::now().
        */
-      bool
-      isPastRemovalTime(std::chrono::system_clock::time_point now) const
-      {
-        return cacheRemovalTime_ <= now;
-      }
+      std::chrono::system_clock::time_point
+      getCacheRemovalTime() const { return cacheRemovalTime_; }
 
       /**
        * Check if the content is still fresh according to its freshness period
@@ -580,20 +745,6 @@ private:
         return freshnessExpiryTime_ > now;
       }
 
-      /**
-       * Compare shared_ptrs to Content based only on cacheRemovalTime_.
-       */
-      class Compare {
-      public:
-        bool
-        operator()
-          (const ptr_lib::shared_ptr<const StaleTimeContent>& x,
-           const ptr_lib::shared_ptr<const StaleTimeContent>& y) const
-        {
-          return x->cacheRemovalTime_ < y->cacheRemovalTime_;
-        }
-      };
-
     private:
       std::chrono::system_clock::time_point cacheRemovalTime_; /**< The time when the content
         becomes stale and should be removed from the cache according to
@@ -603,18 +754,167 @@ private:
         remove from the cache) according to system_clock::now() */
     };
 
+    /**
+     * A ContentEntry is the value in contentIndex_.
+     */
+    struct ContentEntry {
+      ptr_lib::shared_ptr<const Content> content;
+      // The same object as content if it has a FreshnessPeriod, otherwise 0.
+      const StaleTimeContent* staleTimeContent;
+      // The value of nInserted_ when added, to identify the entry.
+      uint64_t insertNumber;
+    };
+
+    /**
+     * A RemovalEntry is in staleTimeHeap_ for content with a FreshnessPeriod.
+     * It only has the name, not the content, so that the content is freed
+     * when it is evicted or replaced before its removal time.
+     */
+    class RemovalEntry {
+    public:
+      RemovalEntry
+        (std::chrono::system_clock::time_point removalTime, const Name& name,
+         uint64_t insertNumber)
+      : removalTime_(removalTime), name_(name), insertNumber_(insertNumber)
+      {
+      }
+
+      bool
+      operator<(const RemovalEntry& other) const
+      {
+        // Reverse the order so that a priority_queue has the earliest at the top.
+        return removalTime_ > other.removalTime_;
+      }
+
+      std::chrono::system_clock::time_point removalTime_;
+      Name name_;
+      // Check this with the ContentEntry in case the entry was replaced.
+      uint64_t insertNumber_;
+    };
+
+    typedef std::map<Name, ContentEntry> ContentIndex;
+
+    typedef std::multimap<Name, ptr_lib::shared_ptr<const PendingInterest> >
+      PendingInterestIndex;
+
+    /**
+     * A Replacer is the base class for the implementation of a
+     * ReplacementPolicy. It tracks the names of the cached Data packets.
+     */
+    class Replacer {
+    public:
+      virtual
+      ~Replacer();
+
+      /**
+       * Add the name of a Data packet which is added to the cache.
+       * @param name The name, which is not already in this Replacer.
+       * @param size The size of the Data packet wire encoding.
+       */
+      virtual void
+      insert(const Name& name, size_t size) = 0;
+
+      /**
+       * Update the Replacer for a cache hit on the Data packet.
+       * @param name The name of the Data packet.
+       */
+      virtual void
+      access(const Name& name) = 0;
+
+      /**
+       * Remove the name of a Data packet which is removed from the cache
+       * other than by evict().
+       * @param name The name of the Data packet.
+       */
+      virtual void
+      erase(const Name& name) = 0;
+
+      /**
+       * Select the Data packet to evict and remove its name from this Replacer.
+       * This must not be called if this Replacer is empty.
+       * @return The name of the Data packet to evict.
+       */
+      virtual Name
+      evict() = 0;
+    };
+
+    class LruReplacer;
+    class ClockReplacer;
+    class ArcReplacer;
+
+    /**
+     * Remove the entry from contentIndex_ and the replacer_, and update size_.
+     * @param entry The iterator of the entry in contentIndex_.
+     */
+    void
+    eraseContent(ContentIndex::iterator entry);
+
+    /**
+     * Evict Data packets selected by the replacer_ until the size_ plus
+     * neededSize is within the capacity_.
+     * @param neededSize The size to make room for.
+     * @param contentList If an entry is evicted and contentList is null, then
+     * set contentList to a new ContentList. Add the evicted content.
+     */
+    void
+    evict(size_t neededSize, ptr_lib::shared_ptr<ContentList>& contentList);
+
+    /**
+     * If onContentRemoved_ and contentList are defined, call
+     * onContentRemoved_(contentList), and log any exception.
+     * @param contentList The removed content, or null if none.
+     */
+    void
+    callOnContentRemoved(const ptr_lib::shared_ptr<ContentList>& contentList);
+
+    /**
+     * Check if the interest matches the entry's name and freshness.
+     * @param interest The Interest to check.
+     * @param entry The ContentEntry to check.
+     * @param now The current time from system_clock::now().
+     * @return True if the entry satisfies the interest.
+     */
+    static bool
+    matches
+      (const Interest& interest, const ContentEntry& entry,
+       std::chrono::system_clock::time_point now)
+    {
+      return interest.matchesName(entry.content->getName()) &&
+        !(interest.getMustBeFresh() && entry.staleTimeContent &&
+          !entry.staleTimeContent->isFresh(now));
+    }
+
     /**
      * Check if now is greater than nextCleanupTime_ and, if so, remove stale
-     * content from staleTimeCache_ and reset nextCleanupTime_ based on
-     * cleanupInterval_. Since add(Data) does a sorted insert into
-     * staleTimeCache_, the check for stale data is quick and does not require
-     * searching the entire staleTimeCache_. If onContentRemoved_ is defined,
+     * content from contentIndex_ and reset nextCleanupTime_ based on
+     * cleanupInterval_. Since staleTimeHeap_ has the earliest
+     * removal time at the top, the check for stale data is quick and does
+     * not require searching the entire cache. If onContentRemoved_ is defined,
      * this calls onContentRemoved_(content) for the removed content.
      * @param now The current time from system_clock::now().
      */
     void
     doCleanup(std::chrono::system_clock::time_point now);
 
+    /**
+     * Remove the timed-out pending interests at the top of pendingInterestHeap_
+     * from pendingInterestIndex_.
+     * @param now The current time from system_clock::now().
+     */
+    void
+    removeTimedOutPendingInterests(std::chrono::system_clock::time_point now);
+
+    /**
+     * Get the entries of pendingInterestIndex_ which can match a Data packet
+     * with the name, which are the interests whose name is a prefix of the
+     * name (or equal). The caller must check Interest.matchesName.
+     * @param name The Data packet name.
+     * @param candidates This appends the iterators of the entries.
+     */
+    void
+    getPendingInterestCandidates
+      (const Name& name, std::vector<PendingInterestIndex::iterator>& candidates);
+
     /**
      * This is a private method to return for setting storePendingInterestCallback_.
      * We need a separate method because the arguments are different from the main
@@ -636,16 +936,39 @@ private:
     std::map<std::string, OnInterestCallback> onDataNotFoundForPrefix_; /**< The map key is the prefix.toUri() */
     std::vector<uint64_t> interestFilterIdList_;
     std::vector<uint64_t> registeredPrefixIdList_;
-    std::vector<ptr_lib::shared_ptr<const Content> > noStaleTimeCache_;
-    // Use a deque so we can efficiently remove from the front.
-    std::deque<ptr_lib::shared_ptr<const StaleTimeContent> > staleTimeCache_;
-    StaleTimeContent::Compare contentCompare_;
-    Name::Component emptyComponent_;
-    std::vector<ptr_lib::shared_ptr<const PendingInterest> > pendingInterestTable_;
+    // The content sorted by name in the NDN canonical order, so that the
+    // content with a prefix is a contiguous range.
+    ContentIndex contentIndex_;
+    // The removal entries of content with a FreshnessPeriod with the earliest
+    // removal time at the top. The content may have been replaced or evicted
+    // from contentIndex_.
+    std::priority_queue<RemovalEntry> staleTimeHeap_;
+    // The number of entries added to contentIndex_, to set insertNumber.
+    uint64_t nInserted_;
+    // The pending interests sorted by name, so that add only checks the
+    // interests whose name is a prefix of the Data name.
+    PendingInterestIndex pendingInterestIndex_;
+    // The pending interests with the earliest timeoutTime_ at the top. An
+    // entry may have already been removed from pendingInterestIndex_ by add.
+    std::priority_queue
+      <ptr_lib::shared_ptr<const PendingInterest>,
+       std::vector<ptr_lib::shared_ptr<const PendingInterest> >,
+       PendingInterest::Compare> pendingInterestHeap_;
     OnInterestCallback storePendingInterestCallback_;
     OnContentRemoved onContentRemoved_;
     bool isDoingCleanup_;
     std::chrono::nanoseconds minimumCacheLifetime_;
+    size_t capacity_;
+    ReplacementPolicy replacementPolicy_;
+    // Null if capacity_ is 0.
+    ptr_lib::shared_ptr<Replacer> replacer_;
+    // The total size of the wire encodings in contentIndex_.
+    size_t size_;
+    uint64_t nHits_;
+    uint64_t nMisses_;
+    uint64_t nEvictions_;
+    // Searched after contentIndex_. Null if not set.
+    ptr_lib::shared_ptr<ShardedContentStore> contentStore_;
   };
 
   ptr_lib::shared_ptr<Impl> impl_;
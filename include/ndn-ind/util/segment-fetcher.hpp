@@ -8,7 +8,7 @@
  * Original file: include/ndn-cpp/util/segment-fetcher.hpp
  * Original repository: https://github.com/named-data/ndn-cpp
  *
- * Summary of Changes: Use std::chrono. Remove unused methods from security v1.
+ * Summary of Changes: Use std::chrono. Remove unused methods from security v1. Use InterestEncodingTemplate. Add Options for a pipelined fetch. Add streaming with OnSegment.
  *   Support ndn_ind_dll.
  *
  * which was originally released under the LGPL license with the following rights:
@@ -36,8 +36,11 @@
 #ifndef NDN_SEGMENT_FETCHER_HPP
 #define NDN_SEGMENT_FETCHER_HPP
 
+#include <map>
+#include <deque>
 #include "../face.hpp"
 #include "../security/key-chain.hpp"
+#include "interest-encoding-template.hpp"
 
 namespace ndn_ind {
 
@@ -86,6 +89,26 @@ namespace ndn_ind {
  * SEGMENT_VERIFICATION_FAILED. If data validation is not required, use
  * DontVerifySegment.
  *
+ * If fetch is called with Options, then step 5 keeps a window of Interests
+ * in flight instead of one segment at a time. The window grows with AIMD or
+ * CUBIC and shrinks when a Data packet has a CongestionMark, when a Nack has
+ * the reason Congestion, or when an Interest times out. Each Interest has a
+ * lifetime of the retransmission timeout (RTO) which is computed from the
+ * measured round-trip time, and a timed-out Interest is re-expressed with the
+ * RTO doubled. Segments which arrive out of order are held until the missing
+ * segments arrive. In this mode, the following errors are also possible:
+ *
+ * - `INTEREST_TIMEOUT`: if no new segment arrives within Options maxTimeout
+ * - `NACK_ERROR`: if a Nack has a reason other than Congestion or Duplicate
+ * - `IO_ERROR`: if the Options OnSegment callback throws an exception
+ *
+ * If the Options have an OnSegment callback, then step 6 is replaced by
+ * calling OnSegment for each segment in order as soon as it and the segments
+ * before it arrive, so that the content is not held in memory. The fetcher
+ * returned by fetch can pause() and resume() the fetch to apply backpressure.
+ * The number of segments which are requested or held but not yet delivered
+ * is limited to the Options maxWindow.
+ *
  * Example:
  *     void onComplete(const Blob& encodedMessage);
  *
@@ -101,7 +124,304 @@ public:
   enum ErrorCode {
     INTEREST_TIMEOUT = 1,
     DATA_HAS_NO_SEGMENT = 2,
-    SEGMENT_VERIFICATION_FAILED = 3
+    SEGMENT_VERIFICATION_FAILED = 3,
+    NACK_ERROR = 4,
+    IO_ERROR = 5
+  };
+
+  typedef func_lib::function<void
+    (uint64_t segmentNumber, const Blob& content)> OnSegment;
+
+  /**
+   * CongestionControl selects how a pipelined fetch changes the window.
+   */
+  enum CongestionControl {
+    // Keep the initial window.
+    CONSTANT_WINDOW = 0,
+    // Additive increase, multiplicative decrease.
+    AIMD = 1,
+    // The CUBIC window growth function of RFC 8312.
+    CUBIC = 2
+  };
+
+  /**
+   * An Options object holds the settings for a pipelined fetch. See the
+   * fetch method which takes Options.
+   */
+  class ndn_ind_dll Options {
+  public:
+    /**
+     * Create an Options with the default values: an initial window of 1
+     * segment, a maximum window of 256 segments, AIMD with an additive step of
+     * 1 segment and a multiplicative decrease of 0.5, a CUBIC beta of 0.7, an
+     * initial RTO of 1 second between 200 milliseconds and 60 seconds, and a
+     * maxTimeout of 60 seconds.
+     */
+    Options()
+    : initialWindow_(1), maxWindow_(256), congestionControl_(AIMD),
+      additiveIncrease_(1), multiplicativeDecrease_(0.5), cubicBeta_(0.7),
+      ignoreCongestionMarks_(false), initialRto_(std::chrono::seconds(1)),
+      minRto_(std::chrono::milliseconds(200)),
+      maxRto_(std::chrono::seconds(60)), maxTimeout_(std::chrono::seconds(60))
+    {
+    }
+
+    /**
+     * Get the number of Interests in flight when the fetch starts.
+     * @return The initial window.
+     */
+    double
+    getInitialWindow() const { return initialWindow_; }
+
+    /**
+     * Get the largest number of Interests in flight.
+     * @return The maximum window.
+     */
+    double
+    getMaxWindow() const { return maxWindow_; }
+
+    /**
+     * Get how the window changes during the fetch.
+     * @return The CongestionControl enum value.
+     */
+    CongestionControl
+    getCongestionControl() const { return congestionControl_; }
+
+    /**
+     * Get the number of segments which AIMD adds to the window for each round
+     * trip, and which slow start adds for each received segment.
+     * @return The additive increase.
+     */
+    double
+    getAdditiveIncrease() const { return additiveIncrease_; }
+
+    /**
+     * Get the factor which AIMD multiplies the window by on congestion.
+     * @return The multiplicative decrease.
+     */
+    double
+    getMultiplicativeDecrease() const { return multiplicativeDecrease_; }
+
+    /**
+     * Get the factor which CUBIC multiplies the window by on congestion.
+     * @return The CUBIC beta.
+     */
+    double
+    getCubicBeta() const { return cubicBeta_; }
+
+    /**
+     * Get whether the window ignores the CongestionMark of received Data.
+     * @return True to ignore congestion marks.
+     */
+    bool
+    getIgnoreCongestionMarks() const { return ignoreCongestionMarks_; }
+
+    /**
+     * Get the callback for streaming the segments in order.
+     * @return The OnSegment callback, or an empty OnSegment() if not
+     * streaming.
+     */
+    const OnSegment&
+    getOnSegment() const { return onSegment_; }
+
+    /**
+     * Get the retransmission timeout before there is a round-trip time
+     * measurement.
+     * @return The initial RTO.
+     */
+    std::chrono::nanoseconds
+    getInitialRto() const { return initialRto_; }
+
+    /**
+     * Get the lower bound of the retransmission timeout.
+     * @return The minimum RTO.
+     */
+    std::chrono::nanoseconds
+    getMinRto() const { return minRto_; }
+
+    /**
+     * Get the upper bound of the retransmission timeout, including backoff.
+     * @return The maximum RTO.
+     */
+    std::chrono::nanoseconds
+    getMaxRto() const { return maxRto_; }
+
+    /**
+     * Get the longest time to retry without receiving a new segment before
+     * calling onError with INTEREST_TIMEOUT.
+     * @return The maximum timeout.
+     */
+    std::chrono::nanoseconds
+    getMaxTimeout() const { return maxTimeout_; }
+
+    /**
+     * Set the number of Interests in flight when the fetch starts.
+     * @param initialWindow The initial window, at least 1.
+     * @return This Options so that you can chain calls to update values.
+     */
+    Options&
+    setInitialWindow(double initialWindow)
+    {
+      initialWindow_ = initialWindow;
+      return *this;
+    }
+
+    /**
+     * Set the largest number of Interests in flight.
+     * @param maxWindow The maximum window, at least 1.
+     * @return This Options so that you can chain calls to update values.
+     */
+    Options&
+    setMaxWindow(double maxWindow)
+    {
+      maxWindow_ = maxWindow;
+      return *this;
+    }
+
+    /**
+     * Set how the window changes during the fetch.
+     * @param congestionControl The CongestionControl enum value.
+     * @return This Options so that you can chain calls to update values.
+     */
+    Options&
+    setCongestionControl(CongestionControl congestionControl)
+    {
+      congestionControl_ = congestionControl;
+      return *this;
+    }
+
+    /**
+     * Set the number of segments which AIMD adds to the window for each round
+     * trip, and which slow start adds for each received segment.
+     * @param additiveIncrease The additive increase.
+     * @return This Options so that you can chain calls to update values.
+     */
+    Options&
+    setAdditiveIncrease(double additiveIncrease)
+    {
+      additiveIncrease_ = additiveIncrease;
+      return *this;
+    }
+
+    /**
+     * Set the factor which AIMD multiplies the window by on congestion.
+     * @param multiplicativeDecrease The multiplicative decrease, between 0
+     * and 1.
+     * @return This Options so that you can chain calls to update values.
+     */
+    Options&
+    setMultiplicativeDecrease(double multiplicativeDecrease)
+    {
+      multiplicativeDecrease_ = multiplicativeDecrease;
+      return *this;
+    }
+
+    /**
+     * Set the factor which CUBIC multiplies the window by on congestion.
+     * @param cubicBeta The CUBIC beta, between 0 and 1.
+     * @return This Options so that you can chain calls to update values.
+     */
+    Options&
+    setCubicBeta(double cubicBeta)
+    {
+      cubicBeta_ = cubicBeta;
+      return *this;
+    }
+
+    /**
+     * Set whether the window ignores the CongestionMark of received Data.
+     * @param ignoreCongestionMarks True to ignore congestion marks.
+     * @return This Options so that you can chain calls to update values.
+     */
+    Options&
+    setIgnoreCongestionMarks(bool ignoreCongestionMarks)
+    {
+      ignoreCongestionMarks_ = ignoreCongestionMarks;
+      return *this;
+    }
+
+    /**
+     * Set the callback for streaming the segments. When each segment and the
+     * segments before it have arrived, the fetch calls
+     * onSegment(segmentNumber, content) and doesn't keep the content, and
+     * calls onComplete with an isNull() Blob after the final segment. If
+     * onSegment throws an exception, the fetch stops and calls onError with
+     * IO_ERROR.
+     * @param onSegment The OnSegment callback, or an empty OnSegment() to
+     * concatenate the content for onComplete. This copies the function
+     * object.
+     * @return This Options so that you can chain calls to update values.
+     */
+    Options&
+    setOnSegment(const OnSegment& onSegment)
+    {
+      onSegment_ = onSegment;
+      return *this;
+    }
+
+    /**
+     * Set the retransmission timeout before there is a round-trip time
+     * measurement.
+     * @param initialRto The initial RTO.
+     * @return This Options so that you can chain calls to update values.
+     */
+    Options&
+    setInitialRto(std::chrono::nanoseconds initialRto)
+    {
+      initialRto_ = initialRto;
+      return *this;
+    }
+
+    /**
+     * Set the lower bound of the retransmission timeout.
+     * @param minRto The minimum RTO.
+     * @return This Options so that you can chain calls to update values.
+     */
+    Options&
+    setMinRto(std::chrono::nanoseconds minRto)
+    {
+      minRto_ = minRto;
+      return *this;
+    }
+
+    /**
+     * Set the upper bound of the retransmission timeout, including backoff.
+     * @param maxRto The maximum RTO.
+     * @return This Options so that you can chain calls to update values.
+     */
+    Options&
+    setMaxRto(std::chrono::nanoseconds maxRto)
+    {
+      maxRto_ = maxRto;
+      return *this;
+    }
+
+    /**
+     * Set the longest time to retry without receiving a new segment before
+     * calling onError with INTEREST_TIMEOUT.
+     * @param maxTimeout The maximum timeout.
+     * @return This Options so that you can chain calls to update values.
+     */
+    Options&
+    setMaxTimeout(std::chrono::nanoseconds maxTimeout)
+    {
+      maxTimeout_ = maxTimeout;
+      return *this;
+    }
+
+  private:
+    double initialWindow_;
+    double maxWindow_;
+    CongestionControl congestionControl_;
+    double additiveIncrease_;
+    double multiplicativeDecrease_;
+    double cubicBeta_;
+    bool ignoreCongestionMarks_;
+    OnSegment onSegment_;
+    std::chrono::nanoseconds initialRto_;
+    std::chrono::nanoseconds minRto_;
+    std::chrono::nanoseconds maxRto_;
+    std::chrono::nanoseconds maxTimeout_;
   };
 
   typedef func_lib::function<bool(const ptr_lib::shared_ptr<Data>& data)> VerifySegment;
@@ -151,7 +471,90 @@ public:
     (Face& face, const Interest &baseInterest, const VerifySegment& verifySegment,
      const OnComplete& onComplete, const OnError& onError);
 
+  /**
+   * Initiate a pipelined segment fetch which keeps a window of Interests in
+   * flight, as described for the class. This is the same as the other fetch
+   * method, except that the InterestLifetime of each Interest after the first
+   * is the retransmission timeout, and a timeout or a Nack with the reason
+   * Congestion or Duplicate re-expresses the Interest.
+   * @param face This calls face.expressInterest to fetch more segments.
+   * @param baseInterest An Interest for the initial segment of the requested
+   * data, where baseInterest.getName() has the name prefix. See the other
+   * fetch method.
+   * @param verifySegment When a Data packet is received this calls
+   * verifySegment(data). See the other fetch method.
+   * @param onComplete When all segments are received, call
+   * onComplete(content) where content is the concatenation of the content of
+   * all the segments.
+   * NOTE: The library will log any exceptions thrown by this callback, but for
+   * better error handling the callback should catch and properly handle any
+   * exceptions.
+   * @param onError Call onError(errorCode, message) for timeout, a Nack or an
+   * error processing segments.
+   * NOTE: The library will log any exceptions thrown by this callback, but for
+   * better error handling the callback should catch and properly handle any
+   * exceptions.
+   * @param options The Options for the window, the retransmission timeout and
+   * streaming.
+   * @return The SegmentFetcher, which you can use to pause() and resume(). If
+   * you don't call pause(), you don't need to keep it since the pending
+   * Interests keep it allocated. But to call pause() and resume() you must keep
+   * it, since once the Interests in flight are processed nothing else refers to
+   * a paused SegmentFetcher.
+   * @throws runtime_error if baseInterest has ApplicationParameters.
+   */
+  static ptr_lib::shared_ptr<SegmentFetcher>
+  fetch
+    (Face& face, const Interest &baseInterest, const VerifySegment& verifySegment,
+     const OnComplete& onComplete, const OnError& onError,
+     const Options& options);
+
+  /**
+   * Stop expressing Interests and calling OnSegment until resume() is
+   * called. The Interests already in flight are still processed and their
+   * segments are held. This may be called from the OnSegment callback. The
+   * time paused does not count toward the Options maxTimeout. The caller must
+   * keep the shared_ptr returned by fetch until calling resume(), since a
+   * paused SegmentFetcher with no Interests in flight is otherwise freed.
+   */
+  void
+  pause() { isPaused_ = true; }
+
+  /**
+   * Call OnSegment for the held segments and express Interests again.
+   */
+  void
+  resume();
+
+  /**
+   * Check if pause() was called without resume().
+   * @return True if paused.
+   */
+  bool
+  isPaused() const { return isPaused_; }
+
+  /**
+   * Make an OnSegment which writes the content of each segment to the file
+   * descriptor, such as a file opened for writing or a pipe.
+   * @param fileDescriptor The file descriptor, which the caller must close
+   * after the fetch.
+   * @return The OnSegment callback to use with Options setOnSegment. It
+   * throws runtime_error if the write fails.
+   */
+  static OnSegment
+  makeFileDescriptorSink(int fileDescriptor);
+
 private:
+  /**
+   * A PendingSegment holds the state of a segment Interest in flight in a
+   * pipelined fetch.
+   */
+  struct PendingSegment {
+    std::chrono::steady_clock::time_point sendTime;
+    bool isRetransmission;
+    uint64_t pendingInterestId;
+  };
+
   /**
    * Create a new SegmentFetcher to use the Face. See the static fetch method
    * for details. After creating the SegmentFetcher, call fetchFirstSegment.
@@ -160,10 +563,22 @@ private:
     (Face& face, const VerifySegment& verifySegment,
      const OnComplete& onComplete, const OnError& onError)
   : face_(face), verifySegment_(verifySegment), onComplete_(onComplete),
-    onError_(onError)
+    onError_(onError), isStopped_(false), isPaused_(false),
+    hasFinalSegment_(false), finalSegment_(0), nextSegmentToRequest_(0),
+    nextSegmentToDeliver_(0), recoveryPoint_(0), window_(1),
+    ssthresh_(0), cubicMaxWindow_(0), hasRttMeasurement_(false)
   {
   }
 
+  /**
+   * Create a new SegmentFetcher for a pipelined fetch. After creating the
+   * SegmentFetcher, call fetchFirstPipelinedSegment.
+   */
+  SegmentFetcher
+    (Face& face, const VerifySegment& verifySegment,
+     const OnComplete& onComplete, const OnError& onError,
+     const Options& options);
+
   void
   fetchFirstSegment(const Interest& baseInterest);
 
@@ -188,6 +603,93 @@ private:
   void
   onTimeout(const ptr_lib::shared_ptr<const Interest>& interest);
 
+  void
+  fetchFirstPipelinedSegment();
+
+  /**
+   * Express the Interest for the segment with the retransmission timeout as
+   * the lifetime, and add it to pending_.
+   */
+  void
+  sendSegmentInterest(uint64_t segment, bool isRetransmission);
+
+  /**
+   * Send Interests for retransmissions and then new segments until the
+   * window is full.
+   */
+  void
+  fillWindow();
+
+  void
+  onPipelinedData
+    (const ptr_lib::shared_ptr<const Interest>& interest,
+     const ptr_lib::shared_ptr<Data>& data);
+
+  void
+  onPipelinedTimeout(const ptr_lib::shared_ptr<const Interest>& interest);
+
+  void
+  onPipelinedNetworkNack
+    (const ptr_lib::shared_ptr<const Interest>& interest,
+     const ptr_lib::shared_ptr<NetworkNack>& networkNack);
+
+  /**
+   * Remove the pending Interest for the segment of the interest name, and
+   * queue it for retransmission. If no segment has been received within
+   * Options maxTimeout, then stop and call onError with INTEREST_TIMEOUT.
+   * @param interest The Interest which timed out or was Nacked.
+   * @param isCongestion True to decrease the window.
+   * @param backOff True to double the retransmission timeout.
+   */
+  void
+  retransmit
+    (const ptr_lib::shared_ptr<const Interest>& interest, bool isCongestion,
+     bool backOff);
+
+  /**
+   * Update the smoothed round-trip time and the retransmission timeout as in
+   * RFC 6298.
+   * @param rtt The measured round-trip time.
+   */
+  void
+  addRttMeasurement(std::chrono::nanoseconds rtt);
+
+  void
+  increaseWindow();
+
+  /**
+   * Decrease the window once per window of Interests, for the first
+   * congestion signal of a segment at or after the recovery point.
+   * @param segment The segment number of the congestion signal.
+   */
+  void
+  decreaseWindow(uint64_t segment);
+
+  /**
+   * Deliver the segments starting at nextSegmentToDeliver_ while not paused,
+   * and finish if the final segment is delivered.
+   */
+  void
+  deliverSegments();
+
+  /**
+   * Remove all pending Interests so that no more callbacks are processed.
+   */
+  void
+  stop();
+
+  /**
+   * Concatenate contentParts_ and call onComplete_.
+   */
+  void
+  callOnComplete();
+
+  /**
+   * Stop and call onError_, logging any exception.
+   */
+  void
+  callOnError(ErrorCode errorCode, const std::string& message);
+
   /**
    * Check if the last component in the name is a segment number.
    * @param name The name to check.
@@ -200,10 +702,38 @@ private:
   }
 
   std::vector<Blob> contentParts_;
+  // The template for the Interest for each segment after the first.
+  ptr_lib::shared_ptr<InterestEncodingTemplate> nextSegmentTemplate_;
   Face& face_;
   VerifySegment verifySegment_;
   OnComplete onComplete_;
   OnError onError_;
+
+  // The following are only used for a pipelined fetch.
+  Options options_;
+  Interest baseInterest_;
+  bool isStopped_;
+  bool isPaused_;
+  bool hasFinalSegment_;
+  uint64_t finalSegment_;
+  uint64_t nextSegmentToRequest_;
+  uint64_t nextSegmentToDeliver_;
+  // The received segments from nextSegmentToDeliver_, keyed by number.
+  std::map<uint64_t, Blob> receivedSegments_;
+  std::map<uint64_t, PendingSegment> pending_;
+  std::deque<uint64_t> retransmitQueue_;
+  // A congestion signal for a segment before this is in the same window as
+  // the last decrease.
+  uint64_t recoveryPoint_;
+  double window_;
+  double ssthresh_;
+  double cubicMaxWindow_;
+  std::chrono::steady_clock::time_point lastDecreaseTime_;
+  std::chrono::steady_clock::time_point lastSegmentTime_;
+  bool hasRttMeasurement_;
+  std::chrono::nanoseconds smoothedRtt_;
+  std::chrono::nanoseconds rttVariation_;
+  std::chrono::nanoseconds rto_;
 };
 
 }
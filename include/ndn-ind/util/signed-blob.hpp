@@ -9,6 +9,7 @@
  * Original repository: https://github.com/named-data/ndn-cpp
  *
  * Summary of Changes: Use NDN_IND macros. Support ndn_ind_dll.
+ * Support Blob slices.
  *
  * which was originally released under the LGPL license with the following rights:
  *
@@ -156,7 +157,7 @@ public:
   signedBuf() const
   {
     if (*this)
-      return &(*this)->front() + signedPortionBeginOffset_;
+      return buf() + signedPortionBeginOffset_;
     else
       return 0;
   }
@@ -182,7 +183,7 @@ public:
   {
     if (*this)
       return BlobLite
-        (&(*this)->front() + signedPortionBeginOffset_,
+        (buf() + signedPortionBeginOffset_,
          signedPortionEndOffset_ - signedPortionBeginOffset_);
     else
       return BlobLite();
@@ -7,7 +7,7 @@
  * Original file: src/c/encoding/tlv/tlv-encoder.c
  * Original repository: https://github.com/named-data/ndn-cpp
  *
- * Summary of Changes: Use NDN_IND macros.
+ * Summary of Changes: Use NDN_IND macros. Size the output once in writeNestedTlv.
  *
  * which was originally released under the LGPL license with the following rights:
  *
@@ -246,6 +246,14 @@ ndn_TlvEncoder_writeNestedTlv
     self->offset = saveOffset;
     self->enableOutput = 1;
 
+    // The first pass gave the length of the whole TLV, so make room for it
+    // with one reallocation. (For the outermost TLV, this sizes the output for
+    // the whole packet, and the nested TLVs don't need to reallocate.)
+    if ((error = ndn_DynamicUInt8Array_ensureLength
+         (self->output, saveOffset + ndn_TlvEncoder_sizeOfVarNumber(type) +
+          ndn_TlvEncoder_sizeOfVarNumber(valueLength) + valueLength)))
+      return error;
+
     // Now, write the output.
     if ((error = ndn_TlvEncoder_writeTypeAndLength(self, type, valueLength)))
       return error;
@@ -7,7 +7,7 @@
  * Original file: src/c/encoding/tlv/tlv-encoder.h
  * Original repository: https://github.com/named-data/ndn-cpp
  *
- * Summary of Changes: Use ndn-ind includes.
+ * Summary of Changes: Use ndn-ind includes. Size the output once in writeNestedTlv.
  *
  * which was originally released under the LGPL license with the following rights:
  *
@@ -371,7 +371,9 @@ ndn_TlvEncoder_writeOptionalNonNegativeIntegerTlvFromDouble(struct ndn_TlvEncode
  * Make a first pass to call writeValue with self->enableOutput = 0 to determine the length of the TLV. Then set
  * self->enableOutput = 1 and write the type and length to self->output and call writeValue again to write the
  * TLVs in the body of the value.  This is to solve the problem of finding the length when the value of a TLV has
- * nested TLVs.  However, if self->enableOutput is already 0 when this is called, then just advance self->offset without
+ * nested TLVs.  Before writing, this ensures that self->output has room for the whole TLV, so that the output for a
+ * whole packet is reallocated at most once.  (If self->output starts with zero length, the new length is exact.)
+ * However, if self->enableOutput is already 0 when this is called, then just advance self->offset without
  * writing to output.
  * @param self A pointer to the ndn_TlvEncoder struct.
  * @param type the type of the TLV.
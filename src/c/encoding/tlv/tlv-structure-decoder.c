@@ -1,4 +1,16 @@
 /**
+ * Copyright (C) 2020 Operant Networks, Incorporated.
+ * @author: Jeff Thompson <jefft0@gmail.com>
+ *
+ * This works is based substantially on previous work as listed below:
+ *
+ * Original file: src/c/encoding/tlv/tlv-structure-decoder.c
+ * Original repository: https://github.com/named-data/ndn-cpp
+ *
+ * Summary of Changes: Decode a whole header in one step.
+ *
+ * which was originally released under the LGPL license with the following rights:
+ *
  * Copyright (C) 2014-2020 Regents of the University of California.
  * @author: Jeff Thompson <jefft0@remap.ucla.edu>
  *
@@ -34,6 +46,97 @@ ndn_TlvStructureDecoder_reset(struct ndn_TlvStructureDecoder *self)
   self->nBytesToRead = 0;
 }
 
+/**
+ * Read a VAR-NUMBER in NDN-TLV starting at input[*offset], if all of its bytes
+ * are in the input.
+ * @param input The input buffer.
+ * @param inputLength The number of bytes in input.
+ * @param offset The offset of the first octet. If this returns 1, update it to
+ * the offset after the VAR-NUMBER.
+ * @param varNumber Set this to the VAR-NUMBER.
+ * @return 1 if read the VAR-NUMBER, or 0 if the input doesn't have all of
+ * its bytes.
+ */
+static __inline int
+readVarNumber
+  (const uint8_t *input, size_t inputLength, size_t *offset,
+   uint64_t *varNumber)
+{
+  const uint8_t *p = input + *offset;
+  size_t nRemainingBytes = inputLength - *offset;
+
+  if (nRemainingBytes < 1)
+    return 0;
+  if (p[0] < 253) {
+    *varNumber = p[0];
+    *offset += 1;
+  }
+  else if (p[0] == 253) {
+    if (nRemainingBytes < 3)
+      return 0;
+    *varNumber = ((uint64_t)p[1] << 8) | p[2];
+    *offset += 3;
+  }
+  else if (p[0] == 254) {
+    if (nRemainingBytes < 5)
+      return 0;
+    *varNumber = ((uint64_t)p[1] << 24) | ((uint64_t)p[2] << 16) |
+      ((uint64_t)p[3] << 8) | p[4];
+    *offset += 5;
+  }
+  else {
+    if (nRemainingBytes < 9)
+      return 0;
+    *varNumber = ((uint64_t)p[1] << 56) | ((uint64_t)p[2] << 48) |
+      ((uint64_t)p[3] << 40) | ((uint64_t)p[4] << 32) |
+      ((uint64_t)p[5] << 24) | ((uint64_t)p[6] << 16) |
+      ((uint64_t)p[7] << 8) | p[8];
+    *offset += 9;
+  }
+
+  return 1;
+}
+
+/**
+ * If this is the start of an element and its whole type and length are in the
+ * input, decode them in one step and skip to the end of the value, so that the
+ * state machine is only needed for a header which is split across inputs.
+ * @param self A pointer to the ndn_TlvStructureDecoder struct.
+ * @param input The input buffer.
+ * @param inputLength The number of bytes in input.
+ * @return 1 if this updated self, or 0 to use the state machine.
+ */
+static __inline int
+findElementEndFast
+  (struct ndn_TlvStructureDecoder *self, const uint8_t *input,
+   size_t inputLength)
+{
+  size_t headerLength = 0;
+  uint64_t type;
+  uint64_t valueLength;
+
+  if (self->state != ndn_TlvStructureDecoder_READ_TYPE || self->offset != 0)
+    return 0;
+  if (!readVarNumber(input, inputLength, &headerLength, &type) ||
+      !readVarNumber(input, inputLength, &headerLength, &valueLength))
+    return 0;
+
+  if (valueLength <= (uint64_t)(inputLength - headerLength)) {
+    // The whole element is in the input.
+    self->offset = headerLength + (size_t)valueLength;
+    self->gotElementEnd = 1;
+  }
+  else {
+    // Read the rest of the value bytes from later input.
+    self->offset = inputLength;
+    // Silently ignore if the length is larger than size_t.
+    self->nBytesToRead = (size_t)valueLength - (inputLength - headerLength);
+    self->state = ndn_TlvStructureDecoder_READ_VALUE_BYTES;
+  }
+
+  return 1;
+}
+
 ndn_Error
 ndn_TlvStructureDecoder_findElementEnd(struct ndn_TlvStructureDecoder *self, const uint8_t *input, size_t inputLength)
 {
@@ -43,6 +146,9 @@ ndn_TlvStructureDecoder_findElementEnd(struct ndn_TlvStructureDecoder *self, con
     // Someone is calling when we already got the end.
     return NDN_ERROR_success;
 
+  if (findElementEndFast(self, input, inputLength))
+    return NDN_ERROR_success;
+
   ndn_TlvDecoder_initialize(&decoder, input, inputLength);
 
   while (1) {
@@ -7,7 +7,7 @@
  * Original file: src/c/transport/socket-transport.c
  * Original repository: https://github.com/named-data/ndn-cpp
  *
- * Summary of Changes: Use ndn-ind includes. Support WinSock2.
+ * Summary of Changes: Use ndn-ind includes. Support WinSock2. Add sendBuffers. Add waitForReceive.
  *
  * which was originally released under the LGPL license with the following rights:
  *
@@ -30,6 +30,11 @@
  * A copy of the GNU Lesser General Public License is in the file COPYING.
  */
 
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+// For sendmmsg.
+#define _GNU_SOURCE
+#endif
+
 // Only compile if we have Unix or Windows socket support.
 #include <ndn-ind/ndn-ind-config.h>
 #if NDN_IND_HAVE_UNISTD_H || defined(_WIN32)
@@ -42,6 +47,7 @@
 #include <sys/types.h>
 #include <netinet/in.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <sys/un.h>
 #include <arpa/inet.h>
 #include <poll.h>
@@ -75,6 +81,11 @@ isValidSocket(int sock) { return sock >= 0; }
 static int DidWSAStartup = 0;
 #endif
 
+/**
+ * The maximum number of buffers for one call to writev or sendmmsg.
+ */
+#define MAX_SEND_BUFFERS 64
+
 ndn_Error ndn_SocketTransport_connect
   (struct ndn_SocketTransport *self, ndn_SocketType socketType, const char *host,
    unsigned short port, struct ndn_ElementListener *elementListener)
@@ -189,13 +200,106 @@ ndn_Error ndn_SocketTransport_send(struct ndn_SocketTransport *self, const uint8
       break;
 
     // Send more.
+    data += nBytes;
     dataLength -= nBytes;
   }
 
   return NDN_ERROR_success;
 }
 
+ndn_Error ndn_SocketTransport_sendBuffers
+  (struct ndn_SocketTransport *self, ndn_SocketType socketType,
+   const struct ndn_Blob *buffers, size_t nBuffers)
+{
+  size_t i;
+  ndn_Error error;
+
+  if (!isValidSocket(self->socketDescriptor))
+    return NDN_ERROR_SocketTransport_socket_is_not_open;
+
+#if NDN_IND_HAVE_UNISTD_H
+  if (socketType == SOCKET_TCP || socketType == SOCKET_UNIX) {
+    struct iovec vectors[MAX_SEND_BUFFERS];
+    // The number of bytes of buffers[0] which were already sent.
+    size_t offset = 0;
+
+    while (nBuffers > 0) {
+      size_t nVectors = nBuffers < MAX_SEND_BUFFERS ? nBuffers : MAX_SEND_BUFFERS;
+      ssize_t nBytes;
+      size_t nBytesSent;
+
+      for (i = 0; i < nVectors; ++i) {
+        vectors[i].iov_base = (void *)buffers[i].value;
+        vectors[i].iov_len = buffers[i].length;
+      }
+      vectors[0].iov_base = (void *)(buffers[0].value + offset);
+      vectors[0].iov_len -= offset;
+
+      if ((nBytes = writev(self->socketDescriptor, vectors, (int)nVectors)) < 0)
+        return NDN_ERROR_SocketTransport_error_in_send;
+
+      // Skip the buffers which were completely sent, and continue after a
+      // partial write.
+      nBytesSent = offset + (size_t)nBytes;
+      while (nBuffers > 0 && nBytesSent >= buffers[0].length) {
+        nBytesSent -= buffers[0].length;
+        ++buffers;
+        --nBuffers;
+      }
+      offset = nBytesSent;
+    }
+
+    return NDN_ERROR_success;
+  }
+#if defined(__linux__)
+  else if (socketType == SOCKET_UDP) {
+    struct mmsghdr messages[MAX_SEND_BUFFERS];
+    struct iovec vectors[MAX_SEND_BUFFERS];
+
+    while (nBuffers > 0) {
+      size_t nMessages = nBuffers < MAX_SEND_BUFFERS ? nBuffers : MAX_SEND_BUFFERS;
+      int nSent;
+
+      ndn_memset((uint8_t *)messages, 0, nMessages * sizeof(messages[0]));
+      for (i = 0; i < nMessages; ++i) {
+        vectors[i].iov_base = (void *)buffers[i].value;
+        vectors[i].iov_len = buffers[i].length;
+        messages[i].msg_hdr.msg_iov = &vectors[i];
+        messages[i].msg_hdr.msg_iovlen = 1;
+      }
+
+      if ((nSent = sendmmsg
+           (self->socketDescriptor, messages, (unsigned int)nMessages, 0)) <= 0)
+        return NDN_ERROR_SocketTransport_error_in_send;
+
+      // sendmmsg may send fewer messages, so continue with the rest.
+      buffers += nSent;
+      nBuffers -= (size_t)nSent;
+    }
+
+    return NDN_ERROR_success;
+  }
+#endif
+#endif
+
+  for (i = 0; i < nBuffers; ++i) {
+    if ((error = ndn_SocketTransport_send
+         (self, buffers[i].value, buffers[i].length)))
+      return error;
+  }
+
+  return NDN_ERROR_success;
+}
+
 ndn_Error ndn_SocketTransport_receiveIsReady(struct ndn_SocketTransport *self, int *receiveIsReady)
+{
+  return ndn_SocketTransport_waitForReceive(self, 0, receiveIsReady);
+}
+
+ndn_Error
+ndn_SocketTransport_waitForReceive
+  (struct ndn_SocketTransport *self, int timeoutMilliseconds,
+   int *receiveIsReady)
 {
   int pollResult;
 #if defined(_WIN32)
@@ -215,15 +319,21 @@ ndn_Error ndn_SocketTransport_receiveIsReady(struct ndn_SocketTransport *self, i
 #if defined(_WIN32)
   pollInfo.fd = self->socketDescriptor;
   pollInfo.events = POLLRDNORM;
-  pollResult = WSAPoll(&pollInfo, 1, 0);
+  pollResult = WSAPoll(&pollInfo, 1, timeoutMilliseconds);
 #else
   pollInfo[0].fd = self->socketDescriptor;
   pollInfo[0].events = POLLIN;
-  pollResult = poll(pollInfo, 1, 0);
+  pollResult = poll(pollInfo, 1, timeoutMilliseconds);
 #endif
 
-  if (!isValidSocket(pollResult))
+  if (!isValidSocket(pollResult)) {
+#if !defined(_WIN32)
+    if (errno == EINTR)
+      // A signal interrupted the wait, so return as if a timeout.
+      return NDN_ERROR_success;
+#endif
     return NDN_ERROR_SocketTransport_error_in_poll;
+  }
   else if (pollResult == 0)
     // Timeout, so no data ready.
     return NDN_ERROR_success;
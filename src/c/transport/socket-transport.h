@@ -8,6 +8,7 @@
  * Original repository: https://github.com/named-data/ndn-cpp
  *
  * Summary of Changes: Use ndn-ind includes. Add readRawPackets. Support WinSock2.
+ * Add sendBuffers.
  *
  * which was originally released under the LGPL license with the following rights:
  *
@@ -36,6 +37,7 @@
 #include <ndn-ind/c/common.h>
 #include <ndn-ind/c/errors.h>
 #include <ndn-ind/c/transport/transport-types.h>
+#include <ndn-ind/c/util/blob-types.h>
 #include "../encoding/element-reader.h"
 
 #ifdef __cplusplus
@@ -103,6 +105,22 @@ ndn_Error ndn_SocketTransport_connect
  */
 ndn_Error ndn_SocketTransport_send(struct ndn_SocketTransport *self, const uint8_t *data, size_t dataLength);
 
+/**
+ * Send each buffer as a packet to the socket, using as few system calls as
+ * possible. For SOCKET_TCP and SOCKET_UNIX, this gathers the buffers with
+ * writev. For SOCKET_UDP, this sends each buffer as a datagram with sendmmsg
+ * (on Linux). If these are not available, this calls ndn_SocketTransport_send
+ * for each buffer.
+ * @param self A pointer to the ndn_SocketTransport struct.
+ * @param socketType The socket type given to ndn_SocketTransport_connect.
+ * @param buffers An array of ndn_Blob with the packets to send.
+ * @param nBuffers The number of entries in buffers.
+ * @return 0 for success, else an error code.
+ */
+ndn_Error ndn_SocketTransport_sendBuffers
+  (struct ndn_SocketTransport *self, ndn_SocketType socketType,
+   const struct ndn_Blob *buffers, size_t nBuffers);
+
 /**
  * Check if there is data ready on the socket to be received with ndn_SocketTransport_receive.
  * This does not block, and returns immediately.
@@ -112,6 +130,20 @@ ndn_Error ndn_SocketTransport_send(struct ndn_SocketTransport *self, const uint8
  */
 ndn_Error ndn_SocketTransport_receiveIsReady(struct ndn_SocketTransport *self, int *receiveIsReady);
 
+/**
+ * Wait until there is data ready on the socket to be received with
+ * ndn_SocketTransport_receive, or until the timeout.
+ * @param self A pointer to the ndn_SocketTransport struct.
+ * @param timeoutMilliseconds The maximum time to wait in milliseconds. If 0,
+ * don't wait, the same as ndn_SocketTransport_receiveIsReady.
+ * @param receiveIsReady This will be set to 1 if data is ready, 0 if not.
+ * @return 0 for success, else an error code.
+ */
+ndn_Error
+ndn_SocketTransport_waitForReceive
+  (struct ndn_SocketTransport *self, int timeoutMilliseconds,
+   int *receiveIsReady);
+
 /**
  * Receive data from the socket.  NOTE: This is a blocking call.  You should first call ndn_SocketTransport_receiveIsReady
  * to make sure there is data ready to receive.
@@ -7,7 +7,7 @@
  * Original file: src/c/transport/unix-transport.h
  * Original repository: https://github.com/named-data/ndn-cpp
  *
- * Summary of Changes: Add readRawPackets.
+ * Summary of Changes: Add readRawPackets. Add sendBuffers. Add waitForReceive.
  *
  * which was originally released under the LGPL license with the following rights:
  *
@@ -100,6 +100,38 @@ static __inline ndn_Error ndn_UnixTransport_send
   return ndn_SocketTransport_send(&self->base, data, dataLength);
 }
 
+/**
+ * Send each buffer as a packet to the socket, using as few system calls as
+ * possible. See ndn_SocketTransport_sendBuffers.
+ * @param self A pointer to the ndn_UnixTransport struct.
+ * @param buffers An array of ndn_Blob with the packets to send.
+ * @param nBuffers The number of entries in buffers.
+ * @return 0 for success, else an error code.
+ */
+static __inline ndn_Error ndn_UnixTransport_sendBuffers
+  (struct ndn_UnixTransport *self, const struct ndn_Blob *buffers,
+   size_t nBuffers)
+{
+  return ndn_SocketTransport_sendBuffers
+    (&self->base, SOCKET_UNIX, buffers, nBuffers);
+}
+
+/**
+ * Wait until there is data ready on the socket to be received, or until the
+ * timeout.
+ * @param self A pointer to the ndn_UnixTransport struct.
+ * @param timeoutMilliseconds The maximum time to wait in milliseconds.
+ * @param receiveIsReady This will be set to 1 if data is ready, 0 if not.
+ * @return 0 for success, else an error code.
+ */
+static __inline ndn_Error
+ndn_UnixTransport_waitForReceive
+  (struct ndn_UnixTransport *self, int timeoutMilliseconds, int *receiveIsReady)
+{
+  return ndn_SocketTransport_waitForReceive
+    (&self->base, timeoutMilliseconds, receiveIsReady);
+}
+
 /**
  * Process any data to receive.  For each element received, call
  * (*elementListener->onReceivedElement)(element, elementLength) for the
@@ -8,7 +8,8 @@
  * Original file: src/data.cpp
  * Original repository: https://github.com/named-data/ndn-cpp
  *
- * Summary of Changes: Use ndn-ind includes.
+ * Summary of Changes: Use ndn-ind includes. Share a backing Blob in set. Add wireDecodeLazy.
+ * Add wireDecodeShared.
  *
  * which was originally released under the LGPL license with the following rights:
  *
@@ -38,7 +39,10 @@
 #include <ndn-ind/sha256-with-rsa-signature.hpp>
 #include <ndn-ind/hmac-with-sha256-signature.hpp>
 #include <ndn-ind/generic-signature.hpp>
+#include <ndn-ind/encoding/tlv-0_3-wire-format.hpp>
+#include <ndn-ind/lite/encoding/tlv-0_3-wire-format-lite.hpp>
 #include "c/data.h"
+#include "c/encoding/tlv/tlv-decoder.h"
 #include "lp/incoming-face-id.hpp"
 #include "lp/congestion-mark.hpp"
 #include <ndn-ind/lite/util/crypto-lite.hpp>
@@ -52,7 +56,10 @@ Data::Data()
 : signature_(new Sha256WithRsaSignature()),
   changeCount_(0),
   defaultFullName_(new Name()),
-  getDefaultWireEncodingChangeCount_(0)
+  getDefaultWireEncodingChangeCount_(0),
+  isMetaInfoLazy_(false),
+  isSignatureLazy_(false),
+  lazyWireFormat_(0)
 {
 }
 
@@ -61,7 +68,10 @@ Data::Data(const Name& name)
   signature_(new Sha256WithRsaSignature()),
   changeCount_(0),
   defaultFullName_(new Name()),
-  getDefaultWireEncodingChangeCount_(0)
+  getDefaultWireEncodingChangeCount_(0),
+  isMetaInfoLazy_(false),
+  isSignatureLazy_(false),
+  lazyWireFormat_(0)
 {
 }
 
@@ -70,7 +80,15 @@ Data::Data(const Data& data)
   metaInfo_(data.metaInfo_),
   content_(data.content_),
   defaultFullName_(new Name(*data.defaultFullName_)),
-  changeCount_(0)
+  changeCount_(0),
+  isMetaInfoLazy_(data.isMetaInfoLazy_),
+  isSignatureLazy_(data.isSignatureLazy_),
+  lazyMetaInfo_(data.lazyMetaInfo_),
+  lazyEncoding_(data.lazyEncoding_),
+  lazyWireFormat_(data.lazyWireFormat_),
+  lazySignatureInfoOffset_(data.lazySignatureInfoOffset_),
+  lazySignatureValueOffset_(data.lazySignatureValueOffset_),
+  lazySignatureValueEndOffset_(data.lazySignatureValueEndOffset_)
 {
   if (data.signature_.get()) {
     signature_.set(data.signature_.get()->clone());
@@ -94,6 +112,15 @@ Data& Data::operator=(const Data& data)
   setName(data.name_.get());
   setMetaInfo(data.metaInfo_.get());
   setContent(data.content_);
+  // setMetaInfo and setSignature cleared the lazy flags, so copy them.
+  isMetaInfoLazy_ = data.isMetaInfoLazy_;
+  isSignatureLazy_ = data.isSignatureLazy_;
+  lazyMetaInfo_ = data.lazyMetaInfo_;
+  lazyEncoding_ = data.lazyEncoding_;
+  lazyWireFormat_ = data.lazyWireFormat_;
+  lazySignatureInfoOffset_ = data.lazySignatureInfoOffset_;
+  lazySignatureValueOffset_ = data.lazySignatureValueOffset_;
+  lazySignatureValueEndOffset_ = data.lazySignatureValueEndOffset_;
   setDefaultWireEncoding
     (data.defaultWireEncoding_, data.defaultWireEncodingFormat_);
 
@@ -148,14 +175,14 @@ Data::getFullName(WireFormat& wireFormat) const
 void
 Data::get(DataLite& dataLite) const
 {
-  signature_.get()->get(dataLite.getSignature());
+  getSignature()->get(dataLite.getSignature());
   name_.get().get(dataLite.getName());
-  metaInfo_.get().get(dataLite.getMetaInfo());
+  getMetaInfo().get(dataLite.getMetaInfo());
   dataLite.setContent(content_);
 }
 
 void
-Data::set(const DataLite& dataLite)
+Data::set(const DataLite& dataLite, const Blob& backing)
 {
   if (dataLite.getSignature().getType() == ndn_SignatureType_Sha256WithRsaSignature)
     signature_.set(ptr_lib::shared_ptr<Signature>(new Sha256WithRsaSignature()));
@@ -172,10 +199,13 @@ Data::set(const DataLite& dataLite)
     throw runtime_error("dataLite.getSignature().getType() has an unrecognized value");
 
   signature_.get()->set(dataLite.getSignature());
+  isSignatureLazy_ = false;
 
-  name_.get().set(dataLite.getName());
+  name_.get().set(dataLite.getName(), backing);
   metaInfo_.get().set(dataLite.getMetaInfo());
-  setContent(Blob(dataLite.getContent()));
+  isMetaInfoLazy_ = false;
+  lazyEncoding_ = Blob();
+  setContent(Blob(dataLite.getContent(), backing));
 }
 
 Data&
@@ -209,7 +239,9 @@ void
 Data::wireDecode(const Blob& input, WireFormat& wireFormat)
 {
   size_t signedPortionBeginOffset, signedPortionEndOffset;
-  wireFormat.decodeData(*this, input.buf(), input.size(), &signedPortionBeginOffset, &signedPortionEndOffset);
+  wireFormat.decodeData
+    (*this, input.buf(), input.size(), &signedPortionBeginOffset,
+     &signedPortionEndOffset);
 
   if (&wireFormat == WireFormat::getDefaultWireFormat())
     // This is the default wire encoding.
@@ -221,4 +253,115 @@ Data::wireDecode(const Blob& input, WireFormat& wireFormat)
     setDefaultWireEncoding(SignedBlob(), 0);
 }
 
+void
+Data::wireDecodeShared(const Blob& input, WireFormat& wireFormat)
+{
+  size_t signedPortionBeginOffset, signedPortionEndOffset;
+  // Use the Blob so that the wire format can share its buffer.
+  wireFormat.decodeData
+    (*this, input, &signedPortionBeginOffset, &signedPortionEndOffset);
+
+  if (&wireFormat == WireFormat::getDefaultWireFormat())
+    // This is the default wire encoding.
+    // Take a pointer to the input Blob without copying.
+    setDefaultWireEncoding
+      (SignedBlob(input, signedPortionBeginOffset, signedPortionEndOffset),
+       WireFormat::getDefaultWireFormat());
+  else
+    setDefaultWireEncoding(SignedBlob(), 0);
+}
+
+void
+Data::wireDecodeLazy(const Blob& input, WireFormat& wireFormat)
+{
+  if (!dynamic_cast<Tlv0_3WireFormat*>(&wireFormat)) {
+    wireDecode(input, wireFormat);
+    return;
+  }
+
+  struct ndn_NameComponent nameComponents[100];
+  struct ndn_NameComponent keyNameComponents[100];
+  DataLite dataLite
+    (nameComponents, sizeof(nameComponents) / sizeof(nameComponents[0]),
+     keyNameComponents, sizeof(keyNameComponents) / sizeof(keyNameComponents[0]));
+
+  // This checks the whole encoding, but only makes pointers into the input.
+  size_t signedPortionBeginOffset, signedPortionEndOffset;
+  ndn_Error error;
+  if ((error = Tlv0_3WireFormatLite::decodeData
+       (dataLite, input.buf(), input.size(), &signedPortionBeginOffset,
+        &signedPortionEndOffset)))
+    throw runtime_error(ndn_getErrorString(error));
+
+  // The SignatureInfo ends at the signed portion end, so find where it starts
+  // by skipping the TLVs before it.
+  struct ndn_TlvDecoder decoder;
+  ndn_TlvDecoder_initialize(&decoder, input.buf(), input.size());
+  ndn_TlvDecoder_seek(&decoder, signedPortionBeginOffset);
+  size_t signatureInfoOffset;
+  while (true) {
+    signatureInfoOffset = decoder.offset;
+    uint64_t type, length;
+    if ((error = ndn_TlvDecoder_readVarNumber(&decoder, &type)) ||
+        (error = ndn_TlvDecoder_readVarNumber(&decoder, &length)))
+      throw runtime_error(ndn_getErrorString(error));
+    if (type == ndn_Tlv_SignatureInfo)
+      break;
+    ndn_TlvDecoder_seek(&decoder, decoder.offset + (size_t)length);
+  }
+
+  name_.get().set(dataLite.getName(), input);
+  setContent(Blob(dataLite.getContent(), input));
+
+  lazyMetaInfo_ = dataLite.getMetaInfo();
+  lazyEncoding_ = input;
+  lazyWireFormat_ = &wireFormat;
+  lazySignatureInfoOffset_ = signatureInfoOffset;
+  lazySignatureValueOffset_ = signedPortionEndOffset;
+  const BlobLite& signatureValue = dataLite.getSignature().getSignature();
+  lazySignatureValueEndOffset_ =
+    (signatureValue.buf() + signatureValue.size()) - input.buf();
+  isMetaInfoLazy_ = true;
+  isSignatureLazy_ = true;
+
+  if (&wireFormat == WireFormat::getDefaultWireFormat())
+    setDefaultWireEncoding
+      (SignedBlob(input, signedPortionBeginOffset, signedPortionEndOffset),
+       WireFormat::getDefaultWireFormat());
+  else
+    setDefaultWireEncoding(SignedBlob(), 0);
+}
+
+void
+Data::decodeLazyMetaInfo()
+{
+  // The decoded values are the same, so keep the default wire encoding.
+  bool isEncodingCurrent =
+    (getDefaultWireEncodingChangeCount_ == getChangeCount());
+
+  metaInfo_.get().set(lazyMetaInfo_);
+  isMetaInfoLazy_ = false;
+
+  if (isEncodingCurrent)
+    getDefaultWireEncodingChangeCount_ = getChangeCount();
+}
+
+void
+Data::decodeLazySignature()
+{
+  bool isEncodingCurrent =
+    (getDefaultWireEncodingChangeCount_ == getChangeCount());
+
+  const uint8_t* encoding = lazyEncoding_.buf();
+  signature_.set(lazyWireFormat_->decodeSignatureInfoAndValue
+    (encoding + lazySignatureInfoOffset_,
+     lazySignatureValueOffset_ - lazySignatureInfoOffset_,
+     encoding + lazySignatureValueOffset_,
+     lazySignatureValueEndOffset_ - lazySignatureValueOffset_));
+  isSignatureLazy_ = false;
+
+  if (isEncodingCurrent)
+    getDefaultWireEncodingChangeCount_ = getChangeCount();
+}
+
 }
@@ -8,7 +8,7 @@
  * Original file: src/encoding/element-listener.cpp
  * Original repository: https://github.com/named-data/ndn-cpp
  *
- * Summary of Changes: Put element-listener.hpp in API.
+ * Summary of Changes: Put element-listener.hpp in API. Add onReceivedElement(Blob).
  *
  * which was originally released under the LGPL license with the following rights:
  *
@@ -32,6 +32,7 @@
  */
 
 #include "../c/encoding/element-listener.h"
+#include <ndn-ind/util/blob.hpp>
 #include <ndn-ind/encoding/element-listener.hpp>
 
 namespace ndn_ind {
@@ -41,6 +42,12 @@ ElementListener::ElementListener()
   ndn_ElementListener_initialize(this, staticOnReceivedElement);
 }
 
+void
+ElementListener::onReceivedElement(const Blob& element)
+{
+  onReceivedElement(element.buf(), element.size());
+}
+
 void
 ElementListener::staticOnReceivedElement(struct ndn_ElementListener *self, const uint8_t *element, size_t elementLength)
 {
@@ -8,7 +8,7 @@
  * Original file: src/encoding/tlv-0_2-wire-format.cpp
  * Original repository: https://github.com/named-data/ndn-cpp
  *
- * Summary of Changes: Use ndn-ind includes.
+ * Summary of Changes: Use ndn-ind includes. Encode to an exact-size buffer.
  *
  * which was originally released under the LGPL license with the following rights:
  *
@@ -47,6 +47,20 @@ Blob
 Tlv0_2WireFormat::encodeInterest
   (const Interest& interest, size_t *signedPortionBeginOffset,
    size_t *signedPortionEndOffset)
+{
+  // The encoder sizes the output to the exact encoding length, so the result
+  // is allocated once with no copy.
+  ptr_lib::shared_ptr<vector<uint8_t> > output =
+    ptr_lib::make_shared<vector<uint8_t> >();
+  encodeInterest
+    (interest, *output, signedPortionBeginOffset, signedPortionEndOffset);
+  return Blob(output, false);
+}
+
+void
+Tlv0_2WireFormat::encodeInterest
+  (const Interest& interest, vector<uint8_t>& output,
+   size_t *signedPortionBeginOffset, size_t *signedPortionEndOffset)
 {
   if (!interest.getDidSetCanBePrefix_() && !didCanBePrefixWarning_) {
     printf
@@ -64,15 +78,15 @@ Tlv0_2WireFormat::encodeInterest
   Blob blob1, blob2;
   interest.get(interestLite, *this, blob1, blob2);
 
-  DynamicUInt8Vector output(256);
+  DynamicUInt8Vector outputArray(output);
   ndn_Error error;
   size_t encodingLength;
   if ((error = Tlv0_2WireFormatLite::encodeInterest
        (interestLite, signedPortionBeginOffset, signedPortionEndOffset,
-        DynamicUInt8ArrayLite::downCast(output), &encodingLength)))
+        DynamicUInt8ArrayLite::downCast(outputArray), &encodingLength)))
     throw runtime_error(ndn_getErrorString(error));
 
-  return output.finish(encodingLength);
+  output.resize(encodingLength);
 }
 
 void
@@ -105,6 +119,16 @@ Tlv0_2WireFormat::decodeInterest
   interest.set(interestLite, *this);
 }
 
+void
+Tlv0_2WireFormat::decodeInterest
+  (Interest& interest, const Blob& input, size_t *signedPortionBeginOffset,
+   size_t *signedPortionEndOffset)
+{
+  decodeInterest
+    (interest, input.buf(), input.size(), signedPortionBeginOffset,
+     signedPortionEndOffset);
+}
+
 Tlv0_2WireFormat* Tlv0_2WireFormat::instance_ = 0;
 
 }
@@ -81,6 +81,22 @@ Blob
 Tlv0_3WireFormat::encodeInterest
   (const Interest& interest, size_t *signedPortionBeginOffset,
    size_t *signedPortionEndOffset)
+{
+  // The encoder sizes the output to the exact encoding length, so the result
+  // is allocated once with no copy. We don't encode into a pooled buffer
+  // because the returned Blob must own its bytes, so pooling would add a copy.
+  // To reuse a buffer, the caller can use the overload with an output vector.
+  ptr_lib::shared_ptr<vector<uint8_t> > output =
+    ptr_lib::make_shared<vector<uint8_t> >();
+  encodeInterest
+    (interest, *output, signedPortionBeginOffset, signedPortionEndOffset);
+  return Blob(output, false);
+}
+
+void
+Tlv0_3WireFormat::encodeInterest
+  (const Interest& interest, vector<uint8_t>& output,
+   size_t *signedPortionBeginOffset, size_t *signedPortionEndOffset)
 {
   if (!interest.getDidSetCanBePrefix_() && !didCanBePrefixWarning_) {
     printf
@@ -98,21 +114,42 @@ Tlv0_3WireFormat::encodeInterest
   Blob blob1, blob2;
   interest.get(interestLite, *this, blob1, blob2);
 
-  DynamicUInt8Vector output(256);
+  DynamicUInt8Vector outputArray(output);
   ndn_Error error;
   size_t encodingLength;
   if ((error = Tlv0_3WireFormatLite::encodeInterest
        (interestLite, signedPortionBeginOffset, signedPortionEndOffset,
-        DynamicUInt8ArrayLite::downCast(output), &encodingLength)))
+        DynamicUInt8ArrayLite::downCast(outputArray), &encodingLength)))
     throw runtime_error(ndn_getErrorString(error));
 
-  return output.finish(encodingLength);
+  output.resize(encodingLength);
 }
 
 void
 Tlv0_3WireFormat::decodeInterest
   (Interest& interest, const uint8_t *input, size_t inputLength,
    size_t *signedPortionBeginOffset, size_t *signedPortionEndOffset)
+{
+  decodeInterest
+    (interest, input, inputLength, Blob(), signedPortionBeginOffset,
+     signedPortionEndOffset);
+}
+
+void
+Tlv0_3WireFormat::decodeInterest
+  (Interest& interest, const Blob& input, size_t *signedPortionBeginOffset,
+   size_t *signedPortionEndOffset)
+{
+  decodeInterest
+    (interest, input.buf(), input.size(), input, signedPortionBeginOffset,
+     signedPortionEndOffset);
+}
+
+void
+Tlv0_3WireFormat::decodeInterest
+  (Interest& interest, const uint8_t *input, size_t inputLength,
+   const Blob& backing, size_t *signedPortionBeginOffset,
+   size_t *signedPortionEndOffset)
 {
   struct ndn_NameComponent nameComponents[100];
   struct ndn_ExcludeEntry excludeEntries[100];
@@ -136,11 +173,25 @@ Tlv0_3WireFormat::decodeInterest
        interestLite.getForwardingHintWireEncoding().size());
   }
 
-  interest.set(interestLite, *this);
+  interest.set(interestLite, *this, backing);
 }
 
 Blob
 Tlv0_3WireFormat::encodeData(const Data& data, size_t *signedPortionBeginOffset, size_t *signedPortionEndOffset)
+{
+  // The encoder sizes the output to the exact encoding length, so the result
+  // is allocated once with no copy.
+  ptr_lib::shared_ptr<vector<uint8_t> > output =
+    ptr_lib::make_shared<vector<uint8_t> >();
+  encodeData
+    (data, *output, signedPortionBeginOffset, signedPortionEndOffset);
+  return Blob(output, false);
+}
+
+void
+Tlv0_3WireFormat::encodeData
+  (const Data& data, vector<uint8_t>& output,
+   size_t *signedPortionBeginOffset, size_t *signedPortionEndOffset)
 {
   struct ndn_NameComponent nameComponents[100];
   struct ndn_NameComponent keyNameComponents[100];
@@ -149,20 +200,40 @@ Tlv0_3WireFormat::encodeData(const Data& data, size_t *signedPortionBeginOffset,
      keyNameComponents, sizeof(keyNameComponents) / sizeof(keyNameComponents[0]));
   data.get(dataLite);
 
-  DynamicUInt8Vector output(1500);
+  DynamicUInt8Vector outputArray(output);
   ndn_Error error;
   size_t encodingLength;
   if ((error = Tlv0_3WireFormatLite::encodeData
        (dataLite, signedPortionBeginOffset, signedPortionEndOffset,
-        DynamicUInt8ArrayLite::downCast(output), &encodingLength)))
+        DynamicUInt8ArrayLite::downCast(outputArray), &encodingLength)))
     throw runtime_error(ndn_getErrorString(error));
 
-  return output.finish(encodingLength);
+  output.resize(encodingLength);
 }
 
 void
 Tlv0_3WireFormat::decodeData
   (Data& data, const uint8_t *input, size_t inputLength, size_t *signedPortionBeginOffset, size_t *signedPortionEndOffset)
+{
+  decodeData
+    (data, input, inputLength, Blob(), signedPortionBeginOffset,
+     signedPortionEndOffset);
+}
+
+void
+Tlv0_3WireFormat::decodeData
+  (Data& data, const Blob& input, size_t *signedPortionBeginOffset,
+   size_t *signedPortionEndOffset)
+{
+  decodeData
+    (data, input.buf(), input.size(), input, signedPortionBeginOffset,
+     signedPortionEndOffset);
+}
+
+void
+Tlv0_3WireFormat::decodeData
+  (Data& data, const uint8_t *input, size_t inputLength, const Blob& backing,
+   size_t *signedPortionBeginOffset, size_t *signedPortionEndOffset)
 {
   struct ndn_NameComponent nameComponents[100];
   struct ndn_NameComponent keyNameComponents[100];
@@ -176,7 +247,7 @@ Tlv0_3WireFormat::decodeData
         signedPortionEndOffset)))
     throw runtime_error(ndn_getErrorString(error));
 
-  data.set(dataLite);
+  data.set(dataLite, backing);
 }
 
 Blob
@@ -8,7 +8,8 @@
  * Original file: src/encoding/wire-format.cpp
  * Original repository: https://github.com/named-data/ndn-cpp
  *
- * Summary of Changes: Use ndn-ind includes. Remove unused methods.
+ * Summary of Changes: Use ndn-ind includes. Remove unused methods. Add decode
+ * from a Blob. Add encode to a caller's vector.
  *
  * which was originally released under the LGPL license with the following rights:
  *
@@ -84,6 +85,26 @@ WireFormat::decodeInterest
   throw logic_error("unimplemented");
 }
 
+void
+WireFormat::encodeInterest
+  (const Interest& interest, vector<uint8_t>& output,
+   size_t *signedPortionBeginOffset, size_t *signedPortionEndOffset)
+{
+  Blob encoding = encodeInterest
+    (interest, signedPortionBeginOffset, signedPortionEndOffset);
+  output.assign(encoding.buf(), encoding.buf() + encoding.size());
+}
+
+void
+WireFormat::decodeInterest
+  (Interest& interest, const Blob& input, size_t *signedPortionBeginOffset,
+   size_t *signedPortionEndOffset)
+{
+  decodeInterest
+    (interest, input.buf(), input.size(), signedPortionBeginOffset,
+     signedPortionEndOffset);
+}
+
 Blob
 WireFormat::encodeData(const Data& data, size_t *signedPortionBeginOffset, size_t *signedPortionEndOffset)
 {
@@ -97,6 +118,26 @@ WireFormat::decodeData
   throw logic_error("unimplemented");
 }
 
+void
+WireFormat::encodeData
+  (const Data& data, vector<uint8_t>& output,
+   size_t *signedPortionBeginOffset, size_t *signedPortionEndOffset)
+{
+  Blob encoding = encodeData
+    (data, signedPortionBeginOffset, signedPortionEndOffset);
+  output.assign(encoding.buf(), encoding.buf() + encoding.size());
+}
+
+void
+WireFormat::decodeData
+  (Data& data, const Blob& input, size_t *signedPortionBeginOffset,
+   size_t *signedPortionEndOffset)
+{
+  decodeData
+    (data, input.buf(), input.size(), signedPortionBeginOffset,
+     signedPortionEndOffset);
+}
+
 Blob
 WireFormat::encodeControlParameters(const ControlParameters& controlParameters)
 {
@@ -8,7 +8,8 @@
  * Original file: src/face.cpp
  * Original repository: https://github.com/named-data/ndn-cpp
  *
- * Summary of Changes: Use ndn-ind includes. Use std::chrono.
+ * Summary of Changes: Use ndn-ind includes. Use std::chrono. Add processEvents(maxWait).
+ * Add setLazyDataDecodingEnabled. Add setSharedDecodingEnabled.
  *
  * which was originally released under the LGPL license with the following rights:
  *
@@ -119,6 +120,18 @@ Face::setInterestLoopbackEnabled(bool interestLoopbackEnabled)
   node_->setInterestLoopbackEnabled(interestLoopbackEnabled);
 }
 
+void
+Face::setLazyDataDecodingEnabled(bool lazyDataDecodingEnabled)
+{
+  node_->setLazyDataDecodingEnabled(lazyDataDecodingEnabled);
+}
+
+void
+Face::setSharedDecodingEnabled(bool sharedDecodingEnabled)
+{
+  node_->setSharedDecodingEnabled(sharedDecodingEnabled);
+}
+
 uint64_t
 Face::expressInterest
   (const Interest& interest, const OnData& onData, const OnTimeout& onTimeout,
@@ -156,6 +169,12 @@ Face::removePendingInterest(uint64_t pendingInterestId)
   node_->removePendingInterest(pendingInterestId);
 }
 
+void
+Face::removePendingInterests(const vector<uint64_t>& pendingInterestIds)
+{
+  node_->removePendingInterests(pendingInterestIds);
+}
+
 void
 Face::makeCommandInterest(Interest& interest, WireFormat& wireFormat)
 {
@@ -248,6 +267,12 @@ Face::processEvents()
   node_->processEvents();
 }
 
+void
+Face::processEvents(nanoseconds maxWait)
+{
+  node_->processEvents(maxWait);
+}
+
 bool
 Face::isLocal()
 {
@@ -266,4 +291,10 @@ Face::callLater(nanoseconds delay, const Callback& callback)
   node_->callLater(delay, callback);
 }
 
+Face::Callback
+Face::callLaterCancellable(nanoseconds delay, const Callback& callback)
+{
+  return node_->callLaterCancellable(delay, callback);
+}
+
 }
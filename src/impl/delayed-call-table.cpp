@@ -8,7 +8,8 @@
  * Original file: src/impl/delayed-call-table.cpp
  * Original repository: https://github.com/named-data/ndn-cpp
  *
- * Summary of Changes: Use NDN_IND macros. Use std::chrono.
+ * Summary of Changes: Use NDN_IND macros. Use std::chrono. Use a heap with
+ * cancellable entries. Add getTimeUntilNextCall.
  *
  * which was originally released under the LGPL license with the following rights:
  *
@@ -31,8 +32,6 @@
  * A copy of the GNU Lesser General Public License is in the file COPYING.
  */
 
-#include <algorithm>
-#include "../c/util/time.h"
 #include "delayed-call-table.hpp"
 
 using namespace std;
@@ -40,35 +39,126 @@ using namespace std::chrono;
 
 namespace ndn_ind {
 
-void
+ptr_lib::shared_ptr<DelayedCallTable::Entry>
 DelayedCallTable::callLater
   (nanoseconds delay, const Face::Callback& callback)
 {
-  ptr_lib::shared_ptr<Entry> entry(new Entry(delay, callback));
-  // Insert into table_, sorted on getCallTime().
-  table_.insert
-    (lower_bound(table_.begin(), table_.end(), entry, entryCompare_), entry);
+  return callAt_
+    (steady_clock::now() + duration_cast<steady_clock::duration>(delay),
+     callback);
+}
+
+ptr_lib::shared_ptr<DelayedCallTable::Entry>
+DelayedCallTable::callAt_
+  (steady_clock::time_point callTime, const Face::Callback& callback)
+{
+  ptr_lib::shared_ptr<Entry> entry(new Entry(callTime, callback));
+  heap_.push_back(HeapItem(entry, ++lastSequenceNo_));
+  entry->heapIndex_ = heap_.size() - 1;
+  siftUp(entry->heapIndex_);
+
+  return entry;
+}
+
+bool
+DelayedCallTable::cancel(const ptr_lib::shared_ptr<Entry>& entry)
+{
+  if (entry->heapIndex_ == Entry::NOT_IN_HEAP ||
+      entry->heapIndex_ >= heap_.size() ||
+      heap_[entry->heapIndex_].entry_ != entry)
+    // Already called or cancelled, or from another table.
+    return false;
+
+  removeAt(entry->heapIndex_);
+  return true;
 }
 
 void
 DelayedCallTable::callTimedOut()
 {
   // nowOffset_ is only used for testing.
-  auto now = system_clock::now() + duration_cast<system_clock::duration>(nowOffset_);
-  // table_ is sorted on _callTime, so we only need to process the timed-out
-  // entries at the front, then quit.
-  while (table_.size() > 0 && table_.front()->getCallTime() <= now) {
-    ptr_lib::shared_ptr<Entry> entry = table_.front();
-    table_.erase(table_.begin());
+  auto now = steady_clock::now() + duration_cast<steady_clock::duration>(nowOffset_);
+  // heap_ is ordered on the call time, so we only need to process the
+  // timed-out entries at the root, then quit.
+  while (heap_.size() > 0 && heap_[0].callTime_ <= now) {
+    ptr_lib::shared_ptr<Entry> entry = heap_[0].entry_;
+    removeAt(0);
+    // The callback may call callLater or cancel.
     entry->callCallback();
   }
 }
 
-DelayedCallTable::Entry::Entry
-  (nanoseconds delay, const Face::Callback& callback)
-  : callback_(callback),
-    callTime_(system_clock::now() + duration_cast<system_clock::duration>(delay))
+nanoseconds
+DelayedCallTable::getTimeUntilNextCall() const
+{
+  if (heap_.size() == 0)
+    return nanoseconds::max();
+
+  // nowOffset_ is only used for testing.
+  auto now = steady_clock::now() + duration_cast<steady_clock::duration>(nowOffset_);
+  if (heap_[0].callTime_ <= now)
+    return nanoseconds::zero();
+  return duration_cast<nanoseconds>(heap_[0].callTime_ - now);
+}
+
+void
+DelayedCallTable::siftUp(size_t index)
 {
+  HeapItem item = std::move(heap_[index]);
+  while (index > 0) {
+    size_t parent = (index - 1) / ARITY;
+    if (!item.isBefore(heap_[parent]))
+      break;
+    place(index, heap_[parent]);
+    index = parent;
+  }
+
+  place(index, item);
+}
+
+void
+DelayedCallTable::siftDown(size_t index)
+{
+  HeapItem item = std::move(heap_[index]);
+  while (true) {
+    size_t firstChild = index * ARITY + 1;
+    if (firstChild >= heap_.size())
+      break;
+
+    // Find the earliest child.
+    size_t endChild = min(firstChild + ARITY, heap_.size());
+    size_t earliest = firstChild;
+    for (size_t child = firstChild + 1; child < endChild; ++child) {
+      if (heap_[child].isBefore(heap_[earliest]))
+        earliest = child;
+    }
+
+    if (!heap_[earliest].isBefore(item))
+      break;
+    place(index, heap_[earliest]);
+    index = earliest;
+  }
+
+  place(index, item);
+}
+
+void
+DelayedCallTable::removeAt(size_t index)
+{
+  heap_[index].entry_->heapIndex_ = Entry::NOT_IN_HEAP;
+
+  size_t last = heap_.size() - 1;
+  if (index != last) {
+    place(index, heap_[last]);
+    heap_.pop_back();
+    // The moved item may belong either above or below its new position.
+    if (index > 0 && heap_[index].isBefore(heap_[(index - 1) / ARITY]))
+      siftUp(index);
+    else
+      siftDown(index);
+  }
+  else
+    heap_.pop_back();
 }
 
 }
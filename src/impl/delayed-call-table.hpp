@@ -8,7 +8,8 @@
  * Original file: src/impl/delayed-call-table.hpp
  * Original repository: https://github.com/named-data/ndn-cpp
  *
- * Summary of Changes: Use NDN_IND macros. Use std::chrono.
+ * Summary of Changes: Use NDN_IND macros. Use std::chrono. Use a heap with
+ * cancellable entries. Add getTimeUntilNextCall.
  *
  * which was originally released under the LGPL license with the following rights:
  *
@@ -34,15 +35,23 @@
 #ifndef NDN_DELAYED_CALL_TABLE_HPP
 #define NDN_DELAYED_CALL_TABLE_HPP
 
-#include <deque>
+#include <vector>
 #include <ndn-ind/face.hpp>
 
 namespace ndn_ind {
 
+/**
+ * A DelayedCallTable holds callbacks to call at a later time. The entries are
+ * kept in a 4-ary min-heap on the call time so that callLater, cancel and
+ * removing the next timed-out entry are O(log N). The call time uses the
+ * steady clock so that it is not affected by changes to the system time.
+ */
 class DelayedCallTable {
 public:
+  class Entry;
+
   DelayedCallTable()
-  : nowOffset_(0)
+  : nowOffset_(0), lastSequenceNo_(0)
   {}
 
   /**
@@ -50,21 +59,74 @@ public:
    * table which is used by callTimedOut().
    * @param delay The delay.
    * @param callback This calls callback() after the delay.
+   * @return The entry which can be given to cancel().
    */
-  void
+  ptr_lib::shared_ptr<Entry>
   callLater(std::chrono::nanoseconds delay, const Face::Callback& callback);
 
   /**
-   * Call and remove timed-out callback entries. Since callLater does a sorted
-   * insert into the delayed call table, the check for timed-out entries is
-   * quick and does not require searching the entire table.
+   * Call callback() at the given time. This is the same as callLater except
+   * for the absolute time, which should only be used for testing, such as to
+   * add entries with the same call time.
+   * @param callTime The steady clock time to call the callback.
+   * @param callback This calls callback() at the call time.
+   * @return The entry which can be given to cancel().
+   */
+  ptr_lib::shared_ptr<Entry>
+  callAt_
+    (std::chrono::steady_clock::time_point callTime,
+     const Face::Callback& callback);
+
+  /**
+   * Remove the entry from the table so that its callback is not called. If
+   * the entry has already been called or cancelled, do nothing.
+   * @param entry The entry returned by callLater.
+   * @return True if the entry was removed, false if it was not in the table.
+   */
+  bool
+  cancel(const ptr_lib::shared_ptr<Entry>& entry);
+
+  /**
+   * Remove the entry from the table if it still exists. This is for use in a
+   * callback which should not keep the entry alive.
+   * @param entry The entry returned by callLater.
+   */
+  void
+  cancelIfExists(const ptr_lib::weak_ptr<Entry>& entry)
+  {
+    ptr_lib::shared_ptr<Entry> sharedEntry = entry.lock();
+    if (sharedEntry)
+      cancel(sharedEntry);
+  }
+
+  /**
+   * Call and remove timed-out callback entries. Since the table is a heap
+   * ordered on the call time, the check for timed-out entries is quick and
+   * does not require searching the entire table.
    */
   void
   callTimedOut();
 
   /**
-   * Set the offset when insert() and refresh() get the current time, which
-   * should only be used for testing.
+   * Get the time until the earliest entry should be called, so that an event
+   * loop can block until then. Since the table is a heap ordered on the call
+   * time, this only checks the root.
+   * @return The time until the earliest call time, or zero if it has passed,
+   * or nanoseconds::max() if the table is empty.
+   */
+  std::chrono::nanoseconds
+  getTimeUntilNextCall() const;
+
+  /**
+   * Get the number of entries which have not been called or cancelled.
+   * @return The number of entries.
+   */
+  size_t
+  size() const { return heap_.size(); }
+
+  /**
+   * Set the offset when callTimedOut() and getTimeUntilNextCall() get the
+   * current time, which should only be used for testing.
    * @param nowOffset The offset.
    */
   void
@@ -73,22 +135,25 @@ public:
     nowOffset_ = nowOffset;
   }
 
-private:
   class Entry {
   public:
     /**
-     * Create a new DelayedCallTable::Entry and set the call time based on the
-     * current time and the delay.
-     * @param delay The delay.
+     * Create a new DelayedCallTable::Entry with the given call time.
+     * @param callTime The time at which to call the callback.
      * @param callback This calls callback() after the delay.
      */
-    Entry(std::chrono::nanoseconds delay, const Face::Callback& callback);
+    Entry
+      (std::chrono::steady_clock::time_point callTime,
+       const Face::Callback& callback)
+    : callback_(callback), callTime_(callTime), heapIndex_(NOT_IN_HEAP)
+    {
+    }
 
     /**
      * Get the time at which the callback should be called.
      * @return The call time.
      */
-    std::chrono::system_clock::time_point
+    std::chrono::steady_clock::time_point
     getCallTime() const { return callTime_; }
 
     /**
@@ -98,29 +163,80 @@ private:
     void
     callCallback() const { callback_(); }
 
+  private:
+    friend class DelayedCallTable;
+
+    static const size_t NOT_IN_HEAP = (size_t)-1;
+
+    const Face::Callback callback_;
+    std::chrono::steady_clock::time_point callTime_;
+    // The position in DelayedCallTable::heap_, or NOT_IN_HEAP.
+    size_t heapIndex_;
+  };
+
+private:
+  /**
+   * A HeapItem is an element of heap_. It has a copy of the call time so that
+   * ordering the heap doesn't need to access the Entry.
+   */
+  struct HeapItem {
+    HeapItem(const ptr_lib::shared_ptr<Entry>& entry, uint64_t sequenceNo)
+    : callTime_(entry->callTime_), sequenceNo_(sequenceNo), entry_(entry)
+    {
+    }
+
     /**
-     * Compare shared_ptrs to Entry based only on callTime_.
+     * Check if this item is called before the other item. Items with the same
+     * call time are called in the order they were added.
+     * @param other The other item.
+     * @return True if this is called first.
      */
-    class Compare {
-    public:
-      bool
-      operator()
-        (const ptr_lib::shared_ptr<const Entry>& x,
-         const ptr_lib::shared_ptr<const Entry>& y) const
-      {
-        return x->callTime_ < y->callTime_;
-      }
-    };
+    bool
+    isBefore(const HeapItem& other) const
+    {
+      if (callTime_ != other.callTime_)
+        return callTime_ < other.callTime_;
+      return sequenceNo_ < other.sequenceNo_;
+    }
 
-  private:
-    const Face::Callback callback_;
-    std::chrono::system_clock::time_point callTime_;
+    std::chrono::steady_clock::time_point callTime_;
+    uint64_t sequenceNo_;
+    ptr_lib::shared_ptr<Entry> entry_;
   };
 
-  // Use a deque so we can efficiently remove from the front.
-  std::deque<ptr_lib::shared_ptr<Entry> > table_;
-  Entry::Compare entryCompare_;
+  /**
+   * Move the item to heap_[index] and update its entry's heapIndex_.
+   */
+  void
+  place(size_t index, HeapItem& item)
+  {
+    heap_[index] = std::move(item);
+    heap_[index].entry_->heapIndex_ = index;
+  }
+
+  /**
+   * Move the item at heap_[index] toward the root until the heap is ordered.
+   */
+  void
+  siftUp(size_t index);
+
+  /**
+   * Move the item at heap_[index] toward the leaves until the heap is ordered.
+   */
+  void
+  siftDown(size_t index);
+
+  /**
+   * Remove the item at heap_[index] and restore the heap order.
+   */
+  void
+  removeAt(size_t index);
+
+  static const size_t ARITY = 4;
+
+  std::vector<HeapItem> heap_;
   std::chrono::nanoseconds nowOffset_;
+  uint64_t lastSequenceNo_;
 };
 
 }
@@ -8,7 +8,7 @@
  * Original file: src/impl/interest-filter-table.cpp
  * Original repository: https://github.com/named-data/ndn-cpp
  *
- * Summary of Changes: Use ndn-ind includes.
+ * Summary of Changes: Use ndn-ind includes. Index prefix filters by a name trie.
  *
  * which was originally released under the LGPL license with the following rights:
  *
@@ -31,6 +31,7 @@
  * A copy of the GNU Lesser General Public License is in the file COPYING.
  */
 
+#include <algorithm>
 #include <ndn-ind/util/logging.hpp>
 #include "interest-filter-table.hpp"
 
@@ -40,33 +41,120 @@ using namespace std;
 
 namespace ndn_ind {
 
+void
+InterestFilterTable::setInterestFilter
+  (uint64_t interestFilterId,
+   const ptr_lib::shared_ptr<const InterestFilter>& filterCopy,
+   const OnInterestCallback& onInterest, Face* face)
+{
+  pair<uint64_t, ptr_lib::shared_ptr<Entry> > sequenceAndEntry
+    (nextSequenceNo_++, ptr_lib::make_shared<Entry>
+     (interestFilterId, filterCopy, onInterest, face));
+  if (filterCopy->hasRegexFilter()) {
+    regexEntries_.push_back(sequenceAndEntry);
+    idIndex_.insert(make_pair(interestFilterId, (NameNode*)0));
+    return;
+  }
+
+  // Find or create the trie node for the prefix.
+  const Name& prefix = filterCopy->getPrefix();
+  NameNode* node = &root_;
+  for (size_t i = 0; i < prefix.size(); ++i) {
+    ptr_lib::shared_ptr<NameNode>& child = node->children_[prefix.get(i)];
+    if (!child)
+      child.reset(new NameNode(node, prefix.get(i)));
+    node = child.get();
+  }
+
+  node->entries_.push_back(sequenceAndEntry);
+  idIndex_.insert(make_pair(interestFilterId, node));
+}
+
 void
 InterestFilterTable::getMatchedFilters
   (const Interest& interest,
     std::vector<ptr_lib::shared_ptr<Entry> > &matchedFilters)
 {
-  for (size_t i = 0; i < table_.size(); ++i) {
-    ptr_lib::shared_ptr<Entry> &entry = table_[i];
-    if (entry->getFilter()->doesMatch(interest.getName()))
-      matchedFilters.push_back(entry);
+  EntryList matched;
+
+  // A plain prefix filter matches if its prefix is a prefix of the name, so
+  // only visit the trie nodes along the name.
+  const Name& name = interest.getName();
+  NameNode* node = &root_;
+  for (size_t i = 0; ; ++i) {
+    matched.insert(matched.end(), node->entries_.begin(), node->entries_.end());
+
+    if (i >= name.size())
+      break;
+    NameNode::Children::iterator child = node->children_.find(name.get(i));
+    if (child == node->children_.end())
+      break;
+    node = child->second.get();
   }
+
+  for (size_t i = 0; i < regexEntries_.size(); ++i) {
+    if (regexEntries_[i].second->getFilter()->doesMatch(name))
+      matched.push_back(regexEntries_[i]);
+  }
+
+  // Return the entries in the order that they were added, as the original
+  // list did.
+  if (matched.size() > 1)
+    sort(matched.begin(), matched.end());
+  for (size_t i = 0; i < matched.size(); ++i)
+    matchedFilters.push_back(matched[i].second);
 }
 
 void
 InterestFilterTable::unsetInterestFilter(uint64_t interestFilterId)
 {
-  int count = 0;
-  // Go backwards through the list so we can erase entries.
-  // Remove all entries even though interestFilterId should be unique.
-  for (int i = (int)table_.size() - 1; i >= 0; --i) {
-    if (table_[i]->getInterestFilterId() == interestFilterId) {
-      ++count;
-      table_.erase(table_.begin() + i);
+  pair<unordered_multimap<uint64_t, NameNode*>::iterator,
+       unordered_multimap<uint64_t, NameNode*>::iterator> range =
+    idIndex_.equal_range(interestFilterId);
+  if (range.first == range.second) {
+    _LOG_DEBUG("unsetInterestFilter: Didn't find interestFilterId " << interestFilterId);
+    return;
+  }
+
+  // Get each node once, since pruning may delete it.
+  vector<NameNode*> nodes;
+  for (unordered_multimap<uint64_t, NameNode*>::iterator index = range.first;
+       index != range.second; ++index) {
+    if (::find(nodes.begin(), nodes.end(), index->second) == nodes.end())
+      nodes.push_back(index->second);
+  }
+  idIndex_.erase(range.first, range.second);
+
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    NameNode* node = nodes[i];
+    if (!node) {
+      removeFromEntries(regexEntries_, interestFilterId);
+      continue;
+    }
+
+    removeFromEntries(node->entries_, interestFilterId);
+    // Remove nodes which no longer have entries or children. This doesn't
+    // remove another node in nodes since its entries are not yet removed.
+    while (node != &root_ && node->entries_.empty() &&
+           node->children_.empty()) {
+      NameNode* parent = node->parent_;
+      // Copy the key since erasing deletes node.
+      Name::Component component = node->component_;
+      parent->children_.erase(component);
+      node = parent;
     }
   }
+}
 
-  if (count == 0)
-    _LOG_DEBUG("unsetInterestFilter: Didn't find interestFilterId " << interestFilterId);
+void
+InterestFilterTable::removeFromEntries
+  (EntryList& entries, uint64_t interestFilterId)
+{
+  // Go backwards through the list so we can erase entries.
+  for (int i = (int)entries.size() - 1; i >= 0; --i) {
+    if (entries[i].second->getInterestFilterId() == interestFilterId)
+      entries.erase(entries.begin() + i);
+  }
 }
 
 }
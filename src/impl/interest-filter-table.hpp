@@ -8,7 +8,7 @@
  * Original file: src/impl/interest-filter-table.hpp
  * Original repository: https://github.com/named-data/ndn-cpp
  *
- * Summary of Changes: Use ndn-ind includes.
+ * Summary of Changes: Use ndn-ind includes. Index prefix filters by a name trie.
  *
  * which was originally released under the LGPL license with the following rights:
  *
@@ -34,13 +34,17 @@
 #ifndef NDN_INTEREST_FILTER_TABLE_HPP
 #define NDN_INTEREST_FILTER_TABLE_HPP
 
+#include <unordered_map>
 #include <ndn-ind/face.hpp>
 
 namespace ndn_ind {
 
 /**
  * An InterestFilterTable is an internal class to hold a list of entries with
- * an interest Filter and its OnInterestCallback.
+ * an interest Filter and its OnInterestCallback. The entries with a plain
+ * prefix filter are indexed by a name component trie so that finding the
+ * filters for an incoming interest only visits the trie nodes along the
+ * interest name. The entries with a regex filter are kept in a separate list.
  */
 class InterestFilterTable {
 public:
@@ -113,6 +117,14 @@ public:
     Face* face_;
   };
 
+  /**
+   * Create a new InterestFilterTable with an empty table.
+   */
+  InterestFilterTable()
+  : root_(0, Name::Component()), nextSequenceNo_(0)
+  {
+  }
+
   /**
    * Add a new entry to the table.
    * @param interestFilterId The ID from Node.getNextEntryId().
@@ -125,15 +137,12 @@ public:
   setInterestFilter
     (uint64_t interestFilterId,
      const ptr_lib::shared_ptr<const InterestFilter>& filterCopy,
-     const OnInterestCallback& onInterest, Face* face)
-  {
-    table_.push_back(ptr_lib::make_shared<Entry>
-      (interestFilterId, filterCopy, onInterest, face));
-  }
+     const OnInterestCallback& onInterest, Face* face);
 
   /**
    * Find all entries from the interest filter table where the interest conforms
-   * to the entry's filter, and add to the matchedFilters list.
+   * to the entry's filter, and add to the matchedFilters list in the order that
+   * the entries were added.
    * @param interest The interest which may match the filter in multiple entries.
    * @param matchedFilters Add each matching InterestFilterTable.Entry from the
    * interest filter table.  The caller should pass in a reference to an empty
@@ -155,7 +164,57 @@ public:
   unsetInterestFilter(uint64_t interestFilterId);
 
 private:
-  std::vector<ptr_lib::shared_ptr<Entry> > table_;
+  /**
+   * An EntryList holds pairs of the sequence number when the entry was added
+   * and the entry. It is ordered by the sequence number.
+   */
+  typedef std::vector<std::pair<uint64_t, ptr_lib::shared_ptr<Entry> > >
+    EntryList;
+
+  /**
+   * A NameNode is a node in the name component trie. The entries of a node
+   * have a plain prefix filter whose prefix is the name from the root to the
+   * node.
+   */
+  class NameNode {
+  public:
+    NameNode(NameNode* parent, const Name::Component& component)
+    : parent_(parent), component_(component)
+    {
+    }
+
+    struct ComponentHash {
+      size_t
+      operator()(const Name::Component& component) const
+      {
+        return component.hash();
+      }
+    };
+
+    typedef std::unordered_map
+      <Name::Component, ptr_lib::shared_ptr<NameNode>, ComponentHash> Children;
+
+    NameNode* parent_;
+    Name::Component component_;
+    Children children_;
+    EntryList entries_;
+  };
+
+  /**
+   * Remove all entries with the interestFilterId from the entry list.
+   * @param entries The entry list.
+   * @param interestFilterId The ID of the entries to remove.
+   */
+  static void
+  removeFromEntries(EntryList& entries, uint64_t interestFilterId);
+
+  NameNode root_;
+  // The node of each entry with a plain prefix filter, or null for an entry
+  // with a regex filter. The interestFilterId should be unique, but allow
+  // duplicates as the original list did.
+  std::unordered_multimap<uint64_t, NameNode*> idIndex_;
+  EntryList regexEntries_;
+  uint64_t nextSequenceNo_;
 };
 
 }
@@ -8,7 +8,8 @@
  * Original file: src/impl/pending-interest-table.cpp
  * Original repository: https://github.com/named-data/ndn-cpp
  *
- * Summary of Changes: Use ndn-ind includes.
+ * Summary of Changes: Use ndn-ind includes. Index entries by a name trie and by
+ * pendingInterestId.
  *
  * which was originally released under the LGPL license with the following rights:
  *
@@ -31,7 +32,6 @@
  * A copy of the GNU Lesser General Public License is in the file COPYING.
  */
 
-#include <algorithm>
 #include <ndn-ind/util/logging.hpp>
 #include "pending-interest-table.hpp"
 
@@ -62,18 +62,35 @@ PendingInterestTable::add
    const ptr_lib::shared_ptr<const Interest>& interestCopy, const OnData& onData,
    const OnTimeout& onTimeout, const OnNetworkNack& onNetworkNack)
 {
-  vector<uint64_t>::iterator removeRequestIterator =
-    ::find(removeRequests_.begin(), removeRequests_.end(), pendingInterestId);
-  if (removeRequestIterator != removeRequests_.end()) {
-    // removePendingInterest was called with the pendingInterestId returned by
-    //   expressInterest before we got here, so don't add a PIT entry.
-    removeRequests_.erase(removeRequestIterator);
-    return ptr_lib::shared_ptr<Entry>();
+  if (!removeRequests_.empty()) {
+    expireRemoveRequests(chrono::steady_clock::now());
+    if (removeRequests_.erase(pendingInterestId) > 0)
+      // removePendingInterest was called with the pendingInterestId returned by
+      //   expressInterest before we got here, so don't add a PIT entry.
+      return ptr_lib::shared_ptr<Entry>();
   }
 
   ptr_lib::shared_ptr<Entry> entry(new Entry
     (pendingInterestId, interestCopy, onData, onTimeout, onNetworkNack));
-  table_.push_back(entry);
+
+  // The pendingInterestId should be unique, but replace any existing entry.
+  IdIndex::iterator existing = idIndex_.find(pendingInterestId);
+  if (existing != idIndex_.end())
+    erase(existing);
+
+  // Find or create the trie node for the interest name.
+  const Name& name = interestCopy->getName();
+  NameNode* node = &root_;
+  for (size_t i = 0; i < name.size(); ++i) {
+    ptr_lib::shared_ptr<NameNode>& child = node->children_[name.get(i)];
+    if (!child)
+      child.reset(new NameNode(node, name.get(i)));
+    node = child.get();
+  }
+
+  node->entries_.push_back(entry);
+  idIndex_.insert(IdIndex::value_type
+    (pendingInterestId, IndexEntry(node, --node->entries_.end())));
   return entry;
 }
 
@@ -81,71 +98,115 @@ void
 PendingInterestTable::extractEntriesForExpressedInterest
   (const Data& data, vector<ptr_lib::shared_ptr<Entry> > &entries)
 {
-  // Go backwards through the list so we can erase entries.
-  for (int i = (int)table_.size() - 1; i >= 0; --i) {
-    ptr_lib::shared_ptr<Entry>& pendingInterest = table_[i];
-    if (pendingInterest->getInterest()->matchesData(data)) {
-      entries.push_back(pendingInterest);
-      // We let the callback from callLater call _processInterestTimeout, but
-      // for efficiency, mark this as removed so that it returns right away.
-      pendingInterest->setIsRemoved();
-      table_.erase(table_.begin() + i);
+  // Only an interest whose name is a prefix of the Data name, or the Data name
+  // plus an implicit digest component, can match. Visit the trie nodes along
+  // the Data name, then the implicit digest children of the last node.
+  vector<uint64_t> matchedIds;
+  const Name& dataName = data.getName();
+  NameNode* node = &root_;
+  for (size_t i = 0; ; ++i) {
+    for (list<ptr_lib::shared_ptr<Entry> >::iterator entry =
+           node->entries_.begin();
+         entry != node->entries_.end(); ++entry) {
+      if ((*entry)->getInterest()->matchesData(data))
+        matchedIds.push_back((*entry)->getPendingInterestId());
+    }
+
+    if (i >= dataName.size())
+      break;
+    NameNode::Children::iterator child = node->children_.find(dataName.get(i));
+    if (child == node->children_.end()) {
+      node = 0;
+      break;
+    }
+    node = child->second.get();
+  }
+
+  if (node) {
+    for (NameNode::Children::iterator child = node->children_.begin();
+         child != node->children_.end(); ++child) {
+      if (!child->first.isImplicitSha256Digest())
+        continue;
+
+      list<ptr_lib::shared_ptr<Entry> >& childEntries = child->second->entries_;
+      for (list<ptr_lib::shared_ptr<Entry> >::iterator entry =
+             childEntries.begin();
+           entry != childEntries.end(); ++entry) {
+        if ((*entry)->getInterest()->matchesData(data))
+          matchedIds.push_back((*entry)->getPendingInterestId());
+      }
     }
   }
+
+  // Remove after the search since erase can remove trie nodes.
+  for (size_t i = 0; i < matchedIds.size(); ++i) {
+    IdIndex::iterator index = idIndex_.find(matchedIds[i]);
+    entries.push_back(*index->second.position_);
+    // This marks the entry as removed and cancels its timeout call.
+    erase(index);
+  }
 }
 
 void
 PendingInterestTable::extractEntriesForNackInterest
   (const Interest& interest, vector<ptr_lib::shared_ptr<Entry> > &entries)
 {
+  // The interests are only the same if the names are the same.
+  NameNode* node = findNode(interest.getName());
+  if (!node)
+    return;
+
   SignedBlob encoding = interest.wireEncode();
 
-  // Go backwards through the list so we can erase entries.
-  for (int i = (int)table_.size() - 1; i >= 0; --i) {
-    ptr_lib::shared_ptr<Entry>& pendingInterest = table_[i];
-    if (!pendingInterest->getOnNetworkNack())
+  vector<uint64_t> matchedIds;
+  for (list<ptr_lib::shared_ptr<Entry> >::iterator entry =
+         node->entries_.begin();
+       entry != node->entries_.end(); ++entry) {
+    if (!(*entry)->getOnNetworkNack())
       continue;
 
     // wireEncode returns the encoding cached when the interest was sent (if
     // it was the default wire encoding).
-    if (pendingInterest->getInterest()->wireEncode().equals(encoding)) {
-      entries.push_back(pendingInterest);
-      // We let the callback from callLater call _processInterestTimeout, but
-      // for efficiency, mark this as removed so that it returns right away.
-      pendingInterest->setIsRemoved();
-      table_.erase(table_.begin() + i);
-    }
+    if ((*entry)->getInterest()->wireEncode().equals(encoding))
+      matchedIds.push_back((*entry)->getPendingInterestId());
+  }
+
+  for (size_t i = 0; i < matchedIds.size(); ++i) {
+    IdIndex::iterator index = idIndex_.find(matchedIds[i]);
+    entries.push_back(*index->second.position_);
+    // This marks the entry as removed and cancels its timeout call.
+    erase(index);
   }
 }
 
 void
 PendingInterestTable::removePendingInterest(uint64_t pendingInterestId)
 {
-  int count = 0;
-  // Go backwards through the list so we can erase entries.
-  // Remove all entries even though pendingInterestId should be unique.
-  for (int i = (int)table_.size() - 1; i >= 0; --i) {
-    if (table_[i]->getPendingInterestId() == pendingInterestId) {
-      ++count;
-      // For efficiency, mark this as removed so that processInterestTimeout
-      // doesn't look for it.
-      table_[i]->setIsRemoved();
-      table_.erase(table_.begin() + i);
-    }
+  IdIndex::iterator index = idIndex_.find(pendingInterestId);
+  if (index != idIndex_.end()) {
+    // This marks the entry as removed and cancels its timeout call.
+    erase(index);
+    return;
   }
 
-  if (count == 0)
-    _LOG_DEBUG("removePendingInterest: Didn't find pendingInterestId " << pendingInterestId);
-
-  if (count == 0) {
-    // The pendingInterestId was not found. Perhaps this has been called before
-    //   the callback in expressInterest can add to the PIT. Add this
-    //   removal request which will be checked before adding to the PIT.
-    if (::find(removeRequests_.begin(), removeRequests_.end(), pendingInterestId)
-        == removeRequests_.end())
-      // Not already requested, so add the request.
-      removeRequests_.push_back(pendingInterestId);
-  }
+  _LOG_DEBUG("removePendingInterest: Didn't find pendingInterestId " << pendingInterestId);
+
+  // The pendingInterestId was not found. Perhaps this has been called before
+  //   the callback in expressInterest can add to the PIT. Add this
+  //   removal request which will be checked before adding to the PIT.
+  chrono::steady_clock::time_point now = chrono::steady_clock::now();
+  expireRemoveRequests(now);
+  if (removeRequests_.insert(make_pair(pendingInterestId, now)).second)
+    // Not already requested, so also add for expiry.
+    removeRequestExpiry_.push_back(make_pair(now, pendingInterestId));
+}
+
+void
+PendingInterestTable::removePendingInterests
+  (const vector<uint64_t>& pendingInterestIds)
+{
+  for (size_t i = 0; i < pendingInterestIds.size(); ++i)
+    removePendingInterest(pendingInterestIds[i]);
 }
 
 bool
@@ -158,16 +219,66 @@ PendingInterestTable::removeEntry
     // Do nothing.
     return false;
 
-  // Search by pointer equality.
-  for (size_t i = 0; i < table_.size(); ++i) {
-    if (table_[i].get() == pendingInterest.get()) {
-      table_[i]->setIsRemoved();
-      table_.erase(table_.begin() + i);
-      return true;
-    }
+  IdIndex::iterator index = idIndex_.find
+    (pendingInterest->getPendingInterestId());
+  // Check pointer equality in case the entry was replaced.
+  if (index == idIndex_.end() ||
+      index->second.position_->get() != pendingInterest.get())
+    return false;
+
+  erase(index);
+  return true;
+}
+
+void
+PendingInterestTable::expireRemoveRequests(chrono::steady_clock::time_point now)
+{
+  // removeRequestExpiry_ is in time order, so only check the front.
+  while (!removeRequestExpiry_.empty() &&
+         now - removeRequestExpiry_.front().first >= removeRequestLifetime_) {
+    uint64_t pendingInterestId = removeRequestExpiry_.front().second;
+    unordered_map<uint64_t, chrono::steady_clock::time_point>::iterator request =
+      removeRequests_.find(pendingInterestId);
+    // Don't erase a request which was removed by add then made again.
+    if (request != removeRequests_.end() &&
+        request->second == removeRequestExpiry_.front().first)
+      removeRequests_.erase(request);
+    removeRequestExpiry_.pop_front();
   }
+}
+
+PendingInterestTable::NameNode*
+PendingInterestTable::findNode(const Name& name)
+{
+  NameNode* node = &root_;
+  for (size_t i = 0; i < name.size(); ++i) {
+    NameNode::Children::iterator child = node->children_.find(name.get(i));
+    if (child == node->children_.end())
+      return 0;
+    node = child->second.get();
+  }
+
+  return node;
+}
 
-  return false;
+void
+PendingInterestTable::erase(IdIndex::iterator index)
+{
+  NameNode* node = index->second.node_;
+  (*index->second.position_)->setIsRemoved();
+  // The entry no longer needs processInterestTimeout.
+  (*index->second.position_)->cancelTimeout();
+  node->entries_.erase(index->second.position_);
+  idIndex_.erase(index);
+
+  // Remove nodes which no longer have entries or children.
+  while (node != &root_ && node->entries_.empty() && node->children_.empty()) {
+    NameNode* parent = node->parent_;
+    // Copy the key since erasing deletes node.
+    Name::Component component = node->component_;
+    parent->children_.erase(component);
+    node = parent;
+  }
 }
 
 }
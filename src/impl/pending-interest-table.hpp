@@ -8,7 +8,8 @@
  * Original file: src/impl/pending-interest-table.hpp
  * Original repository: https://github.com/named-data/ndn-cpp
  *
- * Summary of Changes: Use ndn-ind includes.
+ * Summary of Changes: Use ndn-ind includes. Index entries by a name trie and by
+ * pendingInterestId.
  *
  * which was originally released under the LGPL license with the following rights:
  *
@@ -34,13 +35,19 @@
 #ifndef NDN_PENDING_INTEREST_TABLE_HPP
 #define NDN_PENDING_INTEREST_TABLE_HPP
 
+#include <deque>
+#include <list>
+#include <unordered_map>
 #include <ndn-ind/face.hpp>
 
 namespace ndn_ind {
 
 /**
  * A PendingInterestTable is an internal class to hold a list of pending
- * interests with their callbacks.
+ * interests with their callbacks. The entries are indexed by a name component
+ * trie so that matching an incoming Data packet only visits the entries whose
+ * interest name is a prefix of the Data name, and by pendingInterestId so that
+ * an entry can be removed without searching.
  */
 class PendingInterestTable {
 public:
@@ -112,15 +119,47 @@ public:
     void
     callTimeout();
 
+    /**
+     * Set the function which cancels the timeout call for this entry, which is
+     * called by cancelTimeout().
+     * @param cancelTimeout The function from Face::callLaterCancellable.
+     */
+    void
+    setCancelTimeout(const Face::Callback& cancelTimeout)
+    {
+      cancelTimeout_ = cancelTimeout;
+    }
+
+    /**
+     * Call the function given to setCancelTimeout (if defined) and clear it.
+     * The PendingInterestTable calls this when the entry is removed.
+     */
+    void
+    cancelTimeout()
+    {
+      if (cancelTimeout_) {
+        Face::Callback cancel = cancelTimeout_;
+        cancelTimeout_ = Face::Callback();
+        cancel();
+      }
+    }
+
   private:
     ptr_lib::shared_ptr<const Interest> interest_;
     uint64_t pendingInterestId_;  /**< A unique identifier for this entry so it can be deleted */
     const OnData onData_;
     const OnTimeout onTimeout_;
     const OnNetworkNack onNetworkNack_;
+    Face::Callback cancelTimeout_;
     bool isRemoved_;
   };
 
+  PendingInterestTable()
+  : root_(0, Name::Component()),
+    removeRequestLifetime_(std::chrono::minutes(10))
+  {
+  }
+
   /**
    * Add a new entry to the pending interest table. However, if
    * removePendingInterest was already called with the pendingInterestId, don't
@@ -183,6 +222,14 @@ public:
   void
   removePendingInterest(uint64_t pendingInterestId);
 
+  /**
+   * Call removePendingInterest for each pendingInterestId. Each removal is
+   * O(1), so the cost only depends on the number of IDs.
+   * @param pendingInterestIds The IDs returned from expressInterest.
+   */
+  void
+  removePendingInterests(const std::vector<uint64_t>& pendingInterestIds);
+
   /**
    * Remove the specific pendingInterest entry from the table and set its
    * isRemoved flag. However, if the pendingInterest isRemoved flag is already
@@ -192,9 +239,96 @@ public:
   bool
   removeEntry(const ptr_lib::shared_ptr<Entry>& pendingInterest);
 
+  /**
+   * Get the number of entries in the pending interest table.
+   * @return The number of entries.
+   */
+  size_t
+  size() const { return idIndex_.size(); }
+
 private:
-  std::vector<ptr_lib::shared_ptr<Entry> > table_;
-  std::vector<uint64_t> removeRequests_;
+  /**
+   * A NameNode is a node in the name component trie. The entries of a node are
+   * the pending interests whose name is the name from the root to the node.
+   */
+  class NameNode {
+  public:
+    NameNode(NameNode* parent, const Name::Component& component)
+    : parent_(parent), component_(component)
+    {
+    }
+
+    struct ComponentHash {
+      size_t
+      operator()(const Name::Component& component) const
+      {
+        return component.hash();
+      }
+    };
+
+    typedef std::unordered_map
+      <Name::Component, ptr_lib::shared_ptr<NameNode>, ComponentHash> Children;
+
+    NameNode* parent_;
+    Name::Component component_;
+    Children children_;
+    std::list<ptr_lib::shared_ptr<Entry> > entries_;
+  };
+
+  /**
+   * An IndexEntry locates an Entry in the trie so that it can be removed
+   * without searching.
+   */
+  struct IndexEntry {
+    IndexEntry
+      (NameNode* node,
+       const std::list<ptr_lib::shared_ptr<Entry> >::iterator& position)
+    : node_(node), position_(position)
+    {
+    }
+
+    NameNode* node_;
+    std::list<ptr_lib::shared_ptr<Entry> >::iterator position_;
+  };
+
+  typedef std::unordered_map<uint64_t, IndexEntry> IdIndex;
+
+  /**
+   * Find the trie node for the name.
+   * @param name The name to look for.
+   * @return The node, or null if there is no node for the name.
+   */
+  NameNode*
+  findNode(const Name& name);
+
+  /**
+   * Remove the entry at the index position from its trie node and from
+   * idIndex_, set its isRemoved flag, and remove trie nodes which become empty.
+   * @param index The position in idIndex_.
+   */
+  void
+  erase(IdIndex::iterator index);
+
+  /**
+   * Remove the entries in removeRequests_ which are older than
+   * removeRequestLifetime_.
+   * @param now The current time.
+   */
+  void
+  expireRemoveRequests(std::chrono::steady_clock::time_point now);
+
+  NameNode root_;
+  IdIndex idIndex_;
+  // A removal request is kept until add is called with the pendingInterestId
+  // or it expires. A request for an entry which was already satisfied or timed
+  // out will never be used, so it must expire.
+  std::unordered_map<uint64_t, std::chrono::steady_clock::time_point>
+    removeRequests_;
+  // The removal requests in the order they were made, for expiry. This may
+  // have IDs which were already removed from removeRequests_.
+  std::deque<std::pair<std::chrono::steady_clock::time_point, uint64_t> >
+    removeRequestExpiry_;
+  std::chrono::nanoseconds removeRequestLifetime_;
 };
 
 }
@@ -8,7 +8,7 @@
  * Original file: src/impl/registered-prefix-table.cpp
  * Original repository: https://github.com/named-data/ndn-cpp
  *
- * Summary of Changes: Use ndn-ind includes.
+ * Summary of Changes: Use ndn-ind includes. Index entries by registeredPrefixId.
  *
  * which was originally released under the LGPL license with the following rights:
  *
@@ -31,7 +31,6 @@
  * A copy of the GNU Lesser General Public License is in the file COPYING.
  */
 
-#include <algorithm>
 #include <ndn-ind/util/logging.hpp>
 #include "registered-prefix-table.hpp"
 
@@ -46,54 +45,38 @@ RegisteredPrefixTable::add
   (uint64_t registeredPrefixId, const ptr_lib::shared_ptr<const Name>& prefix,
    uint64_t relatedInterestFilterId)
 {
-  vector<uint64_t>::iterator removeRequestIterator =
-    ::find(removeRequests_.begin(), removeRequests_.end(), registeredPrefixId);
-  if (removeRequestIterator != removeRequests_.end()) {
+  if (removeRequests_.erase(registeredPrefixId) > 0)
     // removeRegisteredPrefix was called with the registeredPrefixId returned
     //   by registerPrefix before we got here, so don't add a registered
     //   prefix table entry.
-    removeRequests_.erase(removeRequestIterator);
     return false;
-  }
 
-  table_.push_back(ptr_lib::make_shared<Entry>
-    (registeredPrefixId, prefix, relatedInterestFilterId));
+  table_[registeredPrefixId] = ptr_lib::make_shared<Entry>
+    (registeredPrefixId, prefix, relatedInterestFilterId);
   return true;
 }
 
 void
 RegisteredPrefixTable::removeRegisteredPrefix(uint64_t registeredPrefixId)
 {
-  int count = 0;
-  // Go backwards through the list so we can erase entries.
-  // Remove all entries even though registeredPrefixId should be unique.
-  for (int i = (int)table_.size() - 1; i >= 0; --i) {
-    Entry& entry = *table_[i];
-
-    if (entry.getRegisteredPrefixId() == registeredPrefixId) {
-      ++count;
-
-      if (entry.getRelatedInterestFilterId() > 0)
-        // Remove the related interest filter.
-        interestFilterTable_.unsetInterestFilter(entry.getRelatedInterestFilterId());
-
-      table_.erase(table_.begin() + i);
-    }
-  }
-
-  if (count == 0)
+  unordered_map<uint64_t, ptr_lib::shared_ptr<Entry> >::iterator found =
+    table_.find(registeredPrefixId);
+  if (found == table_.end()) {
     _LOG_DEBUG("removeRegisteredPrefix: Didn't find registeredPrefixId " << registeredPrefixId);
 
-  if (count == 0) {
     // The registeredPrefixId was not found. Perhaps this has been called before
     //   the callback in registerPrefix can add to the registered prefix table.
     //   Add this removal request which will be checked before adding to the
-    //   registered prefix table.
-    if (::find(removeRequests_.begin(), removeRequests_.end(), registeredPrefixId)
-        == removeRequests_.end())
-      // Not already requested, so add the request.
-      removeRequests_.push_back(registeredPrefixId);
+    //   registered prefix table. (If already requested, this does nothing.)
+    removeRequests_.insert(registeredPrefixId);
+    return;
   }
+
+  ptr_lib::shared_ptr<Entry> entry = found->second;
+  table_.erase(found);
+  if (entry->getRelatedInterestFilterId() > 0)
+    // Remove the related interest filter.
+    interestFilterTable_.unsetInterestFilter(entry->getRelatedInterestFilterId());
 }
 
 }
@@ -8,7 +8,7 @@
  * Original file: src/impl/registered-prefix-table.hpp
  * Original repository: https://github.com/named-data/ndn-cpp
  *
- * Summary of Changes: Use ndn-ind includes.
+ * Summary of Changes: Use ndn-ind includes. Index entries by registeredPrefixId.
  *
  * which was originally released under the LGPL license with the following rights:
  *
@@ -34,6 +34,8 @@
 #ifndef NDN_REGISTERED_PREFIX_TABLE_HPP
 #define NDN_REGISTERED_PREFIX_TABLE_HPP
 
+#include <unordered_map>
+#include <unordered_set>
 #include <ndn-ind/face.hpp>
 #include "interest-filter-table.hpp"
 
@@ -134,9 +136,10 @@ private:
     uint64_t relatedInterestFilterId_;
   };
 
-  std::vector<ptr_lib::shared_ptr<Entry> > table_;
+  // The key is the registeredPrefixId.
+  std::unordered_map<uint64_t, ptr_lib::shared_ptr<Entry> > table_;
   InterestFilterTable& interestFilterTable_;
-  std::vector<uint64_t> removeRequests_;
+  std::unordered_set<uint64_t> removeRequests_;
 };
 
 }
@@ -8,7 +8,7 @@
  * Original file: src/in-memory-storage/in-memory-storage-retaining.cpp
  * Original repository: https://github.com/named-data/ndn-cpp
  *
- * Summary of Changes: Use ndn-ind includes.
+ * Summary of Changes: Use ndn-ind includes. Use lower_bound, selectors, limit and lifetime.
  *
  * which was originally released under the LGPL license with the following rights:
  *
@@ -35,28 +35,148 @@
 #include <ndn-ind/in-memory-storage/in-memory-storage-retaining.hpp>
 
 using namespace std;
+using namespace std::chrono;
 
 namespace ndn_ind {
 
+void
+InMemoryStorageRetaining::insert(const Data& data, nanoseconds lifetime)
+{
+  auto now = this->now();
+  removeExpired(now);
+
+  ptr_lib::shared_ptr<Name> fullName = data.getFullName();
+  Cache::iterator found = cache_.find(*fullName);
+  if (found != cache_.end())
+    erase(found);
+  else if (limit_ != 0 && cache_.size() >= limit_)
+    // Evict the least recently used.
+    erase(useOrder_.front());
+
+  ptr_lib::shared_ptr<Data> dataCopy = ptr_lib::make_shared<Data>(data);
+  Cache::iterator entry = cache_.insert
+    (Cache::value_type(*fullName, dataCopy)).first;
+
+  EntryInfo& info = entryInfo_[dataCopy.get()];
+  if (data.getMetaInfo().getFreshnessPeriod().count() >= 0)
+    info.freshnessExpiryTime_ = now + duration_cast<system_clock::duration>
+      (data.getMetaInfo().getFreshnessPeriod());
+  else
+    info.freshnessExpiryTime_ = system_clock::time_point::max();
+  if (limit_ != 0)
+    info.usePosition_ = useOrder_.insert(useOrder_.end(), entry);
+  info.insertNumber_ = ++nInserted_;
+
+  if (lifetime.count() >= 0)
+    removalHeap_.push(RemovalEntry
+      (now + duration_cast<system_clock::duration>(lifetime), *fullName,
+       info.insertNumber_));
+}
+
 ptr_lib::shared_ptr<Data>
 InMemoryStorageRetaining::find(const Name& name)
 {
-  for (map<Name, ptr_lib::shared_ptr<Data> >::iterator i = cache_.begin();
-       i != cache_.end(); ++i) {
-    if (name.isPrefixOf(i->first))
-      return i->second;
+  removeExpired(this->now());
+
+  // The Name keys are in order, so the first name with the prefix is first.
+  Cache::iterator found = cache_.lower_bound(name);
+  if (found != cache_.end() && name.isPrefixOf(found->first)) {
+    touch(found);
+    return found->second;
   }
 
   return ptr_lib::shared_ptr<Data>();
 }
 
+ptr_lib::shared_ptr<Data>
+InMemoryStorageRetaining::find(const Interest& interest)
+{
+  auto now = this->now();
+  removeExpired(now);
+
+  // The full names with the interest name as a prefix are in [begin, end).
+  const Name& name = interest.getName();
+  Cache::iterator begin = cache_.lower_bound(name);
+  Cache::iterator end;
+  if (!interest.getCanBePrefix()) {
+    // Only a Data name equal to the interest name (or a full name equal to it)
+    // can match. Its full name is the interest name plus the implicit digest,
+    // which sorts before the other components, so stop at a longer name.
+    end = begin;
+    while (end != cache_.end() && end->first.size() <= name.size() + 1 &&
+           name.isPrefixOf(end->first))
+      ++end;
+  }
+  else
+    end = name.size() == 0 ? cache_.end() : cache_.lower_bound(name.getSuccessor());
+
+  Cache::iterator selected = cache_.end();
+  if (interest.getChildSelector() == 1) {
+    // Search from the end so that the first match has the rightmost child.
+    for (Cache::iterator i = end; i != begin; ) {
+      --i;
+      if (interest.matchesData(*i->second) &&
+          !(checkFreshness_ && interest.getMustBeFresh() &&
+            entryInfo_[i->second.get()].freshnessExpiryTime_ <= now)) {
+        selected = i;
+        break;
+      }
+    }
+  }
+  else {
+    for (Cache::iterator i = begin; i != end; ++i) {
+      if (interest.matchesData(*i->second) &&
+          !(checkFreshness_ && interest.getMustBeFresh() &&
+            entryInfo_[i->second.get()].freshnessExpiryTime_ <= now)) {
+        selected = i;
+        break;
+      }
+    }
+  }
+
+  if (selected == cache_.end())
+    return ptr_lib::shared_ptr<Data>();
+
+  touch(selected);
+  return selected->second;
+}
+
 void
 InMemoryStorageRetaining::remove(const Name& prefix)
 {
   // The Name keys are in order.
-  map<Name, ptr_lib::shared_ptr<Data> >::const_iterator it = cache_.lower_bound(prefix);
+  Cache::iterator it = cache_.lower_bound(prefix);
   while (it != cache_.end() && prefix.isPrefixOf(it->first))
-    cache_.erase(it++);
+    erase(it++);
+}
+
+void
+InMemoryStorageRetaining::removeExpired(system_clock::time_point now)
+{
+  while (!removalHeap_.empty() && removalHeap_.top().removalTime_ <= now) {
+    Cache::iterator found = cache_.find(removalHeap_.top().fullName_);
+    // Skip if the entry was already removed or replaced.
+    if (found != cache_.end() &&
+        entryInfo_[found->second.get()].insertNumber_ ==
+          removalHeap_.top().insertNumber_)
+      erase(found);
+
+    removalHeap_.pop();
+  }
+}
+
+void
+InMemoryStorageRetaining::erase(Cache::iterator entry)
+{
+  unordered_map<const Data*, EntryInfo>::iterator info =
+    entryInfo_.find(entry->second.get());
+  if (info != entryInfo_.end()) {
+    if (limit_ != 0)
+      useOrder_.erase(info->second.usePosition_);
+    entryInfo_.erase(info);
+  }
+
+  cache_.erase(entry);
 }
 
 }
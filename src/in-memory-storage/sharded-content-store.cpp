@@ -0,0 +1,110 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2020 Operant Networks, Incorporated.
+ * @author: Jeff Thompson <jefft0@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+
+#include <stdexcept>
+#include <ndn-ind/in-memory-storage/sharded-content-store.hpp>
+
+using namespace std;
+using namespace std::chrono;
+
+namespace ndn_ind {
+
+ShardedContentStore::ShardedContentStore
+  (size_t nShards, size_t limit, size_t nShardComponents)
+: nShardComponents_(nShardComponents)
+{
+  if (nShards == 0)
+    throw runtime_error
+      ("ShardedContentStore: The number of shards must be at least 1");
+
+  // Round up so that the shards together can hold the limit.
+  size_t shardLimit = (limit + nShards - 1) / nShards;
+  for (size_t i = 0; i < nShards; ++i)
+    shards_.push_back(ptr_lib::make_shared<Shard>(shardLimit));
+}
+
+void
+ShardedContentStore::insert(const Data& data, nanoseconds lifetime)
+{
+  // Decode the lazy fields and cache the encoding now, because the copy in the
+  // storage would otherwise update them when another thread reads it.
+  data.getMetaInfo();
+  data.getSignature();
+  data.wireEncode();
+
+  Shard& shard = *shards_[getShardIndex(data.getName())];
+  lock_guard<mutex> lock(shard.mutex_);
+  shard.storage_.insert(data, lifetime);
+}
+
+ptr_lib::shared_ptr<const Data>
+ShardedContentStore::find(const Name& name)
+{
+  if (name.size() >= nShardComponents_)
+    // Only one shard has names with this prefix.
+    return findInShard(getShardIndex(name), name);
+  else
+    return findInAllShards(name, false);
+}
+
+ptr_lib::shared_ptr<const Data>
+ShardedContentStore::find(const Interest& interest)
+{
+  const Name& name = interest.getName();
+  if (name.size() > 0 && name.get(-1).isImplicitSha256Digest())
+    // Only the Data packet with the name before the digest can match.
+    return findInShard(getShardIndex(name.getPrefix(-1)), interest);
+  else if (!interest.getCanBePrefix() || name.size() >= nShardComponents_)
+    return findInShard(getShardIndex(name), interest);
+  else
+    return findInAllShards(interest, interest.getChildSelector() == 1);
+}
+
+void
+ShardedContentStore::remove(const Name& prefix)
+{
+  if (prefix.size() >= nShardComponents_) {
+    Shard& shard = *shards_[getShardIndex(prefix)];
+    lock_guard<mutex> lock(shard.mutex_);
+    shard.storage_.remove(prefix);
+  }
+  else {
+    for (size_t i = 0; i < shards_.size(); ++i) {
+      lock_guard<mutex> lock(shards_[i]->mutex_);
+      shards_[i]->storage_.remove(prefix);
+    }
+  }
+}
+
+size_t
+ShardedContentStore::size()
+{
+  size_t result = 0;
+  for (size_t i = 0; i < shards_.size(); ++i) {
+    lock_guard<mutex> lock(shards_[i]->mutex_);
+    result += shards_[i]->storage_.size();
+  }
+
+  return result;
+}
+
+}
@@ -9,6 +9,7 @@
  * Original repository: https://github.com/named-data/ndn-cpp
  *
  * Summary of Changes: Use NDN_IND macros. Use std::chrono.
+ * Share a backing Blob in set. Add wireDecodeShared.
  *
  * which was originally released under the LGPL license with the following rights:
  *
@@ -114,9 +115,11 @@ Interest::get
 }
 
 void
-Interest::set(const InterestLite& interestLite, WireFormat& wireFormat)
+Interest::set
+  (const InterestLite& interestLite, WireFormat& wireFormat,
+   const Blob& backing)
 {
-  name_.get().set(interestLite.getName());
+  name_.get().set(interestLite.getName(), backing);
   setMinSuffixComponents(interestLite.getMinSuffixComponents());
   setMaxSuffixComponents(interestLite.getMaxSuffixComponents());
   didSetCanBePrefix_ = true;
@@ -127,7 +130,7 @@ Interest::set(const InterestLite& interestLite, WireFormat& wireFormat)
   setChildSelector(interestLite.getChildSelector());
   mustBeFresh_ = (interestLite.getMustBeFresh());
   setInterestLifetimeMilliseconds(interestLite.getInterestLifetimeMilliseconds());
-  applicationParameters_ = Blob(interestLite.getApplicationParameters());
+  applicationParameters_ = Blob(interestLite.getApplicationParameters(), backing);
   if (interestLite.getForwardingHintWireEncoding().buf()) {
     // InterestLite only stores the encoded delegation set.
     try {
@@ -146,7 +149,7 @@ Interest::set(const InterestLite& interestLite, WireFormat& wireFormat)
   setSelectedDelegationIndex(interestLite.getSelectedDelegationIndex());
 
   // Set the nonce last so that getNonceChangeCount_ is set correctly.
-  nonce_ = Blob(interestLite.getNonce());
+  nonce_ = Blob(interestLite.getNonce(), backing);
   // Set getNonceChangeCount_ so that the next call to getNonce() won't clear nonce_.
   getNonceChangeCount_ = getChangeCount();
 }
@@ -190,6 +193,24 @@ Interest::wireDecode(const Blob& input, WireFormat& wireFormat)
     setDefaultWireEncoding(SignedBlob(), 0);
 }
 
+void
+Interest::wireDecodeShared(const Blob& input, WireFormat& wireFormat)
+{
+  size_t signedPortionBeginOffset, signedPortionEndOffset;
+  // Use the Blob so that the wire format can share its buffer.
+  wireFormat.decodeInterest
+    (*this, input, &signedPortionBeginOffset, &signedPortionEndOffset);
+
+  if (&wireFormat == WireFormat::getDefaultWireFormat())
+    // This is the default wire encoding.
+    // Take a pointer to the input Blob without copying.
+    setDefaultWireEncoding
+      (SignedBlob(input, signedPortionBeginOffset, signedPortionEndOffset),
+       WireFormat::getDefaultWireFormat());
+  else
+    setDefaultWireEncoding(SignedBlob(), 0);
+}
+
 void
 Interest::wireDecode
   (const uint8_t *input, size_t inputLength, WireFormat& wireFormat)
@@ -223,7 +244,7 @@ Interest::toUri() const
     selectors << "&ndn.InterestLifetime=" << (uint64_t)round(getInterestLifetimeMilliseconds());
   if (getNonce().size() > 0) {
     selectors << "&ndn.Nonce=";
-    Name::toEscapedString(*getNonce(), selectors);
+    Name::toEscapedString(getNonce().buf(), getNonce().size(), selectors);
   }
   if (exclude_.get().size() > 0)
     selectors << "&ndn.Exclude=" << exclude_.get().toUri();
@@ -393,8 +414,7 @@ Interest::refreshNonce()
     if ((error = CryptoLite::generateRandomBytes
          (&newNonce->front(), newNonce->size())))
       throw runtime_error(ndn_getErrorString(error));
-    // Use the vector equals operator.
-    if (*newNonce != *currentNonce)
+    if (!currentNonce.equals(Blob(newNonce, false)))
       break;
   }
 
@@ -9,6 +9,7 @@
  * Original repository: https://github.com/named-data/ndn-cpp
  *
  * Summary of Changes: Use ndn-ind includes. Add findParametersSha256Digest.
+ * Share a backing Blob in set. Hold short component values inline.
  *
  * which was originally released under the LGPL license with the following rights:
  *
@@ -37,9 +38,9 @@
 #include <string.h>
 #include <stdexcept>
 #include <stdlib.h>
+#include <thread>
 #include <ndn-ind/name.hpp>
 #include "c/util/ndn_memory.h"
-#include "encoding/tlv-encoder.hpp"
 
 using namespace std;
 
@@ -187,35 +188,58 @@ Name::Component::fromNumber
         ("fromNumber: other type code must be non-negative");
   }
 
-  TlvEncoder encoder(8);
-  encoder.writeNonNegativeInteger(number);
-  return Name::Component(Blob(encoder.finish()), type, otherTypeCode);
+  // Encode in a local buffer so that the Component copies the short value
+  // without allocating.
+  uint8_t buffer[8];
+  NameLite::Component componentLite;
+  ndn_Error error;
+  if ((error = componentLite.setFromNumber
+       (number, buffer, sizeof(buffer), type, otherTypeCode)))
+    throw runtime_error(ndn_getErrorString(error));
+
+  return Name::Component(componentLite);
 }
 
 Name::Component
 Name::Component::fromNumberWithMarker(uint64_t number, uint8_t marker)
 {
-  TlvEncoder encoder(9);
-  // Add the leading marker.
-  encoder.writeNonNegativeInteger(marker & 0xff);
-  encoder.writeNonNegativeInteger(number);
-  return Name::Component(encoder.finish());
+  uint8_t buffer[9];
+  NameLite::Component componentLite;
+  ndn_Error error;
+  if ((error = componentLite.setFromNumberWithMarker
+       (number, marker, buffer, sizeof(buffer))))
+    throw runtime_error(ndn_getErrorString(error));
+
+  return Name::Component(componentLite);
 }
 
 Name::Component
 Name::Component::fromNumberWithPrefix(uint64_t number, const uint8_t* prefix, size_t prefixLength)
 {
-  // Initialize with the prefix
-  ptr_lib::shared_ptr<vector<uint8_t> > value(new vector<uint8_t>(prefix, prefix + prefixLength));
-
+  uint8_t numberBuffer[8];
+  size_t numberLength = 0;
   // First encode in little endian.
   while (number != 0) {
-    value->push_back(number & 0xff);
+    numberBuffer[numberLength++] = number & 0xff;
     number >>= 8;
   }
 
   // Make it big endian.
-  reverse(value->begin() + prefixLength, value->end());
+  reverse(numberBuffer, numberBuffer + numberLength);
+
+  if (prefixLength + numberLength <= MAX_INLINE_VALUE_LENGTH) {
+    Component result;
+    ndn_memcpy(result.inlineValue_, prefix, prefixLength);
+    ndn_memcpy
+      (result.inlineValue_ + prefixLength, numberBuffer, numberLength);
+    result.inlineValueLength_ = (uint8_t)(prefixLength + numberLength);
+    return result;
+  }
+
+  ptr_lib::shared_ptr<vector<uint8_t> > value
+    (new vector<uint8_t>(prefixLength + numberLength));
+  ndn_memcpy(&(*value)[0], prefix, prefixLength);
+  ndn_memcpy(&(*value)[prefixLength], numberBuffer, numberLength);
   return Name::Component(Blob(value, false));
 }
 
@@ -223,11 +247,12 @@ void
 Name::Component::get(NameLite::Component& componentLite) const
 {
   if (type_ == ndn_NameComponentType_IMPLICIT_SHA256_DIGEST)
-    componentLite.setImplicitSha256Digest(value_);
+    componentLite.setImplicitSha256Digest(valueBuf(), valueSize());
   if (type_ == ndn_NameComponentType_PARAMETERS_SHA256_DIGEST)
-    componentLite.setParametersSha256Digest(value_);
+    componentLite.setParametersSha256Digest(valueBuf(), valueSize());
   else
-    componentLite = NameLite::Component(value_, type_, otherTypeCode_);
+    componentLite = NameLite::Component
+      (valueBuf(), valueSize(), type_, otherTypeCode_);
 }
 
 void
@@ -235,12 +260,12 @@ Name::Component::toEscapedString(std::ostringstream& result) const
 {
   if (type_ == ndn_NameComponentType_IMPLICIT_SHA256_DIGEST) {
     result << "sha256digest=";
-    value_.toHex(result);
+    ndn_ind::toHex(valueBuf(), valueSize(), result);
     return;
   }
   if (type_ == ndn_NameComponentType_PARAMETERS_SHA256_DIGEST) {
     result << "params-sha256=";
-    value_.toHex(result);
+    ndn_ind::toHex(valueBuf(), valueSize(), result);
     return;
   }
 
@@ -250,7 +275,7 @@ Name::Component::toEscapedString(std::ostringstream& result) const
     result << '=';
   }
 
-  Name::toEscapedString(*value_, result);
+  Name::toEscapedString(valueBuf(), valueSize(), result);
 }
 
 std::string
@@ -283,13 +308,15 @@ Name::Component::compare(const Name::Component& other) const
   if (myTypeCode > otherTypeCode)
     return 1;
 
-  if (value_.size() < other.value_.size())
+  size_t valueSize = this->valueSize();
+  size_t otherValueSize = other.valueSize();
+  if (valueSize < otherValueSize)
     return -1;
-  if (value_.size() > other.value_.size())
+  if (valueSize > otherValueSize)
     return 1;
 
   // The components are equal length.  Just do a byte compare.
-  return ndn_memcmp(value_.buf(), other.value_.buf(), value_.size());
+  return ndn_memcmp(valueBuf(), other.valueBuf(), valueSize);
 }
 
 Name::Component
@@ -319,18 +346,20 @@ Name::Component::fromParametersSha256Digest(const Blob& digest)
 Name::Component
 Name::Component::getSuccessor() const
 {
+  const uint8_t* value = valueBuf();
+  size_t valueSize = this->valueSize();
   // Allocate an extra byte in case the result is larger.
   ptr_lib::shared_ptr<vector<uint8_t> > result
-    (new vector<uint8_t>(value_.size() + 1));
+    (new vector<uint8_t>(valueSize + 1));
 
   bool carry = true;
-  for (int i = (int)value_.size() - 1; i >= 0; --i) {
+  for (int i = (int)valueSize - 1; i >= 0; --i) {
     if (carry) {
-      (*result)[i] = value_.buf()[i] + 1;
+      (*result)[i] = value[i] + 1;
       carry = ((*result)[i] == 0);
     }
     else
-      (*result)[i] = value_.buf()[i];
+      (*result)[i] = value[i];
   }
 
   if (carry)
@@ -340,11 +369,32 @@ Name::Component::getSuccessor() const
     (*result)[result->size() - 1] = 0;
   else
     // We didn't need the extra byte.
-    result->resize(value_.size());
+    result->resize(valueSize);
 
   return Component(Blob(result, false), type_, otherTypeCode_);
 }
 
+void
+Name::Component::createInlineBlob() const
+{
+  uint8_t state = INLINE_BLOB_NONE;
+  if (inlineBlobState_.compare_exchange_strong
+      (state, INLINE_BLOB_CREATING, memory_order_acquire)) {
+    try {
+      value_ = Blob(inlineValue_, inlineValueLength_);
+    } catch (...) {
+      inlineBlobState_.store(INLINE_BLOB_NONE, memory_order_release);
+      throw;
+    }
+    inlineBlobState_.store(INLINE_BLOB_CREATED, memory_order_release);
+    return;
+  }
+
+  // Another thread is creating value_, which only takes an allocation.
+  while (inlineBlobState_.load(memory_order_acquire) != INLINE_BLOB_CREATED)
+    this_thread::yield();
+}
+
 void
 Name::Component::setType(ndn_NameComponentType type, int otherTypeCode)
 {
@@ -485,11 +535,12 @@ Name::get(NameLite& nameLite) const
 }
 
 void
-Name::set(const NameLite& nameLite)
+Name::set(const NameLite& nameLite, const Blob& backing)
 {
   clear();
+  components_.reserve(nameLite.size());
   for (size_t i = 0; i < nameLite.size(); ++i)
-    append(Component(nameLite.get(i)));
+    append(Component(nameLite.get(i), backing));
 }
 
 Name&
@@ -545,7 +596,7 @@ Name::equals(const Name& name) const
 
   // Check from last to first since the last components are more likely to differ.
   for (int i = components_.size() - 1; i >= 0; --i) {
-    if (*components_[i].getValue() != *name.components_[i].getValue())
+    if (!components_[i].valueEquals(name.components_[i]))
       return false;
   }
 
@@ -573,7 +624,7 @@ Name::match(const Name& name) const
   // Check if at least one of given components doesn't match. Check from last to
   // first since the last components are more likely to differ.
   for (int i = components_.size() - 1; i >= 0; --i) {
-    if (*components_[i].getValue() != *name.components_[i].getValue())
+    if (!components_[i].valueEquals(name.components_[i]))
       return false;
   }
 
@@ -622,10 +673,11 @@ Name::fromEscapedString(const char *escapedString)
 }
 
 void
-Name::toEscapedString(const vector<uint8_t>& value, ostringstream& result)
+Name::toEscapedString
+  (const uint8_t* value, size_t valueLength, ostringstream& result)
 {
   bool gotNonDot = false;
-  for (unsigned i = 0; i < value.size(); ++i) {
+  for (unsigned i = 0; i < valueLength; ++i) {
     if (value[i] != 0x2e) {
       gotNonDot = true;
       break;
@@ -634,14 +686,14 @@ Name::toEscapedString(const vector<uint8_t>& value, ostringstream& result)
   if (!gotNonDot) {
     // Special case for component of zero or more periods.  Add 3 periods.
     result << "...";
-    for (size_t i = 0; i < value.size(); ++i)
+    for (size_t i = 0; i < valueLength; ++i)
       result << '.';
   }
   else {
     // In case we need to escape, set to upper case hex and save the previous flags.
     ios::fmtflags saveFlags = result.flags(ios::hex | ios::uppercase);
 
-    for (size_t i = 0; i < value.size(); ++i) {
+    for (size_t i = 0; i < valueLength; ++i) {
       uint8_t x = value[i];
       // Check for 0-9, A-Z, a-z, (+), (-), (.), (_)
       if ((x >= 0x30 && x <= 0x39) || (x >= 0x41 && x <= 0x5a) ||
@@ -8,7 +8,8 @@
  * Original file: src/node.cpp
  * Original repository: https://github.com/named-data/ndn-cpp
  *
- * Summary of Changes: Use NDN_IND macros. Use std::chrono.
+ * Summary of Changes: Use NDN_IND macros. Use std::chrono. Add onReceivedElement(Blob). Optionally decode Data lazily.
+ * Cork the transport in processEvents. Add processEvents(maxWait). Optionally decode as slices.
  *
  * which was originally released under the LGPL license with the following rights:
  *
@@ -55,7 +56,9 @@ Node::Node(const ptr_lib::shared_ptr<Transport>& transport, const ptr_lib::share
 : transport_(transport), connectionInfo_(connectionInfo),
   timeoutPrefix_(Name("/local/timeout")),
   lastEntryId_(0), connectStatus_(ConnectStatus_UNCONNECTED),
-  interestLoopbackEnabled_(false), registeredPrefixTable_(interestFilterTable_),
+  interestLoopbackEnabled_(false), lazyDataDecodingEnabled_(false),
+  sharedDecodingEnabled_(false),
+  registeredPrefixTable_(interestFilterTable_),
   nonceTemplate_((const uint8_t*)"\0\0\0\0", 4)
 {
 }
@@ -414,54 +417,130 @@ Node::nfdRegisterPrefix
 void
 Node::processEvents()
 {
-  transport_->processEvents();
+  // If this is called by a callback of an outer processEvents, send the
+  // packets which the callback sent before it waits in this nested loop.
+  transport_->flush();
+  // Cork the transport so that the packets sent by the callbacks in this
+  // turn of the event loop are sent together when we uncork.
+  transport_->cork();
+  try {
+    transport_->processEvents();
+
+    // If Face::callLater is overridden to use a different mechanism, then
+    // processEvents is not needed to check for delayed calls.
+    delayedCallTable_.callTimedOut();
+  } catch (...) {
+    transport_->uncork();
+    throw;
+  }
+  transport_->uncork();
+}
+
+void
+Node::processEvents(nanoseconds maxWait)
+{
+  // Don't wait past the next delayed call, which processEvents() will call.
+  nanoseconds wait = min(maxWait, delayedCallTable_.getTimeUntilNextCall());
+  if (wait > nanoseconds::zero()) {
+    // A nested call must send the queued packets before waiting for a reply.
+    transport_->flush();
+    transport_->waitForReceive(wait);
+  }
 
-  // If Face::callLater is overridden to use a different mechanism, then
-  // processEvents is not needed to check for delayed calls.
-  delayedCallTable_.callTimedOut();
+  processEvents();
 }
 
 void
 Node::onReceivedElement(const uint8_t *element, size_t elementLength)
 {
-  ptr_lib::shared_ptr<LpPacket> lpPacket;
-  if (element[0] == ndn_Tlv_LpPacket_LpPacket) {
-    // Decode the LpPacket and replace element with the fragment.
-    // Use LpPacketLite to avoid copying the fragment.
-    struct ndn_LpPacketHeaderField headerFields[5];
-    LpPacketLite lpPacketLite
-      (headerFields, sizeof(headerFields) / sizeof(headerFields[0]));
-
-    ndn_Error error;
-    if ((error = Tlv0_2WireFormatLite::decodeLpPacket
-         (lpPacketLite, element, elementLength)))
-      throw runtime_error(ndn_getErrorString(error));
-    element = lpPacketLite.getFragmentWireEncoding().buf();
-    elementLength = lpPacketLite.getFragmentWireEncoding().size();
+  // The element buffer is only valid during this call, so copy it.
+  onReceivedElement(Blob(element, elementLength));
+}
+
+void
+Node::onReceivedElement(const Blob& element)
+{
+  if (!sharedDecodingEnabled_ && element.isSlice()) {
+    // The element is a slice of the transport's receive buffer. Copy it so that
+    // a kept packet doesn't keep the whole buffer.
+    onReceivedElement(Blob(element.buf(), element.size()));
+    return;
+  }
+
+  if (element.size() > 0 && element.buf()[0] == ndn_Tlv_LpPacket_LpPacket)
+    processLpPacket(element);
+  else
+    processElement(element, ptr_lib::shared_ptr<LpPacket>());
+}
+
+void
+Node::processLpPacket(const Blob& element)
+{
+  // Decode the LpPacket and process its fragment.
+  // Use LpPacketLite to avoid copying the fragment.
+  struct ndn_LpPacketHeaderField headerFields[5];
+  LpPacketLite lpPacketLite
+    (headerFields, sizeof(headerFields) / sizeof(headerFields[0]));
+
+  ndn_Error error;
+  if ((error = Tlv0_2WireFormatLite::decodeLpPacket
+       (lpPacketLite, element.buf(), element.size())))
+    throw runtime_error(ndn_getErrorString(error));
+  Blob fragment;
+  if (sharedDecodingEnabled_)
+    // The fragment is a slice which shares the buffer of element.
+    fragment = Blob(lpPacketLite.getFragmentWireEncoding(), element);
+  else
+    // Copy so that the decoded packet does not keep the LpPacket in memory.
+    fragment = Blob(lpPacketLite.getFragmentWireEncoding());
 
+  ptr_lib::shared_ptr<LpPacket> lpPacket;
+  if (lpPacketLite.countHeaderFields() > 0) {
     // We have saved the wire encoding, so clear to copy it to lpPacket.
+    // Only make an LpPacket if there are header fields to copy, since an
+    // LpPacket without header fields has the same effect as none.
     lpPacketLite.setFragmentWireEncoding(BlobLite());
 
     lpPacket.reset(new LpPacket());
     lpPacket->set(lpPacketLite);
   }
 
+  processElement(fragment, lpPacket);
+}
+
+void
+Node::processElement
+  (const Blob& element, const ptr_lib::shared_ptr<LpPacket>& lpPacket)
+{
   // First, decode as Interest or Data.
   ptr_lib::shared_ptr<Interest> interest;
   ptr_lib::shared_ptr<Data> data;
 
-  if (element[0] == ndn_Tlv_Interest || element[0] == ndn_Tlv_Data) {
-    TlvDecoder decoder(element, elementLength);
+  if (element.size() > 0 &&
+      (element.buf()[0] == ndn_Tlv_Interest || element.buf()[0] == ndn_Tlv_Data)) {
+    size_t elementLength = element.size();
+    TlvDecoder decoder(element.buf(), elementLength);
+    // Use wireDecode(Blob) so that the default wire encoding is a reference to
+    // the element, not a copy.
     if (decoder.peekType(ndn_Tlv_Interest, elementLength)) {
       interest.reset(new Interest());
-      interest->wireDecode(element, elementLength, *TlvWireFormat::get());
+      if (sharedDecodingEnabled_)
+        interest->wireDecodeShared(element, *TlvWireFormat::get());
+      else
+        interest->wireDecode(element, *TlvWireFormat::get());
 
       if (lpPacket)
         interest->setLpPacket(lpPacket);
     }
     else if (decoder.peekType(ndn_Tlv_Data, elementLength)) {
       data.reset(new Data());
-      data->wireDecode(element, elementLength, *TlvWireFormat::get());
+      if (lazyDataDecodingEnabled_)
+        // The application only needs the name, so decode the rest on demand.
+        data->wireDecodeLazy(element, *TlvWireFormat::get());
+      else if (sharedDecodingEnabled_)
+        data->wireDecodeShared(element, *TlvWireFormat::get());
+      else
+        data->wireDecode(element, *TlvWireFormat::get());
 
       if (lpPacket)
         data->setLpPacket(lpPacket);
@@ -528,8 +607,10 @@ Node::expressInterestHelper
       // Use a default timeout delay.
       delay = seconds(4);
 
-    face->callLater
-      (delay, bind(&Node::processInterestTimeout, this, pendingInterest));
+    // Keep the cancel function so that the PIT can remove the timeout when
+    // the entry is removed.
+    pendingInterest->setCancelTimeout(face->callLaterCancellable
+      (delay, bind(&Node::processInterestTimeout, this, pendingInterest)));
   }
 
   // Special case: For timeoutPrefix_ we don't actually send the interest.
@@ -538,7 +619,7 @@ Node::expressInterestHelper
     if (encoding.size() > getMaxNdnPacketSize())
       throw runtime_error
         ("The encoded interest size exceeds the maximum limit getMaxNdnPacketSize()");
-    transport_->send(*encoding);
+    transport_->send(encoding.buf(), encoding.size());
 
     if (interestLoopbackEnabled_)
         dispatchInterest(interestCopy);
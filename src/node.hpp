@@ -9,6 +9,8 @@
  * Original repository: https://github.com/named-data/ndn-cpp
  *
  * Summary of Changes: Use NDN_IND macros. Use std::chrono. Put element-listener.hpp in API.
+ * Add onReceivedElement(Blob). Add processEvents(maxWait). Add setLazyDataDecodingEnabled.
+ * Add setSharedDecodingEnabled.
  *
  * which was originally released under the LGPL license with the following rights:
  *
@@ -76,6 +78,29 @@ public:
     interestLoopbackEnabled_ = interestLoopbackEnabled;
   }
 
+  /**
+   * Enable or disable lazy decoding of incoming Data packets.
+   * @param lazyDataDecodingEnabled If true, decode an incoming Data with
+   * Data::wireDecodeLazy, otherwise use Data::wireDecode.
+   */
+  void
+  setLazyDataDecodingEnabled(bool lazyDataDecodingEnabled)
+  {
+    lazyDataDecodingEnabled_ = lazyDataDecodingEnabled;
+  }
+
+  /**
+   * Enable or disable shared decoding of incoming packets.
+   * @param sharedDecodingEnabled If true, decode an incoming Interest or Data
+   * with wireDecodeShared and keep an LpPacket fragment as a slice of the
+   * element, otherwise use wireDecode and copy the fragment.
+   */
+  void
+  setSharedDecodingEnabled(bool sharedDecodingEnabled)
+  {
+    sharedDecodingEnabled_ = sharedDecodingEnabled;
+  }
+
   /**
    * Send the Interest through the transport, read the entire response and call
    * onData, onTimeout or onNetworkNack as described below.
@@ -124,6 +149,17 @@ public:
     pendingInterestTable_.removePendingInterest(pendingInterestId);
   }
 
+  /**
+   * Remove the pending interest entries with the pendingInterestIds from the
+   * pending interest table.
+   * @param pendingInterestIds The IDs returned from expressInterest.
+   */
+  void
+  removePendingInterests(const std::vector<uint64_t>& pendingInterestIds)
+  {
+    pendingInterestTable_.removePendingInterests(pendingInterestIds);
+  }
+
   /**
    * Append a timestamp component and a random value component to interest's
    * name. Then use the keyChain and certificateName to sign the interest. If
@@ -305,6 +341,17 @@ public:
   void
   processEvents();
 
+  /**
+   * Wait until there is data to receive, the next delayed call such as an
+   * interest timeout is due, or maxWait has elapsed, whichever comes first,
+   * then call processEvents().
+   * @param maxWait The maximum time to wait.
+   * @throws This may throw an exception for reading data or in the callback
+   * for processing the data.
+   */
+  void
+  processEvents(std::chrono::nanoseconds maxWait);
+
   const ptr_lib::shared_ptr<Transport>&
   getTransport() { return transport_; }
 
@@ -314,6 +361,16 @@ public:
   void
   onReceivedElement(const uint8_t *element, size_t elementLength);
 
+  /**
+   * Process the received element. The decoded Interest or Data keeps a
+   * reference to the element as its default wire encoding. If the element is a
+   * slice of a larger buffer and shared decoding is not enabled, first copy it
+   * into an exact-size Blob so that the larger buffer is not kept.
+   * @param element The Blob with the entire element.
+   */
+  void
+  onReceivedElement(const Blob& element);
+
   /**
    * Check if the face is local based on the current connection through the
    * Transport; some Transport may cause network I/O (e.g. an IP host name lookup).
@@ -347,6 +404,26 @@ public:
     delayedCallTable_.callLater(delay, callback);
   }
 
+  /**
+   * Call callback() after the given delay, the same as callLater, and return a
+   * function which removes the call from delayedCallTable_.
+   * @param delay The delay.
+   * @param callback This calls callback() after the delay.
+   * @return A function which cancels the call. It does nothing if the call was
+   * already made.
+   */
+  Face::Callback
+  callLaterCancellable
+    (std::chrono::nanoseconds delay, const Face::Callback& callback)
+  {
+    // Use a weak_ptr so that the cancel function doesn't keep the entry (and
+    // the callback) alive.
+    ptr_lib::weak_ptr<DelayedCallTable::Entry> entry =
+      delayedCallTable_.callLater(delay, callback);
+    return func_lib::bind
+      (&DelayedCallTable::cancelIfExists, &delayedCallTable_, entry);
+  }
+
   /**
    * Get the next unique entry ID for the pending interest table, interest
    * filter table, etc. This uses an atomic_uint64_t to be thread safe. Most
@@ -509,6 +586,24 @@ private:
   void
   onConnected();
 
+  /**
+   * Decode the LpPacket and call processElement with its fragment, which shares
+   * the buffer of element.
+   * @param element The Blob with the LpPacket element.
+   */
+  void
+  processLpPacket(const Blob& element);
+
+  /**
+   * Decode the element as an Interest or Data and process it.
+   * @param element The Blob with the Interest or Data element. The decoded
+   * packet keeps a reference to it.
+   * @param lpPacket The LpPacket with the header fields, or null if none.
+   */
+  void
+  processElement
+    (const Blob& element, const ptr_lib::shared_ptr<LpPacket>& lpPacket);
+
   /**
    * Call the OnInterest callback for all entries in the interestFilterTable_
    * that match the interest.
@@ -550,6 +645,8 @@ private:
   Name timeoutPrefix_;
   ConnectStatus connectStatus_;
   bool interestLoopbackEnabled_;
+  bool lazyDataDecodingEnabled_;
+  bool sharedDecodingEnabled_;
   Blob nonceTemplate_;
 #if NDN_IND_HAVE_BOOST_ATOMIC
   // ThreadsafeFace accesses lastEntryId_ outside of a thread safe dispatch, so
@@ -214,7 +214,8 @@ TpmBackEndFile::saveKey
 {
   string filePath = toFilePath(keyName);
   ofstream file(filePath.c_str());
-  file << toBase64(*key->toPkcs1(), true);
+  Blob pkcs1 = key->toPkcs1();
+  file << toBase64(pkcs1.buf(), pkcs1.size(), true);
 
   // Set the file permissions.
 #if !defined(_WIN32) // Windows doesn't have Unix group permissions.
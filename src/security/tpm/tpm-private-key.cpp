@@ -447,12 +447,12 @@ TpmPrivateKey::toPkcs8(bool includeParameters)
   if (keyType_ == KEY_TYPE_EC) {
     OID parametersOid = getEcOid(*ecPrivateKey_);
     return encodePkcs8PrivateKey
-      (*toPkcs1(includeParameters), OID(EC_ENCRYPTION_OID),
+      (toPkcs1(includeParameters), OID(EC_ENCRYPTION_OID),
        ptr_lib::make_shared<DerNode::DerOid>(parametersOid));
   }
   else if (keyType_ == KEY_TYPE_RSA) {
     return encodePkcs8PrivateKey
-      (*toPkcs1(), OID(RSA_ENCRYPTION_OID),
+      (toPkcs1(), OID(RSA_ENCRYPTION_OID),
        ptr_lib::make_shared<DerNode::DerNull>());
   }
   else
@@ -571,7 +571,7 @@ TpmPrivateKey::generatePrivateKey(const KeyParams& keyParams)
 
 Blob
 TpmPrivateKey::encodePkcs8PrivateKey
-  (const vector<uint8_t>& privateKeyDer, const OID& oid,
+  (const Blob& privateKeyDer, const OID& oid,
    const ptr_lib::shared_ptr<DerNode>& parameters)
 {
   ptr_lib::shared_ptr<DerSequence> algorithmIdentifier(new DerSequence());
@@ -582,7 +582,7 @@ TpmPrivateKey::encodePkcs8PrivateKey
   result.addChild(ptr_lib::make_shared<DerNode::DerInteger>(0));
   result.addChild(algorithmIdentifier);
   result.addChild(ptr_lib::make_shared<DerNode::DerOctetString>
-    (&privateKeyDer[0], privateKeyDer.size()));
+    (privateKeyDer.buf(), privateKeyDer.size()));
 
   return result.encode();
 }
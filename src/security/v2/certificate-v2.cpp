@@ -137,7 +137,7 @@ CertificateV2::printCertificate(ostream& output) const
   */
 
   output << "Public key bits:\n";
-  output << toBase64(*getPublicKey(), true);
+  output << toBase64(getPublicKey().buf(), getPublicKey().size(), true);
 
   output << "Signature Information:\n";
   output << "  Signature Type: ";
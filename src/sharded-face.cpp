@@ -0,0 +1,186 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2020 Operant Networks, Incorporated.
+ * @author: Jeff Thompson <jefft0@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+// Only compile if ndn-ind-config.h defines NDN_IND_HAVE_BOOST_ASIO.
+#include <ndn-ind/ndn-ind-config.h>
+#ifdef NDN_IND_HAVE_BOOST_ASIO
+
+#include <stdexcept>
+#include <ndn-ind/sharded-face.hpp>
+
+using namespace std;
+
+namespace ndn_ind {
+
+ShardedFace::Shard::Shard()
+: work_(new boost::asio::io_service::work(ioService_))
+{
+}
+
+ShardedFace::ShardedFace
+  (size_t nShards, const MakeTransport& makeTransport,
+   const ptr_lib::shared_ptr<const Transport::ConnectionInfo>& connectionInfo)
+{
+  if (nShards == 0)
+    throw runtime_error("ShardedFace: The number of shards must be at least 1");
+
+  for (size_t i = 0; i < nShards; ++i) {
+    ptr_lib::shared_ptr<Shard> shard(new Shard());
+    shard->face_.reset(new ThreadsafeFace
+      (shard->ioService_, makeTransport(shard->ioService_), connectionInfo));
+    shards_.push_back(shard);
+  }
+
+  start();
+}
+
+ShardedFace::ShardedFace(size_t nShards)
+{
+  if (nShards == 0)
+    throw runtime_error("ShardedFace: The number of shards must be at least 1");
+
+  for (size_t i = 0; i < nShards; ++i) {
+    ptr_lib::shared_ptr<Shard> shard(new Shard());
+    shard->face_.reset(new ThreadsafeFace(shard->ioService_));
+    shards_.push_back(shard);
+  }
+
+  start();
+}
+
+void
+ShardedFace::start()
+{
+  for (size_t i = 0; i < shards_.size(); ++i) {
+    boost::asio::io_service* ioService = &shards_[i]->ioService_;
+    shards_[i]->thread_ = thread([ioService]() { ioService->run(); });
+  }
+}
+
+ShardedFace::~ShardedFace()
+{
+  // Stop now instead of waiting for the timers of pending interests.
+  for (size_t i = 0; i < shards_.size(); ++i) {
+    shards_[i]->work_.reset();
+    shards_[i]->ioService_.stop();
+  }
+
+  for (size_t i = 0; i < shards_.size(); ++i) {
+    if (shards_[i]->thread_.joinable())
+      shards_[i]->thread_.join();
+    // The thread is stopped, so call Face::shutdown directly instead of the
+    // ThreadsafeFace dispatch.
+    shards_[i]->face_->Face::shutdown();
+  }
+}
+
+void
+ShardedFace::setCommandSigningInfo
+  (KeyChain& keyChain, const Name& certificateName)
+{
+  for (size_t i = 0; i < shards_.size(); ++i)
+    shards_[i]->face_->setCommandSigningInfo(keyChain, certificateName);
+}
+
+uint64_t
+ShardedFace::expressInterest
+  (const Interest& interest, const OnData& onData, const OnTimeout& onTimeout,
+   const OnNetworkNack& onNetworkNack, WireFormat& wireFormat)
+{
+  size_t shardIndex = getShardIndex(interest.getName());
+  return makeId
+    (shards_[shardIndex]->face_->expressInterest
+       (interest, onData, onTimeout, onNetworkNack, wireFormat),
+     shardIndex);
+}
+
+void
+ShardedFace::removePendingInterest(uint64_t pendingInterestId)
+{
+  shards_[getShardIndexOfId(pendingInterestId)]->face_->removePendingInterest
+    (getFaceIdOfId(pendingInterestId));
+}
+
+uint64_t
+ShardedFace::registerPrefix
+  (const Name& prefix, const OnInterestCallback& onInterest,
+   const OnRegisterFailed& onRegisterFailed,
+   const OnRegisterSuccess& onRegisterSuccess,
+   const RegistrationOptions& registrationOptions, WireFormat& wireFormat)
+{
+  size_t shardIndex = getShardIndex(prefix);
+  uint64_t registeredPrefixId = makeId
+    (shards_[shardIndex]->face_->registerPrefix
+       (prefix, onInterest, onRegisterFailed, onRegisterSuccess,
+        registrationOptions, wireFormat),
+     shardIndex);
+
+  lock_guard<mutex> lock(registeredPrefixesMutex_);
+  registeredPrefixes_[registeredPrefixId] = prefix;
+  return registeredPrefixId;
+}
+
+void
+ShardedFace::removeRegisteredPrefix(uint64_t registeredPrefixId)
+{
+  {
+    lock_guard<mutex> lock(registeredPrefixesMutex_);
+    registeredPrefixes_.erase(registeredPrefixId);
+  }
+
+  shards_[getShardIndexOfId(registeredPrefixId)]->face_->removeRegisteredPrefix
+    (getFaceIdOfId(registeredPrefixId));
+}
+
+uint64_t
+ShardedFace::setInterestFilter
+  (const InterestFilter& filter, const OnInterestCallback& onInterest)
+{
+  size_t shardIndex = getShardIndex(filter.getPrefix());
+  {
+    lock_guard<mutex> lock(registeredPrefixesMutex_);
+    // Find the longest registered prefix of the filter prefix.
+    size_t longestPrefixSize = 0;
+    for (map<uint64_t, Name>::iterator entry = registeredPrefixes_.begin();
+         entry != registeredPrefixes_.end(); ++entry) {
+      if (entry->second.size() >= longestPrefixSize &&
+          entry->second.isPrefixOf(filter.getPrefix())) {
+        longestPrefixSize = entry->second.size();
+        shardIndex = getShardIndexOfId(entry->first);
+      }
+    }
+  }
+
+  return makeId
+    (shards_[shardIndex]->face_->setInterestFilter(filter, onInterest),
+     shardIndex);
+}
+
+void
+ShardedFace::unsetInterestFilter(uint64_t interestFilterId)
+{
+  shards_[getShardIndexOfId(interestFilterId)]->face_->unsetInterestFilter
+    (getFaceIdOfId(interestFilterId));
+}
+
+}
+
+#endif // NDN_IND_HAVE_BOOST_ASIO
@@ -8,7 +8,7 @@
  * Original file: src/sync/detail/psync-segment-publisher.cpp
  * Original repository: https://github.com/named-data/ndn-cpp
  *
- * Summary of Changes: Use std::chrono.
+ * Summary of Changes: Use std::chrono. Use the storage lifetime.
  *
  * which was originally released under the LGPL license with the following rights:
  *
@@ -83,15 +83,8 @@ PSyncSegmentPublisher::publish
     if (interestSegment == segmentNo)
       face_.putData(*data);
 
-#if 0 // Until InMemoryStorageFifo implements an eviction policy, use InMemoryStorageRetaining.
+    // The storage removes the segment after the freshness period.
     storage_.insert(*data, freshnessPeriod);
-#else
-    storage_.insert(*data);
-#endif
-
-    face_.callLater
-      (freshnessPeriod,
-       bind(&InMemoryStorageRetaining::remove, &storage_, segmentName));
 
     ++segmentNo;
   } while (segmentBegin < end);
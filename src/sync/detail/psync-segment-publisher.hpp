@@ -8,7 +8,7 @@
  * Original file: src/sync/detail/psync-segment-publisher.hpp
  * Original repository: https://github.com/named-data/ndn-cpp
  *
- * Summary of Changes: Use NDN_IND macros. Use std::chrono.
+ * Summary of Changes: Use NDN_IND macros. Use std::chrono. Use the storage limit.
  *
  * which was originally released under the LGPL license with the following rights:
  *
@@ -57,10 +57,7 @@ public:
   PSyncSegmentPublisher
     (Face& face, KeyChain& keyChain,
      size_t inMemoryStorageLimit = MAX_SEGMENTS_STORED)
-  : face_(face), keyChain_(keyChain)
-#if 0 // Until InMemoryStorageFifo implements an eviction policy, use InMemoryStorageRetaining.
-    , storage_(inMemoryStorageLimit)
-#endif
+  : face_(face), keyChain_(keyChain), storage_(inMemoryStorageLimit)
   {
   }
 
@@ -95,11 +92,7 @@ public:
 private:
   Face& face_;
   KeyChain& keyChain_;
-#if 0 // Until InMemoryStorageFifo implements an eviction policy, use InMemoryStorageRetaining.
-  InMemoryStorageFifo storage_;
-#else
   InMemoryStorageRetaining storage_;
-#endif
 };
 
 }
@@ -148,6 +148,15 @@ ThreadsafeFace::removePendingInterest(uint64_t pendingInterestId)
     (boost::bind(&Node::removePendingInterest, node_, pendingInterestId));
 }
 
+void
+ThreadsafeFace::removePendingInterests
+  (const vector<uint64_t>& pendingInterestIds)
+{
+  // This copies the pendingInterestIds.
+  ioService_.dispatch
+    (boost::bind(&Node::removePendingInterests, node_, pendingInterestIds));
+}
+
 uint64_t
 ThreadsafeFace::registerPrefix
   (const Name& prefix, const OnInterestCallback& onInterest,
@@ -270,7 +279,7 @@ waitHandler
    ptr_lib::shared_ptr<boost::asio::deadline_timer> timer)
 {
   if (errorCode != boost::system::errc::success)
-    // Don't expect this to happen.
+    // The timer was cancelled by callLaterCancellable.
     return;
 
   callback();
@@ -279,6 +288,21 @@ waitHandler
 void
 ThreadsafeFace::callLater
   (nanoseconds delay, const Callback& callback)
+{
+  callLaterCancellable(delay, callback);
+}
+
+static void
+cancelTimer(const ptr_lib::weak_ptr<boost::asio::deadline_timer>& timer)
+{
+  ptr_lib::shared_ptr<boost::asio::deadline_timer> sharedTimer = timer.lock();
+  if (sharedTimer)
+    sharedTimer->cancel();
+}
+
+Face::Callback
+ThreadsafeFace::callLaterCancellable
+  (nanoseconds delay, const Callback& callback)
 {
   ptr_lib::shared_ptr<boost::asio::deadline_timer> timer
     (new boost::asio::deadline_timer
@@ -287,6 +311,9 @@ ThreadsafeFace::callLater
 
   // Pass the timer to waitHandler to keep it alive.
   timer->async_wait(boost::bind(&waitHandler, _1, callback, timer));
+  // The cancel function doesn't keep the timer alive after the wait handler.
+  return boost::bind
+    (&cancelTimer, ptr_lib::weak_ptr<boost::asio::deadline_timer>(timer));
 }
 
 }
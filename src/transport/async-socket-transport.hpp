@@ -9,6 +9,7 @@
  * Original repository: https://github.com/named-data/ndn-cpp
  *
  * Summary of Changes: Use ndn-ind includes. Add readRawPackets. Put element-listener.hpp in API.
+ * Add cork. Read into a TransportReceiveBuffer.
  *
  * which was originally released under the LGPL license with the following rights:
  *
@@ -39,8 +40,8 @@
 #include <boost/asio.hpp>
 #include <boost/enable_shared_from_this.hpp>
 #include <ndn-ind/transport/transport.hpp>
-#include "../c/encoding/element-reader.h"
-#include "../util/dynamic-uint8-vector.hpp"
+#include "transport-receive-buffer.hpp"
+#include "transport-send-queue.hpp"
 
 namespace ndn_ind {
 
@@ -63,6 +64,9 @@ public:
    * elementListener->onReceivedElement for each received packet as-is. If
    * false, then use the ndn_TlvStructureDecoder to ensure that
    * elementListener->onReceivedElement is called once for a whole TLV packet.
+   * Each read fills as much of a large receive buffer as is available, and
+   * each whole TLV packet is given to onReceivedElement(const Blob&) as a
+   * slice of the buffer without copying.
    */
   AsyncSocketTransport(boost::asio::io_service& ioService, bool readRawPackets)
   : impl_(new Impl(ioService, readRawPackets))
@@ -101,6 +105,27 @@ public:
     impl_->send(data, dataLength);
   }
 
+  /**
+   * Queue the packets given to send() until uncork() is called. See
+   * Transport::cork(). This must be called from a dispatch to the ioService.
+   */
+  void
+  cork() { impl_->cork(); }
+
+  /**
+   * Undo one call to cork(). See Transport::uncork(). This must be called from
+   * a dispatch to the ioService.
+   */
+  void
+  uncork() { impl_->uncork(); }
+
+  /**
+   * Send any packets queued by cork(). This must be called from a dispatch to
+   * the ioService.
+   */
+  void
+  flush() { impl_->flush(); }
+
   bool
   getIsConnected()
   {
@@ -126,11 +151,11 @@ private:
   public:
     Impl(boost::asio::io_service& ioService, bool readRawPackets)
     : ioService_(ioService), socket_(new typename AsioProtocol::socket(ioService)),
-      elementBuffer_(new DynamicUInt8Vector(1000)), isConnected_(false)
+      receiveBuffer_(readRawPackets), isConnected_(false),
+      sendQueue_([this](const struct ndn_Blob* buffers, size_t nBuffers) {
+        writeBuffers(buffers, nBuffers);
+      })
     {
-      ndn_memset((uint8_t *)&receiveBuffer_, 0, sizeof(receiveBuffer_));
-      ndn_ElementReader_initialize
-        (&elementReader_, 0, elementBuffer_.get(), readRawPackets);
     }
 
     /**
@@ -150,7 +175,7 @@ private:
     {
       close();
 
-      ndn_ElementReader_reset(&elementReader_, &elementListener);
+      receiveBuffer_.reset(&elementListener);
 
       socket_->async_connect
         (endPoint,
@@ -159,7 +184,7 @@ private:
     }
 
     /**
-     * Implement to send data to the host.
+     * Implement to send data to the host, or to queue it if corked.
      * @param data A pointer to the buffer of data to send.
      * @param dataLength The number of bytes in data.
      */
@@ -170,15 +195,18 @@ private:
         throw std::runtime_error
           ("AsyncSocketTransport.send: The socket is not connected");
 
-      // Assume that this is called from a dispatch so that we are already in the
-      // ioService_ thread. Just do a blocking write.
-      boost::system::error_code errorCode;
-      boost::asio::write
-        (*socket_, boost::asio::buffer(data, dataLength), errorCode);
-      if (errorCode != boost::system::errc::success)
-        throw std::runtime_error("AsyncSocketTransport.send: Error in write");
+      sendQueue_.send(data, dataLength);
     }
 
+    void
+    cork() { sendQueue_.cork(); }
+
+    void
+    uncork() { sendQueue_.uncork(); }
+
+    void
+    flush() { sendQueue_.flush(); }
+
     bool
     getIsConnected()
     {
@@ -191,6 +219,14 @@ private:
     void
     close()
     {
+      try {
+        // Send any packets queued by cork() before closing.
+        sendQueue_.flush();
+      }
+      catch (...) {
+        // Ignore any exceptions.
+      }
+
       try {
         socket_->close();
       }
@@ -217,14 +253,26 @@ private:
       isConnected_ = true;
       onConnected();
 
+      asyncReceive();
+    }
+
+    /**
+     * Start an async_receive into the free space of receiveBuffer_ which calls
+     * readHandler.
+     */
+    void
+    asyncReceive()
+    {
       socket_->async_receive
-        (boost::asio::buffer(receiveBuffer_, sizeof(receiveBuffer_)), 0,
+        (boost::asio::buffer
+           (receiveBuffer_.getFreeSpace(), receiveBuffer_.getFreeSpaceLength()),
+         0,
          boost::bind(&AsyncSocketTransport::Impl::readHandler,
                      this->shared_from_this(), _1, _2));
     }
 
     /**
-     * This is called by async_receive to call elementReader_.onReceivedData and
+     * This is called by async_receive to call receiveBuffer_.onReceived and
      * to call itself again.
      */
     void
@@ -240,25 +288,49 @@ private:
         throw std::runtime_error("AsyncSocketTransport: Error in async_receive");
       }
 
-      ndn_Error error;
-      if ((error = ndn_ElementReader_onReceivedData
-           (&elementReader_, receiveBuffer_, nBytesReceived)))
-        throw std::runtime_error(ndn_getErrorString(error));
+      // Cork so that the packets sent by the callbacks for the received
+      // elements are written together.
+      sendQueue_.cork();
+      try {
+        receiveBuffer_.onReceived(nBytesReceived);
+      } catch (...) {
+        sendQueue_.uncork();
+        throw;
+      }
+      sendQueue_.uncork();
 
       // Request another async receive to loop back to here.
       if (socket_->is_open())
-        socket_->async_receive
-          (boost::asio::buffer(receiveBuffer_, sizeof(receiveBuffer_)), 0,
-           boost::bind(&AsyncSocketTransport::Impl::readHandler,
-                       this->shared_from_this(), _1, _2));
+        asyncReceive();
+    }
+
+    /**
+     * Write the buffers to the socket with one gathering write. Assume that
+     * this is called from a dispatch so that we are already in the ioService_
+     * thread. Just do a blocking write.
+     * @param buffers An array of ndn_Blob with the packets to write.
+     * @param nBuffers The number of entries in buffers.
+     */
+    void
+    writeBuffers(const struct ndn_Blob* buffers, size_t nBuffers)
+    {
+      writeBuffers_.clear();
+      for (size_t i = 0; i < nBuffers; ++i)
+        writeBuffers_.push_back
+          (boost::asio::buffer(buffers[i].value, buffers[i].length));
+
+      boost::system::error_code errorCode;
+      boost::asio::write(*socket_, writeBuffers_, errorCode);
+      if (errorCode != boost::system::errc::success)
+        throw std::runtime_error("AsyncSocketTransport.send: Error in write");
     }
 
     boost::asio::io_service& ioService_;
     boost::shared_ptr<typename AsioProtocol::socket> socket_;
-    uint8_t receiveBuffer_[MAX_NDN_PACKET_SIZE];
-    boost::shared_ptr<DynamicUInt8Vector> elementBuffer_;
-    ndn_ElementReader elementReader_;
+    TransportReceiveBuffer receiveBuffer_;
     bool isConnected_;
+    TransportSendQueue sendQueue_;
+    std::vector<boost::asio::const_buffer> writeBuffers_;
   };
 
   boost::shared_ptr<Impl> impl_;
@@ -9,6 +9,7 @@
  * Original repository: https://github.com/named-data/ndn-cpp
  *
  * Summary of Changes: Use ndn-ind includes. Add readRawPackets. Put element-listener.hpp in API.
+ * Add cork.
  *
  * which was originally released under the LGPL license with the following rights:
  *
@@ -127,6 +128,15 @@ AsyncTcpTransport::send(const uint8_t *data, size_t dataLength)
   socketTransport_->send(data, dataLength);
 }
 
+void
+AsyncTcpTransport::cork() { socketTransport_->cork(); }
+
+void
+AsyncTcpTransport::uncork() { socketTransport_->uncork(); }
+
+void
+AsyncTcpTransport::flush() { socketTransport_->flush(); }
+
 bool
 AsyncTcpTransport::getIsConnected()
 {
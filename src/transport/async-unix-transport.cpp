@@ -8,7 +8,7 @@
  * Original file: src/transport/async-unix-transport.cpp
  * Original repository: https://github.com/named-data/ndn-cpp
  *
- * Summary of Changes: Use ndn-ind includes. Add readRawPackets.
+ * Summary of Changes: Use ndn-ind includes. Add readRawPackets. Add cork.
  *
  * which was originally released under the LGPL license with the following rights:
  *
@@ -88,6 +88,15 @@ AsyncUnixTransport::send(const uint8_t *data, size_t dataLength)
   socketTransport_->send(data, dataLength);
 }
 
+void
+AsyncUnixTransport::cork() { socketTransport_->cork(); }
+
+void
+AsyncUnixTransport::uncork() { socketTransport_->uncork(); }
+
+void
+AsyncUnixTransport::flush() { socketTransport_->flush(); }
+
 bool
 AsyncUnixTransport::getIsConnected()
 {
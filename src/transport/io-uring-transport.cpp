@@ -0,0 +1,569 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2020 Operant Networks, Incorporated.
+ * @author: Jeff Thompson <jefft0@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+// Only compile if ndn-ind-config.h defines NDN_IND_HAVE_LINUX_IO_URING_H.
+#include <ndn-ind/ndn-ind-config.h>
+#if NDN_IND_HAVE_LINUX_IO_URING_H
+
+#include <stdexcept>
+#include <cerrno>
+#include <cstring>
+#include <sys/socket.h>
+#include "../c/transport/tcp-transport.h"
+#include "../c/transport/udp-transport.h"
+#include "../util/dynamic-uint8-vector.hpp"
+#include "io-uring.hpp"
+#include "transport-send-queue.hpp"
+#include <ndn-ind/transport/tcp-transport.hpp>
+#include <ndn-ind/transport/udp-transport.hpp>
+#include <ndn-ind/transport/unix-transport.hpp>
+#include <ndn-ind/transport/io-uring-transport.hpp>
+
+using namespace std;
+
+namespace ndn_ind {
+
+/**
+ * IoUringTransport::Impl owns the socket and the io_uring instance. The
+ * user_data of each submission has a tag in the low byte for the type of
+ * operation. For a send, the upper bytes have the number of bytes to send. An
+ * entry with user_data 0 is an error from IoUring::recycleBuffer.
+ */
+class IoUringTransport::Impl {
+public:
+  Impl(bool readRawPackets)
+  : isStream_(true), isConnected_(false), isReceiving_(false),
+    elementBuffer_(new DynamicUInt8Vector(1000)),
+    sendQueue_([this](const struct ndn_Blob* buffers, size_t nBuffers) {
+      sendBuffers(buffers, nBuffers);
+    }),
+    sendBuffer_(getSendBufferSize()), sendBufferLength_(0), nSendsInFlight_(0),
+    sendErrorNumber_(0)
+  {
+    ndn_SocketTransport_initialize
+      (&transport_, elementBuffer_.get(), readRawPackets ? 1 : 0);
+  }
+
+  ~Impl()
+  {
+    try {
+      close();
+    } catch (...) {
+      // Ignore errors since we are deleting anyway.
+    }
+  }
+
+  void
+  connect
+    (ndn_SocketType socketType, const char* host, unsigned short port,
+     ElementListener& elementListener)
+  {
+    if (ring_)
+      close();
+
+    ndn_Error error;
+    if ((error = ndn_SocketTransport_connect
+         (&transport_, socketType, host, port, &elementListener)))
+      throw runtime_error(ndn_getErrorString(error));
+
+    isStream_ = (socketType != SOCKET_UDP);
+    try {
+      ring_.reset(new IoUring(getRingEntries()));
+      ring_->provideBuffers(getReceiveBufferCount(), getReceiveBufferSize());
+      submitReceive();
+      ring_->submit();
+      checkMultishotReceive();
+    } catch (...) {
+      ring_.reset();
+      isReceiving_ = false;
+      ndn_SocketTransport_close(&transport_);
+      throw;
+    }
+
+    isConnected_ = true;
+  }
+
+  void
+  send(const uint8_t *data, size_t dataLength)
+  {
+    sendQueue_.send(data, dataLength);
+  }
+
+  void
+  cork() { sendQueue_.cork(); }
+
+  void
+  uncork() { sendQueue_.uncork(); }
+
+  void
+  flush() { sendQueue_.flush(); }
+
+  void
+  processEvents()
+  {
+    if (!ring_)
+      return;
+
+    // Process the receives saved while waiting for sends.
+    while (savedReceives_.size() > 0) {
+      struct io_uring_cqe cqe = savedReceives_.front();
+      savedReceives_.erase(savedReceives_.begin());
+      processReceive(cqe.res, cqe.flags);
+    }
+
+    struct io_uring_cqe* cqe;
+    while ((cqe = ring_->peekCqe())) {
+      // Copy and release the entry first in case processing throws.
+      struct io_uring_cqe cqeCopy = *cqe;
+      ring_->seenCqe();
+      processCqe(cqeCopy);
+    }
+
+    // The kernel ends a multishot receive if it runs out of buffers.
+    if (!isReceiving_ && isConnected_)
+      submitReceive();
+    ring_->submit();
+
+    throwSendError();
+  }
+
+  /**
+   * Wait for a completion on the ring. The caller must check hasRing().
+   */
+  void
+  waitForReceive(chrono::nanoseconds maxWait)
+  {
+    if (maxWait <= chrono::nanoseconds::zero() || savedReceives_.size() > 0)
+      return;
+    if (ring_->peekCqe())
+      return;
+
+    ring_->submitAndWait(maxWait);
+  }
+
+  bool
+  hasRing() const { return !!ring_; }
+
+  bool
+  getIsConnected() { return isConnected_; }
+
+  void
+  close()
+  {
+    if (!ring_) {
+      if (isConnected_) {
+        isConnected_ = false;
+        ndn_Error error;
+        if ((error = ndn_SocketTransport_close(&transport_)))
+          throw runtime_error(ndn_getErrorString(error));
+      }
+      return;
+    }
+
+    try {
+      // Send any packets queued by cork() before closing.
+      sendQueue_.flush();
+    } catch (...) {
+      // Ignore errors since we are closing anyway.
+    }
+    sendQueue_.clear();
+
+    try {
+      // The kernel may write to the provided buffers until the receive ends,
+      // so cancel it and wait for it and the sends to complete.
+      if (isReceiving_) {
+        struct io_uring_sqe* sqe = getSqe();
+        sqe->opcode = IORING_OP_ASYNC_CANCEL;
+        sqe->addr = RECEIVE_TAG;
+        sqe->user_data = CANCEL_TAG;
+      }
+      while (isReceiving_ || nSendsInFlight_ > 0) {
+        ring_->submit(1);
+        struct io_uring_cqe* cqe;
+        while ((cqe = ring_->peekCqe())) {
+          if ((cqe->user_data & 0xff) == RECEIVE_TAG) {
+            if (!(cqe->flags & IORING_CQE_F_MORE))
+              isReceiving_ = false;
+          }
+          else if ((cqe->user_data & 0xff) == SEND_TAG)
+            --nSendsInFlight_;
+          ring_->seenCqe();
+        }
+      }
+    } catch (...) {
+      // Ignore errors since we are closing anyway.
+    }
+
+    ring_.reset();
+    isReceiving_ = false;
+    nSendsInFlight_ = 0;
+    sendBufferLength_ = 0;
+    sendErrorNumber_ = 0;
+    savedReceives_.clear();
+    isConnected_ = false;
+
+    ndn_Error error;
+    if ((error = ndn_SocketTransport_close(&transport_)))
+      throw runtime_error(ndn_getErrorString(error));
+  }
+
+private:
+  enum {
+    RECEIVE_TAG = 1,
+    SEND_TAG = 2,
+    CANCEL_TAG = 3
+  };
+
+  static unsigned
+  getRingEntries() { return 256; }
+
+  static unsigned
+  getReceiveBufferCount() { return 64; }
+
+  static size_t
+  getReceiveBufferSize() { return 16384; }
+
+  static size_t
+  getSendBufferSize() { return 262144; }
+
+  /**
+   * Get a submission queue entry, submitting the queue first if it is full.
+   */
+  struct io_uring_sqe*
+  getSqe()
+  {
+    struct io_uring_sqe* sqe = ring_->getSqe();
+    if (!sqe) {
+      ring_->submit();
+      sqe = ring_->getSqe();
+      if (!sqe)
+        throw runtime_error("IoUringTransport: The submission queue is full");
+    }
+
+    return sqe;
+  }
+
+  /**
+   * Add a multishot receive into the provided buffers to the submission queue.
+   */
+  void
+  submitReceive()
+  {
+    struct io_uring_sqe* sqe = getSqe();
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = transport_.socketDescriptor;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = 0;
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->user_data = RECEIVE_TAG;
+    isReceiving_ = true;
+  }
+
+  /**
+   * Check if the kernel already failed the receive from submitReceive() with
+   * EINVAL because it does not support multishot receive. The kernel checks
+   * the submission queue entry when it is submitted, so the error is in the
+   * completion queue when io_uring_enter returns.
+   * @throws runtime_error if the kernel rejected the multishot receive.
+   */
+  void
+  checkMultishotReceive()
+  {
+    struct io_uring_cqe* cqe = ring_->peekCqe();
+    if (cqe && (cqe->user_data & 0xff) == RECEIVE_TAG && cqe->res == -EINVAL) {
+      ring_->seenCqe();
+      isReceiving_ = false;
+      throw runtime_error
+        ("IoUringTransport: The kernel does not support multishot receive, which requires Linux 6.0 or later");
+    }
+  }
+
+  /**
+   * Copy the packets to the send buffer and submit them with one system call.
+   * For a stream socket, submit all the packets as one send.
+   */
+  void
+  sendBuffers(const struct ndn_Blob* buffers, size_t nBuffers)
+  {
+    if (!ring_)
+      throw runtime_error("IoUringTransport.send: The socket is not connected");
+
+    size_t totalLength = 0;
+    for (size_t i = 0; i < nBuffers; ++i)
+      totalLength += buffers[i].length;
+
+    // The send buffer is reused when all sends are complete. A stream socket
+    // can only have one send in flight to keep the bytes in order.
+    reapSends(false);
+    if (sendBufferLength_ + totalLength > sendBuffer_.size() ||
+        (isStream_ && nSendsInFlight_ > 0)) {
+      reapSends(true);
+      if (totalLength > sendBuffer_.size())
+        sendBuffer_.resize(totalLength);
+    }
+
+    uint8_t* output = &sendBuffer_[0] + sendBufferLength_;
+    for (size_t i = 0; i < nBuffers; ++i) {
+      memcpy(output, buffers[i].value, buffers[i].length);
+      if (!isStream_)
+        submitSend(output, buffers[i].length);
+      output += buffers[i].length;
+    }
+    if (isStream_)
+      submitSend(&sendBuffer_[0] + sendBufferLength_, totalLength);
+    sendBufferLength_ += totalLength;
+
+    ring_->submit();
+  }
+
+  void
+  submitSend(const uint8_t* data, size_t dataLength)
+  {
+    struct io_uring_sqe* sqe = getSqe();
+    sqe->opcode = IORING_OP_SEND;
+    sqe->fd = transport_.socketDescriptor;
+    sqe->addr = (uint64_t)(uintptr_t)data;
+    sqe->len = (uint32_t)dataLength;
+    // For a stream socket, let the kernel retry until all bytes are sent.
+    sqe->msg_flags = isStream_ ? MSG_WAITALL : 0;
+    sqe->user_data = ((uint64_t)dataLength << 8) | SEND_TAG;
+    ++nSendsInFlight_;
+  }
+
+  /**
+   * Process the completion queue entries for sends, and save the entries for
+   * receives to be processed by the next call to processEvents(), since this
+   * is called from send(). When no sends are in flight, start reusing the send
+   * buffer from the beginning.
+   * @param wait If true, wait until all sends are complete.
+   */
+  void
+  reapSends(bool wait)
+  {
+    while (true) {
+      struct io_uring_cqe* cqe;
+      while ((cqe = ring_->peekCqe())) {
+        if ((cqe->user_data & 0xff) == RECEIVE_TAG)
+          savedReceives_.push_back(*cqe);
+        else
+          processCqe(*cqe);
+        ring_->seenCqe();
+      }
+
+      if (!wait || nSendsInFlight_ == 0)
+        break;
+      ring_->submit(1);
+    }
+
+    throwSendError();
+  }
+
+  void
+  processCqe(const struct io_uring_cqe& cqe)
+  {
+    uint64_t tag = cqe.user_data & 0xff;
+    if (tag == RECEIVE_TAG)
+      processReceive(cqe.res, cqe.flags);
+    else if (tag == SEND_TAG) {
+      --nSendsInFlight_;
+      if (nSendsInFlight_ == 0)
+        sendBufferLength_ = 0;
+
+      if (cqe.res < 0)
+        sendErrorNumber_ = -cqe.res;
+      else if ((uint64_t)cqe.res != (cqe.user_data >> 8))
+        sendErrorNumber_ = EIO;
+    }
+    else if (cqe.user_data == 0 && cqe.res < 0)
+      throw runtime_error
+        (string("IoUringTransport: Error recycling a receive buffer: ") +
+         strerror(-cqe.res));
+  }
+
+  /**
+   * Give the received bytes to the element reader and give the buffer back to
+   * the kernel.
+   * @param result The res of the completion queue entry.
+   * @param flags The flags of the completion queue entry.
+   */
+  void
+  processReceive(int32_t result, uint32_t flags)
+  {
+    if (!(flags & IORING_CQE_F_MORE))
+      isReceiving_ = false;
+
+    if (result > 0) {
+      uint16_t bufferId = (uint16_t)(flags >> IORING_CQE_BUFFER_SHIFT);
+      ndn_Error error;
+      try {
+        error = ndn_ElementReader_onReceivedData
+          (&transport_.elementReader, ring_->getBuffer(bufferId),
+           (size_t)result);
+      } catch (...) {
+        ring_->recycleBuffer(bufferId);
+        throw;
+      }
+      ring_->recycleBuffer(bufferId);
+
+      if (error)
+        throw runtime_error(ndn_getErrorString(error));
+    }
+    else if (result == 0) {
+      // For a stream socket, the other end closed the connection.
+      if (isStream_)
+        isConnected_ = false;
+    }
+    else if (result != -ENOBUFS && result != -ECANCELED)
+      throw runtime_error
+        (string("IoUringTransport: Error in receive: ") + strerror(-result));
+  }
+
+  void
+  throwSendError()
+  {
+    if (sendErrorNumber_ != 0) {
+      int errorNumber = sendErrorNumber_;
+      sendErrorNumber_ = 0;
+      throw runtime_error
+        (string("IoUringTransport: Error in send: ") + strerror(errorNumber));
+    }
+  }
+
+  // Disable the copy constructor and assignment operator.
+  Impl(const Impl& other);
+  Impl& operator=(const Impl& other);
+
+  struct ndn_SocketTransport transport_;
+  bool isStream_;
+  bool isConnected_;
+  bool isReceiving_;
+  ptr_lib::shared_ptr<DynamicUInt8Vector> elementBuffer_;
+  TransportSendQueue sendQueue_;
+  ptr_lib::shared_ptr<IoUring> ring_;
+  // The packets being sent by the kernel, which must remain valid until the
+  // send is complete.
+  std::vector<uint8_t> sendBuffer_;
+  size_t sendBufferLength_;
+  size_t nSendsInFlight_;
+  int sendErrorNumber_;
+  std::vector<struct io_uring_cqe> savedReceives_;
+};
+
+IoUringTransport::IoUringTransport(bool readRawPackets)
+: impl_(new Impl(readRawPackets))
+{
+}
+
+bool
+IoUringTransport::isLocal(const Transport::ConnectionInfo& connectionInfo)
+{
+  if (dynamic_cast<const UnixTransport::ConnectionInfo*>(&connectionInfo))
+    return true;
+  if (dynamic_cast<const UdpTransport::ConnectionInfo*>(&connectionInfo))
+    return ndn_UdpTransport_isLocal() != 0;
+
+  const TcpTransport::ConnectionInfo& tcpConnectionInfo =
+    dynamic_cast<const TcpTransport::ConnectionInfo&>(connectionInfo);
+  ndn_Error error;
+  int intIsLocal;
+  if ((error = ndn_TcpTransport_isLocal
+       (tcpConnectionInfo.getHost().c_str(), &intIsLocal)))
+    throw runtime_error(ndn_getErrorString(error));
+
+  return intIsLocal != 0;
+}
+
+bool
+IoUringTransport::isAsync() { return false; }
+
+void
+IoUringTransport::connect
+  (const Transport::ConnectionInfo& connectionInfo,
+   ElementListener& elementListener, const OnConnected& onConnected)
+{
+  const UnixTransport::ConnectionInfo* unixConnectionInfo =
+    dynamic_cast<const UnixTransport::ConnectionInfo*>(&connectionInfo);
+  const UdpTransport::ConnectionInfo* udpConnectionInfo =
+    dynamic_cast<const UdpTransport::ConnectionInfo*>(&connectionInfo);
+
+  if (unixConnectionInfo)
+    impl_->connect
+      (SOCKET_UNIX, unixConnectionInfo->getFilePath().c_str(), 0,
+       elementListener);
+  else if (udpConnectionInfo)
+    impl_->connect
+      (SOCKET_UDP, udpConnectionInfo->getHost().c_str(),
+       udpConnectionInfo->getPort(), elementListener);
+  else {
+    const TcpTransport::ConnectionInfo& tcpConnectionInfo =
+      dynamic_cast<const TcpTransport::ConnectionInfo&>(connectionInfo);
+    impl_->connect
+      (SOCKET_TCP, tcpConnectionInfo.getHost().c_str(),
+       tcpConnectionInfo.getPort(), elementListener);
+  }
+
+  if (onConnected)
+    onConnected();
+}
+
+void
+IoUringTransport::send(const uint8_t *data, size_t dataLength)
+{
+  impl_->send(data, dataLength);
+}
+
+void
+IoUringTransport::cork() { impl_->cork(); }
+
+void
+IoUringTransport::uncork() { impl_->uncork(); }
+
+void
+IoUringTransport::flush() { impl_->flush(); }
+
+void
+IoUringTransport::processEvents() { impl_->processEvents(); }
+
+void
+IoUringTransport::waitForReceive(chrono::nanoseconds maxWait)
+{
+  if (!impl_->hasRing()) {
+    // There is no socket to wait for.
+    Transport::waitForReceive(maxWait);
+    return;
+  }
+
+  impl_->waitForReceive(maxWait);
+}
+
+bool
+IoUringTransport::getIsConnected() { return impl_->getIsConnected(); }
+
+void
+IoUringTransport::close() { impl_->close(); }
+
+IoUringTransport::~IoUringTransport()
+{
+}
+
+}
+
+#endif // NDN_IND_HAVE_LINUX_IO_URING_H
@@ -0,0 +1,256 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2020 Operant Networks, Incorporated.
+ * @author: Jeff Thompson <jefft0@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+// Only compile if ndn-ind-config.h defines NDN_IND_HAVE_LINUX_IO_URING_H.
+#include <ndn-ind/ndn-ind-config.h>
+#if NDN_IND_HAVE_LINUX_IO_URING_H
+
+#include <stdexcept>
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include "io-uring.hpp"
+
+using namespace std;
+
+namespace ndn_ind {
+
+/**
+ * Throw a runtime_error with the message and the string for errno.
+ */
+static void
+throwErrno(const char* message, int errorNumber)
+{
+  throw runtime_error(string(message) + ": " + strerror(errorNumber));
+}
+
+IoUring::IoUring(unsigned nEntries)
+: ringFd_(-1), sqRing_(MAP_FAILED), sqRingSize_(0), cqRing_(MAP_FAILED),
+  cqRingSize_(0), sqes_((struct io_uring_sqe*)MAP_FAILED), sqesSize_(0),
+  sqeTail_(0), nToSubmit_(0), bufferSize_(0)
+{
+  struct io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  ringFd_ = (int)syscall(__NR_io_uring_setup, nEntries, &params);
+  if (ringFd_ < 0)
+    throwErrno("IoUring: Error in io_uring_setup", errno);
+
+  sqRingSize_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  cqRingSize_ = params.cq_off.cqes +
+    params.cq_entries * sizeof(struct io_uring_cqe);
+  if (params.features & IORING_FEAT_SINGLE_MMAP) {
+    // The submission and completion queue rings share one mapping.
+    if (cqRingSize_ > sqRingSize_)
+      sqRingSize_ = cqRingSize_;
+    cqRingSize_ = sqRingSize_;
+  }
+
+  sqRing_ = mmap
+    (0, sqRingSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+     ringFd_, IORING_OFF_SQ_RING);
+  if (sqRing_ == MAP_FAILED) {
+    int errorNumber = errno;
+    ::close(ringFd_);
+    throwErrno("IoUring: Error mapping the submission queue", errorNumber);
+  }
+  if (params.features & IORING_FEAT_SINGLE_MMAP)
+    cqRing_ = sqRing_;
+  else {
+    cqRing_ = mmap
+      (0, cqRingSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+       ringFd_, IORING_OFF_CQ_RING);
+    if (cqRing_ == MAP_FAILED) {
+      int errorNumber = errno;
+      munmap(sqRing_, sqRingSize_);
+      ::close(ringFd_);
+      throwErrno("IoUring: Error mapping the completion queue", errorNumber);
+    }
+  }
+
+  sqesSize_ = params.sq_entries * sizeof(struct io_uring_sqe);
+  sqes_ = (struct io_uring_sqe*)mmap
+    (0, sqesSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd_,
+     IORING_OFF_SQES);
+  if (sqes_ == MAP_FAILED) {
+    int errorNumber = errno;
+    if (cqRing_ != sqRing_)
+      munmap(cqRing_, cqRingSize_);
+    munmap(sqRing_, sqRingSize_);
+    ::close(ringFd_);
+    throwErrno("IoUring: Error mapping the submission queue entries", errorNumber);
+  }
+
+  uint8_t* sqRing = (uint8_t*)sqRing_;
+  sqHead_ = (unsigned*)(sqRing + params.sq_off.head);
+  sqTail_ = (unsigned*)(sqRing + params.sq_off.tail);
+  sqMask_ = *(unsigned*)(sqRing + params.sq_off.ring_mask);
+  sqEntries_ = *(unsigned*)(sqRing + params.sq_off.ring_entries);
+  sqArray_ = (unsigned*)(sqRing + params.sq_off.array);
+  sqeTail_ = *sqTail_;
+
+  uint8_t* cqRing = (uint8_t*)cqRing_;
+  cqHead_ = (unsigned*)(cqRing + params.cq_off.head);
+  cqTail_ = (unsigned*)(cqRing + params.cq_off.tail);
+  cqMask_ = *(unsigned*)(cqRing + params.cq_off.ring_mask);
+  cqes_ = (struct io_uring_cqe*)(cqRing + params.cq_off.cqes);
+}
+
+IoUring::~IoUring()
+{
+  ::close(ringFd_);
+
+  munmap(sqes_, sqesSize_);
+  if (cqRing_ != sqRing_)
+    munmap(cqRing_, cqRingSize_);
+  munmap(sqRing_, sqRingSize_);
+}
+
+struct io_uring_sqe*
+IoUring::getSqe()
+{
+  unsigned head = __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE);
+  if (sqeTail_ - head >= sqEntries_)
+    return 0;
+
+  unsigned index = sqeTail_ & sqMask_;
+  struct io_uring_sqe* sqe = &sqes_[index];
+  memset(sqe, 0, sizeof(*sqe));
+  sqArray_[index] = index;
+  ++sqeTail_;
+  ++nToSubmit_;
+  return sqe;
+}
+
+void
+IoUring::submit(unsigned minComplete)
+{
+  if (nToSubmit_ == 0 && minComplete == 0)
+    return;
+
+  // Make the entries visible to the kernel before it reads the tail.
+  __atomic_store_n(sqTail_, sqeTail_, __ATOMIC_RELEASE);
+
+  while (true) {
+    int result = (int)syscall
+      (__NR_io_uring_enter, ringFd_, nToSubmit_, minComplete,
+       minComplete > 0 ? IORING_ENTER_GETEVENTS : 0, 0, 0);
+    if (result >= 0) {
+      nToSubmit_ -= (unsigned)result;
+      if (nToSubmit_ == 0 || minComplete > 0)
+        return;
+      // The kernel didn't take all the entries, so try again.
+    }
+    else if (errno != EINTR)
+      throwErrno("IoUring: Error in io_uring_enter", errno);
+  }
+}
+
+void
+IoUring::submitAndWait(chrono::nanoseconds timeout)
+{
+  __atomic_store_n(sqTail_, sqeTail_, __ATOMIC_RELEASE);
+
+  struct io_uring_getevents_arg arg;
+  struct __kernel_timespec timeSpec;
+  memset(&arg, 0, sizeof(arg));
+  timeSpec.tv_sec = timeout.count() / 1000000000;
+  timeSpec.tv_nsec = timeout.count() % 1000000000;
+  arg.ts = (uint64_t)(uintptr_t)&timeSpec;
+
+  int result = (int)syscall
+    (__NR_io_uring_enter, ringFd_, nToSubmit_, 1,
+     IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG, &arg, sizeof(arg));
+  if (result >= 0)
+    nToSubmit_ -= (unsigned)result;
+  else if (errno != ETIME && errno != EINTR)
+    throwErrno("IoUring: Error in io_uring_enter", errno);
+}
+
+struct io_uring_cqe*
+IoUring::peekCqe()
+{
+  unsigned head = *cqHead_;
+  if (head == __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE))
+    return 0;
+
+  return &cqes_[head & cqMask_];
+}
+
+void
+IoUring::seenCqe()
+{
+  __atomic_store_n(cqHead_, *cqHead_ + 1, __ATOMIC_RELEASE);
+}
+
+void
+IoUring::provideBuffers(unsigned nBuffers, size_t bufferSize)
+{
+  if (bufferSize_ != 0)
+    throw runtime_error("IoUring: The buffers are already provided");
+
+  bufferSize_ = bufferSize;
+  buffers_.resize(nBuffers * bufferSize);
+
+  struct io_uring_sqe* sqe = getSqe();
+  if (!sqe)
+    throw runtime_error("IoUring.provideBuffers: The submission queue is full");
+  sqe->opcode = IORING_OP_PROVIDE_BUFFERS;
+  sqe->fd = (int)nBuffers;
+  sqe->addr = (uint64_t)(uintptr_t)&buffers_[0];
+  sqe->len = (uint32_t)bufferSize;
+  sqe->off = 0;
+  sqe->buf_group = 0;
+  submit(1);
+
+  struct io_uring_cqe* cqe = peekCqe();
+  int result = cqe ? cqe->res : -EIO;
+  if (cqe)
+    seenCqe();
+  if (result < 0)
+    throwErrno("IoUring: Error providing the buffers", -result);
+}
+
+void
+IoUring::recycleBuffer(uint16_t bufferId)
+{
+  struct io_uring_sqe* sqe = getSqe();
+  if (!sqe) {
+    submit();
+    sqe = getSqe();
+    if (!sqe)
+      throw runtime_error("IoUring.recycleBuffer: The submission queue is full");
+  }
+
+  sqe->opcode = IORING_OP_PROVIDE_BUFFERS;
+  sqe->fd = 1;
+  sqe->addr = (uint64_t)(uintptr_t)getBuffer(bufferId);
+  sqe->len = (uint32_t)bufferSize_;
+  sqe->off = bufferId;
+  sqe->buf_group = 0;
+  // Only post a completion queue entry if there is an error.
+  sqe->flags = IOSQE_CQE_SKIP_SUCCESS;
+}
+
+}
+
+#endif // NDN_IND_HAVE_LINUX_IO_URING_H
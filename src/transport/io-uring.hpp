@@ -0,0 +1,169 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2020 Operant Networks, Incorporated.
+ * @author: Jeff Thompson <jefft0@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+#ifndef NDN_IO_URING_HPP
+#define NDN_IO_URING_HPP
+
+// Only compile if ndn-ind-config.h defines NDN_IND_HAVE_LINUX_IO_URING_H.
+#include <ndn-ind/ndn-ind-config.h>
+#if NDN_IND_HAVE_LINUX_IO_URING_H
+
+#include <vector>
+#include <linux/io_uring.h>
+#include <ndn-ind/common.hpp>
+
+namespace ndn_ind {
+
+/**
+ * An IoUring is a minimal wrapper of a Linux io_uring instance using the
+ * system calls directly, so that liburing is not needed. It maps the
+ * submission and completion queues and can provide one group of buffers for
+ * receives which use IOSQE_BUFFER_SELECT. Reading completions with peekCqe
+ * does not need a system call. This is not thread safe.
+ */
+class IoUring {
+public:
+  /**
+   * Create an io_uring instance and map its queues.
+   * @param nEntries The number of submission queue entries. The completion
+   * queue has twice as many.
+   * @throws runtime_error if the kernel does not support io_uring.
+   */
+  IoUring(unsigned nEntries);
+
+  /**
+   * Close the io_uring instance and unmap its memory. The caller should first cancel the requests which use the
+   * provided buffers and wait for their completion.
+   */
+  ~IoUring();
+
+  /**
+   * Get the next free submission queue entry, cleared to zero. The entry is
+   * given to the kernel by the next call to submit().
+   * @return A pointer to the entry, or 0 if the submission queue is full. In
+   * this case, call submit() and try again.
+   */
+  struct io_uring_sqe*
+  getSqe();
+
+  /**
+   * Give the new submission queue entries to the kernel. If there are none and
+   * minComplete is 0, this returns without a system call.
+   * @param minComplete (optional) If not 0, wait until the completion queue
+   * has at least this many entries. If omitted, don't wait.
+   * @throws runtime_error for an error from io_uring_enter.
+   */
+  void
+  submit(unsigned minComplete = 0);
+
+  /**
+   * Give the new submission queue entries to the kernel and wait until the
+   * completion queue is not empty or until the timeout.
+   * @param timeout The maximum time to wait.
+   * @throws runtime_error for an error from io_uring_enter.
+   */
+  void
+  submitAndWait(std::chrono::nanoseconds timeout);
+
+  /**
+   * Get the next completion queue entry without a system call.
+   * @return A pointer to the entry, or 0 if the completion queue is empty. The
+   * entry is valid until calling seenCqe().
+   */
+  struct io_uring_cqe*
+  peekCqe();
+
+  /**
+   * Mark the completion queue entry from peekCqe() as consumed.
+   */
+  void
+  seenCqe();
+
+  /**
+   * Allocate the provided buffers with the group ID 0, give them all to the
+   * kernel and wait for the completion. This can only be called once, before
+   * submitting other entries. (This uses IORING_OP_PROVIDE_BUFFERS instead of
+   * a registered buffer ring since some kernels fail a receive from a buffer
+   * ring with ENOBUFS.)
+   * @param nBuffers The number of buffers.
+   * @param bufferSize The size of each buffer.
+   * @throws runtime_error if the kernel does not support provided buffers.
+   */
+  void
+  provideBuffers(unsigned nBuffers, size_t bufferSize);
+
+  /**
+   * Get the provided buffer with the ID from the flags of a completion queue
+   * entry.
+   * @param bufferId The buffer ID, which is
+   * cqe->flags >> IORING_CQE_BUFFER_SHIFT.
+   * @return A pointer to the buffer.
+   */
+  uint8_t*
+  getBuffer(uint16_t bufferId) { return &buffers_[0] + bufferId * bufferSize_; }
+
+  /**
+   * Give the provided buffer back to the kernel after processing its data.
+   * This adds an entry to the submission queue, which has no completion queue
+   * entry unless it fails with an error, in which case the entry's user_data
+   * is 0.
+   * @param bufferId The buffer ID.
+   */
+  void
+  recycleBuffer(uint16_t bufferId);
+
+private:
+  // Disable the copy constructor and assignment operator.
+  IoUring(const IoUring& other);
+  IoUring& operator=(const IoUring& other);
+
+  int ringFd_;
+  void* sqRing_;
+  size_t sqRingSize_;
+  void* cqRing_;
+  size_t cqRingSize_;
+  struct io_uring_sqe* sqes_;
+  size_t sqesSize_;
+
+  unsigned* sqHead_;
+  unsigned* sqTail_;
+  unsigned sqMask_;
+  unsigned sqEntries_;
+  unsigned* sqArray_;
+  // The tail of the entries from getSqe(), which submit() stores to sqTail_.
+  unsigned sqeTail_;
+  // The number of entries from getSqe() not yet given to io_uring_enter.
+  unsigned nToSubmit_;
+
+  unsigned* cqHead_;
+  unsigned* cqTail_;
+  unsigned cqMask_;
+  struct io_uring_cqe* cqes_;
+
+  size_t bufferSize_;
+  std::vector<uint8_t> buffers_;
+};
+
+}
+
+#endif // NDN_IND_HAVE_LINUX_IO_URING_H
+
+#endif
@@ -0,0 +1,179 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2020 Operant Networks, Incorporated.
+ * @author: Jeff Thompson <jefft0@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+// Only compile if ndn-ind-config.h defines NDN_IND_HAVE_SYS_EVENTFD_H.
+#include <ndn-ind/ndn-ind-config.h>
+#if NDN_IND_HAVE_SYS_EVENTFD_H
+
+#include <stdexcept>
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+#include <poll.h>
+#include <ndn-ind/transport/transport.hpp>
+#include "shm-ring.hpp"
+
+using namespace std;
+using namespace std::chrono;
+
+namespace ndn_ind {
+
+ShmRing::ShmRing(uint8_t* memory, size_t capacity, int eventFd)
+: header_((Header*)memory), records_(memory + sizeof(Header)),
+  capacity_(capacity), eventFd_(eventFd), copyBufferEnd_(0)
+{
+  head_ = __atomic_load_n(&header_->head, __ATOMIC_ACQUIRE);
+  tail_ = __atomic_load_n(&header_->tail, __ATOMIC_ACQUIRE);
+}
+
+void
+ShmRing::initialize()
+{
+  memset(header_, 0, sizeof(Header));
+  head_ = 0;
+  tail_ = 0;
+}
+
+bool
+ShmRing::write(const uint8_t* data, size_t dataLength)
+{
+  size_t recordSize = getRecordSize(dataLength);
+  // A record of at most half the capacity always fits in an empty ring, either
+  // before or after the wrap.
+  if (recordSize > capacity_ / 2)
+    throw runtime_error("ShmRing: The packet is too large for the ring");
+
+  size_t offset = (size_t)(tail_ & (capacity_ - 1));
+  size_t toEnd = capacity_ - offset;
+  size_t needed = recordSize <= toEnd ? recordSize : toEnd + recordSize;
+  uint64_t head = __atomic_load_n(&header_->head, __ATOMIC_ACQUIRE);
+  if (capacity_ - (size_t)(tail_ - head) < needed)
+    return false;
+
+  if (recordSize > toEnd) {
+    // Skip the space at the end so that the record is contiguous.
+    *(uint32_t*)(records_ + offset) = WRAP_LENGTH;
+    tail_ += toEnd;
+    offset = 0;
+  }
+
+  *(uint32_t*)(records_ + offset) = (uint32_t)dataLength;
+  memcpy(records_ + offset + RECORD_HEADER_SIZE, data, dataLength);
+  tail_ += recordSize;
+  // Make the record visible to the consumer before it reads the tail.
+  __atomic_store_n(&header_->tail, tail_, __ATOMIC_RELEASE);
+  return true;
+}
+
+void
+ShmRing::wakeConsumer()
+{
+  // This fence pairs with the one in wait() so that either the consumer sees
+  // the new tail or we see isConsumerWaiting.
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  if (__atomic_load_n(&header_->isConsumerWaiting, __ATOMIC_RELAXED)) {
+    uint64_t one = 1;
+    // Ignore an error since the consumer also waits with a timeout.
+    if (::write(eventFd_, &one, sizeof(one)) < 0) {}
+  }
+}
+
+size_t
+ShmRing::read(ElementListener& listener)
+{
+  uint64_t tail = __atomic_load_n(&header_->tail, __ATOMIC_ACQUIRE);
+  size_t nPackets = 0;
+
+  while (head_ != tail) {
+    size_t offset = (size_t)(head_ & (capacity_ - 1));
+    uint32_t length = *(const uint32_t*)(records_ + offset);
+    if (length == WRAP_LENGTH) {
+      head_ += capacity_ - offset;
+      continue;
+    }
+    if (getRecordSize(length) > capacity_ - offset ||
+        getRecordSize(length) > (size_t)(tail - head_))
+      throw runtime_error("ShmRing: The record length is corrupted");
+
+    // Copy the packet so that the record can be freed before the call.
+    Blob element = copyPacket(records_ + offset + RECORD_HEADER_SIZE, length);
+    head_ += getRecordSize(length);
+    __atomic_store_n(&header_->head, head_, __ATOMIC_RELEASE);
+    ++nPackets;
+
+    listener.onReceivedElement(element);
+  }
+
+  // Free the skipped space at the end of the ring.
+  __atomic_store_n(&header_->head, head_, __ATOMIC_RELEASE);
+  return nPackets;
+}
+
+Blob
+ShmRing::copyPacket(const uint8_t* data, size_t dataLength)
+{
+  if (copyBuffer_.use_count() == 1)
+    // The listener didn't keep a Blob of the previous packets.
+    copyBufferEnd_ = 0;
+  if (!copyBuffer_ || copyBuffer_->size() - copyBufferEnd_ < dataLength) {
+    copyBuffer_.reset(new vector<uint8_t>
+      (dataLength > COPY_BUFFER_SIZE ? dataLength : COPY_BUFFER_SIZE));
+    copyBufferEnd_ = 0;
+  }
+
+  memcpy(copyBuffer_->data() + copyBufferEnd_, data, dataLength);
+  Blob element(Blob(copyBuffer_, false), copyBufferEnd_, dataLength);
+  copyBufferEnd_ += dataLength;
+  return element;
+}
+
+bool
+ShmRing::wait(nanoseconds timeout, int otherFd)
+{
+  if (timeout <= nanoseconds::zero())
+    return false;
+
+  bool otherFdHasEvent = false;
+  __atomic_store_n(&header_->isConsumerWaiting, 1, __ATOMIC_RELAXED);
+  // This fence pairs with the one in wakeConsumer().
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  if (isEmpty()) {
+    struct pollfd pollInfo[2];
+    pollInfo[0].fd = eventFd_;
+    pollInfo[0].events = POLLIN;
+    pollInfo[1].fd = otherFd;
+    pollInfo[1].events = POLLIN;
+    pollInfo[1].revents = 0;
+    if (poll(pollInfo, otherFd >= 0 ? 2 : 1,
+             Transport::getPollTimeoutMilliseconds(timeout)) > 0)
+      otherFdHasEvent = (otherFd >= 0 && pollInfo[1].revents != 0);
+  }
+  __atomic_store_n(&header_->isConsumerWaiting, 0, __ATOMIC_RELAXED);
+
+  // Reset the eventfd counter if it was signaled.
+  uint64_t count;
+  if (::read(eventFd_, &count, sizeof(count)) < 0) {}
+  return otherFdHasEvent;
+}
+
+}
+
+#endif // NDN_IND_HAVE_SYS_EVENTFD_H
@@ -0,0 +1,187 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2020 Operant Networks, Incorporated.
+ * @author: Jeff Thompson <jefft0@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+#ifndef NDN_SHM_RING_HPP
+#define NDN_SHM_RING_HPP
+
+// Only compile if ndn-ind-config.h defines NDN_IND_HAVE_SYS_EVENTFD_H.
+#include <ndn-ind/ndn-ind-config.h>
+#if NDN_IND_HAVE_SYS_EVENTFD_H
+
+#include <chrono>
+#include <vector>
+#include <ndn-ind/common.hpp>
+#include <ndn-ind/util/blob.hpp>
+#include <ndn-ind/encoding/element-listener.hpp>
+
+namespace ndn_ind {
+
+/**
+ * A ShmRing is a single-producer single-consumer queue of packets in shared
+ * memory, used by ShmTransport between two processes. Each packet is written
+ * as one contiguous record so that the consumer copies it with one memcpy into
+ * a local buffer which it shares with the listener as a Blob slice. (A kept
+ * slice keeps the whole local buffer, so Node copies each element into an
+ * exact-size Blob unless shared decoding is enabled.) The producer
+ * may reuse the record as soon as it is copied. The producer signals an eventfd only
+ * when the consumer is waiting, so a busy consumer gets packets without a
+ * system call.
+ */
+class ShmRing {
+public:
+  /**
+   * The Header is at the start of the ring's memory. The head and tail are
+   * the total number of bytes read and written, on separate cache lines so
+   * that the producer and consumer don't contend.
+   */
+  struct Header {
+    // Written by the consumer.
+    uint64_t head;
+    uint8_t padding1[56];
+    // Written by the producer.
+    uint64_t tail;
+    uint8_t padding2[56];
+    // Set by the consumer before waiting on the eventfd.
+    uint32_t isConsumerWaiting;
+    uint8_t padding3[60];
+  };
+
+  /**
+   * Create a ShmRing to use the shared memory.
+   * @param memory A pointer to getMemorySize(capacity) bytes of shared memory,
+   * aligned to 64 bytes. This does not initialize it. See initialize().
+   * @param capacity The number of bytes for records, which must be a power of
+   * 2 and at least 2 * MAX_NDN_PACKET_SIZE.
+   * @param eventFd The eventfd which the producer signals to wake the
+   * consumer. This does not close it.
+   */
+  ShmRing(uint8_t* memory, size_t capacity, int eventFd);
+
+  /**
+   * Get the size of the shared memory for a ring with the capacity.
+   * @param capacity The number of bytes for records.
+   * @return The size of the memory.
+   */
+  static size_t
+  getMemorySize(size_t capacity) { return sizeof(Header) + capacity; }
+
+  /**
+   * Clear the header of new shared memory. Only the process which creates the
+   * shared memory should call this, before giving it to the other process.
+   */
+  void
+  initialize();
+
+  /**
+   * Write the packet as one record if there is room. Make it visible to the
+   * consumer, but don't wake it. See wakeConsumer().
+   * @param data A pointer to the packet.
+   * @param dataLength The length of the packet.
+   * @return True if written, false if there is not enough room.
+   * @throws runtime_error if the packet is larger than the maximum record.
+   */
+  bool
+  write(const uint8_t* data, size_t dataLength);
+
+  /**
+   * If the consumer is waiting in wait(), signal the eventfd to wake it.
+   */
+  void
+  wakeConsumer();
+
+  /**
+   * Call listener.onReceivedElement(const Blob&) for each record. The Blob is a
+   * copy of the record which the listener may keep, and the record is freed
+   * before the call.
+   * @param listener The listener for the packets.
+   * @return The number of packets.
+   * @throws runtime_error if a record is corrupted.
+   */
+  size_t
+  read(ElementListener& listener);
+
+  /**
+   * Check if there is a record to read.
+   * @return True if there are no records.
+   */
+  bool
+  isEmpty() const
+  {
+    return __atomic_load_n(&header_->tail, __ATOMIC_ACQUIRE) == head_;
+  }
+
+  /**
+   * Wait until there is a record to read, or until the timeout. This sets
+   * isConsumerWaiting so that the producer signals the eventfd.
+   * @param timeout The maximum time to wait.
+   * @param otherFd (optional) If not -1, also return if this file descriptor
+   * has an event such as a hangup.
+   * @return True if otherFd has an event.
+   */
+  bool
+  wait(std::chrono::nanoseconds timeout, int otherFd = -1);
+
+private:
+  /**
+   * Get the size of the record for a packet, including the length prefix and
+   * padding so that the next record is aligned to 8 bytes.
+   */
+  static size_t
+  getRecordSize(size_t dataLength)
+  {
+    return RECORD_HEADER_SIZE + ((dataLength + 7) & ~(size_t)7);
+  }
+
+  /**
+   * Copy the packet into copyBuffer_ and return a Blob slice of it. If the
+   * listener didn't keep a Blob of the previous packets, this reuses
+   * copyBuffer_ from the front. Otherwise this continues after the previous
+   * packets, and makes a new copyBuffer_ when it is full.
+   * @param data A pointer to the packet in the ring.
+   * @param dataLength The length of the packet.
+   * @return The Blob with the copy of the packet.
+   */
+  Blob
+  copyPacket(const uint8_t* data, size_t dataLength);
+
+  // The length of a record which means to skip to the start of the ring.
+  static const uint32_t WRAP_LENGTH = 0xffffffff;
+  static const size_t RECORD_HEADER_SIZE = 8;
+  static const size_t COPY_BUFFER_SIZE = 262144;
+
+  Header* header_;
+  uint8_t* records_;
+  size_t capacity_;
+  int eventFd_;
+  // The consumer's copy of header_->head.
+  uint64_t head_;
+  // The producer's copy of header_->tail.
+  uint64_t tail_;
+  ptr_lib::shared_ptr<std::vector<uint8_t> > copyBuffer_;
+  // The offset in copyBuffer_ after the last copied packet.
+  size_t copyBufferEnd_;
+};
+
+}
+
+#endif // NDN_IND_HAVE_SYS_EVENTFD_H
+
+#endif
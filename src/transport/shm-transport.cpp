@@ -0,0 +1,562 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2020 Operant Networks, Incorporated.
+ * @author: Jeff Thompson <jefft0@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+// Only compile if ndn-ind-config.h defines NDN_IND_HAVE_SYS_EVENTFD_H.
+#include <ndn-ind/ndn-ind-config.h>
+#if NDN_IND_HAVE_SYS_EVENTFD_H
+
+#include <stdexcept>
+#include <cerrno>
+#include <cstring>
+#include <deque>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <ndn-ind/util/blob.hpp>
+#include "../c/util/ndn_memory.h"
+#include "shm-ring.hpp"
+#include <ndn-ind/transport/shm-transport.hpp>
+
+using namespace std;
+using namespace std::chrono;
+
+namespace ndn_ind {
+
+/**
+ * ShmTransport::Impl maps the shared memory which has a RegionHeader followed
+ * by the ring from the creator to the acceptor, then the ring from the
+ * acceptor to the creator.
+ */
+class ShmTransport::Impl {
+public:
+  Impl()
+  : socketDescriptor_(-1), region_(MAP_FAILED), regionSize_(0),
+    peerIndex_(0), elementListener_(0), corkDepth_(0), needsWake_(false),
+    isConnected_(false)
+  {
+    eventFds_[0] = -1;
+    eventFds_[1] = -1;
+  }
+
+  ~Impl()
+  {
+    close();
+  }
+
+  /**
+   * Create the shared memory, connect to the Unix socket and send the file
+   * descriptors.
+   */
+  void
+  connect(const ShmTransport::ConnectionInfo& connectionInfo)
+  {
+    size_t ringCapacity = 1;
+    while (ringCapacity < connectionInfo.getRingCapacity() ||
+           ringCapacity < getMinimumRingCapacity())
+      ringCapacity <<= 1;
+    regionSize_ = getRegionSize(ringCapacity);
+
+    int memoryFd = memfd_create("ndn-ind-shm-transport", MFD_CLOEXEC);
+    if (memoryFd < 0)
+      throwErrno("ShmTransport: Error in memfd_create", errno);
+    if (ftruncate(memoryFd, regionSize_) != 0) {
+      int errorNumber = errno;
+      ::close(memoryFd);
+      throwErrno("ShmTransport: Error sizing the shared memory", errorNumber);
+    }
+    region_ = mmap
+      (0, regionSize_, PROT_READ | PROT_WRITE, MAP_SHARED, memoryFd, 0);
+    if (region_ == MAP_FAILED) {
+      int errorNumber = errno;
+      ::close(memoryFd);
+      throwErrno("ShmTransport: Error mapping the shared memory", errorNumber);
+    }
+
+    RegionHeader* header = (RegionHeader*)region_;
+    memset(header, 0, sizeof(RegionHeader));
+    header->magic = MAGIC;
+    header->version = VERSION;
+    header->ringCapacity = ringCapacity;
+
+    for (int i = 0; i < 2; ++i) {
+      eventFds_[i] = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+      if (eventFds_[i] < 0) {
+        int errorNumber = errno;
+        ::close(memoryFd);
+        close();
+        throwErrno("ShmTransport: Error in eventfd", errorNumber);
+      }
+    }
+    // The creator sends on ring 0 and its peer is the acceptor at index 1.
+    makeRings(0);
+    sendRing_->initialize();
+    receiveRing_->initialize();
+
+    socketDescriptor_ = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, connectionInfo.getFilePath().c_str(),
+            sizeof(address.sun_path) - 1);
+    if (socketDescriptor_ < 0 ||
+        ::connect(socketDescriptor_, (struct sockaddr*)&address,
+                  sizeof(address)) != 0) {
+      int errorNumber = errno;
+      ::close(memoryFd);
+      close();
+      throwErrno("ShmTransport: Error connecting to the Unix socket", errorNumber);
+    }
+
+    int fds[3] = { memoryFd, eventFds_[0], eventFds_[1] };
+    bool isSent = sendFileDescriptors(fds);
+    int errorNumber = errno;
+    // The mapping keeps the shared memory after closing its file descriptor.
+    ::close(memoryFd);
+    if (!isSent) {
+      close();
+      throwErrno("ShmTransport: Error sending the shared memory", errorNumber);
+    }
+
+    isConnected_ = true;
+  }
+
+  /**
+   * Receive the file descriptors from the accepted Unix socket and map the
+   * shared memory.
+   */
+  void
+  connect(const ShmTransport::AcceptedConnectionInfo& connectionInfo)
+  {
+    socketDescriptor_ = connectionInfo.getSocketDescriptor();
+
+    int fds[3];
+    if (!receiveFileDescriptors(fds)) {
+      int errorNumber = errno;
+      close();
+      throwErrno("ShmTransport: Error receiving the shared memory", errorNumber);
+    }
+    int memoryFd = fds[0];
+    eventFds_[0] = fds[1];
+    eventFds_[1] = fds[2];
+
+    struct stat status;
+    if (fstat(memoryFd, &status) != 0 ||
+        (size_t)status.st_size < sizeof(RegionHeader)) {
+      ::close(memoryFd);
+      close();
+      throw runtime_error("ShmTransport: The shared memory is too small");
+    }
+    regionSize_ = (size_t)status.st_size;
+    region_ = mmap
+      (0, regionSize_, PROT_READ | PROT_WRITE, MAP_SHARED, memoryFd, 0);
+    int errorNumber = errno;
+    ::close(memoryFd);
+    if (region_ == MAP_FAILED) {
+      close();
+      throwErrno("ShmTransport: Error mapping the shared memory", errorNumber);
+    }
+
+    const RegionHeader* header = (const RegionHeader*)region_;
+    if (header->magic != MAGIC || header->version != VERSION ||
+        header->ringCapacity < getMinimumRingCapacity() ||
+        (header->ringCapacity & (header->ringCapacity - 1)) != 0 ||
+        getRegionSize(header->ringCapacity) != regionSize_) {
+      close();
+      throw runtime_error("ShmTransport: The shared memory header is invalid");
+    }
+
+    // The acceptor sends on ring 1 and its peer is the creator at index 0.
+    makeRings(1);
+    isConnected_ = true;
+  }
+
+  void
+  setElementListener(ElementListener& elementListener)
+  {
+    elementListener_ = &elementListener;
+  }
+
+  void
+  send(const uint8_t *data, size_t dataLength)
+  {
+    if (!sendRing_ || !isConnected_)
+      throw runtime_error("ShmTransport.send: The transport is not connected");
+
+    if (pendingPackets_.size() > 0)
+      writePendingPackets();
+    // Keep the packets in order behind any that are still queued.
+    if (pendingPackets_.size() > 0 || !sendRing_->write(data, dataLength))
+      pendingPackets_.push_back(Blob(data, dataLength));
+
+    if (corkDepth_ > 0)
+      needsWake_ = true;
+    else
+      sendRing_->wakeConsumer();
+  }
+
+  void
+  cork() { ++corkDepth_; }
+
+  void
+  uncork()
+  {
+    if (corkDepth_ == 0)
+      return;
+
+    --corkDepth_;
+    if (corkDepth_ == 0)
+      flush();
+  }
+
+  void
+  flush()
+  {
+    if (needsWake_ && sendRing_) {
+      needsWake_ = false;
+      sendRing_->wakeConsumer();
+    }
+  }
+
+  void
+  processEvents()
+  {
+    if (!receiveRing_)
+      return;
+
+    if (pendingPackets_.size() > 0) {
+      writePendingPackets();
+      sendRing_->wakeConsumer();
+    }
+
+    receiveRing_->read(*elementListener_);
+
+    if (__atomic_load_n(&((RegionHeader*)region_)->isClosed[peerIndex_],
+                        __ATOMIC_ACQUIRE) &&
+        receiveRing_->isEmpty())
+      isConnected_ = false;
+  }
+
+  /**
+   * Return true if there is a peer which can wake waitForReceive.
+   */
+  bool
+  hasPeer() const { return receiveRing_ && isConnected_; }
+
+  /**
+   * Wait for the peer to write to the receive ring. The caller must check
+   * hasPeer().
+   */
+  void
+  waitForReceive(nanoseconds maxWait)
+  {
+    // The peer doesn't wake us when it frees space in the send ring, so check
+    // the queued packets again soon.
+    if (pendingPackets_.size() > 0 && maxWait > milliseconds(1))
+      maxWait = milliseconds(1);
+
+    if (receiveRing_->wait(maxWait, socketDescriptor_)) {
+      // The Unix socket is only readable at end of file when the peer exits.
+      uint8_t buffer[1];
+      if (recv(socketDescriptor_, buffer, sizeof(buffer), MSG_DONTWAIT) == 0)
+        isConnected_ = false;
+    }
+  }
+
+  bool
+  getIsConnected() { return isConnected_; }
+
+  void
+  close()
+  {
+    if (region_ != MAP_FAILED) {
+      if (sendRing_)
+        // Tell the peer that we are closed.
+        __atomic_store_n(&((RegionHeader*)region_)->isClosed[1 - peerIndex_],
+                         1, __ATOMIC_RELEASE);
+      munmap(region_, regionSize_);
+      region_ = MAP_FAILED;
+    }
+    sendRing_.reset();
+    receiveRing_.reset();
+
+    // Closing the socket also wakes the peer if it is waiting.
+    if (socketDescriptor_ >= 0) {
+      ::close(socketDescriptor_);
+      socketDescriptor_ = -1;
+    }
+    for (int i = 0; i < 2; ++i) {
+      if (eventFds_[i] >= 0) {
+        ::close(eventFds_[i]);
+        eventFds_[i] = -1;
+      }
+    }
+
+    pendingPackets_.clear();
+    corkDepth_ = 0;
+    needsWake_ = false;
+    isConnected_ = false;
+  }
+
+private:
+  /**
+   * The RegionHeader is at the start of the shared memory.
+   */
+  struct RegionHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t ringCapacity;
+    // isClosed[0] is set by the creator, isClosed[1] by the acceptor.
+    uint32_t isClosed[2];
+    uint8_t padding[40];
+  };
+
+  static const uint32_t MAGIC = 0x4e444e53;
+  static const uint32_t VERSION = 1;
+
+  /**
+   * Get the minimum ring capacity so that a ring can hold the record for a
+   * packet of MAX_NDN_PACKET_SIZE, which must be at most half of the capacity.
+   */
+  static size_t
+  getMinimumRingCapacity() { return 2 * (MAX_NDN_PACKET_SIZE + 16); }
+
+  static size_t
+  getRegionSize(size_t ringCapacity)
+  {
+    return sizeof(RegionHeader) + 2 * ShmRing::getMemorySize(ringCapacity);
+  }
+
+  static void
+  throwErrno(const char* message, int errorNumber)
+  {
+    throw runtime_error(string(message) + ": " + strerror(errorNumber));
+  }
+
+  /**
+   * Create sendRing_ and receiveRing_ for the mapped region.
+   * @param sendIndex The index of the ring for sending, 0 for the creator or
+   * 1 for the acceptor.
+   */
+  void
+  makeRings(int sendIndex)
+  {
+    size_t ringCapacity = ((RegionHeader*)region_)->ringCapacity;
+    uint8_t* rings[2];
+    rings[0] = (uint8_t*)region_ + sizeof(RegionHeader);
+    rings[1] = rings[0] + ShmRing::getMemorySize(ringCapacity);
+
+    sendRing_.reset(new ShmRing
+      (rings[sendIndex], ringCapacity, eventFds_[sendIndex]));
+    receiveRing_.reset(new ShmRing
+      (rings[1 - sendIndex], ringCapacity, eventFds_[1 - sendIndex]));
+    peerIndex_ = 1 - sendIndex;
+  }
+
+  /**
+   * Write the queued packets to the send ring until it is full.
+   */
+  void
+  writePendingPackets()
+  {
+    while (pendingPackets_.size() > 0 &&
+           sendRing_->write(pendingPackets_.front().buf(),
+                            pendingPackets_.front().size()))
+      pendingPackets_.pop_front();
+  }
+
+  /**
+   * Send the file descriptors for the shared memory and the eventfds on the
+   * Unix socket.
+   * @return True for success, false for an error in errno.
+   */
+  bool
+  sendFileDescriptors(const int fds[3])
+  {
+    uint8_t byte = 0;
+    struct iovec io;
+    io.iov_base = &byte;
+    io.iov_len = 1;
+    union {
+      struct cmsghdr header;
+      uint8_t buffer[CMSG_SPACE(3 * sizeof(int))];
+    } control;
+    memset(&control, 0, sizeof(control));
+
+    struct msghdr message;
+    memset(&message, 0, sizeof(message));
+    message.msg_iov = &io;
+    message.msg_iovlen = 1;
+    message.msg_control = control.buffer;
+    message.msg_controllen = sizeof(control.buffer);
+    struct cmsghdr* controlMessage = CMSG_FIRSTHDR(&message);
+    controlMessage->cmsg_level = SOL_SOCKET;
+    controlMessage->cmsg_type = SCM_RIGHTS;
+    controlMessage->cmsg_len = CMSG_LEN(3 * sizeof(int));
+    ndn_memcpy(CMSG_DATA(controlMessage), (const uint8_t*)fds, 3 * sizeof(int));
+
+    return sendmsg(socketDescriptor_, &message, MSG_NOSIGNAL) == 1;
+  }
+
+  /**
+   * Receive the file descriptors sent by sendFileDescriptors.
+   * @return True for success, false for an error in errno.
+   */
+  bool
+  receiveFileDescriptors(int fds[3])
+  {
+    uint8_t byte;
+    struct iovec io;
+    io.iov_base = &byte;
+    io.iov_len = 1;
+    union {
+      struct cmsghdr header;
+      uint8_t buffer[CMSG_SPACE(3 * sizeof(int))];
+    } control;
+
+    struct msghdr message;
+    memset(&message, 0, sizeof(message));
+    message.msg_iov = &io;
+    message.msg_iovlen = 1;
+    message.msg_control = control.buffer;
+    message.msg_controllen = sizeof(control.buffer);
+    if (recvmsg(socketDescriptor_, &message, MSG_CMSG_CLOEXEC) != 1)
+      return false;
+
+    struct cmsghdr* controlMessage = CMSG_FIRSTHDR(&message);
+    if (!controlMessage || controlMessage->cmsg_level != SOL_SOCKET ||
+        controlMessage->cmsg_type != SCM_RIGHTS ||
+        controlMessage->cmsg_len != CMSG_LEN(3 * sizeof(int))) {
+      errno = EPROTO;
+      return false;
+    }
+    ndn_memcpy((uint8_t*)fds, CMSG_DATA(controlMessage), 3 * sizeof(int));
+    return true;
+  }
+
+  // Disable the copy constructor and assignment operator.
+  Impl(const Impl& other);
+  Impl& operator=(const Impl& other);
+
+  int socketDescriptor_;
+  int eventFds_[2];
+  void* region_;
+  size_t regionSize_;
+  ptr_lib::shared_ptr<ShmRing> sendRing_;
+  ptr_lib::shared_ptr<ShmRing> receiveRing_;
+  // The index in RegionHeader::isClosed of the other process.
+  int peerIndex_;
+  ElementListener* elementListener_;
+  // The packets which didn't fit in the send ring.
+  std::deque<Blob> pendingPackets_;
+  int corkDepth_;
+  bool needsWake_;
+  bool isConnected_;
+};
+
+ShmTransport::ConnectionInfo::~ConnectionInfo()
+{
+}
+
+ShmTransport::AcceptedConnectionInfo::~AcceptedConnectionInfo()
+{
+}
+
+ShmTransport::ShmTransport()
+: impl_(new Impl())
+{
+}
+
+bool
+ShmTransport::isLocal(const Transport::ConnectionInfo& connectionInfo)
+{
+  return true;
+}
+
+bool
+ShmTransport::isAsync() { return false; }
+
+void
+ShmTransport::connect
+  (const Transport::ConnectionInfo& connectionInfo,
+   ElementListener& elementListener, const OnConnected& onConnected)
+{
+  impl_->close();
+
+  const AcceptedConnectionInfo* acceptedConnectionInfo =
+    dynamic_cast<const AcceptedConnectionInfo*>(&connectionInfo);
+  if (acceptedConnectionInfo)
+    impl_->connect(*acceptedConnectionInfo);
+  else
+    impl_->connect
+      (dynamic_cast<const ShmTransport::ConnectionInfo&>(connectionInfo));
+  impl_->setElementListener(elementListener);
+
+  if (onConnected)
+    onConnected();
+}
+
+void
+ShmTransport::send(const uint8_t *data, size_t dataLength)
+{
+  impl_->send(data, dataLength);
+}
+
+void
+ShmTransport::cork() { impl_->cork(); }
+
+void
+ShmTransport::uncork() { impl_->uncork(); }
+
+void
+ShmTransport::flush() { impl_->flush(); }
+
+void
+ShmTransport::processEvents() { impl_->processEvents(); }
+
+void
+ShmTransport::waitForReceive(nanoseconds maxWait)
+{
+  if (!impl_->hasPeer()) {
+    // There is no peer to wake us.
+    Transport::waitForReceive(maxWait);
+    return;
+  }
+
+  impl_->waitForReceive(maxWait);
+}
+
+bool
+ShmTransport::getIsConnected() { return impl_->getIsConnected(); }
+
+void
+ShmTransport::close() { impl_->close(); }
+
+ShmTransport::~ShmTransport()
+{
+}
+
+}
+
+#endif // NDN_IND_HAVE_SYS_EVENTFD_H
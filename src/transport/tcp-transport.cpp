@@ -9,6 +9,7 @@
  * Original repository: https://github.com/named-data/ndn-cpp
  *
  * Summary of Changes: Use ndn-ind includes. Add readRawPackets. Put element-listener.hpp in API. Support WinSock2.
+ * Add cork. Add waitForReceive.
  *
  * which was originally released under the LGPL license with the following rights:
  *
@@ -40,6 +41,7 @@
 #include "../c/transport/tcp-transport.h"
 #include "../c/encoding/element-reader.h"
 #include "../util/dynamic-uint8-vector.hpp"
+#include "transport-send-queue.hpp"
 #include <ndn-ind/transport/tcp-transport.hpp>
 
 using namespace std;
@@ -56,6 +58,14 @@ TcpTransport::TcpTransport(bool readRawPackets)
 {
   ndn_TcpTransport_initialize
     (transport_.get(), elementBuffer_.get(), readRawPackets ? 1 : 0);
+
+  sendQueue_.reset(new TransportSendQueue
+    ([this](const struct ndn_Blob* buffers, size_t nBuffers) {
+      ndn_Error error;
+      if ((error = ndn_TcpTransport_sendBuffers
+           (transport_.get(), buffers, nBuffers)))
+        throw runtime_error(ndn_getErrorString(error));
+    }));
 }
 
 bool
@@ -105,11 +115,18 @@ TcpTransport::connect
 void
 TcpTransport::send(const uint8_t *data, size_t dataLength)
 {
-  ndn_Error error;
-  if ((error = ndn_TcpTransport_send(transport_.get(), data, dataLength)))
-    throw runtime_error(ndn_getErrorString(error));
+  sendQueue_->send(data, dataLength);
 }
 
+void
+TcpTransport::cork() { sendQueue_->cork(); }
+
+void
+TcpTransport::uncork() { sendQueue_->uncork(); }
+
+void
+TcpTransport::flush() { sendQueue_->flush(); }
+
 void
 TcpTransport::processEvents()
 {
@@ -120,6 +137,22 @@ TcpTransport::processEvents()
     throw runtime_error(ndn_getErrorString(error));
 }
 
+void
+TcpTransport::waitForReceive(chrono::nanoseconds maxWait)
+{
+  if (!isConnected_) {
+    // There is no socket to poll.
+    Transport::waitForReceive(maxWait);
+    return;
+  }
+
+  int receiveIsReady;
+  ndn_Error error;
+  if ((error = ndn_TcpTransport_waitForReceive
+       (transport_.get(), getPollTimeoutMilliseconds(maxWait), &receiveIsReady)))
+    throw runtime_error(ndn_getErrorString(error));
+}
+
 bool
 TcpTransport::getIsConnected()
 {
@@ -129,6 +162,13 @@ TcpTransport::getIsConnected()
 void
 TcpTransport::close()
 {
+  try {
+    // Send any packets queued by cork() before closing.
+    sendQueue_->flush();
+  } catch (...) {
+    // Ignore errors since we are closing anyway.
+  }
+
   ndn_Error error;
   if ((error = ndn_TcpTransport_close(transport_.get())))
     throw runtime_error(ndn_getErrorString(error));
@@ -0,0 +1,155 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2020 Operant Networks, Incorporated.
+ * @author: Jeff Thompson <jefft0@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+#include <algorithm>
+#include <stdexcept>
+#include "../c/encoding/tlv/tlv-structure-decoder.h"
+#include "transport-receive-buffer.hpp"
+
+using namespace std;
+
+namespace ndn_ind {
+
+TransportReceiveBuffer::TransportReceiveBuffer
+  (bool readRawPackets, size_t capacity)
+: buffer_(new vector<uint8_t>(max(capacity, (size_t)(2 * MAX_NDN_PACKET_SIZE)))),
+  elementBegin_(0), end_(0), readRawPackets_(readRawPackets),
+  elementListener_(0)
+{
+  ndn_TlvStructureDecoder_initialize(&tlvStructureDecoder_);
+}
+
+void
+TransportReceiveBuffer::reset(ElementListener* elementListener)
+{
+  elementListener_ = elementListener;
+  clear();
+}
+
+void
+TransportReceiveBuffer::onReceived(size_t nBytes)
+{
+  if (nBytes == 0)
+    return;
+  end_ += nBytes;
+
+  if (readRawPackets_) {
+    // Mark the bytes as processed before calling in case the listener calls
+    // reset().
+    size_t begin = elementBegin_;
+    elementBegin_ = end_;
+    try {
+      if (!elementListener_)
+        throw runtime_error(ndn_getErrorString
+          (NDN_ERROR_ElementReader_ElementListener_is_not_specified));
+      elementListener_->onReceivedElement
+        (Blob(Blob(buffer_, false), begin, end_ - begin));
+    } catch (...) {
+      compact();
+      throw;
+    }
+
+    compact();
+    return;
+  }
+
+  try {
+    while (elementBegin_ < end_) {
+      // Continue scanning from where the last call stopped in this element.
+      ndn_Error error = ndn_TlvStructureDecoder_findElementEnd
+        (&tlvStructureDecoder_, &(*buffer_)[0] + elementBegin_,
+         end_ - elementBegin_);
+      if (error) {
+        clear();
+        throw runtime_error(ndn_getErrorString(error));
+      }
+
+      // The buffer can hold more than one packet, so also check a whole element.
+      if (tlvStructureDecoder_.offset > MAX_NDN_PACKET_SIZE) {
+        clear();
+        throw runtime_error(ndn_getErrorString
+          (NDN_ERROR_ElementReader_The_incoming_packet_exceeds_the_maximum_limit_getMaxNdnPacketSize));
+      }
+
+      if (!tlvStructureDecoder_.gotElementEnd)
+        // Wait for more bytes.
+        break;
+
+      if (!elementListener_)
+        throw runtime_error(ndn_getErrorString
+          (NDN_ERROR_ElementReader_ElementListener_is_not_specified));
+
+      // Move to the next element before calling in case the listener throws an
+      // exception or calls reset().
+      Blob element
+        (Blob(buffer_, false), elementBegin_, tlvStructureDecoder_.offset);
+      elementBegin_ += tlvStructureDecoder_.offset;
+      ndn_TlvStructureDecoder_initialize(&tlvStructureDecoder_);
+
+      elementListener_->onReceivedElement(element);
+    }
+  } catch (...) {
+    compact();
+    throw;
+  }
+
+  compact();
+}
+
+void
+TransportReceiveBuffer::compact()
+{
+  if (elementBegin_ == end_ && !isShared()) {
+    // All the elements were processed, so start again at the front.
+    elementBegin_ = 0;
+    end_ = 0;
+  }
+  else if (buffer_->size() - end_ < MAX_NDN_PACKET_SIZE) {
+    // The structure decoder offset is relative to elementBegin_, so it is
+    // still valid.
+    if (isShared()) {
+      // Don't overwrite the elements that the listener kept.
+      ptr_lib::shared_ptr<vector<uint8_t> > newBuffer
+        (new vector<uint8_t>(buffer_->size()));
+      copy(buffer_->begin() + elementBegin_, buffer_->begin() + end_,
+           newBuffer->begin());
+      buffer_ = newBuffer;
+    }
+    else
+      copy(buffer_->begin() + elementBegin_, buffer_->begin() + end_,
+           buffer_->begin());
+    end_ -= elementBegin_;
+    elementBegin_ = 0;
+  }
+}
+
+void
+TransportReceiveBuffer::clear()
+{
+  if (isShared())
+    // Don't overwrite the elements that the listener kept.
+    buffer_.reset(new vector<uint8_t>(buffer_->size()));
+  elementBegin_ = 0;
+  end_ = 0;
+  ndn_TlvStructureDecoder_initialize(&tlvStructureDecoder_);
+}
+
+}
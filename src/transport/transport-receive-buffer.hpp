@@ -0,0 +1,138 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2020 Operant Networks, Incorporated.
+ * @author: Jeff Thompson <jefft0@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+#ifndef NDN_TRANSPORT_RECEIVE_BUFFER_HPP
+#define NDN_TRANSPORT_RECEIVE_BUFFER_HPP
+
+#include <vector>
+#include <ndn-ind/util/blob.hpp>
+#include <ndn-ind/encoding/element-listener.hpp>
+
+namespace ndn_ind {
+
+/**
+ * A TransportReceiveBuffer is used by a stream Transport to read into one
+ * large buffer and find the TLV elements in place. The transport reads as many
+ * bytes as fit into getFreeSpace(), then calls onReceived() which gives each
+ * whole element to the element listener as a Blob slice of the buffer, without
+ * copying. Only the bytes of an element which is not yet complete stay in the
+ * buffer, and these are moved to the front when the free space is too small
+ * for another packet. If the element listener keeps a Blob, then the bytes
+ * that it refers to are never overwritten. Instead, when the free space is too
+ * small, the remaining bytes are moved to a new buffer. A kept slice keeps
+ * the whole buffer, so Node copies each element into an exact-size Blob unless
+ * shared decoding is enabled.
+ */
+class TransportReceiveBuffer {
+public:
+  /**
+   * Create a TransportReceiveBuffer with no element listener.
+   * @param readRawPackets If true, then onReceived() gives all the received
+   * bytes to the element listener as-is. If false, then use the
+   * ndn_TlvStructureDecoder to give the element listener one whole TLV element
+   * at a time.
+   * @param capacity (optional) The size of the buffer. If this is less than
+   * twice MAX_NDN_PACKET_SIZE then use twice MAX_NDN_PACKET_SIZE. If omitted,
+   * use getDefaultCapacity().
+   */
+  TransportReceiveBuffer
+    (bool readRawPackets, size_t capacity = getDefaultCapacity());
+
+  /**
+   * Discard any received bytes and set the element listener for the next call
+   * to onReceived(), such as when the transport connects.
+   * @param elementListener The ElementListener, which must remain valid while
+   * this is used. If null, then onReceived() throws an exception for an
+   * element.
+   */
+  void
+  reset(ElementListener* elementListener);
+
+  /**
+   * Get a pointer to the free space in the buffer for the transport to read
+   * into.
+   * @return A pointer to getFreeSpaceLength() bytes.
+   */
+  uint8_t*
+  getFreeSpace() { return &(*buffer_)[0] + end_; }
+
+  /**
+   * Get the number of bytes available at getFreeSpace(). This is at least
+   * MAX_NDN_PACKET_SIZE after reset() or onReceived().
+   * @return The number of bytes.
+   */
+  size_t
+  getFreeSpaceLength() const { return buffer_->size() - end_; }
+
+  /**
+   * Process the nBytes which the transport read into getFreeSpace(). Call the
+   * element listener's onReceivedElement(const Blob&) for each whole element.
+   * An element listener callback may call reset().
+   * @param nBytes The number of bytes read into getFreeSpace().
+   * @throws runtime_error for a TLV format error or an incoming packet larger
+   * than MAX_NDN_PACKET_SIZE. This discards the received bytes.
+   */
+  void
+  onReceived(size_t nBytes);
+
+  /**
+   * Get the default size of the buffer.
+   * @return 262144.
+   */
+  static size_t
+  getDefaultCapacity() { return 262144; }
+
+private:
+  /**
+   * Move the bytes of the incomplete element to the front of the buffer if the
+   * free space is less than MAX_NDN_PACKET_SIZE. If an element listener still
+   * has a Blob of the buffer, move them to the front of a new buffer instead.
+   */
+  void
+  compact();
+
+  /**
+   * Discard the received bytes and restart the structure decoder.
+   */
+  void
+  clear();
+
+  /**
+   * Check if an element listener still has a Blob which shares buffer_.
+   * @return True if buffer_ is shared.
+   */
+  bool
+  isShared() const { return buffer_.use_count() > 1; }
+
+  ptr_lib::shared_ptr<std::vector<uint8_t> > buffer_;
+  // The offset in buffer_ of the element which is not yet complete.
+  size_t elementBegin_;
+  // The offset in buffer_ of the end of the received bytes.
+  size_t end_;
+  bool readRawPackets_;
+  // The structure decoder offset is relative to elementBegin_.
+  struct ndn_TlvStructureDecoder tlvStructureDecoder_;
+  ElementListener* elementListener_;
+};
+
+}
+
+#endif
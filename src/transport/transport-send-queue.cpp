@@ -0,0 +1,72 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2020 Operant Networks, Incorporated.
+ * @author: Jeff Thompson <jefft0@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+#include "transport-send-queue.hpp"
+
+using namespace std;
+
+namespace ndn_ind {
+
+void
+TransportSendQueue::send(const uint8_t *data, size_t dataLength)
+{
+  if (corkCount_ == 0 || dataLength >= maxQueuedBytes_) {
+    // Keep the order of packets by sending any queued packets first.
+    flush();
+
+    struct ndn_Blob buffer;
+    buffer.value = data;
+    buffer.length = dataLength;
+    sendBuffers_(&buffer, 1);
+    return;
+  }
+
+  queue_.insert(queue_.end(), data, data + dataLength);
+  packetEnds_.push_back(queue_.size());
+  if (queue_.size() >= maxQueuedBytes_)
+    flush();
+}
+
+void
+TransportSendQueue::flush()
+{
+  if (packetEnds_.size() == 0)
+    return;
+
+  // Make the buffers now since queue_ may have been reallocated while adding.
+  buffers_.resize(packetEnds_.size());
+  size_t begin = 0;
+  for (size_t i = 0; i < packetEnds_.size(); ++i) {
+    buffers_[i].value = &queue_[0] + begin;
+    buffers_[i].length = packetEnds_[i] - begin;
+    begin = packetEnds_[i];
+  }
+
+  try {
+    sendBuffers_(&buffers_[0], buffers_.size());
+  } catch (...) {
+    clear();
+    throw;
+  }
+  clear();
+}
+
+}
@@ -0,0 +1,125 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2020 Operant Networks, Incorporated.
+ * @author: Jeff Thompson <jefft0@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+#ifndef NDN_TRANSPORT_SEND_QUEUE_HPP
+#define NDN_TRANSPORT_SEND_QUEUE_HPP
+
+#include <vector>
+#include <ndn-ind/common.hpp>
+#include <ndn-ind/c/util/blob-types.h>
+
+namespace ndn_ind {
+
+/**
+ * A TransportSendQueue is used by a Transport to implement cork(), uncork() and
+ * flush(). While corked, send() copies each packet to the queue, and flush()
+ * gives all queued packets to the SendBuffers function at once so that the
+ * socket can send them with fewer system calls. When not corked, send() gives
+ * the packet to SendBuffers immediately.
+ */
+class TransportSendQueue {
+public:
+  /**
+   * A SendBuffers function sends each buffer as a packet, or throws an
+   * exception for an error.
+   */
+  typedef func_lib::function<void
+    (const struct ndn_Blob* buffers, size_t nBuffers)> SendBuffers;
+
+  /**
+   * Create a TransportSendQueue which is not corked.
+   * @param sendBuffers The function to send packets. This copies the function.
+   * @param maxQueuedBytes (optional) While corked, call flush() when the queue
+   * has this many bytes. If omitted, use getDefaultMaxQueuedBytes().
+   */
+  TransportSendQueue
+    (const SendBuffers& sendBuffers,
+     size_t maxQueuedBytes = getDefaultMaxQueuedBytes())
+  : sendBuffers_(sendBuffers), maxQueuedBytes_(maxQueuedBytes), corkCount_(0)
+  {
+  }
+
+  /**
+   * If corked, copy the packet to the queue and call flush() if the queue
+   * reaches maxQueuedBytes. Otherwise, send the packet immediately.
+   * @param data A pointer to the buffer of data to send.
+   * @param dataLength The number of bytes in data.
+   */
+  void
+  send(const uint8_t *data, size_t dataLength);
+
+  /**
+   * Start queueing packets given to send(). Calls to cork() and uncork() can
+   * be nested.
+   */
+  void
+  cork() { ++corkCount_; }
+
+  /**
+   * Undo one call to cork(). If this is the outermost call, call flush() and
+   * resume sending each packet immediately.
+   */
+  void
+  uncork()
+  {
+    if (corkCount_ > 0 && --corkCount_ == 0)
+      flush();
+  }
+
+  /**
+   * Send all queued packets. This clears the queue even if sending throws an
+   * exception.
+   */
+  void
+  flush();
+
+  /**
+   * Discard all queued packets without sending.
+   */
+  void
+  clear()
+  {
+    queue_.clear();
+    packetEnds_.clear();
+  }
+
+  /**
+   * Get the default maximum number of queued bytes before flush() is called.
+   * @return 65536.
+   */
+  static size_t
+  getDefaultMaxQueuedBytes() { return 65536; }
+
+private:
+  SendBuffers sendBuffers_;
+  size_t maxQueuedBytes_;
+  int corkCount_;
+  // The queued packets, one after the other.
+  std::vector<uint8_t> queue_;
+  // The offset in queue_ of the end of each packet.
+  std::vector<size_t> packetEnds_;
+  // Reused by flush() to give the packets to sendBuffers_.
+  std::vector<struct ndn_Blob> buffers_;
+};
+
+}
+
+#endif
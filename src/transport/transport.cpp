@@ -8,7 +8,7 @@
  * Original file: src/transport/transport.cpp
  * Original repository: https://github.com/named-data/ndn-cpp
  *
- * Summary of Changes: Use ndn-ind includes.
+ * Summary of Changes: Use ndn-ind includes. Add cork. Add waitForReceive.
  *
  * which was originally released under the LGPL license with the following rights:
  *
@@ -32,12 +32,17 @@
  */
 
 #include <stdexcept>
+#include <climits>
+#include <thread>
 #include <ndn-ind/transport/transport.hpp>
 
 using namespace std;
 
 namespace ndn_ind {
 
+// When there is nothing to wait for, waitForReceive sleeps for at most this long.
+static const chrono::nanoseconds MAX_UNCONNECTED_WAIT = chrono::milliseconds(100);
+
 Transport::ConnectionInfo::~ConnectionInfo()
 {
 }
@@ -68,12 +73,36 @@ Transport::send(const uint8_t *data, size_t dataLength)
   throw logic_error("unimplemented");
 }
 
+void
+Transport::cork()
+{
+}
+
+void
+Transport::uncork()
+{
+}
+
+void
+Transport::flush()
+{
+}
+
 void
 Transport::processEvents()
 {
   throw logic_error("unimplemented");
 }
 
+void
+Transport::waitForReceive(chrono::nanoseconds maxWait)
+{
+  // There is nothing to wait for. Don't block forever for a large maxWait such
+  // as nanoseconds::max(), since the caller may connect after this returns.
+  if (maxWait > chrono::nanoseconds::zero())
+    this_thread::sleep_for(min(maxWait, MAX_UNCONNECTED_WAIT));
+}
+
 bool
 Transport::getIsConnected()
 {
@@ -89,4 +118,17 @@ Transport::~Transport()
 {
 }
 
+int
+Transport::getPollTimeoutMilliseconds(chrono::nanoseconds maxWait)
+{
+  if (maxWait <= chrono::nanoseconds::zero())
+    return 0;
+
+  // Clamp before rounding up so that a large maxWait such as
+  // nanoseconds::max() doesn't overflow.
+  if (maxWait.count() > (int64_t)INT_MAX * 1000000)
+    return INT_MAX;
+  return (int)((maxWait.count() + 999999) / 1000000);
+}
+
 }
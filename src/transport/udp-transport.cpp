@@ -9,6 +9,7 @@
  * Original repository: https://github.com/named-data/ndn-cpp
  *
  * Summary of Changes: Use ndn-ind includes. Add readRawPackets. Put element-listener.hpp in API. Support WinSock2.
+ * Add cork. Add waitForReceive.
  *
  * which was originally released under the LGPL license with the following rights:
  *
@@ -40,6 +41,7 @@
 #include "../c/transport/udp-transport.h"
 #include "../c/encoding/element-reader.h"
 #include "../util/dynamic-uint8-vector.hpp"
+#include "transport-send-queue.hpp"
 #include <ndn-ind/transport/udp-transport.hpp>
 
 using namespace std;
@@ -56,6 +58,14 @@ UdpTransport::UdpTransport(bool readRawPackets)
 {
   ndn_UdpTransport_initialize
     (transport_.get(), elementBuffer_.get(), readRawPackets ? 1 : 0);
+
+  sendQueue_.reset(new TransportSendQueue
+    ([this](const struct ndn_Blob* buffers, size_t nBuffers) {
+      ndn_Error error;
+      if ((error = ndn_UdpTransport_sendBuffers
+           (transport_.get(), buffers, nBuffers)))
+        throw runtime_error(ndn_getErrorString(error));
+    }));
 }
 
 bool
@@ -89,11 +99,18 @@ UdpTransport::connect
 void
 UdpTransport::send(const uint8_t *data, size_t dataLength)
 {
-  ndn_Error error;
-  if ((error = ndn_UdpTransport_send(transport_.get(), data, dataLength)))
-    throw runtime_error(ndn_getErrorString(error));
+  sendQueue_->send(data, dataLength);
 }
 
+void
+UdpTransport::cork() { sendQueue_->cork(); }
+
+void
+UdpTransport::uncork() { sendQueue_->uncork(); }
+
+void
+UdpTransport::flush() { sendQueue_->flush(); }
+
 void
 UdpTransport::processEvents()
 {
@@ -104,6 +121,22 @@ UdpTransport::processEvents()
     throw runtime_error(ndn_getErrorString(error));
 }
 
+void
+UdpTransport::waitForReceive(chrono::nanoseconds maxWait)
+{
+  if (!isConnected_) {
+    // There is no socket to poll.
+    Transport::waitForReceive(maxWait);
+    return;
+  }
+
+  int receiveIsReady;
+  ndn_Error error;
+  if ((error = ndn_UdpTransport_waitForReceive
+       (transport_.get(), getPollTimeoutMilliseconds(maxWait), &receiveIsReady)))
+    throw runtime_error(ndn_getErrorString(error));
+}
+
 bool
 UdpTransport::getIsConnected()
 {
@@ -113,6 +146,13 @@ UdpTransport::getIsConnected()
 void
 UdpTransport::close()
 {
+  try {
+    // Send any packets queued by cork() before closing.
+    sendQueue_->flush();
+  } catch (...) {
+    // Ignore errors since we are closing anyway.
+  }
+
   ndn_Error error;
   if ((error = ndn_UdpTransport_close(transport_.get())))
     throw runtime_error(ndn_getErrorString(error));
@@ -8,7 +8,7 @@
  * Original file: src/transport/unix-transport.cpp
  * Original repository: https://github.com/named-data/ndn-cpp
  *
- * Summary of Changes: Use ndn-ind includes. Add readRawPackets. Put element-listener.hpp in API.
+ * Summary of Changes: Use ndn-ind includes. Add readRawPackets. Put element-listener.hpp in API. Add cork. Add waitForReceive.
  *
  * which was originally released under the LGPL license with the following rights:
  *
@@ -40,6 +40,7 @@
 #include "../c/transport/unix-transport.h"
 #include "../c/encoding/element-reader.h"
 #include "../util/dynamic-uint8-vector.hpp"
+#include "transport-send-queue.hpp"
 #include <ndn-ind/transport/unix-transport.hpp>
 
 using namespace std;
@@ -56,6 +57,14 @@ UnixTransport::UnixTransport(bool readRawPackets)
 {
   ndn_UnixTransport_initialize
     (transport_.get(), elementBuffer_.get(), readRawPackets);
+
+  sendQueue_.reset(new TransportSendQueue
+    ([this](const struct ndn_Blob* buffers, size_t nBuffers) {
+      ndn_Error error;
+      if ((error = ndn_UnixTransport_sendBuffers
+           (transport_.get(), buffers, nBuffers)))
+        throw runtime_error(ndn_getErrorString(error));
+    }));
 }
 
 bool
@@ -89,11 +98,18 @@ UnixTransport::connect
 void
 UnixTransport::send(const uint8_t *data, size_t dataLength)
 {
-  ndn_Error error;
-  if ((error = ndn_UnixTransport_send(transport_.get(), data, dataLength)))
-    throw runtime_error(ndn_getErrorString(error));
+  sendQueue_->send(data, dataLength);
 }
 
+void
+UnixTransport::cork() { sendQueue_->cork(); }
+
+void
+UnixTransport::uncork() { sendQueue_->uncork(); }
+
+void
+UnixTransport::flush() { sendQueue_->flush(); }
+
 void
 UnixTransport::processEvents()
 {
@@ -104,6 +120,22 @@ UnixTransport::processEvents()
     throw runtime_error(ndn_getErrorString(error));
 }
 
+void
+UnixTransport::waitForReceive(chrono::nanoseconds maxWait)
+{
+  if (!isConnected_) {
+    // There is no socket to poll.
+    Transport::waitForReceive(maxWait);
+    return;
+  }
+
+  int receiveIsReady;
+  ndn_Error error;
+  if ((error = ndn_UnixTransport_waitForReceive
+       (transport_.get(), getPollTimeoutMilliseconds(maxWait), &receiveIsReady)))
+    throw runtime_error(ndn_getErrorString(error));
+}
+
 bool
 UnixTransport::getIsConnected()
 {
@@ -113,6 +145,13 @@ UnixTransport::getIsConnected()
 void
 UnixTransport::close()
 {
+  try {
+    // Send any packets queued by cork() before closing.
+    sendQueue_->flush();
+  } catch (...) {
+    // Ignore errors since we are closing anyway.
+  }
+
   ndn_Error error;
   if ((error = ndn_UnixTransport_close(transport_.get())))
     throw runtime_error(ndn_getErrorString(error));
@@ -26,13 +26,14 @@ using namespace std;
 namespace ndn_ind {
 
 DynamicUInt8Vector::DynamicUInt8Vector(size_t initialLength)
-: vector_(new vector<uint8_t>())
+: vector_(ptr_lib::make_shared<vector<uint8_t> >()), array_(vector_.get())
 {
   // Note: Don't know why, but it is much faster to set the initial length with
   // resize() than in the constructor.
   vector_->resize(initialLength);
 
-  ndn_DynamicUInt8Array_initialize(this, &vector_->front(), initialLength, DynamicUInt8Vector::realloc);
+  // Use data() since the initial length may be zero.
+  ndn_DynamicUInt8Array_initialize(this, vector_->data(), initialLength, DynamicUInt8Vector::realloc);
 }
 
 uint8_t*
@@ -41,12 +42,22 @@ DynamicUInt8Vector::realloc(struct ndn_DynamicUInt8Array *self, uint8_t *array,
   // Because this method is private, assume there is not a problem with downcasting.
   DynamicUInt8Vector *thisObject = (DynamicUInt8Vector *)self;
 
-  if (array != &thisObject->vector_->front())
+  if (array != thisObject->array_->data())
     // We don't expect this to ever happen. The caller didn't pass the array from this object.
     return 0;
 
-  thisObject->vector_->resize(length);
-  return &thisObject->vector_->front();
+  thisObject->array_->resize(length);
+  return thisObject->array_->data();
+}
+
+DynamicUInt8Vector::DynamicUInt8Vector(vector<uint8_t>& output)
+: array_(&output)
+{
+  // Start with zero length so that the first ensureLength resizes to the exact
+  // length, which doesn't reallocate if it is within the capacity.
+  output.clear();
+  ndn_DynamicUInt8Array_initialize
+    (this, output.data(), 0, DynamicUInt8Vector::realloc);
 }
 
 }
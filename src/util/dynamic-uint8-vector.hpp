@@ -8,7 +8,7 @@
  * Original file: src/util/dynamic-uint8-vector.hpp
  * Original repository: https://github.com/named-data/ndn-cpp
  *
- * Summary of Changes: Use ndn-ind includes.
+ * Summary of Changes: Use ndn-ind includes. Add output to a caller's vector.
  *
  * which was originally released under the LGPL license with the following rights:
  *
@@ -54,6 +54,18 @@ public:
    */
   DynamicUInt8Vector(size_t initialLength);
 
+  /**
+   * Create a new DynamicUInt8Vector which writes into the caller's vector
+   * instead of allocating a new one. This clears output but keeps its
+   * capacity, and ensureLength resizes it as needed, so that a reused vector
+   * only reallocates if the encoding is larger than its capacity. In this case,
+   * get() returns a null pointer and finish() can't be used. Instead, the
+   * caller resizes output to the final length.
+   * @param output The vector to write into, which must remain valid while this
+   * is used.
+   */
+  DynamicUInt8Vector(std::vector<uint8_t>& output);
+
   /**
    * Ensure that the vector size is greater than or equal to length.  If it is,
    * just return. Otherwise, resize the vector (copying as needed).
@@ -154,10 +166,10 @@ public:
   }
 
   uint8_t&
-  operator [] (size_t i) { return (*vector_)[i]; }
+  operator [] (size_t i) { return (*array_)[i]; }
 
   const uint8_t&
-  operator [] (size_t i) const { return (*vector_)[i]; }
+  operator [] (size_t i) const { return (*array_)[i]; }
 
 private:
   /**
@@ -171,6 +183,8 @@ private:
   realloc(struct ndn_DynamicUInt8Array *self, uint8_t *array, size_t length);
 
   ptr_lib::shared_ptr<std::vector<uint8_t> > vector_;
+  // The vector which is written, either vector_ or the caller's vector.
+  std::vector<uint8_t>* array_;
 };
 
 }
@@ -8,7 +8,7 @@
  * Original file: src/util/exponential-re-express.cpp
  * Original repository: https://github.com/named-data/ndn-cpp
  *
- * Summary of Changes: Use NDN_IND macros. Use std::chrono.
+ * Summary of Changes: Use NDN_IND macros. Use std::chrono. Use InterestEncodingTemplate.
  *
  * which was originally released under the LGPL license with the following rights:
  *
@@ -87,10 +87,22 @@ ExponentialReExpress::onTimeout
     return;
   }
 
-  Interest nextInterest(*interest);
-  nextInterest.setInterestLifetime(nextInterestLifetime);
+  if (interest->hasApplicationParameters()) {
+    // InterestEncodingTemplate doesn't support ApplicationParameters.
+    Interest nextInterest(*interest);
+    nextInterest.setInterestLifetime(nextInterestLifetime);
+    face_->expressInterest
+      (nextInterest, callerOnData_,
+       bind(&ExponentialReExpress::onTimeout, shared_from_this(), _1));
+    return;
+  }
+
+  if (!interestTemplate_)
+    // Encode once, so that each re-expressed interest only encodes the nonce
+    // and lifetime.
+    interestTemplate_.reset(new InterestEncodingTemplate(*interest));
   face_->expressInterest
-    (nextInterest, callerOnData_,
+    (*interestTemplate_->makeInterest(nextInterestLifetime), callerOnData_,
      bind(&ExponentialReExpress::onTimeout, shared_from_this(), _1));
 }
 
@@ -0,0 +1,208 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2020 Operant Networks, Incorporated.
+ * @author: Jeff Thompson <jefft0@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+
+#include <stdexcept>
+#include <cmath>
+#include <ndn-ind/encoding/tlv-0_3-wire-format.hpp>
+#include <ndn-ind/lite/util/crypto-lite.hpp>
+#include "../c/encoding/tlv/tlv-encoder.h"
+#include "../c/encoding/tlv/tlv-decoder.h"
+#include <ndn-ind/util/interest-encoding-template.hpp>
+
+using namespace std;
+using namespace std::chrono;
+
+namespace ndn_ind {
+
+/**
+ * Return the number of bytes to encode a TLV with the type and value length.
+ */
+static size_t
+sizeOfTlv(unsigned int type, size_t valueLength)
+{
+  return ndn_TlvEncoder_sizeOfVarNumber(type) +
+    ndn_TlvEncoder_sizeOfVarNumber(valueLength) + valueLength;
+}
+
+InterestEncodingTemplate::InterestEncodingTemplate
+  (const Interest& interest, WireFormat& wireFormat)
+: interest_(interest), wireFormat_(&wireFormat)
+{
+  if (!dynamic_cast<Tlv0_3WireFormat*>(&wireFormat))
+    throw runtime_error
+      ("InterestEncodingTemplate: The wire format must be an NDN-TLV wire format");
+  if (interest.hasApplicationParameters())
+    throw runtime_error
+      ("InterestEncodingTemplate: The Interest can't have ApplicationParameters");
+
+  // The encoder always writes a Nonce, even if the interest doesn't have one.
+  size_t signedPortionEndOffset;
+  encoding_ = wireFormat.encodeInterest
+    (interest_, &nameComponentsBegin_, &signedPortionEndOffset);
+  finalComponentBegin_ = signedPortionEndOffset;
+
+  // Find the Name end, the Nonce and the optional InterestLifetime.
+  struct ndn_TlvDecoder decoder;
+  ndn_TlvDecoder_initialize(&decoder, encoding_.buf(), encoding_.size());
+  size_t endOffset, nameLength;
+  ndn_Error error;
+  if ((error = ndn_TlvDecoder_readNestedTlvsStart
+       (&decoder, ndn_Tlv_Interest, &endOffset)) ||
+      (error = ndn_TlvDecoder_readTypeAndLength
+       (&decoder, ndn_Tlv_Name, &nameLength)))
+    throw runtime_error(ndn_getErrorString(error));
+  nameComponentsEnd_ = decoder.offset + nameLength;
+  ndn_TlvDecoder_seek(&decoder, nameComponentsEnd_);
+
+  while (true) {
+    if (decoder.offset >= endOffset)
+      throw runtime_error
+        ("InterestEncodingTemplate: The Interest encoding has no Nonce");
+
+    size_t fieldBegin = decoder.offset;
+    uint64_t type, length;
+    if ((error = ndn_TlvDecoder_readVarNumber(&decoder, &type)) ||
+        (error = ndn_TlvDecoder_readVarNumber(&decoder, &length)))
+      throw runtime_error(ndn_getErrorString(error));
+    ndn_TlvDecoder_seek(&decoder, decoder.offset + (size_t)length);
+
+    if (type == ndn_Tlv_Nonce) {
+      nonceBegin_ = fieldBegin;
+      break;
+    }
+  }
+
+  int gotInterestLifetime;
+  if ((error = ndn_TlvDecoder_peekType
+       (&decoder, ndn_Tlv_InterestLifetime, endOffset, &gotInterestLifetime)))
+    throw runtime_error(ndn_getErrorString(error));
+  if (gotInterestLifetime) {
+    size_t interestLifetimeLength;
+    if ((error = ndn_TlvDecoder_readTypeAndLength
+         (&decoder, ndn_Tlv_InterestLifetime, &interestLifetimeLength)))
+      throw runtime_error(ndn_getErrorString(error));
+    ndn_TlvDecoder_seek(&decoder, decoder.offset + interestLifetimeLength);
+  }
+  afterInterestLifetimeBegin_ = decoder.offset;
+}
+
+ptr_lib::shared_ptr<Interest>
+InterestEncodingTemplate::makeInterest
+  (const Name::Component* suffix, nanoseconds interestLifetime)
+{
+  uint8_t nonce[4];
+  ndn_Error error;
+  if ((error = CryptoLite::generateRandomBytes(nonce, sizeof(nonce))))
+    throw runtime_error(ndn_getErrorString(error));
+
+  // Get the length of each part of the new encoding.
+  unsigned int suffixType = 0;
+  struct ndn_Blob suffixValue;
+  size_t suffixLength = 0;
+  if (suffix) {
+    // Get the type the same as in ndn_encodeTlvNameComponent.
+    if (suffix->getType() == ndn_NameComponentType_OTHER_CODE)
+      suffixType = (unsigned int)suffix->getOtherTypeCode();
+    else
+      suffixType = (unsigned int)suffix->getType();
+    ndn_Blob_initialize
+      (&suffixValue, suffix->getValue().buf(), suffix->getValue().size());
+    suffixLength = sizeOfTlv(suffixType, suffixValue.length);
+  }
+  size_t prefixComponentsLength = nameComponentsEnd_ - nameComponentsBegin_;
+  size_t nameValueLength = prefixComponentsLength + suffixLength;
+
+  const uint8_t* encoding = encoding_.buf();
+  size_t beforeNonceLength = nonceBegin_ - nameComponentsEnd_;
+  size_t afterInterestLifetimeLength =
+    encoding_.size() - afterInterestLifetimeBegin_;
+
+  bool hasInterestLifetime = (interestLifetime.count() >= 0);
+  uint64_t interestLifetimeMilliseconds = 0;
+  size_t interestLifetimeLength = 0;
+  if (hasInterestLifetime) {
+    // Round the same as ndn_TlvEncoder_writeOptionalNonNegativeIntegerTlvFromDouble.
+    interestLifetimeMilliseconds =
+      (uint64_t)round(toMilliseconds(interestLifetime));
+    interestLifetimeLength = sizeOfTlv
+      (ndn_Tlv_InterestLifetime,
+       ndn_TlvEncoder_sizeOfNonNegativeInteger(interestLifetimeMilliseconds));
+  }
+
+  size_t interestValueLength = sizeOfTlv(ndn_Tlv_Name, nameValueLength) +
+    beforeNonceLength + sizeOfTlv(ndn_Tlv_Nonce, sizeof(nonce)) +
+    interestLifetimeLength + afterInterestLifetimeLength;
+  ptr_lib::shared_ptr<vector<uint8_t> > output
+    (new vector<uint8_t>(sizeOfTlv(ndn_Tlv_Interest, interestValueLength)));
+
+  // Write into the output which already has the exact size.
+  struct ndn_DynamicUInt8Array outputArray;
+  ndn_DynamicUInt8Array_initialize(&outputArray, &output->front(), output->size(), 0);
+  struct ndn_TlvEncoder encoder;
+  ndn_TlvEncoder_initialize(&encoder, &outputArray);
+  struct ndn_Blob nonceBlob;
+  ndn_Blob_initialize(&nonceBlob, nonce, sizeof(nonce));
+
+  size_t signedPortionBeginOffset, signedPortionEndOffset;
+  if ((error = ndn_TlvEncoder_writeTypeAndLength
+       (&encoder, ndn_Tlv_Interest, interestValueLength)) ||
+      (error = ndn_TlvEncoder_writeTypeAndLength
+       (&encoder, ndn_Tlv_Name, nameValueLength)))
+    throw runtime_error(ndn_getErrorString(error));
+  signedPortionBeginOffset = encoder.offset;
+  if (suffix)
+    signedPortionEndOffset = encoder.offset + prefixComponentsLength;
+  else
+    signedPortionEndOffset =
+      encoder.offset + (finalComponentBegin_ - nameComponentsBegin_);
+
+  if ((error = ndn_TlvEncoder_writeArray
+       (&encoder, encoding + nameComponentsBegin_, prefixComponentsLength)) ||
+      (suffix && (error = ndn_TlvEncoder_writeBlobTlv
+       (&encoder, suffixType, &suffixValue))) ||
+      (error = ndn_TlvEncoder_writeArray
+       (&encoder, encoding + nameComponentsEnd_, beforeNonceLength)) ||
+      (error = ndn_TlvEncoder_writeBlobTlv(&encoder, ndn_Tlv_Nonce, &nonceBlob)) ||
+      (hasInterestLifetime && (error = ndn_TlvEncoder_writeNonNegativeIntegerTlv
+       (&encoder, ndn_Tlv_InterestLifetime, interestLifetimeMilliseconds))) ||
+      (error = ndn_TlvEncoder_writeArray
+       (&encoder, encoding + afterInterestLifetimeBegin_,
+        afterInterestLifetimeLength)))
+    throw runtime_error(ndn_getErrorString(error));
+
+  ptr_lib::shared_ptr<Interest> interest(new Interest(interest_));
+  if (suffix)
+    interest->getName().append(*suffix);
+  interest->setInterestLifetime(interestLifetime);
+  // Set the nonce after the other fields since changing a field clears it.
+  interest->setNonce(Blob(nonce, sizeof(nonce)));
+  if (wireFormat_ == WireFormat::getDefaultWireFormat())
+    // Set the default wire encoding last, after changing the fields.
+    interest->setDefaultWireEncoding
+      (SignedBlob(Blob(output, false), signedPortionBeginOffset,
+                  signedPortionEndOffset),
+       wireFormat_);
+
+  return interest;
+}
+
+}
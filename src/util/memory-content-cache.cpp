@@ -8,7 +8,7 @@
  * Original file: src/util/memory-content-cache.cpp
  * Original repository: https://github.com/named-data/ndn-cpp
  *
- * Summary of Changes: Use NDN_IND macros. Use std::chrono.
+ * Summary of Changes: Use NDN_IND macros. Use std::chrono. Index by name. Add setCapacity. Index pending interests. Add setContentStore.
  *
  * which was originally released under the LGPL license with the following rights:
  *
@@ -31,9 +31,10 @@
  * A copy of the GNU Lesser General Public License is in the file COPYING.
  */
 
-#include <algorithm>
+#include <list>
 #include "../c/util/time.h"
 #include <ndn-ind/util/logging.hpp>
+#include <ndn-ind/in-memory-storage/sharded-content-store.hpp>
 #include <ndn-ind/util/memory-content-cache.hpp>
 
 using namespace std;
@@ -48,7 +49,9 @@ MemoryContentCache::Impl::Impl
   (Face* face, nanoseconds cleanupInterval)
 : face_(face), cleanupInterval_(cleanupInterval),
   nextCleanupTime_(system_clock::now() + duration_cast<system_clock::duration>(cleanupInterval)),
-  isDoingCleanup_(false), minimumCacheLifetime_(0)
+  isDoingCleanup_(false), minimumCacheLifetime_(0), capacity_(0),
+  replacementPolicy_(LRU), size_(0), nHits_(0), nMisses_(0), nEvictions_(0),
+  nInserted_(0)
 {
 }
 
@@ -121,42 +124,66 @@ MemoryContentCache::Impl::add(const Data& data)
   auto now = system_clock::now();
   doCleanup(now);
 
-  if (data.getMetaInfo().getFreshnessPeriod().count() >= 0.0) {
-    // The content will go stale, so use staleTimeCache_.
-    ptr_lib::shared_ptr<const StaleTimeContent> content
-      (new StaleTimeContent(data, now, minimumCacheLifetime_));
-    // Insert into staleTimeCache_, sorted on content->cacheRemovalTime_.
-    staleTimeCache_.insert
-      (std::lower_bound(staleTimeCache_.begin(), staleTimeCache_.end(), content, contentCompare_),
-       content);
+  // Remove the content with the same name, if any, before making room.
+  ContentIndex::iterator found = contentIndex_.find(data.getName());
+  if (found != contentIndex_.end())
+    eraseContent(found);
+
+  // wireEncode returns the cached encoding if available.
+  size_t dataSize = data.wireEncode().size();
+  if (capacity_ == 0 || dataSize <= capacity_) {
+    ptr_lib::shared_ptr<ContentList> evictedList;
+    if (replacer_)
+      evict(dataSize, evictedList);
+
+    ContentEntry& entry = contentIndex_[data.getName()];
+    entry.insertNumber = ++nInserted_;
+    if (data.getMetaInfo().getFreshnessPeriod().count() >= 0.0) {
+      // The content will go stale, so also add to staleTimeHeap_.
+      ptr_lib::shared_ptr<const StaleTimeContent> content
+        (new StaleTimeContent(data, now, minimumCacheLifetime_));
+      staleTimeHeap_.push(RemovalEntry
+        (content->getCacheRemovalTime(), data.getName(), entry.insertNumber));
+      entry.content = content;
+      entry.staleTimeContent = content.get();
+    }
+    else {
+      // The data does not go stale.
+      entry.content = ptr_lib::make_shared<const Content>(data);
+      entry.staleTimeContent = 0;
+    }
+    size_ += dataSize;
+    if (replacer_)
+      replacer_->insert(data.getName(), dataSize);
+
+    callOnContentRemoved(evictedList);
   }
   else
-    // The data does not go stale, so use noStaleTimeCache_.
-    noStaleTimeCache_.push_back
-      (ptr_lib::make_shared<const Content>(data));
+    _LOG_DEBUG("MemoryContentCache: Not caching Data larger than the capacity " <<
+               data.getName());
 
   // Remove timed-out interests and check if the data packet matches any pending
-  // interest.
-  // Go backwards through the list so we can erase entries.
-  for (int i = (int)pendingInterestTable_.size() - 1; i >= 0; --i) {
-    if (pendingInterestTable_[i]->isTimedOut(now)) {
-      pendingInterestTable_.erase(pendingInterestTable_.begin() + i);
-      continue;
-    }
-
-    if (pendingInterestTable_[i]->getInterest()->matchesName(data.getName())) {
+  // interest whose name can match.
+  removeTimedOutPendingInterests(now);
+  if (pendingInterestIndex_.empty())
+    return;
+  vector<PendingInterestIndex::iterator> candidates;
+  getPendingInterestCandidates(data.getName(), candidates);
+  for (size_t i = 0; i < candidates.size(); ++i) {
+    const PendingInterest& pendingInterest = *candidates[i]->second;
+    if (pendingInterest.getInterest()->matchesName(data.getName())) {
       try {
         // Send to the same transport from the original call to onInterest.
         // wireEncode returns the cached encoding if available.
         _LOG_TRACE("MemoryContentCache:  Reply w/ add Data " << data.getName());
-        pendingInterestTable_[i]->getFace().send(*data.wireEncode());
+        pendingInterest.getFace().send(data.wireEncode());
       } catch (std::exception& e) {
         _LOG_DEBUG("Error in send: " << e.what());
         return;
       }
 
       // The pending interest is satisfied, so remove it.
-      pendingInterestTable_.erase(pendingInterestTable_.begin() + i);
+      pendingInterestIndex_.erase(candidates[i]);
     }
   }
 }
@@ -165,8 +192,11 @@ void
 MemoryContentCache::Impl::storePendingInterest
   (const ptr_lib::shared_ptr<const Interest>& interest, Face& face)
 {
-  pendingInterestTable_.push_back(ptr_lib::shared_ptr<PendingInterest>
-    (new PendingInterest(interest, face)));
+  ptr_lib::shared_ptr<const PendingInterest> pendingInterest
+    (new PendingInterest(interest, face));
+  pendingInterestIndex_.insert
+    (PendingInterestIndex::value_type(interest->getName(), pendingInterest));
+  pendingInterestHeap_.push(pendingInterest);
 }
 
 void
@@ -176,17 +206,12 @@ MemoryContentCache::Impl::getPendingInterestsForName
 {
   pendingInterests.clear();
 
-  // Remove timed-out interests as we add results.
-  // Go backwards through the list so we can erase entries.
-  auto now = system_clock::now();
-  for (int i = (int)pendingInterestTable_.size() - 1; i >= 0; --i) {
-    if (pendingInterestTable_[i]->isTimedOut(now)) {
-      pendingInterestTable_.erase(pendingInterestTable_.begin() + i);
-      continue;
-    }
-
-    if (pendingInterestTable_[i]->getInterest()->matchesName(name))
-      pendingInterests.push_back(pendingInterestTable_[i]);
+  removeTimedOutPendingInterests(system_clock::now());
+  vector<PendingInterestIndex::iterator> candidates;
+  getPendingInterestCandidates(name, candidates);
+  for (size_t i = 0; i < candidates.size(); ++i) {
+    if (candidates[i]->second->getInterest()->matchesName(name))
+      pendingInterests.push_back(candidates[i]->second);
   }
 }
 
@@ -197,17 +222,48 @@ MemoryContentCache::Impl::getPendingInterestsWithPrefix
 {
   pendingInterests.clear();
 
-  // Remove timed-out interests as we add results.
-  // Go backwards through the list so we can erase entries.
-  auto now = system_clock::now();
-  for (int i = (int)pendingInterestTable_.size() - 1; i >= 0; --i) {
-    if (pendingInterestTable_[i]->isTimedOut(now)) {
-      pendingInterestTable_.erase(pendingInterestTable_.begin() + i);
-      continue;
+  removeTimedOutPendingInterests(system_clock::now());
+  // The interest names with the prefix are in [begin, end).
+  PendingInterestIndex::iterator begin = pendingInterestIndex_.lower_bound(prefix);
+  PendingInterestIndex::iterator end = prefix.size() == 0 ?
+    pendingInterestIndex_.end() :
+    pendingInterestIndex_.lower_bound(prefix.getSuccessor());
+  for (PendingInterestIndex::iterator i = begin; i != end; ++i)
+    pendingInterests.push_back(i->second);
+}
+
+void
+MemoryContentCache::Impl::removeTimedOutPendingInterests
+  (system_clock::time_point now)
+{
+  while (!pendingInterestHeap_.empty() &&
+         pendingInterestHeap_.top()->isTimedOut(now)) {
+    ptr_lib::shared_ptr<const PendingInterest> pendingInterest =
+      pendingInterestHeap_.top();
+    pendingInterestHeap_.pop();
+
+    // Find the entry, unless add has already removed it.
+    pair<PendingInterestIndex::iterator, PendingInterestIndex::iterator> range =
+      pendingInterestIndex_.equal_range(pendingInterest->getInterest()->getName());
+    for (PendingInterestIndex::iterator i = range.first; i != range.second; ++i) {
+      if (i->second == pendingInterest) {
+        pendingInterestIndex_.erase(i);
+        break;
+      }
     }
+  }
+}
 
-    if (prefix.isPrefixOf(pendingInterestTable_[i]->getInterest()->getName()))
-      pendingInterests.push_back(pendingInterestTable_[i]);
+void
+MemoryContentCache::Impl::getPendingInterestCandidates
+  (const Name& name, vector<PendingInterestIndex::iterator>& candidates)
+{
+  // Check each prefix of the name, including the name itself.
+  for (size_t i = 0; i <= name.size(); ++i) {
+    pair<PendingInterestIndex::iterator, PendingInterestIndex::iterator> range =
+      pendingInterestIndex_.equal_range(name.getPrefix(i));
+    for (PendingInterestIndex::iterator j = range.first; j != range.second; ++j)
+      candidates.push_back(j);
   }
 }
 
@@ -223,69 +279,55 @@ MemoryContentCache::Impl::onInterest
   auto now = system_clock::now();
   doCleanup(now);
 
-  const Name::Component* selectedComponent = 0;
-  Blob selectedEncoding;
-  // We need to iterate over both arrays.
-  size_t totalSize = staleTimeCache_.size() + noStaleTimeCache_.size();
-  for (size_t i = 0; i < totalSize; ++i) {
-    const Content* content;
-    bool isFresh = true;
-    if (i < staleTimeCache_.size()) {
-      const StaleTimeContent *staleTimeContent = staleTimeCache_[i].get();
-      content = staleTimeContent;
-      isFresh = staleTimeContent->isFresh(now);
-    }
-    else
-      // We have iterated over the first array. Get from the second.
-      content = noStaleTimeCache_[i - staleTimeCache_.size()].get();
-
-    if (interest->matchesName(content->getName()) &&
-        !(interest->getMustBeFresh() && !isFresh)) {
-      if (interest->getChildSelector() < 0) {
-        // No child selector, so send the first match that we have found.
-        _LOG_TRACE("MemoryContentCache:         Reply Data " << content->getName());
-        face.send(*content->getDataEncoding());
-        return;
+  // The names with the interest name as a prefix are in [begin, end).
+  const Name& interestName = interest->getName();
+  ContentIndex::iterator begin = contentIndex_.lower_bound(interestName);
+  ContentIndex::iterator end = interestName.size() == 0 ?
+    contentIndex_.end() : contentIndex_.lower_bound(interestName.getSuccessor());
+
+  ContentIndex::iterator selected = contentIndex_.end();
+  if (interest->getChildSelector() == 1) {
+    // Search from the end so that the first match has the rightmost child.
+    for (ContentIndex::iterator i = end; i != begin; ) {
+      --i;
+      if (matches(*interest, i->second, now)) {
+        selected = i;
+        break;
       }
-      else {
-        // Update selectedEncoding based on the child selector.
-        const Name::Component* component;
-        if (content->getName().size() > interest->getName().size())
-          component = &content->getName().get(interest->getName().size());
-        else
-          component = &emptyComponent_;
-
-        bool gotBetterMatch = false;
-        if (!selectedEncoding)
-          // Save the first match.
-          gotBetterMatch = true;
-        else {
-          if (interest->getChildSelector() == 0) {
-            // Leftmost child.
-            if (*component < *selectedComponent)
-              gotBetterMatch = true;
-          }
-          else {
-            // Rightmost child.
-            if (*component > *selectedComponent)
-              gotBetterMatch = true;
-          }
-        }
-
-        if (gotBetterMatch) {
-          selectedComponent = component;
-          selectedEncoding = content->getDataEncoding();
-        }
+    }
+  }
+  else {
+    // Search from the start so that the first match has the leftmost child.
+    // With no child selector, send the first match.
+    for (ContentIndex::iterator i = begin; i != end; ++i) {
+      if (matches(*interest, i->second, now)) {
+        selected = i;
+        break;
       }
     }
   }
 
-  if (selectedEncoding) {
-    // We found the leftmost or rightmost child.
+  ptr_lib::shared_ptr<const Data> storedData;
+  if (selected == contentIndex_.end() && contentStore_)
+    storedData = contentStore_->find(*interest);
+
+  if (selected != contentIndex_.end()) {
+    ++nHits_;
+    if (replacer_)
+      replacer_->access(selected->first);
     _LOG_TRACE("MemoryContentCache: Reply Data to Interest " << interest->toUri());
-    face.send(*selectedEncoding);
+    // Copy the Blob in case the send callback modifies the cache.
+    Blob selectedEncoding = selected->second.content->getDataEncoding();
+    face.send(selectedEncoding);
+  }
+  else if (storedData) {
+    ++nHits_;
+    _LOG_TRACE("MemoryContentCache: Reply stored Data to Interest " << interest->toUri());
+    // ShardedContentStore::insert already cached the wire encoding.
+    face.send(storedData->wireEncode());
   }
   else {
+    ++nMisses_;
     _LOG_TRACE("MemoryContentCache: onDataNotFound for " << interest->toUri());
     // Call the onDataNotFound callback (if defined).
     map<string, OnInterestCallback>::iterator onDataNotFound =
@@ -315,37 +357,375 @@ MemoryContentCache::Impl::doCleanup(system_clock::time_point now)
 
   ptr_lib::shared_ptr<ContentList> contentList;
   if (now >= nextCleanupTime_) {
-    // staleTimeCache_ is sorted on cacheRemovalTime_, so we only need to
-    // erase the stale entries at the front, then quit.
-    while (staleTimeCache_.size() > 0 &&
-           staleTimeCache_.front()->isPastRemovalTime(now)) {
+    // staleTimeHeap_ has the earliest removal time at the top, so we only
+    // need to pop the stale entries, then quit.
+    while (!staleTimeHeap_.empty() &&
+           staleTimeHeap_.top().removalTime_ <= now) {
+      ContentIndex::iterator found = contentIndex_.find
+        (staleTimeHeap_.top().name_);
+      bool isCurrent = (found != contentIndex_.end() &&
+        found->second.insertNumber == staleTimeHeap_.top().insertNumber_);
+      staleTimeHeap_.pop();
+      if (!isCurrent)
+        // add has replaced or evicted the content.
+        continue;
+      ptr_lib::shared_ptr<const Content> content = found->second.content;
+      eraseContent(found);
+
       if (onContentRemoved_) {
         // Add to the list of removed content for the OnContentRemoved callback.
         // We make a separate list instead of calling the callback each time
-        // because the callback might call add again to modify the staleTimeCache_.
+        // because the callback might call add again to modify the contentIndex_.
         if (!contentList)
           contentList.reset(new ContentList());
 
-        contentList->push_back(staleTimeCache_.front());
+        contentList->push_back(content);
       }
-
-      staleTimeCache_.erase(staleTimeCache_.begin());
     }
 
     nextCleanupTime_ = now + duration_cast<system_clock::duration>(cleanupInterval_);
   }
 
+  callOnContentRemoved(contentList);
+
+  isDoingCleanup_ = false;
+}
+
+MemoryContentCache::Impl::Replacer::~Replacer()
+{
+}
+
+/**
+ * LruReplacer keeps the names in order of use and evicts the least recently
+ * used.
+ */
+class MemoryContentCache::Impl::LruReplacer
+  : public MemoryContentCache::Impl::Replacer {
+public:
+  virtual void
+  insert(const Name& name, size_t size)
+  {
+    order_.push_front(name);
+    positions_[name] = order_.begin();
+  }
+
+  virtual void
+  access(const Name& name)
+  {
+    map<Name, list<Name>::iterator>::iterator found = positions_.find(name);
+    if (found != positions_.end())
+      // Move to the front without copying the name.
+      order_.splice(order_.begin(), order_, found->second);
+  }
+
+  virtual void
+  erase(const Name& name)
+  {
+    map<Name, list<Name>::iterator>::iterator found = positions_.find(name);
+    if (found != positions_.end()) {
+      order_.erase(found->second);
+      positions_.erase(found);
+    }
+  }
+
+  virtual Name
+  evict()
+  {
+    Name name = order_.back();
+    order_.pop_back();
+    positions_.erase(name);
+    return name;
+  }
+
+private:
+  // The most recently used is at the front.
+  list<Name> order_;
+  map<Name, list<Name>::iterator> positions_;
+};
+
+/**
+ * ClockReplacer keeps the names in a ring with a referenced bit, which a cache
+ * hit sets. To evict, the clock hand clears each set bit until it finds a name
+ * whose bit is clear.
+ */
+class MemoryContentCache::Impl::ClockReplacer
+  : public MemoryContentCache::Impl::Replacer {
+public:
+  ClockReplacer()
+  : hand_(ring_.end())
+  {
+  }
+
+  virtual void
+  insert(const Name& name, size_t size)
+  {
+    // Insert behind the hand so that the hand reaches it last.
+    positions_[name] = ring_.insert(hand_, Slot(name));
+  }
+
+  virtual void
+  access(const Name& name)
+  {
+    map<Name, list<Slot>::iterator>::iterator found = positions_.find(name);
+    if (found != positions_.end())
+      found->second->isReferenced_ = true;
+  }
+
+  virtual void
+  erase(const Name& name)
+  {
+    map<Name, list<Slot>::iterator>::iterator found = positions_.find(name);
+    if (found != positions_.end()) {
+      if (hand_ == found->second)
+        ++hand_;
+      ring_.erase(found->second);
+      positions_.erase(found);
+    }
+  }
+
+  virtual Name
+  evict()
+  {
+    while (true) {
+      if (hand_ == ring_.end())
+        hand_ = ring_.begin();
+
+      if (hand_->isReferenced_) {
+        hand_->isReferenced_ = false;
+        ++hand_;
+      }
+      else {
+        Name name = hand_->name_;
+        positions_.erase(name);
+        hand_ = ring_.erase(hand_);
+        return name;
+      }
+    }
+  }
+
+private:
+  class Slot {
+  public:
+    Slot(const Name& name)
+    : name_(name), isReferenced_(false)
+    {
+    }
+
+    Name name_;
+    bool isReferenced_;
+  };
+
+  list<Slot> ring_;
+  map<Name, list<Slot>::iterator> positions_;
+  // The next slot to check in evict(). ring_.end() wraps to ring_.begin().
+  list<Slot>::iterator hand_;
+};
+
+/**
+ * ArcReplacer implements the Adaptive Replacement Cache where the sizes of
+ * the lists and the target size of T1 are in bytes. T1 has the names used
+ * once and T2 has the names used more than once. The ghost lists B1 and B2
+ * have the names recently evicted from T1 and T2. A new name which is in B1
+ * increases the target size of T1, and a new name in B2 decreases it.
+ */
+class MemoryContentCache::Impl::ArcReplacer
+  : public MemoryContentCache::Impl::Replacer {
+public:
+  ArcReplacer(size_t capacity)
+  : capacity_(capacity), target_(0)
+  {
+    for (int i = 0; i < N_LISTS; ++i)
+      listSize_[i] = 0;
+  }
+
+  virtual void
+  insert(const Name& name, size_t size)
+  {
+    map<Name, Position>::iterator found = positions_.find(name);
+    if (found != positions_.end()) {
+      // The name is in a ghost list, so adapt the target and use T2.
+      size_t delta;
+      if (found->second.list_ == B1) {
+        delta = size * max((size_t)1, listSize_[B2] / max((size_t)1, listSize_[B1]));
+        target_ = min(capacity_, target_ + delta);
+      }
+      else {
+        delta = size * max((size_t)1, listSize_[B1] / max((size_t)1, listSize_[B2]));
+        target_ = target_ > delta ? target_ - delta : 0;
+      }
+
+      found->second.size_ = size;
+      moveToFront(found, T2);
+      return;
+    }
+
+    lists_[T1].push_front(name);
+    Position& position = positions_[name];
+    position.list_ = T1;
+    position.iterator_ = lists_[T1].begin();
+    position.size_ = size;
+    listSize_[T1] += size;
+
+    // Limit the size of the ghost lists.
+    while (listSize_[T1] + listSize_[B1] > capacity_ && !lists_[B1].empty())
+      eraseBack(B1);
+    while (listSize_[T1] + listSize_[T2] + listSize_[B1] + listSize_[B2] >
+           2 * capacity_ && !lists_[B2].empty())
+      eraseBack(B2);
+  }
+
+  virtual void
+  access(const Name& name)
+  {
+    map<Name, Position>::iterator found = positions_.find(name);
+    if (found != positions_.end() &&
+        (found->second.list_ == T1 || found->second.list_ == T2))
+      moveToFront(found, T2);
+  }
+
+  virtual void
+  erase(const Name& name)
+  {
+    map<Name, Position>::iterator found = positions_.find(name);
+    if (found != positions_.end()) {
+      listSize_[found->second.list_] -= found->second.size_;
+      lists_[found->second.list_].erase(found->second.iterator_);
+      positions_.erase(found);
+    }
+  }
+
+  virtual Name
+  evict()
+  {
+    // Evict from T1 if it is larger than the target, otherwise from T2, and
+    // remember the name in the matching ghost list.
+    int list = !lists_[T1].empty() &&
+      (listSize_[T1] > target_ || lists_[T2].empty()) ? T1 : T2;
+    Name name = lists_[list].back();
+    moveToFront(positions_.find(name), list == T1 ? B1 : B2);
+    return name;
+  }
+
+private:
+  enum { T1 = 0, T2 = 1, B1 = 2, B2 = 3, N_LISTS = 4 };
+
+  class Position {
+  public:
+    int list_;
+    list<Name>::iterator iterator_;
+    size_t size_;
+  };
+
+  /**
+   * Move the name to the front of the list.
+   * @param position The iterator of the name in positions_.
+   * @param list The destination list.
+   */
+  void
+  moveToFront(map<Name, Position>::iterator position, int list)
+  {
+    Position& from = position->second;
+    listSize_[from.list_] -= from.size_;
+    lists_[list].splice(lists_[list].begin(), lists_[from.list_], from.iterator_);
+    from.list_ = list;
+    listSize_[list] += from.size_;
+  }
+
+  /**
+   * Remove the name at the back of the list.
+   * @param list The list.
+   */
+  void
+  eraseBack(int list)
+  {
+    map<Name, Position>::iterator found = positions_.find(lists_[list].back());
+    listSize_[list] -= found->second.size_;
+    lists_[list].pop_back();
+    positions_.erase(found);
+  }
+
+  size_t capacity_;
+  // The target size of T1.
+  size_t target_;
+  // The most recently used is at the front of each list.
+  list<Name> lists_[N_LISTS];
+  size_t listSize_[N_LISTS];
+  map<Name, Position> positions_;
+};
+
+void
+MemoryContentCache::Impl::setCapacity
+  (size_t capacity, ReplacementPolicy replacementPolicy)
+{
+  capacity_ = capacity;
+  replacementPolicy_ = replacementPolicy;
+  if (capacity_ == 0) {
+    replacer_.reset();
+    return;
+  }
+
+  if (replacementPolicy_ == CLOCK)
+    replacer_.reset(new ClockReplacer());
+  else if (replacementPolicy_ == ARC)
+    replacer_.reset(new ArcReplacer(capacity_));
+  else
+    replacer_.reset(new LruReplacer());
+
+  // Add the existing content. The order of use is unknown, so use name order.
+  for (ContentIndex::iterator entry = contentIndex_.begin();
+       entry != contentIndex_.end(); ++entry)
+    replacer_->insert
+      (entry->first, entry->second.content->getDataEncoding().size());
+
+  ptr_lib::shared_ptr<ContentList> evictedList;
+  evict(0, evictedList);
+  callOnContentRemoved(evictedList);
+}
+
+void
+MemoryContentCache::Impl::eraseContent(ContentIndex::iterator entry)
+{
+  size_ -= entry->second.content->getDataEncoding().size();
+  if (replacer_)
+    replacer_->erase(entry->first);
+  contentIndex_.erase(entry);
+}
+
+void
+MemoryContentCache::Impl::evict
+  (size_t neededSize, ptr_lib::shared_ptr<ContentList>& contentList)
+{
+  while (size_ + neededSize > capacity_ && !contentIndex_.empty()) {
+    ContentIndex::iterator entry = contentIndex_.find(replacer_->evict());
+    if (entry == contentIndex_.end())
+      // We don't expect this.
+      continue;
+
+    if (onContentRemoved_) {
+      if (!contentList)
+        contentList.reset(new ContentList());
+      contentList->push_back(entry->second.content);
+    }
+
+    size_ -= entry->second.content->getDataEncoding().size();
+    contentIndex_.erase(entry);
+    ++nEvictions_;
+  }
+}
+
+void
+MemoryContentCache::Impl::callOnContentRemoved
+  (const ptr_lib::shared_ptr<ContentList>& contentList)
+{
   if (onContentRemoved_ && contentList) {
     try {
       onContentRemoved_(contentList);
     } catch (const std::exception& ex) {
-      _LOG_ERROR("MemoryContentCache::doCleanup(): Error in onContentRemoved: " << ex.what());
+      _LOG_ERROR("MemoryContentCache: Error in onContentRemoved: " << ex.what());
     } catch (...) {
-      _LOG_ERROR("MemoryContentCache::doCleanup(): Error in onContentRemoved.");
+      _LOG_ERROR("MemoryContentCache: Error in onContentRemoved.");
     }
   }
-
-  isDoingCleanup_ = false;
 }
 
 MemoryContentCache::Impl::StaleTimeContent::StaleTimeContent
@@ -8,7 +8,7 @@
  * Original file: src/util/segment-fetcher.cpp
  * Original repository: https://github.com/named-data/ndn-cpp
  *
- * Summary of Changes: Use NDN_IND macros. Use std::chrono.
+ * Summary of Changes: Use NDN_IND macros. Use std::chrono. Use InterestEncodingTemplate. Add a pipelined fetch. Add streaming with OnSegment.
  *
  * which was originally released under the LGPL license with the following rights:
  *
@@ -33,11 +33,21 @@
  */
 
 #include <stdexcept>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <cerrno>
+#include <cstring>
+#include <ndn-ind/ndn-ind-config.h>
+#if NDN_IND_HAVE_UNISTD_H
+#include <unistd.h>
+#endif
 #include "../c/util/ndn_memory.h"
 #include <ndn-ind/util/logging.hpp>
 #include <ndn-ind/util/segment-fetcher.hpp>
 
 using namespace std;
+using namespace std::chrono;
 using namespace ndn_ind::func_lib;
 
 INIT_LOGGER("ndn.SegmentFetcher");
@@ -62,6 +72,89 @@ SegmentFetcher::fetch
   segmentFetcher->fetchFirstSegment(baseInterest);
 }
 
+ptr_lib::shared_ptr<SegmentFetcher>
+SegmentFetcher::fetch
+  (Face& face, const Interest &baseInterest, const VerifySegment& verifySegment,
+   const OnComplete& onComplete, const OnError& onError,
+   const Options& options)
+{
+  if (baseInterest.hasApplicationParameters())
+    // InterestEncodingTemplate can't append to the name with the parameters
+    // digest.
+    throw runtime_error
+      ("SegmentFetcher: A pipelined fetch does not support ApplicationParameters");
+
+  ptr_lib::shared_ptr<SegmentFetcher> segmentFetcher
+    (new SegmentFetcher(face, verifySegment, onComplete, onError, options));
+  segmentFetcher->baseInterest_ = baseInterest;
+  segmentFetcher->fetchFirstPipelinedSegment();
+  return segmentFetcher;
+}
+
+SegmentFetcher::SegmentFetcher
+  (Face& face, const VerifySegment& verifySegment,
+   const OnComplete& onComplete, const OnError& onError,
+   const Options& options)
+: face_(face), verifySegment_(verifySegment), onComplete_(onComplete),
+  onError_(onError), options_(options), isStopped_(false), isPaused_(false),
+  hasFinalSegment_(false), finalSegment_(0), nextSegmentToRequest_(0),
+  nextSegmentToDeliver_(0), recoveryPoint_(0),
+  window_(max(1.0, min(options.getInitialWindow(), options.getMaxWindow()))),
+  ssthresh_(numeric_limits<double>::max()), cubicMaxWindow_(0),
+  lastSegmentTime_(steady_clock::now()), hasRttMeasurement_(false),
+  smoothedRtt_(0), rttVariation_(0), rto_(options.getInitialRto())
+{
+}
+
+void
+SegmentFetcher::resume()
+{
+  if (!isPaused_ || isStopped_)
+    return;
+
+  isPaused_ = false;
+  // Don't count the time paused toward the maximum timeout.
+  lastSegmentTime_ = steady_clock::now();
+  deliverSegments();
+  fillWindow();
+}
+
+/**
+ * Write all the content to the file descriptor. This is bound by
+ * makeFileDescriptorSink.
+ */
+static void
+writeToFileDescriptor
+  (int fileDescriptor, uint64_t segmentNumber, const Blob& content)
+{
+#if NDN_IND_HAVE_UNISTD_H
+  const uint8_t* buffer = content.buf();
+  size_t nRemaining = content.size();
+  while (nRemaining > 0) {
+    ssize_t nWritten = ::write(fileDescriptor, buffer, nRemaining);
+    if (nWritten < 0) {
+      if (errno == EINTR)
+        continue;
+      throw runtime_error
+        (string("SegmentFetcher: Error writing to the file descriptor: ") +
+         strerror(errno));
+    }
+
+    buffer += nWritten;
+    nRemaining -= (size_t)nWritten;
+  }
+#else
+  throw runtime_error
+    ("SegmentFetcher: Writing to a file descriptor is not supported on this platform");
+#endif
+}
+
+SegmentFetcher::OnSegment
+SegmentFetcher::makeFileDescriptorSink(int fileDescriptor)
+{
+  return bind(&writeToFileDescriptor, fileDescriptor, _1, _2);
+}
+
 void
 SegmentFetcher::fetchFirstSegment(const Interest& baseInterest)
 {
@@ -79,15 +172,38 @@ void
 SegmentFetcher::fetchNextSegment
   (const Interest& originalInterest, const Name& dataName, uint64_t segment)
 {
-  // Start with the original Interest to preserve any special selectors.
-  Interest interest(originalInterest);
-  // Changing a field clears the nonce so that the library will generate a new one.
-  interest.setChildSelector(0);
-  interest.setMustBeFresh(false);
-  interest.setName(dataName.getPrefix(-1).appendSegment(segment));
+  if (originalInterest.hasApplicationParameters()) {
+    // InterestEncodingTemplate can't append to the name with the parameters
+    // digest, so encode each Interest.
+    // Start with the original Interest to preserve any special selectors.
+    Interest interest(originalInterest);
+    // Changing a field clears the nonce so that the library will generate a new one.
+    interest.setChildSelector(0);
+    interest.setMustBeFresh(false);
+    interest.setName(dataName.getPrefix(-1).appendSegment(segment));
+
+    face_.expressInterest
+      (interest,
+       bind(&SegmentFetcher::onSegmentReceived, shared_from_this(), _1, _2),
+       bind(&SegmentFetcher::onTimeout, shared_from_this(), _1));
+    return;
+  }
+
+  if (!nextSegmentTemplate_ ||
+      nextSegmentTemplate_->getInterest().getName().size() != dataName.size() - 1 ||
+      !nextSegmentTemplate_->getInterest().getName().isPrefixOf(dataName)) {
+    // Start with the original Interest to preserve any special selectors.
+    Interest interest(originalInterest);
+    interest.setChildSelector(0);
+    interest.setMustBeFresh(false);
+    interest.setName(dataName.getPrefix(-1));
+    // Encode once, so that each segment Interest only encodes the segment
+    // number, nonce and lifetime.
+    nextSegmentTemplate_.reset(new InterestEncodingTemplate(interest));
+  }
 
   face_.expressInterest
-    (interest,
+    (*nextSegmentTemplate_->makeInterest(Name::Component::fromSegment(segment)),
      bind(&SegmentFetcher::onSegmentReceived, shared_from_this(), _1, _2),
      bind(&SegmentFetcher::onTimeout, shared_from_this(), _1));
 }
@@ -173,27 +289,7 @@ SegmentFetcher::onVerified
 
         if (currentSegment == finalSegmentNumber) {
           // We are finished.
-
-          // Get the total size and concatenate to get the content.
-          int totalSize = 0;
-          for (size_t i = 0; i < contentParts_.size(); ++i)
-            totalSize += contentParts_[i].size();
-          ptr_lib::shared_ptr<vector<uint8_t> > content
-            (new std::vector<uint8_t>(totalSize));
-          size_t offset = 0;
-          for (size_t i = 0; i < contentParts_.size(); ++i) {
-            const Blob& part = contentParts_[i];
-            ndn_memcpy(&(*content)[offset], part.buf(), part.size());
-            offset += part.size();
-          }
-
-          try {
-            onComplete_(Blob(content, false));
-          } catch (const std::exception& ex) {
-            _LOG_ERROR("SegmentFetcher::onSegmentReceived: Error in onComplete: " << ex.what());
-          } catch (...) {
-            _LOG_ERROR("SegmentFetcher::onSegmentReceived: Error in onComplete.");
-          }
+          callOnComplete();
           return;
         }
       }
@@ -235,4 +331,407 @@ SegmentFetcher::onTimeout(const ptr_lib::shared_ptr<const Interest>& interest)
   }
 }
 
+void
+SegmentFetcher::fetchFirstPipelinedSegment()
+{
+  // Changing a field clears the nonce so that the library will generate a new
+  // one for each retry.
+  Interest interest(baseInterest_);
+  interest.setChildSelector(1);
+  interest.setMustBeFresh(true);
+
+  face_.expressInterest
+    (interest,
+     bind(&SegmentFetcher::onPipelinedData, shared_from_this(), _1, _2),
+     bind(&SegmentFetcher::onPipelinedTimeout, shared_from_this(), _1),
+     bind(&SegmentFetcher::onPipelinedNetworkNack, shared_from_this(), _1, _2));
+}
+
+void
+SegmentFetcher::sendSegmentInterest(uint64_t segment, bool isRetransmission)
+{
+  PendingSegment& pendingSegment = pending_[segment];
+  pendingSegment.sendTime = steady_clock::now();
+  pendingSegment.isRetransmission = isRetransmission;
+  pendingSegment.pendingInterestId = 0;
+
+  // Use the RTO as the lifetime so that the Face times out the Interest.
+  uint64_t pendingInterestId = face_.expressInterest
+    (*nextSegmentTemplate_->makeInterest
+     (Name::Component::fromSegment(segment), rto_),
+     bind(&SegmentFetcher::onPipelinedData, shared_from_this(), _1, _2),
+     bind(&SegmentFetcher::onPipelinedTimeout, shared_from_this(), _1),
+     bind(&SegmentFetcher::onPipelinedNetworkNack, shared_from_this(), _1, _2));
+
+  // A Face may call the callback before expressInterest returns.
+  map<uint64_t, PendingSegment>::iterator found = pending_.find(segment);
+  if (found != pending_.end())
+    found->second.pendingInterestId = pendingInterestId;
+}
+
+void
+SegmentFetcher::fillWindow()
+{
+  if (!nextSegmentTemplate_)
+    // We are still waiting for the first segment.
+    return;
+
+  // Skip the segments which were delivered before they were requested.
+  nextSegmentToRequest_ = max(nextSegmentToRequest_, nextSegmentToDeliver_);
+  size_t windowSize = max((size_t)1, (size_t)window_);
+  while (!isStopped_ && !isPaused_ && pending_.size() < windowSize) {
+    uint64_t segment;
+    bool isRetransmission;
+    if (!retransmitQueue_.empty()) {
+      segment = retransmitQueue_.front();
+      retransmitQueue_.pop_front();
+      isRetransmission = true;
+    }
+    else if ((!hasFinalSegment_ || nextSegmentToRequest_ <= finalSegment_) &&
+             // Limit the segments which are not delivered, as a receive window.
+             nextSegmentToRequest_ - nextSegmentToDeliver_ <
+               (uint64_t)max(1.0, options_.getMaxWindow())) {
+      segment = nextSegmentToRequest_;
+      ++nextSegmentToRequest_;
+      isRetransmission = false;
+    }
+    else
+      break;
+
+    if (segment < nextSegmentToDeliver_ ||
+        (hasFinalSegment_ && segment > finalSegment_) ||
+        receivedSegments_.count(segment) > 0 || pending_.count(segment) > 0)
+      // Already received or requested, or past the end.
+      continue;
+
+    sendSegmentInterest(segment, isRetransmission);
+  }
+}
+
+void
+SegmentFetcher::onPipelinedData
+  (const ptr_lib::shared_ptr<const Interest>& interest,
+   const ptr_lib::shared_ptr<Data>& data)
+{
+  if (isStopped_)
+    return;
+
+  if (!verifySegment_(data)) {
+    stop();
+    onValidationFailed(data, "verifySegment returned false");
+    return;
+  }
+
+  if (!endsWithSegmentNumber(data->getName())) {
+    callOnError
+      (DATA_HAS_NO_SEGMENT,
+       string("Got an unexpected packet without a segment number: ") +
+       data->getName().toUri());
+    return;
+  }
+  uint64_t segment;
+  try {
+    segment = data->getName().get(-1).toSegment();
+  }
+  catch (runtime_error& ex) {
+    callOnError
+      (DATA_HAS_NO_SEGMENT,
+       string("Error decoding the name segment number ") +
+       data->getName().get(-1).toEscapedString() + ": " + ex.what());
+    return;
+  }
+
+  if (!nextSegmentTemplate_) {
+    // This is the answer to the first Interest, which has the version.
+    Interest templateInterest(*interest);
+    templateInterest.setChildSelector(0);
+    templateInterest.setMustBeFresh(false);
+    templateInterest.setName(data->getName().getPrefix(-1));
+    nextSegmentTemplate_.reset(new InterestEncodingTemplate(templateInterest));
+  }
+  else if (!nextSegmentTemplate_->getInterest().getName().isPrefixOf
+           (data->getName()))
+    // Not from the version of the first segment.
+    return;
+
+  steady_clock::time_point now = steady_clock::now();
+  lastSegmentTime_ = now;
+  map<uint64_t, PendingSegment>::iterator found = pending_.find(segment);
+  if (found != pending_.end()) {
+    // Karn's algorithm: Don't measure the RTT of a retransmission.
+    if (!found->second.isRetransmission)
+      addRttMeasurement(now - found->second.sendTime);
+    pending_.erase(found);
+  }
+
+  if (data->getMetaInfo().getFinalBlockId().getValue().size() > 0) {
+    try {
+      finalSegment_ = data->getMetaInfo().getFinalBlockId().toSegment();
+    }
+    catch (runtime_error& ex) {
+      callOnError
+        (DATA_HAS_NO_SEGMENT,
+         string("Error decoding the FinalBlockId segment number ") +
+         data->getMetaInfo().getFinalBlockId().toEscapedString() + ": " +
+         ex.what());
+      return;
+    }
+    hasFinalSegment_ = true;
+
+    // Cancel the Interests past the end.
+    for (map<uint64_t, PendingSegment>::iterator i =
+           pending_.upper_bound(finalSegment_);
+         i != pending_.end(); ) {
+      face_.removePendingInterest(i->second.pendingInterestId);
+      pending_.erase(i++);
+    }
+  }
+
+  if (segment >= nextSegmentToDeliver_ &&
+      !(hasFinalSegment_ && segment > finalSegment_))
+    receivedSegments_[segment] = data->getContent();
+
+  if (data->getCongestionMark() > 0 && !options_.getIgnoreCongestionMarks())
+    decreaseWindow(segment);
+  else
+    increaseWindow();
+
+  deliverSegments();
+  fillWindow();
+}
+
+void
+SegmentFetcher::deliverSegments()
+{
+  while (!isStopped_ && !isPaused_) {
+    map<uint64_t, Blob>::iterator next = receivedSegments_.begin();
+    if (next == receivedSegments_.end() || next->first != nextSegmentToDeliver_)
+      break;
+
+    Blob content = next->second;
+    receivedSegments_.erase(next);
+    ++nextSegmentToDeliver_;
+    if (options_.getOnSegment()) {
+      try {
+        options_.getOnSegment()(nextSegmentToDeliver_ - 1, content);
+      } catch (const std::exception& ex) {
+        callOnError(IO_ERROR, string("Error in onSegment: ") + ex.what());
+        return;
+      } catch (...) {
+        callOnError(IO_ERROR, "Error in onSegment");
+        return;
+      }
+    }
+    else
+      contentParts_.push_back(content);
+  }
+
+  if (!isStopped_ && hasFinalSegment_ && nextSegmentToDeliver_ > finalSegment_) {
+    // We are finished.
+    stop();
+    callOnComplete();
+  }
+}
+
+void
+SegmentFetcher::onPipelinedTimeout
+  (const ptr_lib::shared_ptr<const Interest>& interest)
+{
+  if (isStopped_)
+    return;
+
+  retransmit(interest, true, true);
+}
+
+void
+SegmentFetcher::onPipelinedNetworkNack
+  (const ptr_lib::shared_ptr<const Interest>& interest,
+   const ptr_lib::shared_ptr<NetworkNack>& networkNack)
+{
+  if (isStopped_)
+    return;
+
+  if (networkNack->getReason() == ndn_NetworkNackReason_CONGESTION)
+    retransmit(interest, true, false);
+  else if (networkNack->getReason() == ndn_NetworkNackReason_DUPLICATE)
+    // Retry with a new nonce.
+    retransmit(interest, false, false);
+  else
+    callOnError
+      (NACK_ERROR, string("Received a network Nack with reason ") +
+       to_string(networkNack->getReason() == ndn_NetworkNackReason_OTHER_CODE ?
+                 networkNack->getOtherReasonCode() : networkNack->getReason()) +
+       " for interest " + interest->getName().toUri());
+}
+
+void
+SegmentFetcher::retransmit
+  (const ptr_lib::shared_ptr<const Interest>& interest, bool isCongestion,
+   bool backOff)
+{
+  if (!isPaused_ &&
+      steady_clock::now() - lastSegmentTime_ > options_.getMaxTimeout()) {
+    callOnError
+      (INTEREST_TIMEOUT,
+       string("Time out for interest ") + interest->getName().toUri());
+    return;
+  }
+
+  if (backOff)
+    rto_ = min(rto_ * 2, options_.getMaxRto());
+
+  if (!nextSegmentTemplate_) {
+    // Retry the first Interest.
+    fetchFirstPipelinedSegment();
+    return;
+  }
+
+  uint64_t segment;
+  try {
+    segment = interest->getName().get(-1).toSegment();
+  } catch (runtime_error& ex) {
+    // We don't expect this since we made the Interest name.
+    return;
+  }
+  pending_.erase(segment);
+  if (hasFinalSegment_ && segment > finalSegment_)
+    return;
+
+  if (isCongestion)
+    decreaseWindow(segment);
+  retransmitQueue_.push_back(segment);
+  fillWindow();
+}
+
+void
+SegmentFetcher::addRttMeasurement(nanoseconds rtt)
+{
+  if (!hasRttMeasurement_) {
+    hasRttMeasurement_ = true;
+    smoothedRtt_ = rtt;
+    rttVariation_ = rtt / 2;
+  }
+  else {
+    nanoseconds difference = smoothedRtt_ - rtt;
+    if (difference.count() < 0)
+      difference = -difference;
+    rttVariation_ = (rttVariation_ * 3 + difference) / 4;
+    smoothedRtt_ = (smoothedRtt_ * 7 + rtt) / 8;
+  }
+
+  rto_ = smoothedRtt_ + rttVariation_ * 4;
+  rto_ = max(options_.getMinRto(), min(rto_, options_.getMaxRto()));
+}
+
+void
+SegmentFetcher::increaseWindow()
+{
+  if (options_.getCongestionControl() == CONSTANT_WINDOW)
+    return;
+
+  if (window_ < ssthresh_)
+    // Slow start.
+    window_ += options_.getAdditiveIncrease();
+  else if (options_.getCongestionControl() == CUBIC) {
+    // W(t) = C * (t - K)^3 + Wmax, where K = cbrt(Wmax * (1 - beta) / C).
+    const double C = 0.4;
+    double t = duration_cast<duration<double> >
+      (steady_clock::now() - lastDecreaseTime_).count();
+    double K = cbrt(cubicMaxWindow_ * (1 - options_.getCubicBeta()) / C);
+    double target = C * pow(t - K, 3) + cubicMaxWindow_;
+    if (target > window_)
+      window_ += (target - window_) / window_;
+    else
+      // Grow slowly near Wmax.
+      window_ += 0.01 / window_;
+  }
+  else
+    window_ += options_.getAdditiveIncrease() / window_;
+
+  window_ = min(window_, options_.getMaxWindow());
+}
+
+void
+SegmentFetcher::decreaseWindow(uint64_t segment)
+{
+  if (options_.getCongestionControl() == CONSTANT_WINDOW ||
+      segment < recoveryPoint_)
+    return;
+
+  // Ignore more congestion signals for the Interests sent before now.
+  recoveryPoint_ = nextSegmentToRequest_;
+  if (options_.getCongestionControl() == CUBIC) {
+    cubicMaxWindow_ = window_;
+    lastDecreaseTime_ = steady_clock::now();
+    window_ *= options_.getCubicBeta();
+  }
+  else
+    window_ *= options_.getMultiplicativeDecrease();
+
+  window_ = max(window_, 1.0);
+  ssthresh_ = max(window_, 2.0);
+}
+
+void
+SegmentFetcher::stop()
+{
+  isStopped_ = true;
+  for (map<uint64_t, PendingSegment>::iterator i = pending_.begin();
+       i != pending_.end(); ++i)
+    face_.removePendingInterest(i->second.pendingInterestId);
+  pending_.clear();
+  retransmitQueue_.clear();
+  receivedSegments_.clear();
+}
+
+void
+SegmentFetcher::callOnComplete()
+{
+  if (options_.getOnSegment()) {
+    // The content was streamed.
+    try {
+      onComplete_(Blob());
+    } catch (const std::exception& ex) {
+      _LOG_ERROR("SegmentFetcher: Error in onComplete: " << ex.what());
+    } catch (...) {
+      _LOG_ERROR("SegmentFetcher: Error in onComplete.");
+    }
+    return;
+  }
+
+  // Get the total size and concatenate to get the content.
+  size_t totalSize = 0;
+  for (size_t i = 0; i < contentParts_.size(); ++i)
+    totalSize += contentParts_[i].size();
+  ptr_lib::shared_ptr<vector<uint8_t> > content
+    (new std::vector<uint8_t>(totalSize));
+  size_t offset = 0;
+  for (size_t i = 0; i < contentParts_.size(); ++i) {
+    const Blob& part = contentParts_[i];
+    ndn_memcpy(&(*content)[offset], part.buf(), part.size());
+    offset += part.size();
+  }
+
+  try {
+    onComplete_(Blob(content, false));
+  } catch (const std::exception& ex) {
+    _LOG_ERROR("SegmentFetcher::onSegmentReceived: Error in onComplete: " << ex.what());
+  } catch (...) {
+    _LOG_ERROR("SegmentFetcher::onSegmentReceived: Error in onComplete.");
+  }
+}
+
+void
+SegmentFetcher::callOnError(ErrorCode errorCode, const string& message)
+{
+  stop();
+  try {
+    onError_(errorCode, message);
+  } catch (const std::exception& ex) {
+    _LOG_ERROR("SegmentFetcher: Error in onError: " << ex.what());
+  } catch (...) {
+    _LOG_ERROR("SegmentFetcher: Error in onError.");
+  }
+}
+
 }
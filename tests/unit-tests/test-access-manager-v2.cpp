@@ -112,6 +112,35 @@ TEST_F(TestAccessManagerV2, PublishedKdks)
   }
 }
 
+TEST_F(TestAccessManagerV2, PublishedAfterFreshnessPeriod)
+{
+  // The KEK and KDKs are only inserted once, so they must still be served with
+  // MustBeFresh after their FreshnessPeriod.
+  fixture_.manager_->setNowOffset_
+    (DEFAULT_KDK_FRESHNESS_PERIOD + std::chrono::minutes(1));
+
+  ptr_lib::shared_ptr<Interest> kekInterest = ptr_lib::make_shared<Interest>
+    (Name("/access/policy/identity/NAC/dataset/KEK"));
+  kekInterest->setCanBePrefix(true).setMustBeFresh(true);
+  fixture_.face_.receive(kekInterest);
+  ASSERT_EQ(1, fixture_.face_.sentData_.size());
+  ASSERT_TRUE(fixture_.face_.sentData_[0]->getName().getPrefix(-1).equals
+    (Name("/access/policy/identity/NAC/dataset/KEK")));
+  fixture_.face_.sentData_.clear();
+
+  Name kdkName("/access/policy/identity/NAC/dataset/KDK");
+  kdkName
+    .append(fixture_.nacIdentity_->getDefaultKey()->getName().get(-1))
+    .append("ENCRYPTED-BY")
+    .append(fixture_.userIdentities_[0]->getDefaultKey()->getName());
+  ptr_lib::shared_ptr<Interest> kdkInterest = ptr_lib::make_shared<Interest>
+    (kdkName);
+  kdkInterest->setCanBePrefix(true).setMustBeFresh(true);
+  fixture_.face_.receive(kdkInterest);
+  ASSERT_EQ(1, fixture_.face_.sentData_.size());
+  ASSERT_TRUE(fixture_.face_.sentData_[0]->getName().equals(kdkName));
+}
+
 TEST_F(TestAccessManagerV2, EnumerateDataFromInMemoryStorage)
 {
   ASSERT_EQ(3, fixture_.manager_->size());
@@ -177,7 +177,7 @@ dumpData(const Data& data)
   if (data.getContent().size() > 0) {
     string raw;
     for (size_t i = 0; i < data.getContent().size(); ++i)
-      raw += (*data.getContent())[i];
+      raw += data.getContent().buf()[i];
     result.push_back(dump("content (raw):", raw));
     result.push_back(dump("content (hex):", data.getContent().toHex()));
   }
@@ -296,6 +296,134 @@ TEST_F(TestDataMethods, EncodeDecode)
   ASSERT_EQ(dumpData(reDecodedData), initialDump) << "Re-decoded data does not match original dump";
 }
 
+TEST_F(TestDataMethods, EncodeToVector)
+{
+  Data data;
+  data.wireDecode(codedData, sizeof(codedData));
+  WireFormat* wireFormat = TlvWireFormat::get();
+  Blob encoding = wireFormat->encodeData(data);
+
+  // Encoding into a vector gives the same result as encoding to a Blob.
+  vector<uint8_t> output;
+  size_t signedPortionBeginOffset, signedPortionEndOffset;
+  wireFormat->encodeData
+    (data, output, &signedPortionBeginOffset, &signedPortionEndOffset);
+  ASSERT_TRUE(encoding.equals(Blob(output)));
+
+  // Reusing the vector for a smaller and then a larger encoding resizes it.
+  Data smallData(Name("/A"));
+  wireFormat->encodeData
+    (smallData, output, &signedPortionBeginOffset, &signedPortionEndOffset);
+  ASSERT_TRUE(wireFormat->encodeData(smallData).equals(Blob(output)));
+
+  vector<uint8_t> largeContent(5000, 0x55);
+  data.setContent(largeContent);
+  wireFormat->encodeData
+    (data, output, &signedPortionBeginOffset, &signedPortionEndOffset);
+  ASSERT_TRUE(data.wireEncode().equals(Blob(output)));
+  Data reDecodedData;
+  reDecodedData.wireDecode(Blob(output));
+  ASSERT_TRUE(reDecodedData.getContent().equals(Blob(largeContent)));
+}
+
+TEST_F(TestDataMethods, SharedWireEncoding)
+{
+  Blob encoding(codedData, sizeof(codedData));
+  Data data;
+  data.wireDecode(encoding);
+
+  // By default, decoding from a Blob copies the content to a whole vector.
+  ASSERT_FALSE(data.getContent().isSlice());
+  ASSERT_EQ(data.getContent().size(), data.getContent()->size());
+  ASSERT_TRUE(data.getContent().buf() < encoding.buf() ||
+              data.getContent().buf() >= encoding.buf() + encoding.size());
+
+  // wireDecodeShared shares the buffer for the content. (Short name
+  // components are copied into the Name::Component.)
+  data.wireDecodeShared(encoding);
+  const Blob& content = data.getContent();
+  ASSERT_TRUE(content.isSlice());
+  ASSERT_TRUE(content.buf() >= encoding.buf() &&
+              content.buf() + content.size() <= encoding.buf() + encoding.size());
+  ASSERT_EQ(dumpData(data), initialDump) << "Decoded data does not match original dump";
+
+  // A slice has the same value semantics as a copy.
+  Blob contentCopy(content.buf(), content.size());
+  ASSERT_FALSE(contentCopy.isSlice());
+  ASSERT_TRUE(content.equals(contentCopy));
+  ASSERT_TRUE(contentCopy.equals(content));
+  ASSERT_EQ(contentCopy.hash(), content.hash());
+  ASSERT_EQ(contentCopy.toHex(), content.toHex());
+  ASSERT_FALSE(content.equals(Blob(encoding, 0, content.size())));
+
+  // A slice of a slice is relative to the first slice.
+  Blob slice(encoding, 2, 4);
+  ASSERT_EQ(4, slice.size());
+  ASSERT_EQ(encoding.buf() + 2, slice.buf());
+  Blob sliceOfSlice(slice, 1, 3);
+  ASSERT_EQ(encoding.buf() + 3, sliceOfSlice.buf());
+  ASSERT_THROW(Blob(slice, 2, 3), runtime_error);
+
+  // The shared_ptr operators are not slice-aware.
+  ASSERT_EQ(encoding.size(), slice->size());
+  ASSERT_NE(slice.size(), slice->size());
+  ASSERT_EQ(encoding.buf(), (*slice).data());
+
+  // reset() also clears the slice.
+  slice.reset();
+  ASSERT_TRUE(slice.isNull());
+  ASSERT_FALSE(slice.isSlice());
+  ASSERT_EQ(0, slice.size());
+  sliceOfSlice.reset(new vector<uint8_t>(10, 7));
+  ASSERT_FALSE(sliceOfSlice.isSlice());
+  ASSERT_EQ(10, sliceOfSlice.size());
+  ASSERT_EQ(sliceOfSlice->data(), sliceOfSlice.buf());
+}
+
+TEST_F(TestDataMethods, LazyDecode)
+{
+  Blob encoding(codedData, sizeof(codedData));
+  Data data;
+  data.wireDecodeLazy(encoding);
+  ASSERT_EQ("/ndn/abc", data.getName().toUri());
+  ASSERT_TRUE(data.wireEncode().equals(encoding)) <<
+    "The lazy decoded Data should keep the wire encoding";
+
+  // Decoding the MetaInfo and Signature on demand keeps the wire encoding.
+  ASSERT_EQ(dumpData(data), initialDump) << "Lazy decoded data does not match original dump";
+  ASSERT_EQ(encoding.buf(), data.getDefaultWireEncoding().buf());
+
+  // A copy decodes on demand the same way.
+  Data lazyData;
+  lazyData.wireDecodeLazy(encoding);
+  Data dataCopy(lazyData);
+  ASSERT_EQ(dumpData(dataCopy), initialDump) << "Copied lazy data does not match original dump";
+  Data dataAssigned;
+  dataAssigned = lazyData;
+  ASSERT_EQ(dumpData(dataAssigned), initialDump) << "Assigned lazy data does not match original dump";
+  ASSERT_EQ(dumpData(lazyData), initialDump);
+
+  // Setting a field replaces the pending value and changes the encoding.
+  Data changedData;
+  changedData.wireDecodeLazy(encoding);
+  MetaInfo metaInfo;
+  metaInfo.setFreshnessPeriod(seconds(1));
+  changedData.setMetaInfo(metaInfo);
+  ASSERT_EQ(1000, duration_cast<milliseconds>
+    (changedData.getMetaInfo().getFreshnessPeriod()).count());
+  ASSERT_TRUE(changedData.getDefaultWireEncoding().isNull());
+  Data reDecodedData;
+  reDecodedData.wireDecode(changedData.wireEncode());
+  ASSERT_EQ(1000, duration_cast<milliseconds>
+    (reDecodedData.getMetaInfo().getFreshnessPeriod()).count());
+  ASSERT_EQ("/testname/KEY/DSK-123/ID-CERT",
+    KeyLocator::getFromSignature(reDecodedData.getSignature()).getKeyName().toUri());
+
+  // A bad encoding still throws. (codedData has one extra byte at the end.)
+  Blob truncated(codedData, sizeof(codedData) - 2);
+  ASSERT_THROW(Data().wireDecodeLazy(truncated), runtime_error);
+}
+
 TEST_F(TestDataMethods, EmptySignature)
 {
   // make sure nothing is set in the signature of newly created data
@@ -0,0 +1,282 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2020 Operant Networks, Incorporated.
+ * @author: Jeff Thompson <jefft0@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+
+#include "gtest/gtest.h"
+#include "../../src/impl/delayed-call-table.hpp"
+
+using namespace std;
+using namespace std::chrono;
+using namespace ndn_ind;
+
+/**
+ * A WaitTransport lets the test deliver received packets directly to the
+ * element listener, and saves the maxWait given to waitForReceive.
+ */
+class WaitTransport : public Transport {
+public:
+  WaitTransport()
+  : elementListener_(0), lastMaxWait_(nanoseconds::zero())
+  {
+  }
+
+  virtual bool
+  isLocal(const Transport::ConnectionInfo& connectionInfo) { return true; }
+
+  virtual bool
+  isAsync() { return false; }
+
+  virtual void
+  connect
+    (const Transport::ConnectionInfo& connectionInfo,
+     ElementListener& elementListener, const OnConnected& onConnected)
+  {
+    elementListener_ = &elementListener;
+    if (onConnected)
+      onConnected();
+  }
+
+  virtual void
+  send(const uint8_t *data, size_t dataLength) {}
+
+  virtual void
+  processEvents() {}
+
+  virtual void
+  waitForReceive(nanoseconds maxWait) { lastMaxWait_ = maxWait; }
+
+  virtual bool
+  getIsConnected() { return elementListener_ != 0; }
+
+  /**
+   * Deliver the buffer to the element listener as if it was received.
+   * @param encoding The wire encoding of the packet.
+   */
+  void
+  receive(const Blob& encoding)
+  {
+    elementListener_->onReceivedElement(encoding.buf(), encoding.size());
+  }
+
+  ElementListener* elementListener_;
+  nanoseconds lastMaxWait_;
+};
+
+class TestDelayedCallTable : public ::testing::Test {
+public:
+  /**
+   * Call table_.callAt_ with a callback which appends id to calls_.
+   */
+  ptr_lib::shared_ptr<DelayedCallTable::Entry>
+  callAt(steady_clock::time_point callTime, int id)
+  {
+    return table_.callAt_(callTime, [=]() { calls_.push_back(id); });
+  }
+
+  /**
+   * Call all the entries in table_, as if an hour has passed.
+   */
+  void
+  callAll()
+  {
+    table_.setNowOffset_(hours(1));
+    table_.callTimedOut();
+  }
+
+  DelayedCallTable table_;
+  vector<int> calls_;
+};
+
+TEST_F(TestDelayedCallTable, HeapOrder)
+{
+  // Add the call times out of order, enough for more than two heap levels.
+  auto start = steady_clock::now();
+  const int nEntries = 100;
+  for (int i = 0; i < nEntries; ++i) {
+    int id = (i * 37) % nEntries;
+    callAt(start + milliseconds(id), id);
+  }
+  ASSERT_EQ(nEntries, table_.size());
+
+  callAll();
+  ASSERT_EQ(0, table_.size());
+  ASSERT_EQ(nEntries, calls_.size());
+  for (int i = 0; i < nEntries; ++i)
+    ASSERT_EQ(i, calls_[i]);
+}
+
+TEST_F(TestDelayedCallTable, CallOnlyTimedOut)
+{
+  table_.callLater(hours(1), [&]() { calls_.push_back(2); });
+  table_.callLater(nanoseconds::zero(), [&]() { calls_.push_back(1); });
+
+  table_.callTimedOut();
+  ASSERT_EQ(vector<int>({ 1 }), calls_);
+  ASSERT_EQ(1, table_.size());
+}
+
+TEST_F(TestDelayedCallTable, EqualCallTimesFifo)
+{
+  // Entries with the same call time are called in the order they were added,
+  // even when interleaved with an earlier and a later call time.
+  auto callTime = steady_clock::now();
+  for (int i = 0; i < 20; ++i) {
+    callAt(callTime, i);
+    if (i % 5 == 0) {
+      callAt(callTime - milliseconds(1), -1);
+      callAt(callTime + milliseconds(1), 100);
+    }
+  }
+
+  callAll();
+  ASSERT_EQ(28, calls_.size());
+  for (int i = 0; i < 4; ++i)
+    ASSERT_EQ(-1, calls_[i]);
+  for (int i = 0; i < 20; ++i)
+    ASSERT_EQ(i, calls_[4 + i]);
+  for (int i = 24; i < 28; ++i)
+    ASSERT_EQ(100, calls_[i]);
+}
+
+TEST_F(TestDelayedCallTable, Cancel)
+{
+  auto start = steady_clock::now();
+  vector<ptr_lib::shared_ptr<DelayedCallTable::Entry> > entries;
+  for (int i = 0; i < 20; ++i)
+    entries.push_back(callAt(start + milliseconds(i), i));
+
+  // Cancel the root, a middle entry and the last entry in the heap.
+  ASSERT_TRUE(table_.cancel(entries[0]));
+  ASSERT_TRUE(table_.cancel(entries[7]));
+  ASSERT_TRUE(table_.cancel(entries[19]));
+  ASSERT_EQ(17, table_.size());
+  // Cancelling again does nothing.
+  ASSERT_FALSE(table_.cancel(entries[7]));
+  ASSERT_EQ(17, table_.size());
+
+  // An entry from another table is not removed.
+  DelayedCallTable otherTable;
+  ptr_lib::shared_ptr<DelayedCallTable::Entry> otherEntry =
+    otherTable.callLater(hours(1), []() {});
+  ASSERT_FALSE(table_.cancel(otherEntry));
+  ASSERT_EQ(17, table_.size());
+
+  // A callback can cancel a later entry.
+  table_.callAt_(start + milliseconds(10) + microseconds(1), [&]() {
+    calls_.push_back(-1);
+    table_.cancel(entries[15]);
+  });
+
+  callAll();
+  vector<int> expected;
+  for (int i = 1; i < 19; ++i) {
+    if (i == 7 || i == 15)
+      continue;
+    expected.push_back(i);
+    if (i == 10)
+      expected.push_back(-1);
+  }
+  ASSERT_EQ(expected, calls_);
+
+  // An entry which was already called is not removed.
+  ASSERT_FALSE(table_.cancel(entries[1]));
+}
+
+TEST_F(TestDelayedCallTable, CancelIfExists)
+{
+  auto start = steady_clock::now();
+  ptr_lib::weak_ptr<DelayedCallTable::Entry> entry1 = callAt(start, 1);
+  ptr_lib::weak_ptr<DelayedCallTable::Entry> entry2 = callAt(start, 2);
+  // The table keeps the entry alive until it is called or cancelled.
+  ASSERT_FALSE(entry1.expired());
+
+  table_.cancelIfExists(entry1);
+  ASSERT_EQ(1, table_.size());
+  ASSERT_TRUE(entry1.expired());
+  // Cancelling an expired entry does nothing.
+  table_.cancelIfExists(entry1);
+  ASSERT_EQ(1, table_.size());
+
+  callAll();
+  ASSERT_EQ(vector<int>({ 2 }), calls_);
+  ASSERT_TRUE(entry2.expired());
+  table_.cancelIfExists(entry2);
+  ASSERT_EQ(0, table_.size());
+}
+
+TEST_F(TestDelayedCallTable, GetTimeUntilNextCall)
+{
+  ASSERT_EQ(nanoseconds::max(), table_.getTimeUntilNextCall());
+
+  table_.callLater(seconds(10), []() {});
+  nanoseconds wait = table_.getTimeUntilNextCall();
+  ASSERT_TRUE(wait > seconds(9) && wait <= seconds(10));
+
+  ptr_lib::shared_ptr<DelayedCallTable::Entry> entry =
+    table_.callLater(seconds(1), []() {});
+  ASSERT_TRUE(table_.getTimeUntilNextCall() <= seconds(1));
+
+  table_.cancel(entry);
+  ASSERT_TRUE(table_.getTimeUntilNextCall() > seconds(9));
+
+  // The call time has passed.
+  table_.setNowOffset_(seconds(20));
+  ASSERT_EQ(nanoseconds::zero(), table_.getTimeUntilNextCall());
+  table_.callTimedOut();
+  ASSERT_EQ(nanoseconds::max(), table_.getTimeUntilNextCall());
+}
+
+TEST_F(TestDelayedCallTable, PitTimeoutCancelled)
+{
+  ptr_lib::shared_ptr<WaitTransport> transport(new WaitTransport());
+  Face face(transport, ptr_lib::make_shared<Transport::ConnectionInfo>());
+
+  Name name("/test/pit-timeout");
+  Interest interest(name);
+  interest.setCanBePrefix(false);
+  interest.setInterestLifetime(seconds(1));
+  int nData = 0;
+  int nTimeouts = 0;
+  face.expressInterest
+    (interest,
+     [&](const ptr_lib::shared_ptr<const Interest>&,
+         const ptr_lib::shared_ptr<Data>&) { ++nData; },
+     [&](const ptr_lib::shared_ptr<const Interest>&) { ++nTimeouts; });
+
+  // processEvents only waits until the Interest timeout.
+  face.processEvents(seconds(100));
+  ASSERT_TRUE(transport->lastMaxWait_ <= seconds(1));
+
+  transport->receive(Data(name).wireEncode());
+  ASSERT_EQ(1, nData);
+
+  // The satisfied Interest removed its timeout from the table.
+  face.processEvents(seconds(100));
+  ASSERT_TRUE(transport->lastMaxWait_ == seconds(100));
+  ASSERT_EQ(0, nTimeouts);
+}
+
+int
+main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,425 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (C) 2020 Operant Networks, Incorporated.
+ * @author: Jeff Thompson <jefft0@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+#include "gtest/gtest.h"
+#include <cstring>
+#include <climits>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <ndn-ind/face.hpp>
+#include <ndn-ind/transport/tcp-transport.hpp>
+
+using namespace std;
+using namespace std::chrono;
+using namespace ndn_ind;
+
+/**
+ * Create a listening socket bound to an available port on the loopback
+ * interface.
+ * @param port Set this to the bound port.
+ * @return The socket descriptor.
+ */
+static int
+listenLoopback(unsigned short& port)
+{
+  int socketDescriptor = socket(AF_INET, SOCK_STREAM, 0);
+  struct sockaddr_in address;
+  memset(&address, 0, sizeof(address));
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  if (socketDescriptor < 0 ||
+      ::bind(socketDescriptor, (struct sockaddr*)&address, sizeof(address)) != 0 ||
+      listen(socketDescriptor, 1) != 0)
+    throw runtime_error("Can't listen on the loopback socket");
+
+  socklen_t addressLength = sizeof(address);
+  getsockname(socketDescriptor, (struct sockaddr*)&address, &addressLength);
+  port = ntohs(address.sin_port);
+  return socketDescriptor;
+}
+
+static double
+getMillisecondsSince(steady_clock::time_point start)
+{
+  return duration_cast<microseconds>(steady_clock::now() - start).count() /
+    1000.0;
+}
+
+/**
+ * A SliceTransport gives each received element to the element listener as a
+ * slice of a large buffer, as a transport with a TransportReceiveBuffer does.
+ */
+class SliceTransport : public Transport {
+public:
+  SliceTransport()
+  : elementListener_(0)
+  {
+  }
+
+  virtual bool
+  isLocal(const Transport::ConnectionInfo& connectionInfo) { return true; }
+
+  virtual bool
+  isAsync() { return false; }
+
+  virtual void
+  connect
+    (const Transport::ConnectionInfo& connectionInfo,
+     ElementListener& elementListener, const OnConnected& onConnected)
+  {
+    elementListener_ = &elementListener;
+    if (onConnected)
+      onConnected();
+  }
+
+  virtual void
+  send(const uint8_t *data, size_t dataLength) {}
+
+  virtual void
+  processEvents() {}
+
+  virtual bool
+  getIsConnected() { return elementListener_ != 0; }
+
+  /**
+   * Copy the encoding into a new 256 KB buffer and give the element listener a
+   * slice of it.
+   * @param encoding The wire encoding of the packet.
+   * @return The new buffer.
+   */
+  Blob
+  receive(const Blob& encoding)
+  {
+    ptr_lib::shared_ptr<vector<uint8_t> > buffer
+      (new vector<uint8_t>(262144));
+    memcpy(&(*buffer)[100], encoding.buf(), encoding.size());
+    Blob bufferBlob(buffer, false);
+    elementListener_->onReceivedElement
+      (Blob(bufferBlob, 100, encoding.size()));
+    return bufferBlob;
+  }
+
+  ElementListener* elementListener_;
+};
+
+class TestFaceProcessEvents : public ::testing::Test {
+public:
+  TestFaceProcessEvents()
+  {
+    listenSocket_ = listenLoopback(port_);
+    face_.reset(new Face
+      (ptr_lib::make_shared<TcpTransport>(),
+       ptr_lib::make_shared<TcpTransport::ConnectionInfo>("127.0.0.1", port_)));
+  }
+
+  virtual
+  ~TestFaceProcessEvents()
+  {
+    face_->shutdown();
+    ::close(listenSocket_);
+  }
+
+  int listenSocket_;
+  unsigned short port_;
+  ptr_lib::shared_ptr<Face> face_;
+};
+
+TEST_F(TestFaceProcessEvents, WaitForCallLater)
+{
+  bool called = false;
+  face_->callLater(milliseconds(50), [&]() { called = true; });
+
+  auto start = steady_clock::now();
+  face_->processEvents(seconds(10));
+  double elapsed = getMillisecondsSince(start);
+
+  ASSERT_TRUE(called) << "processEvents should wait for the delayed call";
+  ASSERT_GE(elapsed, 45.0);
+  ASSERT_LT(elapsed, 2000.0) << "processEvents should not wait for maxWait";
+}
+
+TEST_F(TestFaceProcessEvents, WaitForMaxWait)
+{
+  bool called = false;
+  face_->callLater(seconds(10), [&]() { called = true; });
+
+  auto start = steady_clock::now();
+  face_->processEvents(milliseconds(50));
+  double elapsed = getMillisecondsSince(start);
+
+  ASSERT_FALSE(called);
+  ASSERT_GE(elapsed, 45.0);
+  ASSERT_LT(elapsed, 2000.0);
+
+  // A wait of zero doesn't block.
+  start = steady_clock::now();
+  face_->processEvents(nanoseconds::zero());
+  ASSERT_LT(getMillisecondsSince(start), 45.0);
+}
+
+TEST_F(TestFaceProcessEvents, WaitForever)
+{
+  bool called = false;
+  face_->callLater(milliseconds(50), [&]() { called = true; });
+
+  // The delayed call limits an unbounded maxWait.
+  auto start = steady_clock::now();
+  face_->processEvents(nanoseconds::max());
+  double elapsed = getMillisecondsSince(start);
+
+  ASSERT_TRUE(called);
+  ASSERT_GE(elapsed, 45.0);
+  ASSERT_LT(elapsed, 2000.0);
+}
+
+TEST_F(TestFaceProcessEvents, WaitForeverUnconnected)
+{
+  // The face connects on the first expressInterest or registerPrefix, so the
+  // TcpTransport has no socket to wait for. It still returns.
+  auto start = steady_clock::now();
+  face_->processEvents(nanoseconds::max());
+  ASSERT_LT(getMillisecondsSince(start), 2000.0);
+
+  TcpTransport transport;
+  ASSERT_FALSE(transport.getIsConnected());
+  start = steady_clock::now();
+  transport.waitForReceive(nanoseconds::max());
+  ASSERT_LT(getMillisecondsSince(start), 2000.0);
+}
+
+TEST_F(TestFaceProcessEvents, PollTimeoutMilliseconds)
+{
+  ASSERT_EQ(0, Transport::getPollTimeoutMilliseconds(nanoseconds::zero()));
+  ASSERT_EQ(0, Transport::getPollTimeoutMilliseconds(nanoseconds(-1)));
+  ASSERT_EQ(0, Transport::getPollTimeoutMilliseconds(nanoseconds::min()));
+  // A fraction of a millisecond is rounded up.
+  ASSERT_EQ(1, Transport::getPollTimeoutMilliseconds(nanoseconds(1)));
+  ASSERT_EQ(1, Transport::getPollTimeoutMilliseconds(milliseconds(1)));
+  ASSERT_EQ(2, Transport::getPollTimeoutMilliseconds
+            (milliseconds(1) + nanoseconds(1)));
+  // A large wait is clamped without overflow.
+  ASSERT_EQ(INT_MAX, Transport::getPollTimeoutMilliseconds
+            (milliseconds(INT_MAX)));
+  ASSERT_EQ(INT_MAX, Transport::getPollTimeoutMilliseconds
+            (milliseconds((int64_t)INT_MAX + 1)));
+  ASSERT_EQ(INT_MAX, Transport::getPollTimeoutMilliseconds(hours(24 * 365)));
+  ASSERT_EQ(INT_MAX, Transport::getPollTimeoutMilliseconds(nanoseconds::max()));
+}
+
+TEST_F(TestFaceProcessEvents, WaitForData)
+{
+  Name name("/test/process-events");
+  ptr_lib::shared_ptr<Data> receivedData;
+  bool timedOut = false;
+  Interest interest(name);
+  interest.setCanBePrefix(false);
+  interest.setInterestLifetime(seconds(10));
+  face_->expressInterest
+    (interest,
+     [&](const ptr_lib::shared_ptr<const Interest>&,
+         const ptr_lib::shared_ptr<Data>& data) { receivedData = data; },
+     [&](const ptr_lib::shared_ptr<const Interest>&) { timedOut = true; });
+  int peer = accept(listenSocket_, 0, 0);
+  ASSERT_GE(peer, 0);
+
+  // Read the Interest, then reply with the Data.
+  uint8_t buffer[1000];
+  ASSERT_GT(recv(peer, buffer, sizeof(buffer), 0), 0);
+  Data data(name);
+  data.setContent(Blob((const uint8_t*)"hello", 5));
+  Blob encoding = data.wireEncode();
+  ASSERT_EQ(encoding.size(), ::send(peer, encoding.buf(), encoding.size(), 0));
+
+  auto start = steady_clock::now();
+  face_->processEvents(seconds(5));
+  double elapsed = getMillisecondsSince(start);
+
+  ASSERT_TRUE(!!receivedData) << "processEvents should process the Data";
+  ASSERT_FALSE(timedOut);
+  ASSERT_EQ(name, receivedData->getName());
+  ASSERT_LT(elapsed, 2000.0) << "processEvents should not wait for maxWait";
+
+  ::close(peer);
+}
+
+TEST_F(TestFaceProcessEvents, LazyDataDecoding)
+{
+  face_->setLazyDataDecodingEnabled(true);
+
+  Name name("/test/lazy-data-decoding");
+  ptr_lib::shared_ptr<Data> receivedData;
+  Interest interest(name);
+  interest.setCanBePrefix(false);
+  interest.setInterestLifetime(seconds(10));
+  face_->expressInterest
+    (interest,
+     [&](const ptr_lib::shared_ptr<const Interest>&,
+         const ptr_lib::shared_ptr<Data>& data) { receivedData = data; },
+     [&](const ptr_lib::shared_ptr<const Interest>&) {});
+  int peer = accept(listenSocket_, 0, 0);
+  ASSERT_GE(peer, 0);
+
+  uint8_t buffer[1000];
+  ASSERT_GT(recv(peer, buffer, sizeof(buffer), 0), 0);
+  Data data(name);
+  data.getMetaInfo().setFreshnessPeriod(seconds(2));
+  data.setContent(Blob((const uint8_t*)"hello", 5));
+  Blob encoding = data.wireEncode();
+  ASSERT_EQ(encoding.size(), ::send(peer, encoding.buf(), encoding.size(), 0));
+
+  face_->processEvents(seconds(5));
+
+  // The lazily decoded fields are the same as the sent Data.
+  ASSERT_TRUE(!!receivedData);
+  const Data& constData = *receivedData;
+  ASSERT_TRUE(constData.getMetaInfo().getFreshnessPeriod() == seconds(2));
+  ASSERT_TRUE(!!constData.getSignature());
+  ASSERT_EQ(*data.getFullName(), *constData.getFullName());
+  ASSERT_TRUE(constData.wireEncode().equals(encoding));
+
+  ::close(peer);
+}
+
+TEST_F(TestFaceProcessEvents, SharedDecoding)
+{
+  Name name("/test/shared-decoding");
+  Data data(name);
+  data.setContent(Blob((const uint8_t*)"hello", 5));
+  Blob encoding = data.wireEncode();
+  Interest interest(name);
+  interest.setCanBePrefix(false);
+  interest.setInterestLifetime(seconds(10));
+
+  int peer = -1;
+  uint8_t buffer[1000];
+  for (int i = 0; i < 2; ++i) {
+    // Shared decoding is disabled by default, so first check for a copy.
+    bool sharedDecodingEnabled = (i == 1);
+    face_->setSharedDecodingEnabled(sharedDecodingEnabled);
+
+    ptr_lib::shared_ptr<Data> receivedData;
+    face_->expressInterest
+      (interest,
+       [&](const ptr_lib::shared_ptr<const Interest>&,
+           const ptr_lib::shared_ptr<Data>& data) { receivedData = data; },
+       [&](const ptr_lib::shared_ptr<const Interest>&) {});
+    if (peer < 0) {
+      peer = accept(listenSocket_, 0, 0);
+      ASSERT_GE(peer, 0);
+    }
+
+    ASSERT_GT(recv(peer, buffer, sizeof(buffer), 0), 0);
+    ASSERT_EQ(encoding.size(), ::send(peer, encoding.buf(), encoding.size(), 0));
+    face_->processEvents(seconds(5));
+
+    ASSERT_TRUE(!!receivedData);
+    ASSERT_TRUE(receivedData->getContent().equals(data.getContent()));
+    ASSERT_EQ(sharedDecodingEnabled, receivedData->getContent().isSlice());
+  }
+
+  ::close(peer);
+}
+
+TEST_F(TestFaceProcessEvents, ReceivedSliceIsCopied)
+{
+  Name name("/test/received-slice");
+  Data data(name);
+  data.setContent(Blob((const uint8_t*)"hello", 5));
+  Blob encoding = data.wireEncode();
+  Interest interest(name);
+  interest.setCanBePrefix(false);
+
+  ptr_lib::shared_ptr<SliceTransport> transport(new SliceTransport());
+  Face face
+    (transport, ptr_lib::make_shared<TcpTransport::ConnectionInfo>
+     ("127.0.0.1", port_));
+  for (int i = 0; i < 2; ++i) {
+    bool sharedDecodingEnabled = (i == 1);
+    face.setSharedDecodingEnabled(sharedDecodingEnabled);
+
+    ptr_lib::shared_ptr<Data> receivedData;
+    face.expressInterest
+      (interest,
+       [&](const ptr_lib::shared_ptr<const Interest>&,
+           const ptr_lib::shared_ptr<Data>& data) { receivedData = data; },
+       [&](const ptr_lib::shared_ptr<const Interest>&) {});
+    ptr_lib::weak_ptr<const vector<uint8_t> > buffer =
+      transport->receive(encoding);
+
+    ASSERT_TRUE(!!receivedData);
+    ASSERT_TRUE(receivedData->getDefaultWireEncoding().equals(encoding));
+    // Without shared decoding, the Data doesn't keep the large buffer.
+    ASSERT_EQ(sharedDecodingEnabled, !buffer.expired());
+    ASSERT_EQ(sharedDecodingEnabled,
+              receivedData->getDefaultWireEncoding().isSlice());
+  }
+
+  face.shutdown();
+}
+
+TEST_F(TestFaceProcessEvents, NestedProcessEventsFlushes)
+{
+  Name name("/test/process-events");
+  Interest interest(name);
+  interest.setCanBePrefix(false);
+  interest.setInterestLifetime(seconds(10));
+  Interest nestedInterest(Name("/test/nested"));
+  nestedInterest.setCanBePrefix(false);
+  nestedInterest.setInterestLifetime(seconds(10));
+  int peer = -1;
+  bool nestedInterestSent = false;
+
+  // The callback sends an Interest while the transport is corked, then waits
+  // for the reply in a nested processEvents.
+  face_->expressInterest
+    (interest,
+     [&](const ptr_lib::shared_ptr<const Interest>&,
+         const ptr_lib::shared_ptr<Data>& data) {
+       face_->expressInterest(nestedInterest, OnData());
+       face_->processEvents(milliseconds(10));
+       uint8_t nestedBuffer[1000];
+       nestedInterestSent =
+         (recv(peer, nestedBuffer, sizeof(nestedBuffer), MSG_DONTWAIT) > 0);
+     });
+  peer = accept(listenSocket_, 0, 0);
+  ASSERT_GE(peer, 0);
+
+  uint8_t buffer[1000];
+  ASSERT_GT(recv(peer, buffer, sizeof(buffer), 0), 0);
+  Data data(name);
+  Blob encoding = data.wireEncode();
+  ASSERT_EQ(encoding.size(), ::send(peer, encoding.buf(), encoding.size(), 0));
+
+  face_->processEvents(seconds(5));
+  ASSERT_TRUE(nestedInterestSent) <<
+    "A nested processEvents should send the Interest queued by the callback";
+
+  ::close(peer);
+}
+
+int
+main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
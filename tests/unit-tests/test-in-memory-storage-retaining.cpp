@@ -0,0 +1,177 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2020 Operant Networks, Incorporated.
+ * @author: Jeff Thompson <jefft0@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+#include "gtest/gtest.h"
+#include <thread>
+#include <ndn-ind/in-memory-storage/in-memory-storage-retaining.hpp>
+
+using namespace std;
+using namespace std::chrono;
+using namespace ndn_ind;
+
+/**
+ * Make an Interest with the name and CanBePrefix.
+ */
+static Interest
+makeInterest(const Name& name, bool canBePrefix)
+{
+  Interest interest(name);
+  interest.setCanBePrefix(canBePrefix);
+  return interest;
+}
+
+class TestInMemoryStorageRetaining : public ::testing::Test {
+};
+
+TEST_F(TestInMemoryStorageRetaining, FindByName)
+{
+  InMemoryStorageRetaining storage;
+  storage.insert(Data(Name("/a/2")));
+  storage.insert(Data(Name("/a/1")));
+  storage.insert(Data(Name("/b/1")));
+  // Insert the same Data packet again.
+  storage.insert(Data(Name("/b/1")));
+  ASSERT_EQ(3, storage.size());
+
+  ASSERT_EQ(Name("/a/1"), storage.find(Name("/a"))->getName());
+  ASSERT_EQ(Name("/b/1"), storage.find(Name("/b/1"))->getName());
+  ASSERT_FALSE(storage.find(Name("/c")));
+  ASSERT_FALSE(storage.find(Name("/a/1/x")));
+
+  storage.remove(Name("/a"));
+  ASSERT_EQ(1, storage.size());
+  ASSERT_FALSE(storage.find(Name("/a")));
+}
+
+TEST_F(TestInMemoryStorageRetaining, FindByInterest)
+{
+  InMemoryStorageRetaining storage(0, true);
+  Data staleData(Name("/a/1"));
+  staleData.getMetaInfo().setFreshnessPeriod(milliseconds(0));
+  Data freshData(Name("/a/2"));
+  freshData.getMetaInfo().setFreshnessPeriod(hours(1));
+  Data longData(Name("/a/2/x"));
+  storage.insert(staleData);
+  storage.insert(freshData);
+  storage.insert(longData);
+  storage.insert(Data(Name("/ab")));
+
+  ASSERT_EQ(Name("/a/1"), storage.find(makeInterest(Name("/a"), true))->getName());
+  ASSERT_FALSE(storage.find(makeInterest(Name("/a"), false)));
+  ASSERT_EQ(Name("/a/2"),
+            storage.find(makeInterest(Name("/a/2"), false))->getName());
+  ASSERT_EQ(Name("/a/2"),
+            storage.find(makeInterest(Name("/a/2"), true))->getName());
+  ASSERT_EQ(Name("/a/1"),
+            storage.find(makeInterest(*staleData.getFullName(), false))->getName());
+
+  Interest rightmostInterest = makeInterest(Name("/a"), true);
+  rightmostInterest.setChildSelector(1);
+  ASSERT_EQ(Name("/a/2/x"), storage.find(rightmostInterest)->getName());
+
+  // A Data packet without a FreshnessPeriod is always fresh.
+  Interest freshInterest = makeInterest(Name("/a"), true);
+  freshInterest.setMustBeFresh(true);
+  ASSERT_EQ(Name("/a/2"), storage.find(freshInterest)->getName());
+  freshInterest.setName(Name("/a/1"));
+  ASSERT_FALSE(storage.find(freshInterest));
+  freshInterest.setName(Name("/a/2/x"));
+  ASSERT_EQ(Name("/a/2/x"), storage.find(freshInterest)->getName());
+}
+
+TEST_F(TestInMemoryStorageRetaining, IgnoreFreshness)
+{
+  // An authoritative storage ignores the FreshnessPeriod.
+  InMemoryStorageRetaining storage(0, false);
+  Data data(Name("/a/1"));
+  data.getMetaInfo().setFreshnessPeriod(hours(1));
+  storage.insert(data);
+
+  Interest freshInterest = makeInterest(Name("/a"), true);
+  freshInterest.setMustBeFresh(true);
+  storage.setNowOffset_(hours(2));
+  ASSERT_EQ(Name("/a/1"), storage.find(freshInterest)->getName());
+
+  // By default, the storage checks the FreshnessPeriod.
+  InMemoryStorageRetaining checkingStorage;
+  checkingStorage.insert(data);
+  ASSERT_EQ(Name("/a/1"), checkingStorage.find(freshInterest)->getName());
+  checkingStorage.setNowOffset_(hours(2));
+  ASSERT_FALSE(checkingStorage.find(freshInterest));
+  // Without MustBeFresh, the stale Data packet is found.
+  ASSERT_EQ(Name("/a/1"),
+            checkingStorage.find(makeInterest(Name("/a"), true))->getName());
+}
+
+TEST_F(TestInMemoryStorageRetaining, Limit)
+{
+  InMemoryStorageRetaining storage(2);
+  ASSERT_EQ(2, storage.getLimit());
+  storage.insert(Data(Name("/a")));
+  storage.insert(Data(Name("/b")));
+  // Use /a so that /b is the least recently used.
+  ASSERT_TRUE(!!storage.find(makeInterest(Name("/a"), false)));
+  storage.insert(Data(Name("/c")));
+  ASSERT_EQ(2, storage.size());
+  ASSERT_TRUE(!!storage.find(Name("/a")));
+  ASSERT_FALSE(storage.find(Name("/b")));
+  ASSERT_TRUE(!!storage.find(Name("/c")));
+
+  // Replacing the same Data packet does not evict.
+  storage.insert(Data(Name("/c")));
+  ASSERT_EQ(2, storage.size());
+  ASSERT_TRUE(!!storage.find(Name("/a")));
+
+  // Removing makes room.
+  storage.remove(Name("/a"));
+  storage.insert(Data(Name("/d")));
+  ASSERT_EQ(2, storage.size());
+  ASSERT_TRUE(!!storage.find(Name("/c")));
+}
+
+TEST_F(TestInMemoryStorageRetaining, Lifetime)
+{
+  InMemoryStorageRetaining storage;
+  storage.insert(Data(Name("/a")), milliseconds(10));
+  storage.insert(Data(Name("/b")), hours(1));
+  storage.insert(Data(Name("/c")));
+  ASSERT_TRUE(!!storage.find(Name("/a")));
+
+  this_thread::sleep_for(milliseconds(20));
+  ASSERT_FALSE(storage.find(Name("/a")));
+  ASSERT_EQ(2, storage.size());
+
+  // Insert /b again without a lifetime, so that the earlier lifetimes do not apply.
+  Data data(Name("/b"));
+  storage.insert(data, milliseconds(10));
+  storage.remove(Name("/b"));
+  storage.insert(data);
+  this_thread::sleep_for(milliseconds(20));
+  ASSERT_TRUE(!!storage.find(Name("/b")));
+  ASSERT_EQ(2, storage.size());
+}
+
+int
+main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
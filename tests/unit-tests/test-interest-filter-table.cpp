@@ -0,0 +1,177 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2020 Operant Networks, Incorporated.
+ * @author: Jeff Thompson <jefft0@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+#include "gtest/gtest.h"
+#include "../../src/impl/registered-prefix-table.hpp"
+
+using namespace std;
+using namespace ndn_ind;
+
+class TestInterestFilterTable : public ::testing::Test {
+public:
+  /**
+   * Set an interest filter with an empty callback.
+   */
+  void
+  set(uint64_t interestFilterId, const InterestFilter& filter)
+  {
+    table_.setInterestFilter
+      (interestFilterId, ptr_lib::make_shared<InterestFilter>(filter),
+       OnInterestCallback(), 0);
+  }
+
+  /**
+   * Get the interest filter IDs of the entries matching the name, in the
+   * order returned by getMatchedFilters.
+   */
+  vector<uint64_t>
+  getMatchedIds(const Name& name)
+  {
+    vector<ptr_lib::shared_ptr<InterestFilterTable::Entry> > matchedFilters;
+    table_.getMatchedFilters(Interest(name), matchedFilters);
+    vector<uint64_t> ids;
+    for (size_t i = 0; i < matchedFilters.size(); ++i)
+      ids.push_back(matchedFilters[i]->getInterestFilterId());
+    return ids;
+  }
+
+  InterestFilterTable table_;
+};
+
+TEST_F(TestInterestFilterTable, PrefixMatch)
+{
+  set(1, InterestFilter("/a"));
+  set(2, InterestFilter("/a/b"));
+  set(3, InterestFilter("/a/b/c"));
+  set(4, InterestFilter("/x"));
+  set(5, InterestFilter("/"));
+
+  ASSERT_EQ(vector<uint64_t>({ 1, 2, 5 }), getMatchedIds(Name("/a/b")));
+  ASSERT_EQ(vector<uint64_t>({ 1, 2, 3, 5 }), getMatchedIds(Name("/a/b/c/d")));
+  // A filter with a longer prefix doesn't match.
+  ASSERT_EQ(vector<uint64_t>({ 1, 5 }), getMatchedIds(Name("/a")));
+  // A sibling component doesn't match.
+  ASSERT_EQ(vector<uint64_t>({ 1, 5 }), getMatchedIds(Name("/a/c")));
+  ASSERT_EQ(vector<uint64_t>({ 5 }), getMatchedIds(Name("/y")));
+  ASSERT_EQ(vector<uint64_t>({ 5 }), getMatchedIds(Name()));
+}
+
+TEST_F(TestInterestFilterTable, RegexMatch)
+{
+  set(1, InterestFilter("/a", "<b><>"));
+  set(2, InterestFilter("/a"));
+  set(3, InterestFilter("/a", "<>*<c>"));
+
+  ASSERT_EQ(vector<uint64_t>({ 1, 2 }), getMatchedIds(Name("/a/b/x")));
+  ASSERT_EQ(vector<uint64_t>({ 2, 3 }), getMatchedIds(Name("/a/x/c")));
+  // The regex must match all of the components after the prefix.
+  ASSERT_EQ(vector<uint64_t>({ 2 }), getMatchedIds(Name("/a/b/x/y")));
+  // The regex filter also needs its prefix.
+  ASSERT_EQ(vector<uint64_t>(), getMatchedIds(Name("/z/b/x")));
+}
+
+TEST_F(TestInterestFilterTable, InsertionOrder)
+{
+  // Interleave filters on different trie nodes and regex filters. The matched
+  // filters must be in the order they were set, not in trie order.
+  set(10, InterestFilter("/a/b/c"));
+  set(9, InterestFilter("/a", "<b><>"));
+  set(8, InterestFilter("/a"));
+  set(7, InterestFilter("/a/b"));
+  set(6, InterestFilter("/a/b/c"));
+  set(5, InterestFilter("/"));
+  set(4, InterestFilter("/a", "<>*"));
+  set(3, InterestFilter("/a"));
+
+  ASSERT_EQ(vector<uint64_t>({ 10, 9, 8, 7, 6, 5, 4, 3 }),
+            getMatchedIds(Name("/a/b/c")));
+  ASSERT_EQ(vector<uint64_t>({ 8, 7, 5, 4, 3 }), getMatchedIds(Name("/a/b")));
+}
+
+TEST_F(TestInterestFilterTable, Unset)
+{
+  set(1, InterestFilter("/a"));
+  set(2, InterestFilter("/a"));
+  set(3, InterestFilter("/a/b/c"));
+  set(4, InterestFilter("/a", "<b><>"));
+
+  // Unsetting one ID doesn't affect another with the same prefix.
+  table_.unsetInterestFilter(1);
+  ASSERT_EQ(vector<uint64_t>({ 2, 3, 4 }), getMatchedIds(Name("/a/b/c")));
+
+  table_.unsetInterestFilter(4);
+  ASSERT_EQ(vector<uint64_t>({ 2, 3 }), getMatchedIds(Name("/a/b/c")));
+
+  // Unsetting the only entry on a deep node prunes it but not the parent.
+  table_.unsetInterestFilter(3);
+  ASSERT_EQ(vector<uint64_t>({ 2 }), getMatchedIds(Name("/a/b/c")));
+
+  // An unknown or already unset ID does nothing.
+  table_.unsetInterestFilter(3);
+  table_.unsetInterestFilter(99);
+  ASSERT_EQ(vector<uint64_t>({ 2 }), getMatchedIds(Name("/a/b/c")));
+
+  table_.unsetInterestFilter(2);
+  ASSERT_EQ(vector<uint64_t>(), getMatchedIds(Name("/a/b/c")));
+
+  // The pruned nodes can be added again.
+  set(5, InterestFilter("/a/b/c"));
+  set(6, InterestFilter("/a"));
+  ASSERT_EQ(vector<uint64_t>({ 5, 6 }), getMatchedIds(Name("/a/b/c")));
+}
+
+TEST_F(TestInterestFilterTable, RegisteredPrefixRemoveRequest)
+{
+  RegisteredPrefixTable registeredPrefixTable(table_);
+  ptr_lib::shared_ptr<const Name> prefix(new Name("/a"));
+
+  // Removing the registered prefix removes its related interest filter.
+  set(1, InterestFilter("/a"));
+  set(2, InterestFilter("/a"));
+  ASSERT_TRUE(registeredPrefixTable.add(10, prefix, 1));
+  registeredPrefixTable.removeRegisteredPrefix(10);
+  ASSERT_EQ(vector<uint64_t>({ 2 }), getMatchedIds(Name("/a")));
+
+  // Removing before add records a remove request, so add doesn't add it.
+  registeredPrefixTable.removeRegisteredPrefix(11);
+  // A repeated request is the same as one.
+  registeredPrefixTable.removeRegisteredPrefix(11);
+  ASSERT_FALSE(registeredPrefixTable.add(11, prefix, 2));
+  // The related interest filter is left to the caller.
+  ASSERT_EQ(vector<uint64_t>({ 2 }), getMatchedIds(Name("/a")));
+
+  // add consumed the remove request, so adding again succeeds.
+  ASSERT_TRUE(registeredPrefixTable.add(11, prefix, 2));
+  registeredPrefixTable.removeRegisteredPrefix(11);
+  ASSERT_EQ(vector<uint64_t>(), getMatchedIds(Name("/a")));
+
+  // A remove request for one ID doesn't affect another.
+  registeredPrefixTable.removeRegisteredPrefix(12);
+  ASSERT_TRUE(registeredPrefixTable.add(13, prefix, 0));
+  ASSERT_FALSE(registeredPrefixTable.add(12, prefix, 0));
+}
+
+int
+main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -41,6 +41,7 @@
 #include <ndn-ind/sha256-with-rsa-signature.hpp>
 #include <ndn-ind/encoding/tlv-0_2-wire-format.hpp>
 #include <ndn-ind/interest.hpp>
+#include <ndn-ind/util/interest-encoding-template.hpp>
 
 using namespace std;
 using namespace std::chrono;
@@ -552,6 +553,60 @@ TEST_F(TestInterestMethods, AppendParametersDigest)
     "params-sha256=a16cc669b4c9ef6801e1569488513f9523ffb28a39e53aa6e11add8d00a413fc");
 }
 
+TEST_F(TestInterestMethods, EncodingTemplate)
+{
+  Interest templateInterest(Name("/local/ndn/prefix"));
+  templateInterest.setCanBePrefix(false);
+  templateInterest.setMustBeFresh(true);
+  templateInterest.setInterestLifetime(milliseconds(4000));
+  InterestEncodingTemplate encodingTemplate(templateInterest);
+
+  ptr_lib::shared_ptr<Interest> interest = encodingTemplate.makeInterest
+    (Name::Component::fromSegment(300), milliseconds(30000));
+  ASSERT_EQ("/local/ndn/prefix/%00%01%2C", interest->getName().toUri());
+  ASSERT_EQ(4, interest->getNonce().size());
+  ASSERT_EQ(30000.0, toMilliseconds(interest->getInterestLifetime()));
+  ASSERT_TRUE(!interest->getDefaultWireEncoding().isNull());
+
+  // The template encoding must be the same as encoding the fields.
+  Interest expected(templateInterest);
+  expected.getName().appendSegment(300);
+  expected.setInterestLifetime(milliseconds(30000));
+  expected.setNonce(interest->getNonce());
+  Blob expectedEncoding = expected.wireEncode();
+  ASSERT_TRUE(interest->wireEncode().equals(expectedEncoding));
+  ASSERT_EQ(expected.wireEncode().signedSize(),
+            interest->wireEncode().signedSize());
+
+  // Use the template lifetime.
+  interest = encodingTemplate.makeInterest(Name::Component("suffix"));
+  ASSERT_EQ(4000.0, toMilliseconds(interest->getInterestLifetime()));
+  expected = Interest(templateInterest);
+  expected.getName().append("suffix");
+  expected.setNonce(interest->getNonce());
+  ASSERT_TRUE(interest->wireEncode().equals(expected.wireEncode()));
+
+  // No suffix and no lifetime.
+  interest = encodingTemplate.makeInterest(milliseconds(-1));
+  ASSERT_TRUE(interest->getName().equals(templateInterest.getName()));
+  ASSERT_TRUE(interest->getInterestLifetime().count() < 0);
+  expected = Interest(templateInterest);
+  expected.setInterestLifetime(milliseconds(-1));
+  expected.setNonce(interest->getNonce());
+  ASSERT_TRUE(interest->wireEncode().equals(expected.wireEncode()));
+
+  // Each Interest has a new nonce.
+  ASSERT_FALSE(encodingTemplate.makeInterest(milliseconds(4000))->getNonce().equals
+               (encodingTemplate.makeInterest(milliseconds(4000))->getNonce()));
+
+  Interest parametersInterest(Name("/local/ndn/prefix"));
+  uint8_t applicationParameters[] = { 0x23, 0x01, 0xC0 };
+  parametersInterest.setApplicationParameters
+    (Blob(applicationParameters, sizeof(applicationParameters)));
+  ASSERT_THROW(InterestEncodingTemplate{parametersInterest}, runtime_error)
+    << "Expected an exception for ApplicationParameters";
+}
+
 int
 main(int argc, char **argv)
 {
@@ -0,0 +1,330 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (C) 2020 Operant Networks, Incorporated.
+ * @author: Jeff Thompson <jefft0@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+#include "gtest/gtest.h"
+#include <ndn-ind/ndn-ind-config.h>
+#if NDN_IND_HAVE_LINUX_IO_URING_H
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <ndn-ind/transport/tcp-transport.hpp>
+#include <ndn-ind/transport/udp-transport.hpp>
+#include <ndn-ind/transport/unix-transport.hpp>
+#include <ndn-ind/transport/io-uring-transport.hpp>
+#include "../../src/transport/io-uring.hpp"
+
+using namespace std;
+using namespace ndn_ind;
+
+/**
+ * A SavingElementListener saves each received element.
+ */
+class SavingElementListener : public ElementListener {
+public:
+  virtual void
+  onReceivedElement(const uint8_t *element, size_t elementLength)
+  {
+    elements_.push_back(string((const char*)element, elementLength));
+  }
+
+  vector<string> elements_;
+};
+
+/**
+ * Make a TLV element of type 5 with a value of valueLength bytes of the
+ * character c, using a 3-byte length encoding if needed.
+ */
+static string
+makeElement(size_t valueLength, char c)
+{
+  string element("\x05", 1);
+  if (valueLength < 253)
+    element += (char)valueLength;
+  else {
+    element += (char)253;
+    element += (char)(valueLength >> 8);
+    element += (char)(valueLength & 0xff);
+  }
+  return element + string(valueLength, c);
+}
+
+static void
+sendString(Transport& transport, const string& packet)
+{
+  transport.send((const uint8_t*)packet.data(), packet.size());
+}
+
+/**
+ * Call transport.processEvents() until the listener has nElements elements or
+ * a timeout.
+ */
+static void
+processEventsUntil
+  (Transport& transport, const SavingElementListener& listener,
+   size_t nElements)
+{
+  auto timeout = chrono::steady_clock::now() + chrono::seconds(10);
+  while (listener.elements_.size() < nElements &&
+         chrono::steady_clock::now() < timeout) {
+    transport.processEvents();
+    this_thread::sleep_for(chrono::microseconds(100));
+  }
+}
+
+/**
+ * Read exactly length bytes from the stream socket.
+ */
+static string
+readAll(int socketDescriptor, size_t length)
+{
+  string result;
+  char buffer[4096];
+  while (result.size() < length) {
+    ssize_t nBytes = recv
+      (socketDescriptor, buffer, min(sizeof(buffer), length - result.size()), 0);
+    if (nBytes <= 0)
+      break;
+    result.append(buffer, nBytes);
+  }
+  return result;
+}
+
+/**
+ * Check if the kernel allows io_uring, which may be disabled by a container.
+ */
+static bool
+isIoUringSupported()
+{
+  try {
+    IoUring ring(8);
+    ring.provideBuffers(8, 1024);
+    return true;
+  } catch (const std::exception& ex) {
+    cout << "Skipping test since io_uring is not supported: " << ex.what() <<
+      endl;
+    return false;
+  }
+}
+
+/**
+ * Bind a socket to an available port on the loopback interface.
+ */
+static int
+bindLoopback(int type, unsigned short& port)
+{
+  int socketDescriptor = socket(AF_INET, type, 0);
+  struct sockaddr_in address;
+  memset(&address, 0, sizeof(address));
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  if (socketDescriptor < 0 ||
+      ::bind(socketDescriptor, (struct sockaddr*)&address, sizeof(address)) != 0)
+    throw runtime_error("Can't bind the loopback socket");
+
+  socklen_t addressLength = sizeof(address);
+  getsockname(socketDescriptor, (struct sockaddr*)&address, &addressLength);
+  port = ntohs(address.sin_port);
+  return socketDescriptor;
+}
+
+class TestIoUringTransport : public ::testing::Test {
+};
+
+TEST_F(TestIoUringTransport, Tcp)
+{
+  if (!isIoUringSupported())
+    return;
+
+  unsigned short port;
+  int listenSocket = bindLoopback(SOCK_STREAM, port);
+  ASSERT_EQ(0, listen(listenSocket, 1));
+
+  IoUringTransport transport;
+  SavingElementListener listener;
+  ASSERT_TRUE(transport.isLocal(TcpTransport::ConnectionInfo("127.0.0.1")));
+  transport.connect
+    (TcpTransport::ConnectionInfo("127.0.0.1", port), listener,
+     Transport::OnConnected());
+  ASSERT_TRUE(transport.getIsConnected());
+  int peer = accept(listenSocket, 0, 0);
+  ::close(listenSocket);
+
+  // Send elements which are split across writes.
+  string element1 = makeElement(10, 'a');
+  string element2 = makeElement(5000, 'b');
+  string stream = element1 + element2;
+  ASSERT_EQ(5, ::send(peer, stream.data(), 5, 0));
+  ASSERT_EQ(stream.size() - 5,
+            ::send(peer, stream.data() + 5, stream.size() - 5, 0));
+  processEventsUntil(transport, listener, 2);
+  ASSERT_EQ(2, listener.elements_.size());
+  ASSERT_EQ(element1, listener.elements_[0]);
+  ASSERT_EQ(element2, listener.elements_[1]);
+
+  // Corked packets are sent together, in order.
+  transport.cork();
+  sendString(transport, element2);
+  sendString(transport, element1);
+  transport.uncork();
+  sendString(transport, element1);
+  ASSERT_EQ(element2 + element1 + element1,
+            readAll(peer, 2 * element1.size() + element2.size()));
+
+  transport.close();
+  ASSERT_FALSE(transport.getIsConnected());
+  ::close(peer);
+}
+
+TEST_F(TestIoUringTransport, ManyBuffers)
+{
+  if (!isIoUringSupported())
+    return;
+
+  unsigned short port;
+  int listenSocket = bindLoopback(SOCK_STREAM, port);
+  ASSERT_EQ(0, listen(listenSocket, 1));
+
+  IoUringTransport transport;
+  SavingElementListener listener;
+  transport.connect
+    (TcpTransport::ConnectionInfo("127.0.0.1", port), listener,
+     Transport::OnConnected());
+  int peer = accept(listenSocket, 0, 0);
+  ::close(listenSocket);
+
+  // Send more than all the provided buffers before processing, so that the
+  // receive runs out of buffers and must be submitted again.
+  string element = makeElement(4000, 'c');
+  size_t nElements = 1000;
+  thread writer([&]() {
+    for (size_t i = 0; i < nElements; ++i)
+      ::send(peer, element.data(), element.size(), 0);
+  });
+  this_thread::sleep_for(chrono::milliseconds(200));
+  processEventsUntil(transport, listener, nElements);
+  writer.join();
+
+  ASSERT_EQ(nElements, listener.elements_.size());
+  for (size_t i = 0; i < nElements; ++i)
+    ASSERT_EQ(element, listener.elements_[i]);
+
+  transport.close();
+  ::close(peer);
+}
+
+TEST_F(TestIoUringTransport, Udp)
+{
+  if (!isIoUringSupported())
+    return;
+
+  unsigned short port;
+  int peer = bindLoopback(SOCK_DGRAM, port);
+
+  IoUringTransport transport;
+  SavingElementListener listener;
+  ASSERT_FALSE(transport.isLocal(UdpTransport::ConnectionInfo("127.0.0.1")));
+  transport.connect
+    (UdpTransport::ConnectionInfo("127.0.0.1", port), listener,
+     Transport::OnConnected());
+
+  transport.cork();
+  sendString(transport, "packet1");
+  sendString(transport, "packet2");
+  transport.uncork();
+
+  char buffer[100];
+  struct sockaddr_in from;
+  socklen_t fromLength = sizeof(from);
+  ssize_t nBytes = recvfrom
+    (peer, buffer, sizeof(buffer), 0, (struct sockaddr*)&from, &fromLength);
+  ASSERT_EQ("packet1", string(buffer, nBytes)) << "Each packet is a datagram";
+  nBytes = recv(peer, buffer, sizeof(buffer), 0);
+  ASSERT_EQ("packet2", string(buffer, nBytes)) << "Each packet is a datagram";
+
+  string element = makeElement(100, 'd');
+  sendto(peer, element.data(), element.size(), 0, (struct sockaddr*)&from,
+         fromLength);
+  processEventsUntil(transport, listener, 1);
+  ASSERT_EQ(1, listener.elements_.size());
+  ASSERT_EQ(element, listener.elements_[0]);
+
+  transport.close();
+  ::close(peer);
+}
+
+TEST_F(TestIoUringTransport, Unix)
+{
+  if (!isIoUringSupported())
+    return;
+
+  string filePath = "/tmp/test-io-uring-transport-" + to_string(getpid()) +
+    ".sock";
+  unlink(filePath.c_str());
+  int listenSocket = socket(AF_UNIX, SOCK_STREAM, 0);
+  struct sockaddr_un address;
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  strncpy(address.sun_path, filePath.c_str(), sizeof(address.sun_path) - 1);
+  ASSERT_EQ(0, ::bind(listenSocket, (struct sockaddr*)&address, sizeof(address)));
+  ASSERT_EQ(0, listen(listenSocket, 1));
+
+  IoUringTransport transport;
+  SavingElementListener listener;
+  ASSERT_TRUE(transport.isLocal(UnixTransport::ConnectionInfo(filePath.c_str())));
+  transport.connect
+    (UnixTransport::ConnectionInfo(filePath.c_str()), listener,
+     Transport::OnConnected());
+  int peer = accept(listenSocket, 0, 0);
+  ::close(listenSocket);
+  unlink(filePath.c_str());
+
+  string element = makeElement(300, 'e');
+  sendString(transport, element);
+  ASSERT_EQ(element, readAll(peer, element.size()));
+  ::send(peer, element.data(), element.size(), 0);
+  processEventsUntil(transport, listener, 1);
+  ASSERT_EQ(1, listener.elements_.size());
+  ASSERT_EQ(element, listener.elements_[0]);
+
+  // The transport sees that the other end closed the connection.
+  ::close(peer);
+  auto timeout = chrono::steady_clock::now() + chrono::seconds(10);
+  while (transport.getIsConnected() && chrono::steady_clock::now() < timeout)
+    transport.processEvents();
+  ASSERT_FALSE(transport.getIsConnected());
+  transport.close();
+}
+
+#endif // NDN_IND_HAVE_LINUX_IO_URING_H
+
+int
+main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,514 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2020 Operant Networks, Incorporated.
+ * @author: Jeff Thompson <jefft0@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+#include "gtest/gtest.h"
+#include <thread>
+#include <ndn-ind/encoding/tlv-0_2-wire-format.hpp>
+#include <ndn-ind/in-memory-storage/sharded-content-store.hpp>
+#include <ndn-ind/util/memory-content-cache.hpp>
+
+using namespace std;
+using namespace std::chrono;
+using namespace ndn_ind;
+using namespace ndn_ind::func_lib;
+
+/**
+ * A LoopbackTransport decodes each sent Data packet and lets the test deliver
+ * received packets directly to the element listener.
+ */
+class LoopbackTransport : public Transport {
+public:
+  LoopbackTransport()
+  : elementListener_(0)
+  {
+  }
+
+  virtual bool
+  isLocal(const Transport::ConnectionInfo& connectionInfo) { return true; }
+
+  virtual bool
+  isAsync() { return false; }
+
+  virtual void
+  connect
+    (const Transport::ConnectionInfo& connectionInfo,
+     ElementListener& elementListener, const OnConnected& onConnected)
+  {
+    elementListener_ = &elementListener;
+    if (onConnected)
+      onConnected();
+  }
+
+  virtual void
+  send(const uint8_t *data, size_t dataLength)
+  {
+    // Ignore the Interest which connects the transport. The Data type is 6.
+    if (dataLength > 0 && data[0] == 6) {
+      sentData_.push_back(Data());
+      sentData_.back().wireDecode(data, dataLength);
+    }
+  }
+
+  virtual void
+  processEvents() {}
+
+  virtual bool
+  getIsConnected() { return elementListener_ != 0; }
+
+  /**
+   * Deliver the buffer to the element listener as if it was received.
+   * @param encoding The wire encoding of the packet.
+   */
+  void
+  receive(const Blob& encoding)
+  {
+    elementListener_->onReceivedElement(encoding.buf(), encoding.size());
+  }
+
+  vector<Data> sentData_;
+
+private:
+  ElementListener* elementListener_;
+};
+
+class TestMemoryContentCache : public ::testing::Test {
+public:
+  TestMemoryContentCache()
+  : transport_(new LoopbackTransport()),
+    face_(transport_, ptr_lib::make_shared<Transport::ConnectionInfo>()),
+    prefix_("/test/content"),
+    nDataNotFound_(0)
+  {
+    // Express an interest which connects the transport to the face.
+    Interest connectInterest(Name("/test/connect"));
+    connectInterest.setCanBePrefix(false);
+    connectInterest.setInterestLifetime(hours(1));
+    face_.expressInterest(connectInterest, OnData(), OnTimeout());
+  }
+
+  /**
+   * Deliver the Interest to the face and return the name of the Data packet
+   * which the cache sent in response.
+   * @param interest The Interest to deliver.
+   * @param wireFormat (optional) The wire format to encode the Interest.
+   * NDN-TLV 0.2 keeps the ChildSelector.
+   * @return The name of the sent Data packet, or an empty Name if the cache
+   * did not send a Data packet.
+   */
+  Name
+  express
+    (Interest interest,
+     WireFormat& wireFormat = *WireFormat::getDefaultWireFormat())
+  {
+    interest.setInterestLifetime(seconds(4));
+    interest.refreshNonce();
+    transport_->sentData_.clear();
+    transport_->receive(interest.wireEncode(wireFormat));
+    if (transport_->sentData_.size() == 0)
+      return Name();
+    return transport_->sentData_.back().getName();
+  }
+
+  void
+  onDataNotFound
+    (const ptr_lib::shared_ptr<const Name>& prefix,
+     const ptr_lib::shared_ptr<const Interest>& interest, Face& face,
+     uint64_t interestFilterId,
+     const ptr_lib::shared_ptr<const InterestFilter>& filter)
+  {
+    ++nDataNotFound_;
+  }
+
+  void
+  onContentRemoved
+    (const ptr_lib::shared_ptr<MemoryContentCache::ContentList>& contentList)
+  {
+    removed_ = contentList;
+  }
+
+  ptr_lib::shared_ptr<LoopbackTransport> transport_;
+  Face face_;
+  Name prefix_;
+  int nDataNotFound_;
+  ptr_lib::shared_ptr<MemoryContentCache::ContentList> removed_;
+};
+
+TEST_F(TestMemoryContentCache, ExactAndPrefix)
+{
+  MemoryContentCache cache(&face_);
+  cache.setInterestFilter
+    (prefix_, bind(&TestMemoryContentCache::onDataNotFound, this, _1, _2, _3, _4, _5));
+  for (int version = 1; version <= 3; ++version) {
+    for (int segment = 0; segment < 3; ++segment)
+      cache.add(Data(Name(prefix_).appendVersion(version).appendSegment(segment)));
+  }
+  // Add a name which has the prefix as a string but not as a Name.
+  cache.add(Data(Name("/test/contentX/1")));
+
+  Interest exactInterest(Name(prefix_).appendVersion(2).appendSegment(1));
+  exactInterest.setCanBePrefix(false);
+  ASSERT_EQ(exactInterest.getName(), express(exactInterest));
+
+  Interest prefixInterest(Name(prefix_).appendVersion(2));
+  prefixInterest.setCanBePrefix(true);
+  ASSERT_EQ(Name(prefix_).appendVersion(2).appendSegment(0),
+            express(prefixInterest));
+
+  // The exact name of a prefix is not a match if CanBePrefix is false.
+  Interest notPrefixInterest(Name(prefix_).appendVersion(2));
+  notPrefixInterest.setCanBePrefix(false);
+  ASSERT_EQ(Name(), express(notPrefixInterest));
+  ASSERT_EQ(1, nDataNotFound_);
+
+  Interest missingInterest(Name(prefix_).appendVersion(4));
+  missingInterest.setCanBePrefix(true);
+  ASSERT_EQ(Name(), express(missingInterest));
+  ASSERT_EQ(2, nDataNotFound_);
+}
+
+TEST_F(TestMemoryContentCache, ChildSelector)
+{
+  MemoryContentCache cache(&face_);
+  cache.setInterestFilter(prefix_);
+  // Add out of order.
+  int versions[] = { 2, 9, 1, 10 };
+  for (size_t i = 0; i < sizeof(versions) / sizeof(versions[0]); ++i) {
+    for (int segment = 0; segment < 2; ++segment)
+      cache.add(Data(Name(prefix_).appendVersion(versions[i]).appendSegment(segment)));
+  }
+  // Add a name after the prefix in the canonical order.
+  cache.add(Data(Name("/test/contentX/1")));
+
+  Interest leftmostInterest(prefix_);
+  leftmostInterest.setCanBePrefix(true);
+  leftmostInterest.setChildSelector(0);
+  ASSERT_EQ(Name(prefix_).appendVersion(1).appendSegment(0),
+            express(leftmostInterest, *Tlv0_2WireFormat::get()));
+
+  Interest rightmostInterest(prefix_);
+  rightmostInterest.setCanBePrefix(true);
+  rightmostInterest.setChildSelector(1);
+  ASSERT_EQ(Name(prefix_).appendVersion(10).appendSegment(1),
+            express(rightmostInterest, *Tlv0_2WireFormat::get()));
+
+  // With the empty name, the range goes to the end of the cache.
+  Interest allInterest((Name()));
+  allInterest.setCanBePrefix(true);
+  allInterest.setChildSelector(1);
+  cache.setInterestFilter(Name());
+  ASSERT_EQ(Name("/test/contentX/1"),
+            express(allInterest, *Tlv0_2WireFormat::get()));
+}
+
+TEST_F(TestMemoryContentCache, FreshnessAndCleanup)
+{
+  MemoryContentCache cache(&face_, milliseconds(0));
+  cache.setInterestFilter(prefix_);
+  cache.setOnContentRemoved
+    (bind(&TestMemoryContentCache::onContentRemoved, this, _1));
+  cache.setMinimumCacheLifetime(milliseconds(100));
+
+  Data staleData(Name(prefix_).append("stale"));
+  staleData.getMetaInfo().setFreshnessPeriod(milliseconds(0));
+  cache.add(staleData);
+  Data freshData(Name(prefix_).append("zfresh"));
+  freshData.getMetaInfo().setFreshnessPeriod(hours(1));
+  cache.add(freshData);
+
+  // The stale Data is still cached for the minimum cache lifetime.
+  Interest interest(prefix_);
+  interest.setCanBePrefix(true);
+  ASSERT_EQ(staleData.getName(), express(interest));
+  interest.setMustBeFresh(true);
+  ASSERT_EQ(freshData.getName(), express(interest));
+  ASSERT_FALSE(removed_);
+
+  // Replace the stale Data with a fresh one of the same name.
+  Data replacedData(staleData.getName());
+  replacedData.setContent(Blob((const uint8_t*)"new", 3));
+  replacedData.getMetaInfo().setFreshnessPeriod(hours(1));
+  cache.add(replacedData);
+
+  // After the minimum cache lifetime, cleanup skips the replaced entry.
+  this_thread::sleep_for(milliseconds(150));
+  ASSERT_EQ(staleData.getName(), express(interest));
+  ASSERT_TRUE(transport_->sentData_[0].getContent().equals
+              (replacedData.getContent()));
+  ASSERT_FALSE(removed_);
+
+  // Remove the stale Data, which cleanup reports.
+  cache.setMinimumCacheLifetime(milliseconds(0));
+  Data expiringData(Name(prefix_).append("expiring"));
+  expiringData.getMetaInfo().setFreshnessPeriod(milliseconds(10));
+  cache.add(expiringData);
+  this_thread::sleep_for(milliseconds(20));
+  interest.setMustBeFresh(false);
+  ASSERT_EQ(staleData.getName(), express(interest));
+  ASSERT_TRUE(!!removed_);
+  ASSERT_EQ(1, removed_->size());
+  ASSERT_EQ(expiringData.getName(), (*removed_)[0]->getName());
+  Interest expiringInterest(expiringData.getName());
+  expiringInterest.setCanBePrefix(false);
+  ASSERT_EQ(Name(), express(expiringInterest));
+}
+
+/**
+ * Make a Data packet with the name prefix_/suffix and 100 bytes of content,
+ * so that Data packets with the same suffix length have the same size.
+ */
+static Data
+makeData(const Name& prefix, const string& suffix)
+{
+  Data data(Name(prefix).append(suffix));
+  data.setContent(Blob(vector<uint8_t>(100, 0)));
+  return data;
+}
+
+TEST_F(TestMemoryContentCache, Capacity)
+{
+  size_t dataSize = makeData(prefix_, "a").wireEncode().size();
+  MemoryContentCache::ReplacementPolicy policies[] =
+    { MemoryContentCache::LRU, MemoryContentCache::CLOCK,
+      MemoryContentCache::ARC };
+  for (size_t i = 0; i < sizeof(policies) / sizeof(policies[0]); ++i) {
+    MemoryContentCache cache(&face_);
+    cache.setInterestFilter(prefix_);
+    cache.setOnContentRemoved
+      (bind(&TestMemoryContentCache::onContentRemoved, this, _1));
+    cache.setCapacity(3 * dataSize, policies[i]);
+    ASSERT_EQ(3 * dataSize, cache.getCapacity());
+    ASSERT_EQ(policies[i], cache.getReplacementPolicy());
+    removed_.reset();
+
+    cache.add(makeData(prefix_, "a"));
+    cache.add(makeData(prefix_, "b"));
+    cache.add(makeData(prefix_, "c"));
+    ASSERT_EQ(3 * dataSize, cache.getSize());
+
+    // Use a, so that each policy evicts b to add d.
+    Interest interestA(Name(prefix_).append("a"));
+    interestA.setCanBePrefix(false);
+    ASSERT_EQ(interestA.getName(), express(interestA));
+    cache.add(makeData(prefix_, "d"));
+    ASSERT_EQ(3 * dataSize, cache.getSize());
+    ASSERT_EQ(1, cache.getNEvictions());
+    ASSERT_TRUE(!!removed_);
+    ASSERT_EQ(1, removed_->size());
+    ASSERT_EQ(Name(prefix_).append("b"), (*removed_)[0]->getName());
+
+    Interest interestB(Name(prefix_).append("b"));
+    interestB.setCanBePrefix(false);
+    ASSERT_EQ(Name(), express(interestB));
+    ASSERT_EQ(1, cache.getNHits());
+    ASSERT_EQ(1, cache.getNMisses());
+
+    // Replacing a Data packet with the same name does not evict.
+    cache.add(makeData(prefix_, "a"));
+    ASSERT_EQ(1, cache.getNEvictions());
+
+    // A Data packet larger than the capacity is not cached.
+    Data largeData(Name(prefix_).append("large"));
+    largeData.setContent(Blob(vector<uint8_t>(4 * dataSize, 0)));
+    cache.add(largeData);
+    ASSERT_EQ(3 * dataSize, cache.getSize());
+    ASSERT_EQ(1, cache.getNEvictions());
+
+    // Reducing the capacity evicts now.
+    cache.setCapacity(dataSize, policies[i]);
+    ASSERT_EQ(dataSize, cache.getSize());
+    ASSERT_EQ(3, cache.getNEvictions());
+  }
+}
+
+TEST_F(TestMemoryContentCache, EvictedContentIsFreed)
+{
+  size_t dataSize = makeData(prefix_, "a").wireEncode().size();
+  // A FreshnessPeriod makes the encoding larger, so use it for the capacity.
+  Data freshData = makeData(prefix_, "a");
+  freshData.getMetaInfo().setFreshnessPeriod(seconds(10));
+  MemoryContentCache cache(&face_);
+  cache.setCapacity(freshData.wireEncode().size());
+
+  ptr_lib::weak_ptr<const vector<uint8_t> > encoding;
+  {
+    // Use a FreshnessPeriod so that the content also has a removal time.
+    Data data = makeData(prefix_, "a");
+    data.getMetaInfo().setFreshnessPeriod(seconds(10));
+    encoding = data.wireEncode();
+    cache.add(data);
+  }
+  ASSERT_FALSE(encoding.expired());
+
+  // Evicting the content frees it before its removal time.
+  cache.add(makeData(prefix_, "b"));
+  ASSERT_EQ(1, cache.getNEvictions());
+  ASSERT_TRUE(encoding.expired());
+
+  // Replacing content with the same name also frees it.
+  {
+    Data data = makeData(prefix_, "b");
+    data.getMetaInfo().setFreshnessPeriod(seconds(10));
+    encoding = data.wireEncode();
+    cache.add(data);
+  }
+  ASSERT_FALSE(encoding.expired());
+  cache.add(makeData(prefix_, "b"));
+  ASSERT_TRUE(encoding.expired());
+  ASSERT_EQ(dataSize, cache.getSize());
+}
+
+TEST_F(TestMemoryContentCache, ArcResistsScan)
+{
+  size_t dataSize = makeData(prefix_, "a").wireEncode().size();
+  Interest interestA(Name(prefix_).append("a"));
+  interestA.setCanBePrefix(false);
+  Interest interestB(Name(prefix_).append("b"));
+  interestB.setCanBePrefix(false);
+
+  MemoryContentCache::ReplacementPolicy policies[] =
+    { MemoryContentCache::LRU, MemoryContentCache::ARC };
+  for (size_t i = 0; i < sizeof(policies) / sizeof(policies[0]); ++i) {
+    MemoryContentCache cache(&face_);
+    cache.setInterestFilter(prefix_);
+    cache.setCapacity(4 * dataSize, policies[i]);
+
+    // Use a and b more than once.
+    cache.add(makeData(prefix_, "a"));
+    cache.add(makeData(prefix_, "b"));
+    for (int j = 0; j < 2; ++j) {
+      express(interestA);
+      express(interestB);
+    }
+
+    // Scan Data packets which are used once.
+    for (int j = 0; j < 8; ++j)
+      cache.add(makeData(prefix_, string(1, (char)('m' + j))));
+
+    if (policies[i] == MemoryContentCache::ARC) {
+      ASSERT_EQ(interestA.getName(), express(interestA));
+      ASSERT_EQ(interestB.getName(), express(interestB));
+    }
+    else {
+      ASSERT_EQ(Name(), express(interestA));
+      ASSERT_EQ(Name(), express(interestB));
+    }
+  }
+}
+
+TEST_F(TestMemoryContentCache, PendingInterests)
+{
+  MemoryContentCache cache(&face_);
+  cache.setInterestFilter(prefix_, cache.getStorePendingInterest());
+
+  Data data(Name(prefix_).append("a").append("1"));
+  data.setContent(Blob((const uint8_t*)"content", 7));
+  Interest prefixInterest(Name(prefix_).append("a"));
+  prefixInterest.setCanBePrefix(true);
+  Interest notPrefixInterest(Name(prefix_).append("a"));
+  notPrefixInterest.setCanBePrefix(false);
+  Interest exactInterest(data.getName());
+  exactInterest.setCanBePrefix(false);
+  Interest digestInterest(*data.getFullName());
+  digestInterest.setCanBePrefix(false);
+  Interest otherInterest(Name(prefix_).append("a").append("2"));
+  otherInterest.setCanBePrefix(false);
+  Interest expiringInterest(data.getName());
+  expiringInterest.setCanBePrefix(false);
+  expiringInterest.setInterestLifetime(milliseconds(10));
+
+  Interest* interests[] = { &prefixInterest, &notPrefixInterest, &exactInterest,
+    &digestInterest, &otherInterest };
+  for (size_t i = 0; i < sizeof(interests) / sizeof(interests[0]); ++i) {
+    ASSERT_EQ(Name(), express(*interests[i]));
+  }
+  expiringInterest.refreshNonce();
+  transport_->receive(expiringInterest.wireEncode());
+  ASSERT_EQ(0, transport_->sentData_.size());
+
+  vector<ptr_lib::shared_ptr<const MemoryContentCache::PendingInterest> >
+    pendingInterests;
+  cache.getPendingInterestsWithPrefix(Name(prefix_).append("a"), pendingInterests);
+  ASSERT_EQ(6, pendingInterests.size());
+  cache.getPendingInterestsWithPrefix(Name(), pendingInterests);
+  ASSERT_EQ(6, pendingInterests.size());
+  // Interest.matchesName does not match the name with the implicit digest.
+  cache.getPendingInterestsForName(data.getName(), pendingInterests);
+  ASSERT_EQ(3, pendingInterests.size());
+
+  // The expiring interest times out, and the others which match are satisfied.
+  this_thread::sleep_for(milliseconds(20));
+  cache.add(data);
+  ASSERT_EQ(2, transport_->sentData_.size());
+  cache.getPendingInterestsWithPrefix(Name(), pendingInterests);
+  ASSERT_EQ(3, pendingInterests.size());
+  cache.getPendingInterestsForName(data.getName(), pendingInterests);
+  ASSERT_EQ(0, pendingInterests.size());
+
+  transport_->sentData_.clear();
+  cache.add(Data(otherInterest.getName()));
+  ASSERT_EQ(1, transport_->sentData_.size());
+  ASSERT_EQ(otherInterest.getName(), transport_->sentData_[0].getName());
+  cache.getPendingInterestsWithPrefix(Name(), pendingInterests);
+  ASSERT_EQ(2, pendingInterests.size());
+}
+
+TEST_F(TestMemoryContentCache, ContentStore)
+{
+  MemoryContentCache cache(&face_);
+  cache.setInterestFilter
+    (prefix_, bind(&TestMemoryContentCache::onDataNotFound, this, _1, _2, _3, _4, _5));
+  ptr_lib::shared_ptr<ShardedContentStore> contentStore
+    (new ShardedContentStore(4));
+  cache.setContentStore(contentStore);
+  ASSERT_EQ(contentStore, cache.getContentStore());
+
+  // Insert into the content store from another thread.
+  thread worker([&contentStore, this]() {
+    for (int segment = 0; segment < 10; ++segment)
+      contentStore->insert(Data(Name(prefix_).appendSegment(segment)));
+  });
+  worker.join();
+  cache.add(Data(Name(prefix_).appendSegment(20)));
+
+  Interest storedInterest(Name(prefix_).appendSegment(5));
+  storedInterest.setCanBePrefix(false);
+  ASSERT_EQ(storedInterest.getName(), express(storedInterest));
+  Interest cachedInterest(Name(prefix_).appendSegment(20));
+  cachedInterest.setCanBePrefix(false);
+  ASSERT_EQ(cachedInterest.getName(), express(cachedInterest));
+  // The cache is searched before the content store.
+  Interest prefixInterest(prefix_);
+  prefixInterest.setCanBePrefix(true);
+  ASSERT_EQ(cachedInterest.getName(), express(prefixInterest));
+  ASSERT_EQ(3, cache.getNHits());
+
+  Interest missingInterest(Name(prefix_).appendSegment(30));
+  missingInterest.setCanBePrefix(false);
+  ASSERT_EQ(Name(), express(missingInterest));
+  ASSERT_EQ(1, nDataNotFound_);
+}
+
+int
+main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
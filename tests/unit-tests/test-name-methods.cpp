@@ -36,6 +36,8 @@
 
 #include "gtest/gtest.h"
 #include <algorithm>
+#include <thread>
+#include <type_traits>
 #include <ndn-ind/name.hpp>
 #include <ndn-ind/encoding/tlv-wire-format.hpp>
 
@@ -97,6 +99,112 @@ TEST_F(TestNameComponentMethods, Compare)
   ASSERT_TRUE(c80.compare(c7f) > 0) << "%80 should be greater than %7f";
 }
 
+TEST_F(TestNameComponentMethods, ShortAndLongValues)
+{
+  const uint8_t shortValue[] = { 0x00, 0x01, 0x02 };
+  uint8_t longValue[40];
+  for (size_t i = 0; i < sizeof(longValue); ++i)
+    longValue[i] = (uint8_t)i;
+
+  // Components with a copied value must equal components sharing a Blob.
+  Name::Component shortComponent(shortValue, sizeof(shortValue));
+  Name::Component shortBlobComponent(Blob(shortValue, sizeof(shortValue)));
+  ASSERT_TRUE(shortComponent.equals(shortBlobComponent));
+  ASSERT_EQ(shortBlobComponent.hash(), shortComponent.hash());
+  ASSERT_EQ(0, shortComponent.compare(shortBlobComponent));
+  ASSERT_TRUE(shortComponent.getValue().equals
+              (Blob(shortValue, sizeof(shortValue))));
+
+  Name::Component longComponent(longValue, sizeof(longValue));
+  Name::Component longBlobComponent(Blob(longValue, sizeof(longValue)));
+  ASSERT_TRUE(longComponent.equals(longBlobComponent));
+  ASSERT_EQ(longBlobComponent.hash(), longComponent.hash());
+  ASSERT_TRUE(longComponent.getValue().equals
+              (Blob(longValue, sizeof(longValue))));
+  ASSERT_FALSE(longComponent.equals(shortComponent));
+
+  // A copy made before getValue() has the same value.
+  Name::Component segment = Name::Component::fromSegment(0x1234);
+  Name::Component segmentCopy(segment);
+  ASSERT_TRUE(segment.getValue().equals(segmentCopy.getValue()));
+  ASSERT_EQ(0x1234, segmentCopy.toSegment());
+  ASSERT_TRUE(segmentCopy.isSegment());
+
+  // A number with a prefix longer than the short value storage.
+  Name::Component prefixed = Name::Component::fromNumberWithPrefix
+    (0x0102, longValue, sizeof(longValue));
+  ASSERT_EQ(sizeof(longValue) + 2, prefixed.getValue().size());
+  ASSERT_EQ(0x0102, prefixed.toNumberWithPrefix(longValue, sizeof(longValue)));
+
+  // The default component value is still null.
+  ASSERT_TRUE(Name::Component().getValue().isNull());
+}
+
+TEST_F(TestNameComponentMethods, GetValueFromThreads)
+{
+  for (int i = 0; i < 100; ++i) {
+    const Name::Component segment = Name::Component::fromSegment(i);
+
+    // Each thread calls getValue() on the same const component. They must all
+    // get the same Blob.
+    const Blob* values[4];
+    vector<thread> threads;
+    for (size_t j = 0; j < 4; ++j)
+      threads.push_back(thread([&segment, &values, i, j] {
+        values[j] = &segment.getValue();
+        // Also copy the component while another thread may be creating the Blob.
+        Name::Component copy(segment);
+        ASSERT_EQ(i, copy.toSegment());
+      }));
+    for (size_t j = 0; j < threads.size(); ++j)
+      threads[j].join();
+
+    for (size_t j = 0; j < 4; ++j) {
+      ASSERT_EQ(&segment.getValue(), values[j]);
+      ASSERT_EQ(segment.getValue().buf(), values[j]->buf());
+    }
+    ASSERT_EQ(i, segment.toSegment());
+  }
+
+  // A copy made after getValue() shares the Blob.
+  Name::Component segment = Name::Component::fromSegment(1);
+  const uint8_t* buf = segment.getValue().buf();
+  Name::Component copy(segment);
+  ASSERT_EQ(buf, copy.getValue().buf());
+
+  // Assigning a new inline value replaces the Blob created by getValue().
+  copy = Name::Component::fromSegment(2);
+  ASSERT_EQ(2, copy.toSegment());
+  ASSERT_TRUE(copy.getValue().equals(Name::Component::fromSegment(2).getValue()));
+}
+
+TEST_F(TestNameComponentMethods, Move)
+{
+  // A vector of components moves them when it grows.
+  ASSERT_TRUE(is_nothrow_move_constructible<Name::Component>::value);
+  ASSERT_TRUE(is_nothrow_move_assignable<Name::Component>::value);
+
+  // Moving a long value takes its Blob.
+  string longValue(100, 'a');
+  Name::Component longComponent(longValue);
+  const uint8_t* buf = longComponent.getValue().buf();
+  Name::Component moved(move(longComponent));
+  ASSERT_EQ(buf, moved.getValue().buf());
+  ASSERT_EQ(longValue, moved.getValue().toRawStr());
+
+  // Moving an inline value keeps the Blob if getValue() created it.
+  Name::Component segment = Name::Component::fromSegment(1);
+  buf = segment.getValue().buf();
+  moved = move(segment);
+  ASSERT_EQ(1, moved.toSegment());
+  ASSERT_EQ(buf, moved.getValue().buf());
+
+  // Moving an inline value without a Blob makes one when needed.
+  moved = Name::Component::fromSegment(2);
+  ASSERT_EQ(2, moved.toSegment());
+  ASSERT_TRUE(moved.getValue().equals(Name::Component::fromSegment(2).getValue()));
+}
+
 class TestNameMethods : public ::testing::Test {
 public:
   TestNameMethods()
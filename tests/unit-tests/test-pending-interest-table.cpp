@@ -0,0 +1,216 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2020 Operant Networks, Incorporated.
+ * @author: Jeff Thompson <jefft0@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+
+#include "gtest/gtest.h"
+#include <algorithm>
+#include "../../src/impl/pending-interest-table.hpp"
+
+using namespace std;
+using namespace ndn_ind;
+
+/**
+ * Make an Interest with the name and CanBePrefix.
+ */
+static ptr_lib::shared_ptr<const Interest>
+makeInterest(const Name& name, bool canBePrefix)
+{
+  ptr_lib::shared_ptr<Interest> interest(new Interest(name));
+  interest->setCanBePrefix(canBePrefix);
+  return interest;
+}
+
+/**
+ * Get the sorted pending interest IDs of the entries.
+ */
+static vector<uint64_t>
+getIds(const vector<ptr_lib::shared_ptr<PendingInterestTable::Entry> >& entries)
+{
+  vector<uint64_t> ids;
+  for (size_t i = 0; i < entries.size(); ++i)
+    ids.push_back(entries[i]->getPendingInterestId());
+  sort(ids.begin(), ids.end());
+  return ids;
+}
+
+class TestPendingInterestTable : public ::testing::Test {
+public:
+  /**
+   * Add an entry with empty callbacks.
+   */
+  ptr_lib::shared_ptr<PendingInterestTable::Entry>
+  add(uint64_t pendingInterestId, const Name& name, bool canBePrefix)
+  {
+    return table_.add
+      (pendingInterestId, makeInterest(name, canBePrefix), OnData(),
+       OnTimeout(), OnNetworkNack());
+  }
+
+  PendingInterestTable table_;
+};
+
+TEST_F(TestPendingInterestTable, Add)
+{
+  ASSERT_EQ(0, table_.size());
+  ptr_lib::shared_ptr<PendingInterestTable::Entry> entry =
+    add(1, Name("/a/b"), false);
+  ASSERT_TRUE(!!entry);
+  ASSERT_EQ(1, entry->getPendingInterestId());
+  ASSERT_EQ(Name("/a/b"), entry->getInterest()->getName());
+  ASSERT_FALSE(entry->getIsRemoved());
+  ASSERT_EQ(1, table_.size());
+
+  // Entries with the same name are separate.
+  add(2, Name("/a/b"), false);
+  ASSERT_EQ(2, table_.size());
+
+  // Adding with an existing ID replaces the entry.
+  ptr_lib::shared_ptr<PendingInterestTable::Entry> replacement =
+    add(1, Name("/c"), false);
+  ASSERT_EQ(2, table_.size());
+  ASSERT_TRUE(entry->getIsRemoved());
+  ASSERT_FALSE(replacement->getIsRemoved());
+}
+
+TEST_F(TestPendingInterestTable, ExtractForData)
+{
+  add(1, Name("/a"), true);
+  add(2, Name("/a"), false);
+  add(3, Name("/a/b"), false);
+  add(4, Name("/a/b"), true);
+  add(5, Name("/a/b/c"), true);
+  add(6, Name("/x"), true);
+
+  // A prefix Interest needs CanBePrefix. An Interest with a longer name can't
+  // match.
+  vector<ptr_lib::shared_ptr<PendingInterestTable::Entry> > entries;
+  table_.extractEntriesForExpressedInterest(Data(Name("/a/b")), entries);
+  ASSERT_EQ(vector<uint64_t>({ 1, 3, 4 }), getIds(entries));
+  for (size_t i = 0; i < entries.size(); ++i)
+    ASSERT_TRUE(entries[i]->getIsRemoved());
+  ASSERT_EQ(3, table_.size());
+
+  // The extracted entries are removed, so they don't match again.
+  entries.clear();
+  table_.extractEntriesForExpressedInterest(Data(Name("/a/b")), entries);
+  ASSERT_EQ(0, entries.size());
+
+  entries.clear();
+  table_.extractEntriesForExpressedInterest(Data(Name("/y")), entries);
+  ASSERT_EQ(0, entries.size());
+  ASSERT_EQ(3, table_.size());
+}
+
+TEST_F(TestPendingInterestTable, ExtractForImplicitDigest)
+{
+  Data data(Name("/a/b"));
+  data.setContent(Blob((const uint8_t*)"hello", 5));
+  Name fullName = *data.getFullName();
+  Data otherData(Name("/a/b"));
+  otherData.setContent(Blob((const uint8_t*)"other", 5));
+
+  add(1, fullName, false);
+  add(2, *otherData.getFullName(), false);
+
+  // Only the Interest with the implicit digest of the Data matches.
+  vector<ptr_lib::shared_ptr<PendingInterestTable::Entry> > entries;
+  table_.extractEntriesForExpressedInterest(data, entries);
+  ASSERT_EQ(vector<uint64_t>({ 1 }), getIds(entries));
+  ASSERT_EQ(1, table_.size());
+
+  entries.clear();
+  table_.extractEntriesForExpressedInterest(otherData, entries);
+  ASSERT_EQ(vector<uint64_t>({ 2 }), getIds(entries));
+  ASSERT_EQ(0, table_.size());
+}
+
+TEST_F(TestPendingInterestTable, RemoveEntry)
+{
+  ptr_lib::shared_ptr<PendingInterestTable::Entry> entry1 =
+    add(1, Name("/a/b"), false);
+  ptr_lib::shared_ptr<PendingInterestTable::Entry> entry2 =
+    add(2, Name("/a/b"), false);
+
+  ASSERT_TRUE(table_.removeEntry(entry1));
+  ASSERT_TRUE(entry1->getIsRemoved());
+  ASSERT_EQ(1, table_.size());
+  // Removing again does nothing.
+  ASSERT_FALSE(table_.removeEntry(entry1));
+  ASSERT_EQ(1, table_.size());
+
+  // The other entry with the same name still matches.
+  vector<ptr_lib::shared_ptr<PendingInterestTable::Entry> > entries;
+  table_.extractEntriesForExpressedInterest(Data(Name("/a/b")), entries);
+  ASSERT_EQ(vector<uint64_t>({ 2 }), getIds(entries));
+  ASSERT_FALSE(table_.removeEntry(entry2));
+}
+
+TEST_F(TestPendingInterestTable, RemovePendingInterest)
+{
+  ptr_lib::shared_ptr<PendingInterestTable::Entry> entry =
+    add(1, Name("/a"), false);
+  table_.removePendingInterest(1);
+  ASSERT_TRUE(entry->getIsRemoved());
+  ASSERT_EQ(0, table_.size());
+
+  // A removal before add means that add doesn't add the entry.
+  table_.removePendingInterest(2);
+  ASSERT_FALSE(!!add(2, Name("/a"), false));
+  ASSERT_EQ(0, table_.size());
+  // The removal request is only used once.
+  ASSERT_TRUE(!!add(2, Name("/a"), false));
+  ASSERT_EQ(1, table_.size());
+}
+
+TEST_F(TestPendingInterestTable, CancelTimeout)
+{
+  int nCancels1 = 0, nCancels2 = 0, nCancels3 = 0;
+  ptr_lib::shared_ptr<PendingInterestTable::Entry> entry1 =
+    add(1, Name("/a"), false);
+  entry1->setCancelTimeout([&]() { ++nCancels1; });
+  ptr_lib::shared_ptr<PendingInterestTable::Entry> entry2 =
+    add(2, Name("/b"), false);
+  entry2->setCancelTimeout([&]() { ++nCancels2; });
+  ptr_lib::shared_ptr<PendingInterestTable::Entry> entry3 =
+    add(3, Name("/c"), false);
+  entry3->setCancelTimeout([&]() { ++nCancels3; });
+
+  // Each way of removing an entry cancels its timeout call once.
+  vector<ptr_lib::shared_ptr<PendingInterestTable::Entry> > entries;
+  table_.extractEntriesForExpressedInterest(Data(Name("/a")), entries);
+  table_.removeEntry(entry2);
+  table_.removePendingInterest(3);
+  ASSERT_EQ(1, nCancels1);
+  ASSERT_EQ(1, nCancels2);
+  ASSERT_EQ(1, nCancels3);
+
+  table_.removeEntry(entry2);
+  entry1->cancelTimeout();
+  ASSERT_EQ(1, nCancels1);
+  ASSERT_EQ(1, nCancels2);
+}
+
+int
+main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
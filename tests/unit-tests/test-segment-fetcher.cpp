@@ -0,0 +1,424 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2020 Operant Networks, Incorporated.
+ * @author: Jeff Thompson <jefft0@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+#include "gtest/gtest.h"
+#include <set>
+#include <cstdio>
+#include <unistd.h>
+#include <ndn-ind/util/segment-fetcher.hpp>
+
+using namespace std;
+using namespace std::chrono;
+using namespace ndn_ind;
+using namespace ndn_ind::func_lib;
+
+/**
+ * Append the TLV with the type and value to the output. The type and length
+ * are each one byte or three bytes.
+ */
+static void
+appendTlv(vector<uint8_t>& output, int type, const uint8_t* value, size_t length)
+{
+  int fields[] = { type, (int)length };
+  for (int i = 0; i < 2; ++i) {
+    if (fields[i] < 253)
+      output.push_back((uint8_t)fields[i]);
+    else {
+      output.push_back(253);
+      output.push_back((uint8_t)(fields[i] >> 8));
+      output.push_back((uint8_t)(fields[i] & 0xff));
+    }
+  }
+  output.insert(output.end(), value, value + length);
+}
+
+/**
+ * Make an LpPacket with the header field and the packet as the fragment.
+ * @param headerType The type of the header field.
+ * @param headerValue The value of the header field.
+ * @param packet The encoding of the Interest or Data.
+ * @return The LpPacket encoding.
+ */
+static Blob
+makeLpPacket(int headerType, const vector<uint8_t>& headerValue, const Blob& packet)
+{
+  vector<uint8_t> value;
+  appendTlv(value, headerType, &headerValue[0], headerValue.size());
+  appendTlv(value, 80, packet.buf(), packet.size());
+  vector<uint8_t> lpPacket;
+  appendTlv(lpPacket, 100, &value[0], value.size());
+  return Blob(lpPacket);
+}
+
+/**
+ * A ProducerTransport answers each Interest for /test/<version>/<segment>
+ * with a segment of the content, or as configured with a Nack, a Data packet
+ * with a CongestionMark or no answer. The answers are received in the next
+ * call to processEvents.
+ */
+class ProducerTransport : public Transport {
+public:
+  ProducerTransport(size_t nSegments, size_t segmentSize)
+  : prefix_("/test/%FD%01"), elementListener_(0)
+  {
+    for (size_t i = 0; i < nSegments * segmentSize; ++i)
+      content_.push_back((uint8_t)i);
+    for (size_t i = 0; i < nSegments; ++i) {
+      Data data(Name(prefix_).appendSegment(i));
+      data.setContent(Blob(&content_[i * segmentSize], segmentSize));
+      data.getMetaInfo().setFinalBlockId
+        (Name::Component::fromSegment(nSegments - 1));
+      segments_.push_back(data.wireEncode());
+    }
+  }
+
+  virtual bool
+  isLocal(const Transport::ConnectionInfo& connectionInfo) { return true; }
+
+  virtual bool
+  isAsync() { return false; }
+
+  virtual void
+  connect
+    (const Transport::ConnectionInfo& connectionInfo,
+     ElementListener& elementListener, const OnConnected& onConnected)
+  {
+    elementListener_ = &elementListener;
+    if (onConnected)
+      onConnected();
+  }
+
+  virtual void
+  send(const uint8_t *data, size_t dataLength)
+  {
+    Interest interest;
+    interest.wireDecode(data, dataLength);
+    uint64_t segment = 0;
+    if (interest.getName().size() > prefix_.size())
+      segment = interest.getName().get(-1).toSegment();
+    ++nInterests_[segment];
+
+    if (dropOnce_.erase(segment) > 0)
+      return;
+    if (duplicateOnce_.erase(segment) > 0) {
+      uint8_t reason[] = { ndn_NetworkNackReason_DUPLICATE };
+      vector<uint8_t> nackValue;
+      appendTlv(nackValue, 801, reason, sizeof(reason));
+      answers_.push_back
+        (makeLpPacket(800, nackValue, Blob(data, dataLength)));
+      return;
+    }
+    if (noRoute_.count(segment) > 0) {
+      uint8_t reason[] = { ndn_NetworkNackReason_NO_ROUTE };
+      vector<uint8_t> nackValue;
+      appendTlv(nackValue, 801, reason, sizeof(reason));
+      answers_.push_back
+        (makeLpPacket(800, nackValue, Blob(data, dataLength)));
+      return;
+    }
+    if (congestionMark_.count(segment) > 0) {
+      answers_.push_back
+        (makeLpPacket(832, vector<uint8_t>(1, 1), segments_[segment]));
+      return;
+    }
+
+    // Answer out of order by putting each odd segment first.
+    if (segment % 2 == 1)
+      answers_.insert(answers_.begin(), segments_[segment]);
+    else
+      answers_.push_back(segments_[segment]);
+  }
+
+  virtual void
+  processEvents()
+  {
+    vector<Blob> answers;
+    answers.swap(answers_);
+    for (size_t i = 0; i < answers.size(); ++i)
+      elementListener_->onReceivedElement(answers[i].buf(), answers[i].size());
+  }
+
+  virtual bool
+  getIsConnected() { return elementListener_ != 0; }
+
+  Name prefix_;
+  vector<uint8_t> content_;
+  vector<Blob> segments_;
+  set<uint64_t> dropOnce_;
+  set<uint64_t> duplicateOnce_;
+  set<uint64_t> noRoute_;
+  set<uint64_t> congestionMark_;
+  map<uint64_t, int> nInterests_;
+
+private:
+  ElementListener* elementListener_;
+  vector<Blob> answers_;
+};
+
+class TestSegmentFetcher : public ::testing::Test {
+public:
+  TestSegmentFetcher()
+  : nErrors_(0)
+  {
+  }
+
+  /**
+   * Fetch /test with the options through the transport and process events
+   * until finished.
+   */
+  void
+  fetch
+    (const ptr_lib::shared_ptr<ProducerTransport>& transport,
+     const SegmentFetcher::Options& options)
+  {
+    Face face(transport, ptr_lib::make_shared<Transport::ConnectionInfo>());
+    Interest interest(Name("/test"));
+    interest.setCanBePrefix(true);
+    interest.setInterestLifetime(milliseconds(1000));
+
+    bool isFinished = false;
+    fetcher_ = SegmentFetcher::fetch
+      (face, interest, SegmentFetcher::DontVerifySegment,
+       [&](const Blob& content) {
+         content_ = content;
+         isFinished = true;
+       },
+       [&](SegmentFetcher::ErrorCode errorCode, const string& message) {
+         ++nErrors_;
+         errorCode_ = errorCode;
+         isFinished = true;
+       },
+       options);
+
+    auto start = steady_clock::now();
+    while (!isFinished && steady_clock::now() - start < seconds(10)) {
+      face.processEvents();
+      if (onProcessEvents_)
+        onProcessEvents_();
+    }
+    face.shutdown();
+  }
+
+  ptr_lib::shared_ptr<SegmentFetcher> fetcher_;
+  func_lib::function<void()> onProcessEvents_;
+  Blob content_;
+  int nErrors_;
+  SegmentFetcher::ErrorCode errorCode_;
+};
+
+TEST_F(TestSegmentFetcher, Pipelined)
+{
+  ptr_lib::shared_ptr<ProducerTransport> transport
+    (new ProducerTransport(100, 10));
+  fetch(transport, SegmentFetcher::Options().setInitialWindow(4));
+
+  ASSERT_EQ(0, nErrors_);
+  ASSERT_TRUE(content_.equals(Blob(transport->content_)))
+    << "The out-of-order segments were not reassembled";
+  // The first Interest discovers segment 0, so each segment is fetched once.
+  for (uint64_t segment = 1; segment < 100; ++segment)
+    ASSERT_EQ(1, transport->nInterests_[segment]);
+  ASSERT_EQ(0, transport->nInterests_.count(100))
+    << "Requested a segment after the FinalBlockId";
+}
+
+TEST_F(TestSegmentFetcher, ConstantWindowAndCubic)
+{
+  ptr_lib::shared_ptr<ProducerTransport> transport
+    (new ProducerTransport(50, 7));
+  transport->congestionMark_.insert(10);
+  fetch(transport, SegmentFetcher::Options().setInitialWindow(8)
+        .setCongestionControl(SegmentFetcher::CONSTANT_WINDOW));
+  ASSERT_EQ(0, nErrors_);
+  ASSERT_TRUE(content_.equals(Blob(transport->content_)));
+
+  transport.reset(new ProducerTransport(50, 7));
+  transport->congestionMark_.insert(10);
+  fetch(transport, SegmentFetcher::Options()
+        .setCongestionControl(SegmentFetcher::CUBIC));
+  ASSERT_EQ(0, nErrors_);
+  ASSERT_TRUE(content_.equals(Blob(transport->content_)));
+}
+
+TEST_F(TestSegmentFetcher, RetransmitAfterNackAndTimeout)
+{
+  ptr_lib::shared_ptr<ProducerTransport> transport
+    (new ProducerTransport(20, 10));
+  transport->duplicateOnce_.insert(5);
+  transport->dropOnce_.insert(7);
+  fetch(transport, SegmentFetcher::Options().setInitialWindow(4)
+        .setInitialRto(milliseconds(50)).setMinRto(milliseconds(50)));
+
+  ASSERT_EQ(0, nErrors_);
+  ASSERT_TRUE(content_.equals(Blob(transport->content_)));
+  ASSERT_EQ(2, transport->nInterests_[5]) << "Expected a retry after the Nack";
+  ASSERT_EQ(2, transport->nInterests_[7]) << "Expected a retry after the timeout";
+}
+
+TEST_F(TestSegmentFetcher, NackError)
+{
+  ptr_lib::shared_ptr<ProducerTransport> transport
+    (new ProducerTransport(20, 10));
+  transport->noRoute_.insert(3);
+  fetch(transport, SegmentFetcher::Options().setInitialWindow(4));
+
+  ASSERT_EQ(1, nErrors_);
+  ASSERT_EQ(SegmentFetcher::NACK_ERROR, errorCode_);
+}
+
+TEST_F(TestSegmentFetcher, MaxTimeout)
+{
+  ptr_lib::shared_ptr<ProducerTransport> transport
+    (new ProducerTransport(20, 10));
+  // Drop the first Interest, which has no segment number.
+  transport->dropOnce_.insert(0);
+  fetch(transport, SegmentFetcher::Options().setInitialRto(milliseconds(20))
+        .setMaxTimeout(milliseconds(10)));
+
+  ASSERT_EQ(1, nErrors_);
+  ASSERT_EQ(SegmentFetcher::INTEREST_TIMEOUT, errorCode_);
+}
+
+TEST_F(TestSegmentFetcher, Streaming)
+{
+  ptr_lib::shared_ptr<ProducerTransport> transport
+    (new ProducerTransport(100, 10));
+  vector<uint8_t> streamed;
+  uint64_t expectedSegment = 0;
+  fetch(transport, SegmentFetcher::Options().setInitialWindow(8).setOnSegment
+        ([&](uint64_t segmentNumber, const Blob& content) {
+          ASSERT_EQ(expectedSegment, segmentNumber) << "Not in order";
+          ++expectedSegment;
+          streamed.insert(streamed.end(), content.buf(), content.buf() + content.size());
+        }));
+
+  ASSERT_EQ(0, nErrors_);
+  ASSERT_TRUE(content_.isNull()) << "onComplete should get a null Blob";
+  ASSERT_EQ(100, expectedSegment);
+  ASSERT_TRUE(Blob(streamed).equals(Blob(transport->content_)));
+}
+
+TEST_F(TestSegmentFetcher, PauseResume)
+{
+  ptr_lib::shared_ptr<ProducerTransport> transport
+    (new ProducerTransport(100, 10));
+  vector<uint8_t> streamed;
+  size_t nSegmentsWhenPaused = 0;
+  int nProcessEventsWhilePaused = 0;
+  SegmentFetcher::Options options;
+  options.setInitialWindow(4).setMaxWindow(4).setOnSegment
+    ([&](uint64_t segmentNumber, const Blob& content) {
+      ASSERT_FALSE(fetcher_->isPaused());
+      streamed.insert(streamed.end(), content.buf(), content.buf() + content.size());
+      if (segmentNumber == 10) {
+        fetcher_->pause();
+        nSegmentsWhenPaused = transport->nInterests_.size();
+      }
+    });
+  onProcessEvents_ = [&]() {
+    if (fetcher_->isPaused()) {
+      // No more Interests are sent while paused.
+      ASSERT_EQ(nSegmentsWhenPaused, transport->nInterests_.size());
+      if (++nProcessEventsWhilePaused == 20)
+        fetcher_->resume();
+    }
+  };
+  fetch(transport, options);
+
+  ASSERT_EQ(0, nErrors_);
+  ASSERT_EQ(20, nProcessEventsWhilePaused);
+  ASSERT_TRUE(Blob(streamed).equals(Blob(transport->content_)));
+  // The receive window limits the requested segments to 4 past segment 10.
+  ASSERT_LE(nSegmentsWhenPaused, 15);
+}
+
+TEST_F(TestSegmentFetcher, PauseLongerThanMaxTimeout)
+{
+  ptr_lib::shared_ptr<ProducerTransport> transport
+    (new ProducerTransport(40, 10));
+  vector<uint8_t> streamed;
+  steady_clock::time_point pauseTime;
+  SegmentFetcher::Options options;
+  options.setInitialWindow(4).setMaxWindow(4).setMinRto(milliseconds(10))
+    .setInitialRto(milliseconds(10)).setMaxTimeout(milliseconds(200))
+    .setOnSegment([&](uint64_t segmentNumber, const Blob& content) {
+      streamed.insert(streamed.end(), content.buf(), content.buf() + content.size());
+      if (segmentNumber == 10) {
+        fetcher_->pause();
+        pauseTime = steady_clock::now();
+      }
+    });
+  uint64_t firstSegmentAfterResume = 0;
+  onProcessEvents_ = [&]() {
+    if (fetcher_->isPaused() &&
+        steady_clock::now() - pauseTime > milliseconds(400)) {
+      // Drop the window of Interests sent by resume() so that they time out
+      // before another segment arrives.
+      firstSegmentAfterResume = transport->nInterests_.rbegin()->first + 1;
+      for (uint64_t i = 0; i < 4; ++i)
+        transport->dropOnce_.insert(firstSegmentAfterResume + i);
+      fetcher_->resume();
+    }
+  };
+  fetch(transport, options);
+
+  ASSERT_EQ(0, nErrors_) << "The time paused should not count as a timeout";
+  ASSERT_EQ(2, transport->nInterests_[firstSegmentAfterResume])
+    << "Expected a retry after the timeout";
+  ASSERT_TRUE(Blob(streamed).equals(Blob(transport->content_)));
+}
+
+TEST_F(TestSegmentFetcher, FileDescriptorSink)
+{
+  ptr_lib::shared_ptr<ProducerTransport> transport
+    (new ProducerTransport(30, 100));
+  FILE* file = tmpfile();
+  ASSERT_TRUE(file != 0);
+  fetch(transport, SegmentFetcher::Options().setInitialWindow(4).setOnSegment
+        (SegmentFetcher::makeFileDescriptorSink(fileno(file))));
+  ASSERT_EQ(0, nErrors_);
+
+  vector<uint8_t> written(transport->content_.size() + 1);
+  ASSERT_EQ(0, fseek(file, 0, SEEK_SET));
+  ASSERT_EQ(transport->content_.size(),
+            fread(&written[0], 1, written.size(), file));
+  written.pop_back();
+  ASSERT_TRUE(Blob(written).equals(Blob(transport->content_)));
+  fclose(file);
+
+  // Writing to the read end of a pipe fails.
+  int pipeFds[2];
+  ASSERT_EQ(0, pipe(pipeFds));
+  transport.reset(new ProducerTransport(30, 100));
+  fetch(transport, SegmentFetcher::Options().setOnSegment
+        (SegmentFetcher::makeFileDescriptorSink(pipeFds[0])));
+  ::close(pipeFds[0]);
+  ::close(pipeFds[1]);
+  ASSERT_EQ(1, nErrors_);
+  ASSERT_EQ(SegmentFetcher::IO_ERROR, errorCode_);
+}
+
+int
+main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
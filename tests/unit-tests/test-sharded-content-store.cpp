@@ -0,0 +1,156 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2020 Operant Networks, Incorporated.
+ * @author: Jeff Thompson <jefft0@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+
+#include "gtest/gtest.h"
+#include <thread>
+#include <ndn-ind/in-memory-storage/sharded-content-store.hpp>
+
+using namespace std;
+using namespace std::chrono;
+using namespace ndn_ind;
+
+/**
+ * Make an Interest with the name and CanBePrefix.
+ */
+static Interest
+makeInterest(const Name& name, bool canBePrefix)
+{
+  Interest interest(name);
+  interest.setCanBePrefix(canBePrefix);
+  return interest;
+}
+
+class TestShardedContentStore : public ::testing::Test {
+};
+
+TEST_F(TestShardedContentStore, FindAcrossShards)
+{
+  ShardedContentStore store(4);
+  ASSERT_EQ(4, store.getShardCount());
+  for (int i = 0; i < 20; ++i)
+    store.insert(Data(Name("/a").appendSegment(i)));
+  store.insert(Data(Name("/b/1")));
+  // Insert the same Data packet again.
+  store.insert(Data(Name("/b/1")));
+  ASSERT_EQ(21, store.size());
+
+  // The Data packets with the prefix are in different shards.
+  ASSERT_NE(store.getShardIndex(Name("/a").appendSegment(0)),
+            store.getShardIndex(Name("/a").appendSegment(1)));
+  ASSERT_EQ(Name("/a").appendSegment(0), store.find(Name("/a"))->getName());
+  ASSERT_EQ(Name("/a").appendSegment(0),
+            store.find(makeInterest(Name("/a"), true))->getName());
+  Interest rightmostInterest = makeInterest(Name("/a"), true);
+  rightmostInterest.setChildSelector(1);
+  ASSERT_EQ(Name("/a").appendSegment(19), store.find(rightmostInterest)->getName());
+
+  ASSERT_EQ(Name("/a").appendSegment(7),
+            store.find(makeInterest(Name("/a").appendSegment(7), false))->getName());
+  ASSERT_FALSE(store.find(makeInterest(Name("/a"), false)));
+  Data data(Name("/b/1"));
+  ASSERT_EQ(Name("/b/1"),
+            store.find(makeInterest(*data.getFullName(), false))->getName());
+  ASSERT_FALSE(store.find(Name("/c")));
+
+  store.remove(Name("/a"));
+  ASSERT_EQ(1, store.size());
+  ASSERT_FALSE(store.find(Name("/a")));
+}
+
+TEST_F(TestShardedContentStore, ShardComponents)
+{
+  // Choose the shard by the first two components.
+  ShardedContentStore store(4, 0, 2);
+  for (int version = 1; version <= 3; ++version) {
+    for (int segment = 0; segment < 5; ++segment)
+      store.insert(Data(Name("/a").appendVersion(version).appendSegment(segment)));
+  }
+
+  size_t shardIndex = store.getShardIndex(Name("/a").appendVersion(2));
+  ASSERT_EQ(shardIndex,
+            store.getShardIndex(Name("/a").appendVersion(2).appendSegment(3)));
+  ASSERT_EQ(Name("/a").appendVersion(2).appendSegment(0),
+            store.find(Name("/a").appendVersion(2))->getName());
+  Interest rightmostInterest = makeInterest(Name("/a").appendVersion(2), true);
+  rightmostInterest.setChildSelector(1);
+  ASSERT_EQ(Name("/a").appendVersion(2).appendSegment(4),
+            store.find(rightmostInterest)->getName());
+  // A shorter prefix still searches all the shards.
+  rightmostInterest.setName(Name("/a"));
+  ASSERT_EQ(Name("/a").appendVersion(3).appendSegment(4),
+            store.find(rightmostInterest)->getName());
+
+  store.remove(Name("/a").appendVersion(2));
+  ASSERT_EQ(10, store.size());
+  ASSERT_FALSE(store.find(Name("/a").appendVersion(2)));
+}
+
+TEST_F(TestShardedContentStore, Limit)
+{
+  // The limit of 8 is divided into 2 per shard.
+  ShardedContentStore store(4, 8);
+  for (int i = 0; i < 100; ++i)
+    store.insert(Data(Name("/a").appendSegment(i)));
+  ASSERT_LE(store.size(), 8);
+  ASSERT_TRUE(!!store.find(Name("/a").appendSegment(99)));
+
+  store.insert(Data(Name("/b")), milliseconds(10));
+  ASSERT_TRUE(!!store.find(Name("/b")));
+  this_thread::sleep_for(milliseconds(20));
+  ASSERT_FALSE(store.find(Name("/b")));
+}
+
+TEST_F(TestShardedContentStore, ConcurrentInsertAndFind)
+{
+  ShardedContentStore store(8);
+  const int nThreads = 4;
+  const int nData = 500;
+  vector<int> nFound(nThreads, 0);
+  vector<thread> threads;
+  for (int t = 0; t < nThreads; ++t) {
+    threads.push_back(thread([&store, &nFound, t, nData]() {
+      for (int i = 0; i < nData; ++i) {
+        Name name = Name("/thread").appendSegment(t).appendSegment(i);
+        store.insert(Data(name));
+        if (store.find(makeInterest(name, false)))
+          ++nFound[t];
+      }
+    }));
+  }
+  for (int t = 0; t < nThreads; ++t)
+    threads[t].join();
+
+  ASSERT_EQ(nThreads * nData, store.size());
+  for (int t = 0; t < nThreads; ++t)
+    ASSERT_EQ(nData, nFound[t]);
+  Interest rightmostInterest = makeInterest(Name("/thread"), true);
+  rightmostInterest.setChildSelector(1);
+  ASSERT_EQ(Name("/thread").appendSegment(nThreads - 1).appendSegment(nData - 1),
+            store.find(rightmostInterest)->getName());
+}
+
+int
+main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
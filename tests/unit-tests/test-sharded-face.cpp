@@ -0,0 +1,340 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2020 Operant Networks, Incorporated.
+ * @author: Jeff Thompson <jefft0@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+
+#include "gtest/gtest.h"
+#include <ndn-ind/ndn-ind-config.h>
+#ifdef NDN_IND_HAVE_BOOST_ASIO
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <ndn-ind/control-response.hpp>
+#include <ndn-ind/security/key-chain.hpp>
+#include <ndn-ind/sharded-face.hpp>
+
+using namespace std;
+using namespace std::chrono;
+using namespace ndn_ind;
+using namespace ndn_ind::func_lib;
+
+/**
+ * A ShardTransport stands in for the connection of one shard to the
+ * forwarder. It saves the name of each Interest which the shard sends, and
+ * answers a register command, or an Interest if isAnswering_ is true.
+ */
+class ShardTransport : public Transport {
+public:
+  ShardTransport(boost::asio::io_service& ioService)
+  : isAnswering_(true), ioService_(ioService), elementListener_(0)
+  {
+  }
+
+  virtual bool
+  isLocal(const ConnectionInfo& connectionInfo) { return true; }
+
+  virtual bool
+  isAsync() { return false; }
+
+  virtual void
+  connect
+    (const ConnectionInfo& connectionInfo, ElementListener& elementListener,
+     const OnConnected& onConnected)
+  {
+    elementListener_ = &elementListener;
+    if (onConnected)
+      onConnected();
+  }
+
+  virtual void
+  send(const uint8_t* data, size_t dataLength)
+  {
+    Interest interest;
+    interest.wireDecode(data, dataLength);
+    {
+      lock_guard<mutex> lock(mutex_);
+      interestNames_.push_back(interest.getName());
+    }
+
+    if (Name("/localhost/nfd/rib/register").isPrefixOf(interest.getName())) {
+      ControlResponse response;
+      response.setStatusCode(200);
+      Data responseData(interest.getName());
+      responseData.setContent(response.wireEncode());
+      receive(responseData.wireEncode());
+    }
+    else if (isAnswering_)
+      receive(Data(interest.getName()).wireEncode());
+  }
+
+  /**
+   * Call onReceivedElement on the thread of the shard, as if the packet is
+   * received from the forwarder. The shard must already be connected.
+   * @param encoding The packet encoding.
+   */
+  void
+  receive(const Blob& encoding)
+  {
+    ElementListener* elementListener = elementListener_;
+    ioService_.post([elementListener, encoding]() {
+      elementListener->onReceivedElement(encoding.buf(), encoding.size());
+    });
+  }
+
+  virtual void
+  processEvents() {}
+
+  virtual bool
+  getIsConnected() { return elementListener_ != 0; }
+
+  vector<Name>
+  getInterestNames()
+  {
+    lock_guard<mutex> lock(mutex_);
+    return interestNames_;
+  }
+
+  atomic<bool> isAnswering_;
+
+private:
+  boost::asio::io_service& ioService_;
+  atomic<ElementListener*> elementListener_;
+  mutex mutex_;
+  vector<Name> interestNames_;
+};
+
+/**
+ * Wait until isDone() returns true.
+ * @return True if isDone() returned true, or false after 10 seconds.
+ */
+static bool
+waitUntil(const function<bool()>& isDone)
+{
+  auto timeout = steady_clock::now() + seconds(10);
+  while (!isDone()) {
+    if (steady_clock::now() > timeout)
+      return false;
+    this_thread::sleep_for(milliseconds(1));
+  }
+
+  return true;
+}
+
+/**
+ * Make an Interest with the name where CanBePrefix is false.
+ */
+static Interest
+makeInterest(const Name& name)
+{
+  Interest interest(name);
+  interest.setCanBePrefix(false);
+  return interest;
+}
+
+class TestShardedFace : public ::testing::Test {
+public:
+  TestShardedFace()
+  : keyChain_("pib-memory:", "tpm-memory:")
+  {
+    keyChain_.createIdentityV2(Name("/TestShardedFace"));
+  }
+
+  /**
+   * Make a ShardedFace where each shard uses a ShardTransport, and put the
+   * transports in transports_ in the order of the shards.
+   */
+  ptr_lib::shared_ptr<ShardedFace>
+  makeFace(size_t nShards)
+  {
+    transports_.clear();
+    return ptr_lib::make_shared<ShardedFace>
+      (nShards,
+       [this](boost::asio::io_service& ioService) {
+         ptr_lib::shared_ptr<ShardTransport> transport
+           (new ShardTransport(ioService));
+         transports_.push_back(transport);
+         return transport;
+       },
+       ptr_lib::make_shared<Transport::ConnectionInfo>());
+  }
+
+  /**
+   * Make a name under prefix for which getShardIndex is not in shardIndexes.
+   */
+  static Name
+  makeNameOnOtherShard
+    (ShardedFace& face, const Name& prefix, const set<size_t>& shardIndexes)
+  {
+    for (int i = 0; ; ++i) {
+      Name name(prefix);
+      name.append(to_string(i));
+      if (shardIndexes.count(face.getShardIndex(name)) == 0)
+        return name;
+    }
+  }
+
+  KeyChain keyChain_;
+  vector<ptr_lib::shared_ptr<ShardTransport> > transports_;
+};
+
+TEST_F(TestShardedFace, ExpressInterestOnShardOfName)
+{
+  ptr_lib::shared_ptr<ShardedFace> face = makeFace(4);
+  ASSERT_EQ(4, face->getShardCount());
+  ASSERT_EQ(4, transports_.size());
+
+  atomic<int> nData(0);
+  for (int i = 0; i < 20; ++i)
+    face->expressInterest
+      (makeInterest(Name("/test/express").appendSegment(i)),
+       [&](auto&, auto&) { ++nData; });
+  ASSERT_TRUE(waitUntil([&]() { return nData == 20; }));
+
+  // Each Interest is sent on the connection of the shard for its name.
+  size_t nInterests = 0;
+  for (size_t i = 0; i < transports_.size(); ++i) {
+    vector<Name> names = transports_[i]->getInterestNames();
+    nInterests += names.size();
+    for (size_t j = 0; j < names.size(); ++j)
+      ASSERT_EQ(i, face->getShardIndex(names[j]));
+  }
+  ASSERT_EQ(20, nInterests);
+}
+
+TEST_F(TestShardedFace, RemovePendingInterest)
+{
+  ptr_lib::shared_ptr<ShardedFace> face = makeFace(4);
+  for (size_t i = 0; i < transports_.size(); ++i)
+    transports_[i]->isAnswering_ = false;
+
+  Name name1("/test/remove/1");
+  size_t shard1 = face->getShardIndex(name1);
+  Name name2 = makeNameOnOtherShard(*face, "/test/remove", { shard1 });
+  size_t shard2 = face->getShardIndex(name2);
+
+  atomic<int> nData1(0), nData2(0);
+  uint64_t pendingInterestId1 = face->expressInterest
+    (makeInterest(name1), [&](auto&, auto&) { ++nData1; });
+  uint64_t pendingInterestId2 = face->expressInterest
+    (makeInterest(name2), [&](auto&, auto&) { ++nData2; });
+  ASSERT_NE(pendingInterestId1, pendingInterestId2);
+  ASSERT_TRUE(waitUntil([&]() {
+    return transports_[shard1]->getInterestNames().size() == 1 &&
+           transports_[shard2]->getInterestNames().size() == 1;
+  }));
+
+  // The ID is decoded to remove the Interest from the shard which sent it.
+  face->removePendingInterest(pendingInterestId1);
+  transports_[shard1]->receive(Data(name1).wireEncode());
+  transports_[shard2]->receive(Data(name2).wireEncode());
+  ASSERT_TRUE(waitUntil([&]() { return nData2 == 1; }));
+  this_thread::sleep_for(milliseconds(100));
+  ASSERT_EQ(0, nData1);
+}
+
+TEST_F(TestShardedFace, InterestFilterOnShardOfRegisteredPrefix)
+{
+  ptr_lib::shared_ptr<ShardedFace> face = makeFace(4);
+  face->setCommandSigningInfo(keyChain_, keyChain_.getDefaultCertificateName());
+
+  // Make names where the hash of each name is on a different shard.
+  Name prefix("/test/register");
+  size_t prefixShard = face->getShardIndex(prefix);
+  Name longPrefix = makeNameOnOtherShard(*face, prefix, { prefixShard });
+  size_t longPrefixShard = face->getShardIndex(longPrefix);
+  Name filterPrefix = makeNameOnOtherShard
+    (*face, longPrefix, { prefixShard, longPrefixShard });
+
+  atomic<int> nRegistered(0);
+  face->registerPrefix
+    (prefix, OnInterestCallback(), [](auto&) {},
+     [&](auto&, auto) { ++nRegistered; });
+  uint64_t longPrefixId = face->registerPrefix
+    (longPrefix, OnInterestCallback(), [](auto&) {},
+     [&](auto&, auto) { ++nRegistered; });
+  ASSERT_TRUE(waitUntil([&]() { return nRegistered == 2; }));
+  // Each register command is sent on the connection of the shard for its name.
+  ASSERT_EQ(1, transports_[prefixShard]->getInterestNames().size());
+  ASSERT_EQ(1, transports_[longPrefixShard]->getInterestNames().size());
+
+  // The forwarder sends the Interest on the connection of the shard which
+  // registered the longest prefix, so the filter must be on that shard.
+  atomic<int> nInterests(0);
+  OnInterestCallback onInterest = [&](auto&, auto&, auto&, auto, auto&) {
+    ++nInterests;
+  };
+  uint64_t interestFilterId = face->setInterestFilter
+    (InterestFilter(filterPrefix), onInterest);
+  Blob interestEncoding =
+    makeInterest(Name(filterPrefix).append("a")).wireEncode();
+  transports_[longPrefixShard]->receive(interestEncoding);
+  ASSERT_TRUE(waitUntil([&]() { return nInterests == 1; }));
+
+  // The ID is decoded to unset the filter on the shard which set it.
+  face->unsetInterestFilter(interestFilterId);
+  transports_[longPrefixShard]->receive(interestEncoding);
+  this_thread::sleep_for(milliseconds(100));
+  ASSERT_EQ(1, nInterests);
+
+  // After removing the long prefix, the filter uses the shorter prefix.
+  face->removeRegisteredPrefix(longPrefixId);
+  face->setInterestFilter(InterestFilter(filterPrefix), onInterest);
+  transports_[prefixShard]->receive(interestEncoding);
+  ASSERT_TRUE(waitUntil([&]() { return nInterests == 2; }));
+}
+
+TEST_F(TestShardedFace, DestroyWithPendingInterests)
+{
+  atomic<int> nCallbacks(0);
+  auto startTime = steady_clock::now();
+  {
+    ptr_lib::shared_ptr<ShardedFace> face = makeFace(4);
+    for (size_t i = 0; i < transports_.size(); ++i)
+      transports_[i]->isAnswering_ = false;
+
+    for (int i = 0; i < 20; ++i) {
+      Interest interest(makeInterest(Name("/test/destroy").appendSegment(i)));
+      interest.setInterestLifetime(seconds(10));
+      face->expressInterest
+        (interest, [&](auto&, auto&) { ++nCallbacks; },
+         [&](auto&) { ++nCallbacks; }, [&](auto&, auto&) { ++nCallbacks; });
+    }
+    ASSERT_TRUE(waitUntil([&]() {
+      size_t nInterests = 0;
+      for (size_t i = 0; i < transports_.size(); ++i)
+        nInterests += transports_[i]->getInterestNames().size();
+      return nInterests == 20;
+    }));
+  }
+
+  // The destructor stops the shards without waiting for the Interest timeouts.
+  ASSERT_TRUE(steady_clock::now() - startTime < seconds(5));
+  ASSERT_EQ(0, nCallbacks);
+}
+
+#endif // NDN_IND_HAVE_BOOST_ASIO
+
+int
+main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
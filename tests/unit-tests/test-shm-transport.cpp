@@ -0,0 +1,382 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (C) 2020 Operant Networks, Incorporated.
+ * @author: Jeff Thompson <jefft0@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+#include "gtest/gtest.h"
+#include <ndn-ind/ndn-ind-config.h>
+#if NDN_IND_HAVE_SYS_EVENTFD_H
+
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <ndn-ind/face.hpp>
+#include <ndn-ind/security/key-chain.hpp>
+#include <ndn-ind/transport/shm-transport.hpp>
+#include <ndn-ind-tools/micro-forwarder/micro-forwarder.hpp>
+
+using namespace std;
+using namespace std::chrono;
+using namespace ndn_ind;
+using namespace ndn_ind::func_lib;
+using namespace ndntools;
+
+/**
+ * A SavingElementListener saves each received element.
+ */
+class SavingElementListener : public ElementListener {
+public:
+  virtual void
+  onReceivedElement(const uint8_t *element, size_t elementLength)
+  {
+    elements_.push_back(string((const char*)element, elementLength));
+  }
+
+  vector<string> elements_;
+};
+
+/**
+ * A KeepingElementListener also keeps the Blob of each received element.
+ */
+class KeepingElementListener : public SavingElementListener {
+public:
+  virtual void
+  onReceivedElement(const Blob& element)
+  {
+    SavingElementListener::onReceivedElement(element.buf(), element.size());
+    blobs_.push_back(element);
+  }
+
+  vector<Blob> blobs_;
+};
+
+/**
+ * Make a TLV element of type 5 with a value of valueLength bytes of the
+ * character c, using a 3-byte length encoding if needed.
+ */
+static string
+makeElement(size_t valueLength, char c)
+{
+  string element("\x05", 1);
+  if (valueLength < 253)
+    element += (char)valueLength;
+  else {
+    element += (char)253;
+    element += (char)(valueLength >> 8);
+    element += (char)(valueLength & 0xff);
+  }
+  return element + string(valueLength, c);
+}
+
+static void
+sendString(Transport& transport, const string& packet)
+{
+  transport.send((const uint8_t*)packet.data(), packet.size());
+}
+
+/**
+ * Call processEvents() for both transports until the listener has nElements
+ * elements or a timeout.
+ */
+static void
+processEventsUntil
+  (Transport& transport1, Transport& transport2,
+   const SavingElementListener& listener, size_t nElements)
+{
+  auto timeout = steady_clock::now() + seconds(10);
+  while (listener.elements_.size() < nElements &&
+         steady_clock::now() < timeout) {
+    transport1.processEvents();
+    transport2.processEvents();
+  }
+}
+
+static string
+makeFilePath(const char* name)
+{
+  return string("/tmp/test-shm-transport-") + name + "-" + to_string(getpid()) +
+    ".sock";
+}
+
+/**
+ * Connect the client with a ShmTransport::ConnectionInfo and the server with a
+ * ShmTransport::AcceptedConnectionInfo.
+ */
+static void
+connectPair
+  (ShmTransport& client, SavingElementListener& clientListener,
+   ShmTransport& server, SavingElementListener& serverListener,
+   size_t ringCapacity = ShmTransport::ConnectionInfo::getDefaultRingCapacity())
+{
+  string filePath = makeFilePath("pair");
+  unlink(filePath.c_str());
+  int listenSocket = socket(AF_UNIX, SOCK_STREAM, 0);
+  struct sockaddr_un address;
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  strncpy(address.sun_path, filePath.c_str(), sizeof(address.sun_path) - 1);
+  if (::bind(listenSocket, (struct sockaddr*)&address, sizeof(address)) != 0 ||
+      listen(listenSocket, 1) != 0)
+    throw runtime_error("Can't listen on the Unix socket");
+
+  client.connect
+    (ShmTransport::ConnectionInfo(filePath.c_str(), ringCapacity),
+     clientListener, Transport::OnConnected());
+  int socketDescriptor = accept(listenSocket, 0, 0);
+  ::close(listenSocket);
+  unlink(filePath.c_str());
+  server.connect
+    (ShmTransport::AcceptedConnectionInfo(socketDescriptor), serverListener,
+     Transport::OnConnected());
+}
+
+class TestShmTransport : public ::testing::Test {
+};
+
+TEST_F(TestShmTransport, SendAndReceive)
+{
+  ShmTransport client, server;
+  SavingElementListener clientListener, serverListener;
+  connectPair(client, clientListener, server, serverListener);
+  ASSERT_TRUE(client.isLocal(ShmTransport::ConnectionInfo("")));
+  ASSERT_TRUE(client.getIsConnected());
+  ASSERT_TRUE(server.getIsConnected());
+
+  string element1 = makeElement(10, 'a');
+  string element2 = makeElement(8000, 'b');
+  sendString(client, element1);
+  sendString(client, element2);
+  processEventsUntil(client, server, serverListener, 2);
+  ASSERT_EQ(2, serverListener.elements_.size());
+  ASSERT_EQ(element1, serverListener.elements_[0]);
+  ASSERT_EQ(element2, serverListener.elements_[1]);
+
+  // Corked packets are delivered in order.
+  server.cork();
+  sendString(server, element2);
+  sendString(server, element1);
+  server.uncork();
+  processEventsUntil(client, server, clientListener, 2);
+  ASSERT_EQ(2, clientListener.elements_.size());
+  ASSERT_EQ(element2, clientListener.elements_[0]);
+  ASSERT_EQ(element1, clientListener.elements_[1]);
+}
+
+TEST_F(TestShmTransport, WrapAndOverflow)
+{
+  ShmTransport client, server;
+  SavingElementListener clientListener, serverListener;
+  // Use the minimum ring capacity so that the ring wraps many times.
+  connectPair(client, clientListener, server, serverListener, 1);
+
+  // Send more than fits in the ring before the server reads, so that the
+  // client must queue packets and write them when the server frees space.
+  vector<string> elements;
+  for (size_t i = 0; i < 200; ++i) {
+    elements.push_back(makeElement(1 + (i * 997) % 8000, 'a' + i % 26));
+    sendString(client, elements.back());
+  }
+  processEventsUntil(client, server, serverListener, elements.size());
+  ASSERT_EQ(elements.size(), serverListener.elements_.size());
+  for (size_t i = 0; i < elements.size(); ++i)
+    ASSERT_EQ(elements[i], serverListener.elements_[i]);
+}
+
+TEST_F(TestShmTransport, KeepReceivedBlobs)
+{
+  ShmTransport client, server;
+  SavingElementListener clientListener;
+  KeepingElementListener serverListener;
+  connectPair(client, clientListener, server, serverListener, 1);
+
+  // Send enough to wrap the ring and fill more than one copy buffer.
+  vector<string> elements;
+  for (size_t i = 0; i < 200; ++i) {
+    elements.push_back(makeElement(1 + (i * 997) % 8000, 'a' + i % 26));
+    sendString(client, elements.back());
+  }
+  processEventsUntil(client, server, serverListener, elements.size());
+  ASSERT_EQ(elements.size(), serverListener.blobs_.size());
+
+  // The kept Blobs are not overwritten by later packets.
+  for (size_t i = 0; i < elements.size(); ++i)
+    ASSERT_EQ(elements[i], string
+      ((const char*)serverListener.blobs_[i].buf(),
+       serverListener.blobs_[i].size()));
+}
+
+TEST_F(TestShmTransport, WaitForReceive)
+{
+  ShmTransport client, server;
+  SavingElementListener clientListener, serverListener;
+  connectPair(client, clientListener, server, serverListener);
+
+  // With nothing to receive, wait for maxWait.
+  auto startTime = steady_clock::now();
+  server.waitForReceive(milliseconds(50));
+  ASSERT_TRUE(steady_clock::now() - startTime >= milliseconds(50));
+
+  // A send from another thread wakes the waiting server.
+  string element = makeElement(100, 'c');
+  thread sender([&]() {
+    this_thread::sleep_for(milliseconds(100));
+    sendString(client, element);
+  });
+  startTime = steady_clock::now();
+  server.waitForReceive(nanoseconds::max());
+  auto elapsed = steady_clock::now() - startTime;
+  sender.join();
+  ASSERT_TRUE(elapsed < seconds(5)) << "The send did not wake the server";
+  server.processEvents();
+  ASSERT_EQ(1, serverListener.elements_.size());
+  ASSERT_EQ(element, serverListener.elements_[0]);
+}
+
+TEST_F(TestShmTransport, Close)
+{
+  ShmTransport client, server;
+  SavingElementListener clientListener, serverListener;
+  connectPair(client, clientListener, server, serverListener);
+
+  // Packets sent before closing are still received.
+  string element = makeElement(100, 'd');
+  sendString(client, element);
+  client.close();
+  ASSERT_FALSE(client.getIsConnected());
+
+  server.processEvents();
+  ASSERT_EQ(1, serverListener.elements_.size());
+  ASSERT_FALSE(server.getIsConnected());
+  ASSERT_THROW(sendString(server, element), runtime_error);
+
+  // Without a peer to wake it, waiting for nanoseconds::max() still returns.
+  auto startTime = steady_clock::now();
+  server.waitForReceive(nanoseconds::max());
+  ASSERT_TRUE(steady_clock::now() - startTime < seconds(5));
+}
+
+TEST_F(TestShmTransport, MicroForwarder)
+{
+  string filePath = makeFilePath("forwarder");
+  MicroForwarder forwarder;
+  forwarder.listenShm(filePath);
+
+  KeyChain keyChain("pib-memory:", "tpm-memory:");
+  keyChain.createIdentityV2(Name("/TestShmTransport"));
+
+  Face producerFace
+    (ptr_lib::make_shared<ShmTransport>(),
+     ptr_lib::make_shared<ShmTransport::ConnectionInfo>(filePath.c_str()));
+  producerFace.setCommandSigningInfo
+    (keyChain, keyChain.getDefaultCertificateName());
+  Face consumerFace
+    (ptr_lib::make_shared<ShmTransport>(),
+     ptr_lib::make_shared<ShmTransport::ConnectionInfo>(filePath.c_str()));
+
+  Name prefix("/test/shm");
+  bool isRegistered = false;
+  producerFace.registerPrefix
+    (prefix,
+     [&](auto&, auto& interest, auto& face, auto, auto&) {
+       Data data(interest->getName());
+       data.setContent(Blob((const uint8_t*)"hello", 5));
+       keyChain.sign(data);
+       face.putData(data);
+     },
+     [](auto&) {},
+     [&](auto&, auto) { isRegistered = true; });
+
+  auto processEventsUntil = [&](const function<bool()>& isDone) {
+    auto timeout = steady_clock::now() + seconds(10);
+    while (!isDone() && steady_clock::now() < timeout) {
+      forwarder.processEvents();
+      producerFace.processEvents();
+      consumerFace.processEvents();
+    }
+  };
+  processEventsUntil([&]() { return isRegistered; });
+  ASSERT_TRUE(isRegistered);
+
+  // The forwarder sends the Interest and Data through the shared memory faces.
+  string content;
+  bool isTimedOut = false;
+  Interest interest(Name(prefix).append("1"));
+  interest.setCanBePrefix(false);
+  consumerFace.expressInterest
+    (interest,
+     [&](auto&, auto& data) { content = data->getContent().toRawStr(); },
+     [&](auto&) { isTimedOut = true; });
+  processEventsUntil([&]() { return content.size() > 0 || isTimedOut; });
+  unlink(filePath.c_str());
+  ASSERT_EQ("hello", content);
+}
+
+TEST_F(TestShmTransport, MicroForwarderSilentClient)
+{
+  string filePath = makeFilePath("silent");
+  MicroForwarder forwarder;
+  forwarder.listenShm(filePath);
+
+  // Connect a Unix socket which never sends the shared memory.
+  int silentSocket = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  struct sockaddr_un address;
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  strncpy(address.sun_path, filePath.c_str(), sizeof(address.sun_path) - 1);
+  ASSERT_EQ(0, ::connect
+    (silentSocket, (struct sockaddr*)&address, sizeof(address)));
+
+  // The forwarder doesn't wait for the shared memory.
+  auto startTime = steady_clock::now();
+  forwarder.processEvents();
+  forwarder.processEvents();
+  ASSERT_TRUE(steady_clock::now() - startTime < seconds(1));
+
+  // The forwarder still adds a face for an application which connects after.
+  KeyChain keyChain("pib-memory:", "tpm-memory:");
+  keyChain.createIdentityV2(Name("/TestShmTransport"));
+  Face face
+    (ptr_lib::make_shared<ShmTransport>(),
+     ptr_lib::make_shared<ShmTransport::ConnectionInfo>(filePath.c_str()));
+  face.setCommandSigningInfo(keyChain, keyChain.getDefaultCertificateName());
+  bool isRegistered = false;
+  face.registerPrefix
+    (Name("/test/shm"), [](auto&, auto&, auto&, auto, auto&) {},
+     [](auto&) {}, [&](auto&, auto) { isRegistered = true; });
+  auto timeout = steady_clock::now() + seconds(10);
+  while (!isRegistered && steady_clock::now() < timeout) {
+    forwarder.processEvents();
+    face.processEvents();
+  }
+  ::close(silentSocket);
+  unlink(filePath.c_str());
+  ASSERT_TRUE(isRegistered);
+}
+
+#endif // NDN_IND_HAVE_SYS_EVENTFD_H
+
+int
+main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,279 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (C) 2020 Operant Networks, Incorporated.
+ * @author: Jeff Thompson <jefft0@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+#include "gtest/gtest.h"
+#include <stdexcept>
+#include "../../src/transport/transport-receive-buffer.hpp"
+
+using namespace std;
+using namespace ndn_ind;
+
+/**
+ * A SavingElementListener saves each received element and its address.
+ */
+class SavingElementListener : public ElementListener {
+public:
+  virtual void
+  onReceivedElement(const uint8_t *element, size_t elementLength)
+  {
+    elements_.push_back(string((const char*)element, elementLength));
+    addresses_.push_back(element);
+  }
+
+  vector<string> elements_;
+  vector<const uint8_t*> addresses_;
+};
+
+/**
+ * A KeepingElementListener also keeps the Blob of each received element.
+ */
+class KeepingElementListener : public SavingElementListener {
+public:
+  virtual void
+  onReceivedElement(const Blob& element)
+  {
+    SavingElementListener::onReceivedElement(element.buf(), element.size());
+    blobs_.push_back(element);
+  }
+
+  vector<Blob> blobs_;
+};
+
+/**
+ * Make a TLV element of type 5 with a value of valueLength bytes of the
+ * character c, using a 3-byte length encoding if needed.
+ */
+static string
+makeElement(size_t valueLength, char c)
+{
+  string element("\x05", 1);
+  if (valueLength < 253)
+    element += (char)valueLength;
+  else {
+    element += (char)253;
+    element += (char)(valueLength >> 8);
+    element += (char)(valueLength & 0xff);
+  }
+  return element + string(valueLength, c);
+}
+
+/**
+ * Copy the bytes to the free space of the buffer and call onReceived.
+ */
+static void
+receive(TransportReceiveBuffer& buffer, const string& bytes)
+{
+  ASSERT_TRUE(bytes.size() <= buffer.getFreeSpaceLength());
+  copy(bytes.begin(), bytes.end(), buffer.getFreeSpace());
+  buffer.onReceived(bytes.size());
+}
+
+class TestTransportReceiveBuffer : public ::testing::Test {
+};
+
+TEST_F(TestTransportReceiveBuffer, InPlace)
+{
+  SavingElementListener listener;
+  TransportReceiveBuffer buffer(false);
+  buffer.reset(&listener);
+
+  ASSERT_EQ(TransportReceiveBuffer::getDefaultCapacity(),
+            buffer.getFreeSpaceLength());
+  const uint8_t* freeSpace = buffer.getFreeSpace();
+  string element1 = makeElement(10, 'a');
+  string element2 = makeElement(300, 'b');
+  receive(buffer, element1 + element2);
+
+  ASSERT_EQ(2, listener.elements_.size());
+  ASSERT_EQ(element1, listener.elements_[0]);
+  ASSERT_EQ(element2, listener.elements_[1]);
+  ASSERT_EQ(freeSpace, listener.addresses_[0])
+    << "The element should be given in place";
+  ASSERT_EQ(freeSpace + element1.size(), listener.addresses_[1])
+    << "The element should be given in place";
+  ASSERT_EQ(freeSpace, buffer.getFreeSpace())
+    << "After all elements are processed, reading should restart at the front";
+}
+
+TEST_F(TestTransportReceiveBuffer, SplitElements)
+{
+  SavingElementListener listener;
+  TransportReceiveBuffer buffer(false);
+  buffer.reset(&listener);
+
+  string stream;
+  vector<string> elements;
+  for (size_t i = 0; i < 20; ++i) {
+    elements.push_back(makeElement(i * 37, 'a' + i));
+    stream += elements.back();
+  }
+
+  // Receive in pieces which split the type, length and value.
+  size_t pieceSizes[] = { 1, 2, 3, 7, 100 };
+  for (size_t i = 0, offset = 0; offset < stream.size(); ++i) {
+    size_t length = min
+      (pieceSizes[i % (sizeof(pieceSizes) / sizeof(pieceSizes[0]))],
+       stream.size() - offset);
+    receive(buffer, stream.substr(offset, length));
+    offset += length;
+  }
+
+  ASSERT_EQ(elements, listener.elements_);
+}
+
+TEST_F(TestTransportReceiveBuffer, SplitAtEveryOffset)
+{
+  // Use a 3-byte type and a 3-byte, 5-byte and 1-byte length, so that the
+  // header is decoded in one step or by the state machine depending on the split.
+  string element1("\xfd\x01\x00\xfd\x01\x2c", 6);
+  element1 += string(300, 'a');
+  string element2("\x06\xfe\x00\x00\x00\x14", 6);
+  element2 += string(20, 'b');
+  string element3("\x07\x00", 2);
+  string stream = element1 + element2 + element3;
+
+  for (size_t split = 0; split <= stream.size(); ++split) {
+    SavingElementListener listener;
+    TransportReceiveBuffer buffer(false);
+    buffer.reset(&listener);
+
+    receive(buffer, stream.substr(0, split));
+    receive(buffer, stream.substr(split));
+    ASSERT_EQ(3, listener.elements_.size()) << "Split at " << split;
+    ASSERT_EQ(element1, listener.elements_[0]) << "Split at " << split;
+    ASSERT_EQ(element2, listener.elements_[1]) << "Split at " << split;
+    ASSERT_EQ(element3, listener.elements_[2]) << "Split at " << split;
+  }
+}
+
+TEST_F(TestTransportReceiveBuffer, Compact)
+{
+  SavingElementListener listener;
+  // Use the minimum capacity so that the tail is moved to the front often.
+  TransportReceiveBuffer buffer(false, 0);
+  buffer.reset(&listener);
+  ASSERT_EQ(2 * MAX_NDN_PACKET_SIZE, buffer.getFreeSpaceLength());
+
+  string stream;
+  vector<string> elements;
+  for (size_t i = 0; i < 100; ++i) {
+    elements.push_back(makeElement(1000 + i * 50, 'a' + i % 26));
+    stream += elements.back();
+  }
+
+  // Fill as much free space as possible with each read.
+  for (size_t offset = 0; offset < stream.size(); ) {
+    ASSERT_TRUE(buffer.getFreeSpaceLength() >= MAX_NDN_PACKET_SIZE);
+    size_t length = min(buffer.getFreeSpaceLength(), stream.size() - offset);
+    receive(buffer, stream.substr(offset, length));
+    offset += length;
+  }
+
+  ASSERT_EQ(elements, listener.elements_);
+}
+
+TEST_F(TestTransportReceiveBuffer, KeepBlobs)
+{
+  KeepingElementListener listener;
+  // Use the minimum capacity so that the bytes are moved to a new buffer often.
+  TransportReceiveBuffer buffer(false, 0);
+  buffer.reset(&listener);
+
+  const uint8_t* freeSpace = buffer.getFreeSpace();
+  string element1 = makeElement(10, 'a');
+  receive(buffer, element1);
+  ASSERT_EQ(freeSpace, listener.blobs_[0].buf())
+    << "The element should be given in place";
+  ASSERT_EQ(freeSpace + element1.size(), buffer.getFreeSpace())
+    << "The kept element should not be overwritten by the next read";
+
+  string stream;
+  vector<string> elements;
+  elements.push_back(element1);
+  for (size_t i = 0; i < 100; ++i) {
+    elements.push_back(makeElement(1000 + i * 50, 'a' + i % 26));
+    stream += elements.back();
+  }
+
+  for (size_t offset = 0; offset < stream.size(); ) {
+    ASSERT_TRUE(buffer.getFreeSpaceLength() >= MAX_NDN_PACKET_SIZE);
+    size_t length = min(buffer.getFreeSpaceLength(), stream.size() - offset);
+    receive(buffer, stream.substr(offset, length));
+    offset += length;
+  }
+
+  ASSERT_EQ(elements, listener.elements_);
+  // Each kept Blob still has its element.
+  for (size_t i = 0; i < elements.size(); ++i)
+    ASSERT_EQ(elements[i], string
+      ((const char*)listener.blobs_[i].buf(), listener.blobs_[i].size()));
+
+  // After reset(), the next element doesn't overwrite the kept Blobs.
+  buffer.reset(&listener);
+  receive(buffer, makeElement(2000, 'z'));
+  ASSERT_EQ(elements[0], string
+    ((const char*)listener.blobs_[0].buf(), listener.blobs_[0].size()));
+}
+
+TEST_F(TestTransportReceiveBuffer, MaxPacketSize)
+{
+  SavingElementListener listener;
+  TransportReceiveBuffer buffer(false);
+  buffer.reset(&listener);
+
+  string element = makeElement(MAX_NDN_PACKET_SIZE + 10, 'a');
+  ASSERT_THROW(receive(buffer, element), runtime_error);
+
+  // The received bytes are discarded, so the next element is received.
+  string element2 = makeElement(10, 'b');
+  receive(buffer, element2);
+  ASSERT_EQ(1, listener.elements_.size());
+  ASSERT_EQ(element2, listener.elements_[0]);
+}
+
+TEST_F(TestTransportReceiveBuffer, RawPackets)
+{
+  SavingElementListener listener;
+  TransportReceiveBuffer buffer(true);
+  buffer.reset(&listener);
+
+  receive(buffer, "abc");
+  receive(buffer, "de");
+  ASSERT_EQ(2, listener.elements_.size());
+  ASSERT_EQ("abc", listener.elements_[0]);
+  ASSERT_EQ("de", listener.elements_[1]);
+
+  // A kept raw packet is not overwritten by the next read.
+  KeepingElementListener keepingListener;
+  buffer.reset(&keepingListener);
+  receive(buffer, "fgh");
+  receive(buffer, "ij");
+  ASSERT_EQ(2, keepingListener.blobs_.size());
+  ASSERT_TRUE(keepingListener.blobs_[0].equals(Blob((const uint8_t*)"fgh", 3)));
+  ASSERT_TRUE(keepingListener.blobs_[1].equals(Blob((const uint8_t*)"ij", 2)));
+}
+
+int
+main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
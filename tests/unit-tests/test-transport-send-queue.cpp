@@ -0,0 +1,173 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (C) 2020 Operant Networks, Incorporated.
+ * @author: Jeff Thompson <jefft0@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, with the additional exemption that
+ * compiling, linking, and/or using OpenSSL is allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * A copy of the GNU Lesser General Public License is in the file COPYING.
+ */
+
+#include "gtest/gtest.h"
+#include <cstring>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <ndn-ind/transport/udp-transport.hpp>
+#include "../../src/transport/transport-send-queue.hpp"
+
+using namespace std;
+using namespace ndn_ind;
+using namespace ndn_ind::func_lib;
+
+/**
+ * Save each call to sendBuffers as a list of packets.
+ */
+static void
+saveBuffers
+  (const struct ndn_Blob* buffers, size_t nBuffers,
+   vector<vector<string> >* sent)
+{
+  sent->push_back(vector<string>());
+  for (size_t i = 0; i < nBuffers; ++i)
+    sent->back().push_back
+      (string((const char*)buffers[i].value, buffers[i].length));
+}
+
+static void
+sendString(TransportSendQueue& queue, const string& packet)
+{
+  queue.send((const uint8_t*)packet.data(), packet.size());
+}
+
+class TestTransportSendQueue : public ::testing::Test {
+};
+
+TEST_F(TestTransportSendQueue, Cork)
+{
+  vector<vector<string> > sent;
+  TransportSendQueue queue(bind(&saveBuffers, _1, _2, &sent));
+
+  sendString(queue, "a");
+  ASSERT_EQ(1, sent.size()) << "Not corked, so send immediately";
+  ASSERT_EQ(1, sent[0].size());
+  ASSERT_EQ("a", sent[0][0]);
+
+  queue.cork();
+  queue.cork();
+  sendString(queue, "bb");
+  sendString(queue, "ccc");
+  queue.uncork();
+  ASSERT_EQ(1, sent.size()) << "Still corked by the outer cork";
+  sendString(queue, "d");
+  queue.uncork();
+  ASSERT_EQ(2, sent.size()) << "The outer uncork sends all at once";
+  ASSERT_EQ(3, sent[1].size());
+  ASSERT_EQ("bb", sent[1][0]);
+  ASSERT_EQ("ccc", sent[1][1]);
+  ASSERT_EQ("d", sent[1][2]);
+
+  queue.uncork();
+  sendString(queue, "e");
+  ASSERT_EQ(3, sent.size()) << "An extra uncork shouldn't underflow";
+
+  queue.cork();
+  sendString(queue, "f");
+  queue.flush();
+  ASSERT_EQ(4, sent.size());
+  ASSERT_EQ("f", sent[3][0]);
+  sendString(queue, "g");
+  ASSERT_EQ(4, sent.size()) << "flush shouldn't uncork";
+  queue.uncork();
+  ASSERT_EQ(5, sent.size());
+  queue.flush();
+  ASSERT_EQ(5, sent.size()) << "Don't send an empty queue";
+}
+
+TEST_F(TestTransportSendQueue, MaxQueuedBytes)
+{
+  vector<vector<string> > sent;
+  TransportSendQueue queue(bind(&saveBuffers, _1, _2, &sent), 10);
+
+  queue.cork();
+  sendString(queue, "1234");
+  sendString(queue, "5678");
+  ASSERT_EQ(0, sent.size());
+  sendString(queue, "90");
+  ASSERT_EQ(1, sent.size()) << "Flush when the queue reaches the maximum";
+  ASSERT_EQ(3, sent[0].size());
+
+  sendString(queue, "ab");
+  sendString(queue, "0123456789");
+  ASSERT_EQ(3, sent.size()) <<
+    "Flush the queue before a large packet, then send it without copying";
+  ASSERT_EQ("ab", sent[1][0]);
+  ASSERT_EQ("0123456789", sent[2][0]);
+  queue.uncork();
+  ASSERT_EQ(3, sent.size());
+}
+
+TEST_F(TestTransportSendQueue, UdpTransport)
+{
+  // Bind a socket to receive on the loopback interface.
+  int receiver = socket(AF_INET, SOCK_DGRAM, 0);
+  ASSERT_TRUE(receiver >= 0);
+  struct sockaddr_in address;
+  memset(&address, 0, sizeof(address));
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  ASSERT_EQ(0, ::bind(receiver, (struct sockaddr*)&address, sizeof(address)));
+  socklen_t addressLength = sizeof(address);
+  ASSERT_EQ
+    (0, getsockname(receiver, (struct sockaddr*)&address, &addressLength));
+
+  class DummyElementListener : public ElementListener {
+  public:
+    virtual void
+    onReceivedElement(const uint8_t *element, size_t elementLength) {}
+  };
+  DummyElementListener elementListener;
+  UdpTransport transport;
+  transport.connect
+    (UdpTransport::ConnectionInfo("127.0.0.1", ntohs(address.sin_port)),
+     elementListener, Transport::OnConnected());
+
+  const size_t nPackets = 100;
+  transport.cork();
+  for (size_t i = 0; i < nPackets; ++i) {
+    string packet = "packet" + to_string(i);
+    transport.send((const uint8_t*)packet.data(), packet.size());
+  }
+  char buffer[100];
+  ASSERT_TRUE(recv(receiver, buffer, sizeof(buffer), MSG_DONTWAIT) < 0) <<
+    "The packets should be queued while corked";
+
+  transport.uncork();
+  for (size_t i = 0; i < nPackets; ++i) {
+    ssize_t nBytes = recv(receiver, buffer, sizeof(buffer), MSG_DONTWAIT);
+    ASSERT_EQ("packet" + to_string(i), string(buffer, nBytes)) <<
+      "Each packet should be a separate datagram in order";
+  }
+
+  transport.close();
+  close(receiver);
+}
+
+int
+main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
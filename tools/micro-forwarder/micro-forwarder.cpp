@@ -20,6 +20,17 @@
  */
 
 #include <set>
+#include <stdexcept>
+#include <cerrno>
+#include <cstring>
+#include <ndn-ind/ndn-ind-config.h>
+#if NDN_IND_HAVE_SYS_EVENTFD_H
+#include <unistd.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <ndn-ind/transport/shm-transport.hpp>
+#endif
 #include <ndn-ind/util/logging.hpp>
 #include <ndn-ind/encoding/tlv-wire-format.hpp>
 #include <ndn-ind/lite/encoding/tlv-0_3-wire-format-lite.hpp>
@@ -41,6 +52,12 @@ INIT_LOGGER("ndntools.MicroForwarder");
 
 namespace ndntools {
 
+#if NDN_IND_HAVE_SYS_EVENTFD_H
+// How long to wait for an application to send the shared memory after it
+// connects to a Unix socket given to listenShm.
+static const nanoseconds SHM_CONNECTION_TIMEOUT = seconds(5);
+#endif
+
 int
 MicroForwarder::addFace
   (const string& uri, const ptr_lib::shared_ptr<Transport>& transport,
@@ -65,6 +82,39 @@ MicroForwarder::addFace(const char *host, unsigned short port)
      ptr_lib::make_shared<TcpTransport::ConnectionInfo>(host, port));
 }
 
+#if NDN_IND_HAVE_SYS_EVENTFD_H
+void
+MicroForwarder::listenShm(const string& filePath)
+{
+  struct sockaddr_un address;
+  if (filePath.size() >= sizeof(address.sun_path))
+    throw runtime_error("MicroForwarder.listenShm: The file path is too long");
+
+  int socketDescriptor = socket
+    (AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  if (socketDescriptor < 0)
+    throw runtime_error
+      (string("MicroForwarder.listenShm: Error creating the socket: ") +
+       strerror(errno));
+
+  unlink(filePath.c_str());
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  strcpy(address.sun_path, filePath.c_str());
+  if (::bind(socketDescriptor, (struct sockaddr*)&address, sizeof(address)) != 0 ||
+      listen(socketDescriptor, 16) != 0) {
+    int errorNumber = errno;
+    ::close(socketDescriptor);
+    throw runtime_error
+      ("MicroForwarder.listenShm: Error listening on " + filePath + ": " +
+       strerror(errorNumber));
+  }
+
+  shmListeners_.push_back(make_pair(filePath, socketDescriptor));
+  _LOG_INFO("Listening for shared memory faces on " << filePath);
+}
+#endif
+
 bool
 MicroForwarder::addRoute(const Name& name, int faceId, int cost)
 {
@@ -140,6 +190,60 @@ MicroForwarder::remoteRegisterPrefix
 void
 MicroForwarder::processEvents()
 {
+#if NDN_IND_HAVE_SYS_EVENTFD_H
+  auto now = steady_clock::now();
+  for (int i = 0; i < shmListeners_.size(); ++i) {
+    while (true) {
+      // The accepted socket is non-blocking so that an application which
+      // connects but doesn't send the shared memory can't block the forwarder.
+      int socketDescriptor = accept4
+        (shmListeners_[i].second, 0, 0, SOCK_NONBLOCK | SOCK_CLOEXEC);
+      if (socketDescriptor < 0)
+        break;
+
+      PendingShmConnection connection;
+      connection.filePath = shmListeners_[i].first;
+      connection.socketDescriptor = socketDescriptor;
+      connection.deadline = now + SHM_CONNECTION_TIMEOUT;
+      pendingShmConnections_.push_back(connection);
+    }
+  }
+
+  // Add a face for each accepted socket which has received the shared memory,
+  // so that ShmTransport::connect doesn't wait for it.
+  for (size_t i = 0; i < pendingShmConnections_.size(); ) {
+    PendingShmConnection connection = pendingShmConnections_[i];
+    struct pollfd pollInfo;
+    pollInfo.fd = connection.socketDescriptor;
+    pollInfo.events = POLLIN;
+    pollInfo.revents = 0;
+    if (poll(&pollInfo, 1, 0) <= 0) {
+      if (now < connection.deadline) {
+        ++i;
+        continue;
+      }
+
+      _LOG_ERROR("MicroForwarder: Timeout receiving the shared memory on " <<
+        connection.filePath);
+      ::close(connection.socketDescriptor);
+      pendingShmConnections_.erase(pendingShmConnections_.begin() + i);
+      continue;
+    }
+
+    pendingShmConnections_.erase(pendingShmConnections_.begin() + i);
+    // If the socket has an error or was closed, then connect fails and closes it.
+    try {
+      addFace
+        ("shm://" + connection.filePath, ptr_lib::make_shared<ShmTransport>(),
+         ptr_lib::make_shared<ShmTransport::AcceptedConnectionInfo>
+           (connection.socketDescriptor));
+    } catch (const std::exception& ex) {
+      _LOG_ERROR("MicroForwarder: Error adding a shared memory face: " <<
+        ex.what());
+    }
+  }
+#endif
+
   for (int i = 0; i < faces_.size(); ++i) {
     faces_[i]->processEvents();
   }
@@ -206,7 +310,8 @@ MicroForwarder::onReceivedElement
   }
   else if (interestOrData[0] == Tlv_Data) {
     data.reset(new Data());
-    data->wireDecode(interestOrData, interestOrDataLength, *TlvWireFormat::get());
+    // Forwarding only needs the name, so don't decode the signature.
+    data->wireDecodeLazy(interestOrData, interestOrDataLength, *TlvWireFormat::get());
   }
 
   auto now = system_clock::now();
@@ -417,7 +522,8 @@ MicroForwarder::onReceivedLocalhostInterest
     Data responseData(interest->getName());
     responseData.setContent(controlResponse.wireEncode());
     // TODO: Sign the responseData.
-    face->send(*responseData.wireEncode());
+    Blob encoding = responseData.wireEncode();
+    face->send(encoding.buf(), encoding.size());
   }
   else {
     _LOG_INFO("Unrecognized localhost prefix " << interest->getName());
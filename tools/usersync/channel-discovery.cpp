@@ -355,7 +355,7 @@ ChannelDiscovery::Impl::makeChannelListData(int sequenceNo)
     if (i > 0)
       content << "\n";
     Blob channelBlob((const uint8_t*)&myChannelList_[i][0], myChannelList_[i].size());
-    content << Name::toEscapedString(*channelBlob);
+    Name::toEscapedString(channelBlob.buf(), channelBlob.size(), content);
   }
   string contentString = content.str();
   data->setContent(Blob((const uint8_t*)&contentString[0], contentString.size()));